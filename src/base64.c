@@ -44,35 +44,56 @@ void base64_parse_opts(int argc, char **argv, base64_opt_t *opt) {
     }
 }
 
+void base64_write(arena_t *arena, strview_t data, bool decode) {
+    buffer_t in = { .data = (u8*)data.buf, .len = data.len };
+    buffer_t out = decode ? base64_decode(arena, in) : base64_encode(arena, in);
+    fmt_write(out.data, out.len);
+}
+
+// 3 bytes encode to 4 characters, so as long as every block is a
+// multiple of both the padding only ends up in the last one
+#define BASE64_BLOCK_SIZE (3 * 4 * KB(8))
+
+void base64_stream(arena_t arena, oshandle_t fp, bool decode) {
+    chunkstream_t cs = chunk_init(&arena, fp, BASE64_BLOCK_SIZE);
+    usize scratch_pos = arena_tell(&arena);
+
+    strview_t block = STRV_EMPTY;
+    while (chunk_get_fixed(&cs, BASE64_BLOCK_SIZE, &block)) {
+        if (decode && !cs.terminated) {
+            block = strv_trim_right(block);
+        }
+        base64_write(&arena, block, decode);
+        arena_rewind(&arena, scratch_pos);
+    }
+
+    chunk_cleanup(&cs);
+}
+
 void TOY(base64)(int argc, char **argv) {
     base64_opt_t opt = {0};
     base64_parse_opts(argc, argv, &opt);
 
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
 
-    str_t data = {0};
-    if (opt.in_piped) {
-        data = common_read_buffered(&arena, os_stdin());
-    }
-    else if (opt.file.len) {
-        data = os_file_read_all_str(&arena, opt.file);
-    }
-    else {
-        outstream_t out = ostr_init(&arena);
-        for (i64 i = 0; i < opt.arg_count; ++i) {
-            if (i > 0) ostr_putc(&out, ' ');
-            ostr_puts(&out, opt.args[i]);
+    if (opt.in_piped || opt.file.len) {
+        oshandle_t fp = opt.in_piped ? os_stdin() : os_file_open(opt.file, OS_FILE_READ);
+        if (!os_handle_valid(fp)) {
+            fatal("can't open %v: %v", opt.file, os_get_error_string(os_get_last_error()));
         }
-        data = ostr_to_str(&out);
+        base64_stream(arena, fp, opt.decode);
+        if (!opt.in_piped) {
+            os_file_close(fp);
+        }
+        return;
     }
 
-    buffer_t in = { .data = (u8*)data.buf, .len = data.len };
-    buffer_t out = {0};
-    if (opt.decode) {
-        out = base64_decode(&arena, in);
+    outstream_t out = ostr_init(&arena);
+    for (i64 i = 0; i < opt.arg_count; ++i) {
+        if (i > 0) ostr_putc(&out, ' ');
+        ostr_puts(&out, opt.args[i]);
     }
-    else {
-        out = base64_encode(&arena, in);
-    }
-    print("%v", out);
+    str_t data = ostr_to_str(&out);
+
+    base64_write(&arena, strv(data), opt.decode);
 }
@@ -205,8 +205,12 @@ void TOY(cksum)(int argc, char **argv) {
     void *udata = cksum_crc32b_init(&arena, &opt);
     for (i64 i = 0; i < opt.file_count; ++i) {
         arena_t scratch = arena;
-        buffer_t buf = os_file_read_all(&scratch, opt.files[i]);
+        oshandle_t fp = os_file_open(opt.files[i], OS_FILE_READ);
+        os_file_view_t view = os_file_map(&scratch, fp);
+        buffer_t buf = { (u8 *)view.data.buf, view.data.len };
         u32 cksum = cksum_crc32b(scratch, buf, udata, &opt);
+        os_file_unmap(&view);
+        os_file_close(fp);
         if (opt.quiet) {
             continue;
         }
@@ -7,6 +7,16 @@
 #include <string.h>
 #include <time.h>
 
+#if (defined(__x86_64__) || defined(_M_X64)) && !COLLA_TCC
+    #define COLLA_SCAN_X64 1
+    #include <immintrin.h>
+    #if COLLA_MSVC
+        #include <intrin.h>
+    #endif
+#else
+    #define COLLA_SCAN_X64 0
+#endif
+
 #if COLLA_TCC 
 #define COLLA_NO_CONDITION_VARIABLE 1
 #define COLLA_NO_NET 1
@@ -42,11 +52,94 @@ extern void net_init(void);
 extern void net_cleanup(void);
 #endif
 
+extern bool os__stdout_is_tty(void);
+extern void os__stdout_lock(void);
+extern void os__stdout_unlock(void);
+extern void os__stdout_write(const void *buf, usize len);
+extern void os__cpu_pause(void);
+extern void os__wait_on_address(i64 *address, i64 value);
+extern void os__wake_all_on_address(i64 *address);
+extern bool os__file_map(oshandle_t handle, os_file_view_t *view);
+extern usize os__file_read_some(oshandle_t handle, void *buf, usize len);
+extern void os__file_unmap(os_file_view_t *view);
+
+typedef enum {
+    FMT__LINE_BUFFERED,
+    FMT__FULLY_BUFFERED,
+} fmt__mode_e;
+
+typedef struct fmt__out_t fmt__out_t;
+struct fmt__out_t {
+    usize len;
+    // set while formatting a record, the buffer is only written 
+    // when it overflows and in that case we keep the lock until 
+    // the whole record has been written
+    bool in_record;
+    bool locked;
+    // in the list of live buffers, so that fmt_flush_all can find it
+    bool registered;
+    fmt__out_t *prev;
+    fmt__out_t *next;
+    char buf[COLLA_FMT_BUFFER_SIZE];
+};
+
+// until colla_init we don't know where stdout goes, 
+// so assume it's a terminal
+fmt__mode_e fmt__mode = FMT__LINE_BUFFERED;
+thread_local fmt__out_t fmt__out = {0};
+// the buffers of every thread that printed something and hasn't exited yet,
+// only touched with the stdout lock held
+fmt__out_t *fmt__live = NULL;
+bool fmt__at_exit_registered = false;
+
+static fmt__out_t *fmt__get(void) {
+    fmt__out_t *out = &fmt__out;
+    if (!out->registered) {
+        os__stdout_lock();
+        out->next = fmt__live;
+        if (fmt__live) fmt__live->prev = out;
+        fmt__live = out;
+        out->registered = true;
+        os__stdout_unlock();
+    }
+    return out;
+}
+
+static void fmt__flush(fmt__out_t *out) {
+    if (out->len == 0) {
+        return;
+    }
+    if (!out->locked) os__stdout_lock();
+    os__stdout_write(out->buf, out->len);
+    if (!out->locked) os__stdout_unlock();
+    out->len = 0;
+}
+
 static char *colla_fmt__stb_callback(const char *buf, void *ud, int len) {
-    // TODO maybe use os_write?
-    fflush(stdout);
-    fwrite(buf, 1, len, stdout);
-    return (char *)ud;
+    fmt__out_t *out = ud;
+    out->len += len;
+
+    if (out->in_record) {
+        if ((out->len + STB_SPRINTF_MIN) > sizeof(out->buf)) {
+            if (!out->locked) {
+                os__stdout_lock();
+                out->locked = true;
+            }
+            fmt__flush(out);
+        }
+    }
+    else if ((out->len + STB_SPRINTF_MIN) > sizeof(out->buf)) {
+        fmt__flush(out);
+    }
+    else if (fmt__mode == FMT__LINE_BUFFERED && memchr(buf, '\n', len)) {
+        fmt__flush(out);
+    }
+
+    return out->buf + out->len;
+}
+
+static void colla_fmt__at_exit(void) {
+    fmt_flush_all();
 }
 
 void colla_init(colla_modules_e modules) {
@@ -54,6 +147,11 @@ void colla_init(colla_modules_e modules) {
     if (modules & COLLA_OS) {
         os_init();
     }
+    fmt__mode = os__stdout_is_tty() ? FMT__LINE_BUFFERED : FMT__FULLY_BUFFERED;
+    if (!fmt__at_exit_registered) {
+        atexit(colla_fmt__at_exit);
+        fmt__at_exit_registered = true;
+    }
 #if !COLLA_NO_NET
     if (modules & COLLA_NET) {
         net_init();
@@ -62,6 +160,8 @@ void colla_init(colla_modules_e modules) {
 }
 
 void colla_cleanup(void) {
+    fmt_flush();
+    scratch_release();
     colla_modules_e modules = colla__initialised_modules;
     if (modules & COLLA_OS) {
         os_cleanup();
@@ -82,8 +182,97 @@ int fmt_print(const char *fmt, ...) {
 }
 
 int fmt_printv(const char *fmt, va_list args) {
-    char buffer[STB_SPRINTF_MIN] = {0};
-    return colla_stb_vsprintfcb(colla_fmt__stb_callback, buffer, buffer, fmt, args);
+    fmt__out_t *out = fmt__get();
+    if ((out->len + STB_SPRINTF_MIN) > sizeof(out->buf)) {
+        fmt__flush(out);
+    }
+    return colla_stb_vsprintfcb(colla_fmt__stb_callback, out, out->buf + out->len, fmt, args);
+}
+
+int fmt_record(const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int out = fmt_recordv(fmt, args);
+    va_end(args);
+    return out;
+}
+
+int fmt_recordv(const char *fmt, va_list args) {
+    fmt__out_t *out = fmt__get();
+    if ((out->len + STB_SPRINTF_MIN) > sizeof(out->buf)) {
+        fmt__flush(out);
+    }
+
+    out->in_record = true;
+    int result = colla_stb_vsprintfcb(colla_fmt__stb_callback, out, out->buf + out->len, fmt, args);
+    out->in_record = false;
+
+    // the record didn't fit in the buffer, write the rest 
+    // before anyone else can get in the middle
+    if (out->locked) {
+        fmt__flush(out);
+        out->locked = false;
+        os__stdout_unlock();
+    }
+    else if (fmt__mode == FMT__LINE_BUFFERED) {
+        fmt__flush(out);
+    }
+
+    return result;
+}
+
+void fmt_write(const void *buf, usize len) {
+    fmt__out_t *out = fmt__get();
+
+    if ((out->len + len) > sizeof(out->buf)) {
+        fmt__flush(out);
+        // too big to buffer, write it directly
+        if (len >= sizeof(out->buf)) {
+            os__stdout_lock();
+            os__stdout_write(buf, len);
+            os__stdout_unlock();
+            return;
+        }
+    }
+
+    memcpy(out->buf + out->len, buf, len);
+    out->len += len;
+
+    if (fmt__mode == FMT__LINE_BUFFERED && memchr(buf, '\n', len)) {
+        fmt__flush(out);
+    }
+}
+
+void fmt_flush(void) {
+    fmt__flush(&fmt__out);
+}
+
+void fmt_flush_all(void) {
+    os__stdout_lock();
+    for (fmt__out_t *out = fmt__live; out; out = out->next) {
+        // a thread in the middle of a record that overflowed owns the lock 
+        // until it's done, so by the time we get here it has written it all
+        if (out->len) {
+            os__stdout_write(out->buf, out->len);
+            out->len = 0;
+        }
+    }
+    os__stdout_unlock();
+}
+
+void fmt_release(void) {
+    fmt__out_t *out = &fmt__out;
+    fmt__flush(out);
+    if (!out->registered) {
+        return;
+    }
+    os__stdout_lock();
+    if (out->prev) out->prev->next = out->next;
+    else           fmt__live = out->next;
+    if (out->next) out->next->prev = out->prev;
+    out->prev = out->next = NULL;
+    out->registered = false;
+    os__stdout_unlock();
 }
 
 int fmt_buffer(char *buf, usize len, const char *fmt, ...) {
@@ -414,15 +603,7 @@ bool strv_contains(strview_t ctx, char c) {
 }
 
 bool strv_contains_view(strview_t ctx, strview_t view) {
-    if (ctx.len < view.len) return false;
-    usize end = (ctx.len - view.len) + 1;
-
-    for (usize i = 0; i < end; ++i) {
-        if (memcmp(ctx.buf + i, view.buf, view.len) == 0) {
-            return true;
-        }
-    }
-    return false;
+    return strv_find_view(ctx, view, 0) != STR_NONE;
 }
 
 bool strv_contains_either(strview_t ctx, strview_t chars) {
@@ -436,25 +617,29 @@ bool strv_contains_either(strview_t ctx, strview_t chars) {
 }
 
 usize strv_find(strview_t ctx, char c, usize from) {
-    for (usize i = from; i < ctx.len; ++i) {
-        if (ctx.buf[i] == c) {
-            return i;
-        }
-    }
-    return STR_NONE;
+    if (from >= ctx.len) return STR_NONE;
+    usize pos = scan_find(strv_sub(ctx, from, STR_END), c);
+    return pos != STR_NONE ? from + pos : STR_NONE;
 }
 
-usize strv_find_view(strview_t ctx, strview_t view, usize from) {
-    if (view.len > ctx.len) return STR_NONE;
+static usize search__find(const searcher_t *s, strview_t needle, strview_t ctx, usize from);
+static usize search__rfind(const searcher_t *s, strview_t needle, strview_t ctx, usize from_right);
 
-    usize end = (ctx.len - view.len) + 1;
+// the skip tables of a searcher take longer to build than a short search, and
+// the vector pair kernels are faster than horspool even on long texts, so only
+// a long search with the scalar kernels builds them
+static bool search__wants_table(strview_t needle, usize hay_len) {
+    return needle.len >= COLLA_SEARCH_SKIP_TABLE_LEN &&
+           hay_len >= COLLA_SEARCH_SKIP_TABLE_MIN_TEXT &&
+           scan_get_isa() == SCAN_ISA_SCALAR;
+}
 
-    for (usize i = from; i < end; ++i) {
-        if (memcmp(ctx.buf + i, view.buf, view.len) == 0) {
-            return i;
-        }
+usize strv_find_view(strview_t ctx, strview_t view, usize from) {
+    if (from > ctx.len || !search__wants_table(view, ctx.len - from)) {
+        return search__find(NULL, view, ctx, from);
     }
-    return STR_NONE;
+    searcher_t searcher = searcher_init(view);
+    return searcher_find(&searcher, ctx, from);
 }
 
 usize strv_find_either(strview_t ctx, strview_t chars, usize from) {
@@ -472,2233 +657,7473 @@ usize strv_find_either(strview_t ctx, strview_t chars, usize from) {
 usize strv_rfind(strview_t ctx, char c, usize from_right) {
     if (ctx.len == 0) return STR_NONE;
     if (from_right > ctx.len) from_right = ctx.len;
-    isize end = (isize)(ctx.len - from_right);
-    for (isize i = end - 1; i >= 0; --i) {
-        if (ctx.buf[i] == c) {
-            return (usize)i;
-        }
-    }
-    return STR_NONE;
+    return scan_rfind(strv_sub(ctx, 0, ctx.len - from_right), c);
 }
 
 usize strv_rfind_view(strview_t ctx, strview_t view, usize from_right) {
-    if (ctx.len == 0) return STR_NONE;
-    if (from_right > ctx.len) from_right = ctx.len;
-    isize end = (isize)(ctx.len - from_right);
-    if (end < (isize)view.len) return STR_NONE;
-    for (isize i = end - view.len; i >= 0; --i) {
-        if (memcmp(ctx.buf + i, view.buf, view.len) == 0) {
-            return (usize)i;
-        }
+    if (from_right > ctx.len || !search__wants_table(view, ctx.len - from_right)) {
+        return search__rfind(NULL, view, ctx, from_right);
     }
-    return STR_NONE;
-}
-
-// == CTYPE ========================================================
-
-bool char_is_space(char c) {
-    return (c >= '\t' && c <= '\r') || c == ' ';
+    searcher_t searcher = searcher_init(view);
+    return searcher_rfind(&searcher, ctx, from_right);
 }
 
-bool char_is_alpha(char c) {
-    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
-}
+// == SCAN =========================================================
 
-bool char_is_num(char c) {
-    return c >= '0' && c <= '9';
-}
+#if COLLA_MSVC
+    #define SCAN__AVX2_TARGET
+#else
+    #define SCAN__AVX2_TARGET __attribute__((target("avx2")))
+#endif
 
-bool char_is_hex(char c) {
-    c = char_lower(c);
-    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+static inline u32 scan__ctz64(u64 v) {
+#if COLLA_MSVC && COLLA_SCAN_X64
+    unsigned long index = 0;
+    _BitScanForward64(&index, v);
+    return (u32)index;
+#elif COLLA_MSVC || COLLA_TCC
+    u32 n = 0;
+    while (!(v & 1)) { v >>= 1; n++; }
+    return n;
+#else
+    return (u32)__builtin_ctzll(v);
+#endif
 }
 
-char char_lower(char c) {
-    return c >= 'A' && c <= 'Z' ? c + 32 : c;
+// index of the highest set bit
+static inline u32 scan__msb64(u64 v) {
+#if COLLA_MSVC && COLLA_SCAN_X64
+    unsigned long index = 0;
+    _BitScanReverse64(&index, v);
+    return (u32)index;
+#elif COLLA_MSVC || COLLA_TCC
+    u32 n = 0;
+    while (v >>= 1) n++;
+    return n;
+#else
+    return 63u - (u32)__builtin_clzll(v);
+#endif
 }
 
-char char_upper(char c) {
-    return c <= 'a' && c >= 'z' ? c - 32 : c;
+static inline u32 scan__popcount64(u64 v) {
+#if COLLA_MSVC || COLLA_TCC
+    // popcnt is not guaranteed on every x64 cpu
+    v = v - ((v >> 1) & 0x5555555555555555ull);
+    v = (v & 0x3333333333333333ull) + ((v >> 2) & 0x3333333333333333ull);
+    v = (v + (v >> 4)) & 0x0f0f0f0f0f0f0f0full;
+    return (u32)((v * 0x0101010101010101ull) >> 56);
+#else
+    return (u32)__builtin_popcountll(v);
+#endif
 }
 
-// == INPUT STREAM =================================================
+// scalar kernels, used as is on non-x64 and for the tails
 
-instream_t istr_init(strview_t str) {
-	return (instream_t) {
-		.beg = str.buf,
-        .cur = str.buf,
-        .len = str.len,
-	};
+static u64 scan__mask64_scalar(const char *buf, char c) {
+    u64 mask = 0;
+    for (u32 i = 0; i < 64; ++i) {
+        mask |= (u64)(buf[i] == c) << i;
+    }
+    return mask;
 }
 
-char istr_get(instream_t *ctx) {
-    return istr_remaining(ctx) ? *ctx->cur++ : '\0';
+static usize scan__find_scalar(const char *buf, usize len, char c) {
+    if (len == 0) return STR_NONE;
+    const char *found = memchr(buf, c, len);
+    return found ? (usize)(found - buf) : STR_NONE;
 }
 
-char istr_peek(instream_t *ctx) {
-    return istr_remaining(ctx) ? *ctx->cur : '\0';
+static usize scan__rfind_scalar(const char *buf, usize len, char c) {
+    for (usize i = len; i > 0; --i) {
+        if (buf[i - 1] == c) {
+            return i - 1;
+        }
+    }
+    return STR_NONE;
 }
 
-char istr_peek_next(instream_t *ctx) {
-    return istr_remaining(ctx) > 1 ? *(ctx->cur + 1) : '\0';
+static usize scan__count_scalar(const char *buf, usize len, char c) {
+    usize count = 0;
+    for (usize i = 0; i < len; ++i) {
+        count += buf[i] == c;
+    }
+    return count;
 }
 
-char istr_prev(instream_t *ctx) {
-    return istr_tell(ctx) ? *(ctx->cur - 1) : '\0';
-}
+// finds a needle of at least 2 bytes by first looking for positions where 
+// both its first and last byte match, and only then comparing the middle
 
-char istr_prev_prev(instream_t *ctx) {
-    return istr_tell(ctx) > 1 ? *(ctx->cur - 2) : '\0';
+static usize scan__pair_find_scalar(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    usize starts = len - nlen + 1;
+    char last = needle[nlen - 1];
+    usize i = 0;
+    while (i < starts) {
+        const char *first = memchr(hay + i, needle[0], starts - i);
+        if (!first) {
+            break;
+        }
+        i = (usize)(first - hay);
+        if (hay[i + nlen - 1] == last && memcmp(hay + i + 1, needle + 1, nlen - 2) == 0) {
+            return i;
+        }
+        i++;
+    }
+    return STR_NONE;
 }
 
-void istr_ignore(instream_t *ctx, char delim) {
-    while (!istr_is_finished(ctx) && *ctx->cur != delim) {
-        ctx->cur++;
+static usize scan__pair_rfind_scalar(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    char first = needle[0];
+    char last = needle[nlen - 1];
+    for (usize i = len - nlen + 1; i > 0; --i) {
+        const char *cur = hay + i - 1;
+        if (cur[0] == first && cur[nlen - 1] == last && memcmp(cur + 1, needle + 1, nlen - 2) == 0) {
+            return i - 1;
+        }
     }
+    return STR_NONE;
 }
 
-void istr_ignore_and_skip(instream_t *ctx, char delim) {
-    istr_ignore(ctx, delim);
-    istr_skip(ctx, 1);
-}
+#if COLLA_SCAN_X64
 
-void istr_skip(instream_t *ctx, usize n) {
-    if (!ctx) return;
-    usize rem = istr_remaining(ctx);
-    if (n > rem) n = rem;
-    ctx->cur += n;
-}
+// SSE2 is part of x64, no need to check for it
 
-void istr_skip_whitespace(instream_t *ctx) {
-    while (!istr_is_finished(ctx) && char_is_space(*ctx->cur)) {
-        ctx->cur++;
-    }
+static u64 scan__mask64_sse2(const char *buf, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    u64 m0 = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf +  0)), needle));
+    u64 m1 = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + 16)), needle));
+    u64 m2 = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + 32)), needle));
+    u64 m3 = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + 48)), needle));
+    return m0 | (m1 << 16) | (m2 << 32) | (m3 << 48);
 }
 
-void istr_rewind(instream_t *ctx) {
-    if (ctx) ctx->cur = ctx->beg;
-}
+static usize scan__find_sse2(const char *buf, usize len, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    usize i = 0;
 
-void istr_rewind_n(instream_t *ctx, usize amount) {
-    if (!ctx) return;
-    usize rem = istr_remaining(ctx);
-    ctx->cur -= MIN(amount, rem);
-}
+    for (; (i + 64) <= len; i += 64) {
+        __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i +  0)), needle);
+        __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i + 16)), needle);
+        __m128i d = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i + 32)), needle);
+        __m128i e = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i + 48)), needle);
+        __m128i any = _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(d, e));
+        if (_mm_movemask_epi8(any)) {
+            return i + scan__ctz64(scan__mask64_sse2(buf + i, c));
+        }
+    }
 
-usize istr_tell(instream_t *ctx) {
-    return ctx ? ctx->cur - ctx->beg : 0;
-}
+    for (; (i + 16) <= len; i += 16) {
+        u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i)), needle));
+        if (mask) {
+            return i + scan__ctz64(mask);
+        }
+    }
 
-usize istr_remaining(instream_t *ctx) {
-    return ctx ? ctx->len - (ctx->cur - ctx->beg) : 0;
-}
- 
-bool istr_is_finished(instream_t *ctx) {
-    return !(ctx && istr_remaining(ctx) > 0);
+    usize found = scan__find_scalar(buf + i, len - i, c);
+    return found != STR_NONE ? i + found : STR_NONE;
 }
 
-bool istr_get_bool(instream_t *ctx, bool *val) {
-    if (!ctx || !ctx->cur || !val) return false;
-    usize rem = istr_remaining(ctx);
-    if (rem >= 4 && memcmp(ctx->cur, "true", 4) == 0) {
-        *val = true;
-        ctx->cur += 4;
-        return true;
+static usize scan__rfind_sse2(const char *buf, usize len, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    usize i = len;
+
+    for (; i >= 64; i -= 64) {
+        u64 mask = scan__mask64_sse2(buf + i - 64, c);
+        if (mask) {
+            return i - 64 + scan__msb64(mask);
+        }
     }
-    if (rem >= 5 && memcmp(ctx->cur, "false", 5) == 0) {
-        *val = false;
-        ctx->cur += 5;
-        return true;
+
+    for (; i >= 16; i -= 16) {
+        u32 mask = (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i - 16)), needle));
+        if (mask) {
+            return i - 16 + scan__msb64(mask);
+        }
     }
-    return false;
+
+    return scan__rfind_scalar(buf, i, c);
 }
 
-bool istr_get_u8(instream_t *ctx, u8 *val) {
-    u64 out = 0;
-    bool result = istr_get_u64(ctx, &out);
-    if (result && out < UINT8_MAX) {
-        *val = (u8)out;
+static usize scan__count_sse2(const char *buf, usize len, char c) {
+    __m128i needle = _mm_set1_epi8(c);
+    __m128i zero = _mm_setzero_si128();
+    __m128i total = zero;
+    usize i = 0;
+
+    while ((i + 16) <= len) {
+        // every byte counts up to 255 matches before being summed up
+        __m128i partial = zero;
+        for (u32 n = 0; n < 255 && (i + 16) <= len; ++n, i += 16) {
+            __m128i eq = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *)(buf + i)), needle);
+            partial = _mm_sub_epi8(partial, eq);
+        }
+        total = _mm_add_epi64(total, _mm_sad_epu8(partial, zero));
     }
-    return result;
+
+    usize count = (usize)_mm_cvtsi128_si64(total) + 
+                  (usize)_mm_cvtsi128_si64(_mm_unpackhi_epi64(total, total));
+    return count + scan__count_scalar(buf + i, len - i, c);
 }
 
-bool istr_get_u16(instream_t *ctx, u16 *val) {
-    u64 out = 0;
-    bool result = istr_get_u64(ctx, &out);
-    if (result && out < UINT16_MAX) {
-        *val = (u16)out;
+static usize scan__pair_find_sse2(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last  = _mm_set1_epi8(needle[nlen - 1]);
+    usize starts = len - nlen + 1;
+    usize i = 0;
+
+    for (; (i + 16) <= starts; i += 16) {
+        __m128i eq_first = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(hay + i)));
+        __m128i eq_last  = _mm_cmpeq_epi8(last,  _mm_loadu_si128((const __m128i *)(hay + i + nlen - 1)));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+        while (mask) {
+            u32 bit = scan__ctz64(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
     }
-    return result;
+
+    usize found = scan__pair_find_scalar(hay + i, len - i, needle, nlen);
+    return found != STR_NONE ? i + found : STR_NONE;
 }
 
-bool istr_get_u32(instream_t *ctx, u32 *val) {
-    u64 out = 0;
-    bool result = istr_get_u64(ctx, &out);
-    if (result && out < UINT32_MAX) {
-        *val = (u32)out;
+static usize scan__pair_rfind_sse2(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    __m128i first = _mm_set1_epi8(needle[0]);
+    __m128i last  = _mm_set1_epi8(needle[nlen - 1]);
+    usize starts = len - nlen + 1;
+
+    for (; starts >= 16; starts -= 16) {
+        usize i = starts - 16;
+        __m128i eq_first = _mm_cmpeq_epi8(first, _mm_loadu_si128((const __m128i *)(hay + i)));
+        __m128i eq_last  = _mm_cmpeq_epi8(last,  _mm_loadu_si128((const __m128i *)(hay + i + nlen - 1)));
+        u32 mask = (u32)_mm_movemask_epi8(_mm_and_si128(eq_first, eq_last));
+        while (mask) {
+            u32 bit = scan__msb64(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0) {
+                return i + bit;
+            }
+            mask &= ~(1u << bit);
+        }
     }
-    return result;
+
+    return scan__pair_rfind_scalar(hay, starts + nlen - 1, needle, nlen);
 }
 
+SCAN__AVX2_TARGET
+static u64 scan__mask64_avx2(const char *buf, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    u64 lo = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf +  0)), needle));
+    u64 hi = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + 32)), needle));
+    return lo | (hi << 32);
+}
 
-bool istr_get_u64(instream_t *ctx, u64 *val) {
-    if (!ctx || !ctx->cur || !val) return false;
-    char *end = NULL;
-    *val = strtoull(ctx->cur, &end, 0);
+SCAN__AVX2_TARGET
+static usize scan__find_avx2(const char *buf, usize len, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    usize i = 0;
 
-    if (ctx->cur == end) {
-        return false;
+    for (; (i + 128) <= len; i += 128) {
+        __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i +  0)), needle);
+        __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i + 32)), needle);
+        __m256i d = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i + 64)), needle);
+        __m256i e = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i + 96)), needle);
+        __m256i any = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(d, e));
+        if (_mm256_movemask_epi8(any)) {
+            u64 mask = scan__mask64_avx2(buf + i, c);
+            if (mask) {
+                return i + scan__ctz64(mask);
+            }
+            return i + 64 + scan__ctz64(scan__mask64_avx2(buf + i + 64, c));
+        }
     }
-    else if (*val == ULLONG_MAX) {
-        return false;
+
+    for (; (i + 32) <= len; i += 32) {
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i)), needle));
+        if (mask) {
+            return i + scan__ctz64(mask);
+        }
     }
 
-    ctx->cur = end;
-    return true;
+    usize found = scan__find_scalar(buf + i, len - i, c);
+    return found != STR_NONE ? i + found : STR_NONE;
 }
 
-bool istr_get_i8(instream_t *ctx, i8 *val) {
-    i64 out = 0;
-    bool result = istr_get_i64(ctx, &out);
-    if (result && out > INT8_MIN && out < INT8_MAX) {
-        *val = (i8)out;
+SCAN__AVX2_TARGET
+static usize scan__rfind_avx2(const char *buf, usize len, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    usize i = len;
+
+    for (; i >= 64; i -= 64) {
+        u64 mask = scan__mask64_avx2(buf + i - 64, c);
+        if (mask) {
+            return i - 64 + scan__msb64(mask);
+        }
     }
-    return result;
-}
 
-bool istr_get_i16(instream_t *ctx, i16 *val) {
-    i64 out = 0;
-    bool result = istr_get_i64(ctx, &out);
-    if (result && out > INT16_MIN && out < INT16_MAX) {
-        *val = (i16)out;
+    for (; i >= 32; i -= 32) {
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i - 32)), needle));
+        if (mask) {
+            return i - 32 + scan__msb64(mask);
+        }
     }
-    return result;
+
+    return scan__rfind_scalar(buf, i, c);
 }
 
-bool istr_get_i32(instream_t *ctx, i32 *val) {
-    i64 out = 0;
-    bool result = istr_get_i64(ctx, &out);
-    if (result && out > INT32_MIN && out < INT32_MAX) {
-        *val = (i32)out;
+SCAN__AVX2_TARGET
+static usize scan__count_avx2(const char *buf, usize len, char c) {
+    __m256i needle = _mm256_set1_epi8(c);
+    __m256i zero = _mm256_setzero_si256();
+    __m256i total = zero;
+    usize i = 0;
+
+    while ((i + 32) <= len) {
+        __m256i partial = zero;
+        for (u32 n = 0; n < 255 && (i + 32) <= len; ++n, i += 32) {
+            __m256i eq = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i *)(buf + i)), needle);
+            partial = _mm256_sub_epi8(partial, eq);
+        }
+        total = _mm256_add_epi64(total, _mm256_sad_epu8(partial, zero));
+    }
+
+    usize count = (usize)_mm256_extract_epi64(total, 0) + 
+                  (usize)_mm256_extract_epi64(total, 1) + 
+                  (usize)_mm256_extract_epi64(total, 2) + 
+                  (usize)_mm256_extract_epi64(total, 3);
+    return count + scan__count_scalar(buf + i, len - i, c);
+}
+
+SCAN__AVX2_TARGET
+static usize scan__pair_find_avx2(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last  = _mm256_set1_epi8(needle[nlen - 1]);
+    usize starts = len - nlen + 1;
+    usize i = 0;
+
+    for (; (i + 32) <= starts; i += 32) {
+        __m256i eq_first = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(hay + i)));
+        __m256i eq_last  = _mm256_cmpeq_epi8(last,  _mm256_loadu_si256((const __m256i *)(hay + i + nlen - 1)));
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(eq_first, eq_last));
+        while (mask) {
+            u32 bit = scan__ctz64(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0) {
+                return i + bit;
+            }
+            mask &= mask - 1;
+        }
     }
-    return result;
+
+    usize found = scan__pair_find_scalar(hay + i, len - i, needle, nlen);
+    return found != STR_NONE ? i + found : STR_NONE;
 }
 
-bool istr_get_i64(instream_t *ctx, i64 *val) {
-    if (!ctx || !ctx->cur || !val) return false;
-    char *end = NULL;
-    i64 out = strtoll(ctx->cur, &end, 0);
+SCAN__AVX2_TARGET
+static usize scan__pair_rfind_avx2(const char *hay, usize len, const char *needle, usize nlen) {
+    if (len < nlen) return STR_NONE;
+    __m256i first = _mm256_set1_epi8(needle[0]);
+    __m256i last  = _mm256_set1_epi8(needle[nlen - 1]);
+    usize starts = len - nlen + 1;
 
-    if (ctx->cur == end) {
-        return false;
-    }
-    else if(*val == INT64_MAX || *val == INT64_MIN) {
-        return false;
+    for (; starts >= 32; starts -= 32) {
+        usize i = starts - 32;
+        __m256i eq_first = _mm256_cmpeq_epi8(first, _mm256_loadu_si256((const __m256i *)(hay + i)));
+        __m256i eq_last  = _mm256_cmpeq_epi8(last,  _mm256_loadu_si256((const __m256i *)(hay + i + nlen - 1)));
+        u32 mask = (u32)_mm256_movemask_epi8(_mm256_and_si256(eq_first, eq_last));
+        while (mask) {
+            u32 bit = scan__msb64(mask);
+            if (memcmp(hay + i + bit + 1, needle + 1, nlen - 2) == 0) {
+                return i + bit;
+            }
+            mask &= ~(1u << bit);
+        }
     }
 
-    ctx->cur = end;
-    *val = out;
-    return true;
+    return scan__pair_rfind_scalar(hay, starts + nlen - 1, needle, nlen);
 }
 
-bool istr_get_num(instream_t *ctx, double *val) {
-    if (!ctx || !ctx->cur || !val) return false;
-    char *end = NULL;
-    *val = strtod(ctx->cur, &end);
-    
-    if(ctx->cur == end) {
-        warn("istrGetDouble: no valid conversion could be performed (%.5s)", ctx->cur);
+static bool scan__cpu_has_avx2(void) {
+#if COLLA_MSVC
+    int regs[4] = {0};
+    __cpuid(regs, 1);
+    bool osxsave = (regs[2] & (1 << 27)) != 0;
+    bool avx     = (regs[2] & (1 << 28)) != 0;
+    if (!osxsave || !avx) {
         return false;
     }
-    else if(*val == HUGE_VAL || *val == -HUGE_VAL) {
-        warn("istrGetDouble: value read is out of the range of representable values");
+    // the os has to save the ymm registers too
+    if ((_xgetbv(0) & 6) != 6) {
         return false;
     }
-
-    ctx->cur = end;
-    return true;
+    __cpuidex(regs, 7, 0);
+    return (regs[1] & (1 << 5)) != 0;
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2");
+#endif
 }
 
-bool istr_get_float(instream_t *ctx, float *val) {
-    double v = 0;
-    if (!istr_get_num(ctx, &v)) {
-        return false;
-    }
-    if (v >= HUGE_VALF || v <= -HUGE_VALF) {
-        return false;
-    }
-    *val = (float)v;
-    return true;
-}
+#endif // COLLA_SCAN_X64
 
-strview_t istr_get_view(instream_t *ctx, char delim) {
-    if (!ctx || !ctx->cur) return STRV_EMPTY;
-    const char *from = ctx->cur;
-    istr_ignore(ctx, delim);
-    usize len = ctx->cur - from;
-    return strv(from, len);
-}
+typedef struct scan__kernels_t scan__kernels_t;
+struct scan__kernels_t {
+    scan_isa_e isa;
+    u64 (*mask64)(const char *buf, char c);
+    usize (*find)(const char *buf, usize len, char c);
+    usize (*rfind)(const char *buf, usize len, char c);
+    usize (*count)(const char *buf, usize len, char c);
+    usize (*pair_find)(const char *hay, usize len, const char *needle, usize nlen);
+    usize (*pair_rfind)(const char *hay, usize len, const char *needle, usize nlen);
+};
 
-strview_t istr_get_view_either(instream_t *ctx, strview_t chars) {
-    if (!ctx || !ctx->cur) return STRV_EMPTY;
-    const char *from = ctx->cur;
-    while (!istr_is_finished(ctx) && !strv_contains(chars, *ctx->cur)) {
-        ctx->cur++;
-    }
+static const scan__kernels_t scan__scalar_kernels = {
+    SCAN_ISA_SCALAR, scan__mask64_scalar, scan__find_scalar, scan__rfind_scalar, scan__count_scalar,
+    scan__pair_find_scalar, scan__pair_rfind_scalar,
+};
 
-    usize len = ctx->cur - from;
-    return strv(from, len);
-}
+#if COLLA_SCAN_X64
+static const scan__kernels_t scan__sse2_kernels = {
+    SCAN_ISA_SSE2, scan__mask64_sse2, scan__find_sse2, scan__rfind_sse2, scan__count_sse2,
+    scan__pair_find_sse2, scan__pair_rfind_sse2,
+};
 
-strview_t istr_get_view_len(instream_t *ctx, usize len) {
-    if (!ctx || !ctx->cur) return STRV_EMPTY;
-    const char *from = ctx->cur;
-    istr_skip(ctx, len);
-    usize buflen = ctx->cur - from;
-    return (strview_t){ from, buflen };
-}
+static const scan__kernels_t scan__avx2_kernels = {
+    SCAN_ISA_AVX2, scan__mask64_avx2, scan__find_avx2, scan__rfind_avx2, scan__count_avx2,
+    scan__pair_find_avx2, scan__pair_rfind_avx2,
+};
+#endif
 
-strview_t istr_get_line(instream_t *ctx) {
-    strview_t line = istr_get_view(ctx, '\n');
-    istr_skip(ctx, 1);
-    if (strv_ends_with(line, '\r')) {
-        line = strv_remove_suffix(line, 1);
+// picked on first use, every thread ends up writing the same pointer
+static const scan__kernels_t *scan__kernels = NULL;
+
+static const scan__kernels_t *scan__get_kernels(void) {
+    if (!scan__kernels) {
+#if COLLA_SCAN_X64
+        scan__kernels = scan__cpu_has_avx2() ? &scan__avx2_kernels : &scan__sse2_kernels;
+#else
+        scan__kernels = &scan__scalar_kernels;
+#endif
     }
-    return line;
+    return scan__kernels;
 }
 
-strview_t istr_get_word(instream_t *ctx) {
-    strview_t word = istr_get_view_either(ctx, strv(" \t\v\r\n"));
-    return word;
+scan_isa_e scan_get_isa(void) {
+    return scan__get_kernels()->isa;
 }
 
-// == OUTPUT STREAM ================================================
-
-outstream_t ostr_init(arena_t *exclusive_arena) {
-    return (outstream_t) {
-        .beg = (char *)(exclusive_arena ? exclusive_arena->cur : NULL),
-        .arena = exclusive_arena,
-    };
+bool scan_set_isa(scan_isa_e isa) {
+    switch (isa) {
+        case SCAN_ISA_SCALAR: 
+            scan__kernels = &scan__scalar_kernels; 
+            return true;
+#if COLLA_SCAN_X64
+        case SCAN_ISA_SSE2: 
+            scan__kernels = &scan__sse2_kernels; 
+            return true;
+        case SCAN_ISA_AVX2: 
+            if (!scan__cpu_has_avx2()) return false;
+            scan__kernels = &scan__avx2_kernels; 
+            return true;
+#endif
+        default:
+            return false;
+    }
 }
 
-void ostr_clear(outstream_t *ctx) {
-    arena_pop(ctx->arena, ostr_tell(ctx));
+usize scan_find(strview_t ctx, char c) {
+    return scan__get_kernels()->find(ctx.buf, ctx.len, c);
 }
 
-usize ostr_tell(outstream_t *ctx) {
-    return ctx->arena ? (char *)ctx->arena->cur - ctx->beg : 0;
+usize scan_rfind(strview_t ctx, char c) {
+    return scan__get_kernels()->rfind(ctx.buf, ctx.len, c);
 }
 
-char ostr_back(outstream_t *ctx) {
-    usize len = ostr_tell(ctx);
-    return len ? ctx->beg[len - 1] : '\0';
+usize scan_count(strview_t ctx, char c) {
+    return scan__get_kernels()->count(ctx.buf, ctx.len, c);
 }
 
-str_t ostr_to_str(outstream_t *ctx) {
-    ostr_putc(ctx, '\0');
+usize scan_find_nth(strview_t ctx, char c, usize n) {
+    if (n == 0) return STR_NONE;
 
-    usize len = ostr_tell(ctx);
+    const scan__kernels_t *kernels = scan__get_kernels();
+    usize i = 0;
 
-    str_t out = {
-        .buf = ctx->beg,
-        .len = len ? len - 1 : 0,
-    };
+    for (; (i + 64) <= ctx.len; i += 64) {
+        u64 mask = kernels->mask64(ctx.buf + i, c);
+        usize found = scan__popcount64(mask);
+        if (found >= n) {
+            // drop the lowest bits until the nth one is the lowest
+            while (--n) mask &= mask - 1;
+            return i + scan__ctz64(mask);
+        }
+        n -= found;
+    }
 
-    memset(ctx, 0, sizeof(outstream_t));
-    return out;
-}
+    for (; i < ctx.len; ++i) {
+        if (ctx.buf[i] == c && --n == 0) {
+            return i;
+        }
+    }
 
-strview_t ostr_as_view(outstream_t *ctx) {
-    return strv(ctx->beg, ostr_tell(ctx));
+    return STR_NONE;
 }
 
-void ostr_rewind(outstream_t *ctx, usize from_beg) {
-    if (!ctx->arena) return;
-    ctx->arena->cur = (u8*)ctx->beg + from_beg;
-}
+usize scan_rfind_nth(strview_t ctx, char c, usize n) {
+    if (n == 0) return STR_NONE;
 
-void ostr_pop(outstream_t *ctx, usize count) {
-    if (!ctx->arena) return;
-    arena_pop(ctx->arena, count);
-}
+    const scan__kernels_t *kernels = scan__get_kernels();
+    usize i = ctx.len;
 
-void ostr_print(outstream_t *ctx, const char *fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    ostr_printv(ctx, fmt, args);
-    va_end(args);
-}
+    for (; i >= 64; i -= 64) {
+        u64 mask = kernels->mask64(ctx.buf + i - 64, c);
+        usize found = scan__popcount64(mask);
+        if (found >= n) {
+            // drop the highest bits until the nth one is the highest
+            while (--n) mask &= ~(1ull << scan__msb64(mask));
+            return i - 64 + scan__msb64(mask);
+        }
+        n -= found;
+    }
 
-void ostr_printv(outstream_t *ctx, const char *fmt, va_list args) {
-    if (!ctx->arena) return;
-    str_fmtv(ctx->arena, fmt, args);
-    // remove null terminator
-    arena_pop(ctx->arena, 1);
-}
+    for (; i > 0; --i) {
+        if (ctx.buf[i - 1] == c && --n == 0) {
+            return i - 1;
+        }
+    }
 
-void ostr_putc(outstream_t *ctx, char c) {
-    if (!ctx->arena) return;
-    char *newc = alloc(ctx->arena, char);
-    *newc = c;
+    return STR_NONE;
 }
 
-void ostr_puts(outstream_t *ctx, strview_t v) {
-    if (strv_is_empty(v)) return;
-    str(ctx->arena, v);
-    // remove null terminator
-    arena_pop(ctx->arena, 1);
+scan_iter_t scan_iter_init(strview_t ctx, char c) {
+    return (scan_iter_t){
+        .data = ctx,
+        .c = c,
+    };
 }
 
-void ostr_append_bool(outstream_t *ctx, bool val) {
-    ostr_puts(ctx, val ? strv("true") : strv("false"));
-}
+bool scan_iter_next(scan_iter_t *it, usize *pos) {
+    while (it->mask == 0) {
+        if (it->next >= it->data.len) {
+            return false;
+        }
 
-void ostr_append_uint(outstream_t *ctx, u64 val) {
-    ostr_print(ctx, "%I64u", val);
-}
+        const char *block = it->data.buf + it->next;
+        usize remaining = it->data.len - it->next;
 
-void ostr_append_int(outstream_t *ctx, i64 val) {
-    ostr_print(ctx, "%I64d", val);
-}
+        if (remaining >= 64) {
+            it->mask = scan__get_kernels()->mask64(block, it->c);
+        }
+        else {
+            it->mask = 0;
+            for (usize i = 0; i < remaining; ++i) {
+                it->mask |= (u64)(block[i] == it->c) << i;
+            }
+        }
 
-void ostr_append_num(outstream_t *ctx, double val) {
-    ostr_print(ctx, "%g", val);
+        it->base = it->next;
+        it->next += 64;
+    }
+
+    if (pos) *pos = it->base + scan__ctz64(it->mask);
+    // clear the lowest bit
+    it->mask &= it->mask - 1;
+    return true;
 }
 
-// == INPUT BINARY STREAM ==========================================
+// == SEARCH =======================================================
 
-ibstream_t ibstr_init(buffer_t buffer) {
-    return (ibstream_t){
-        .beg = buffer.data,
-        .cur = buffer.data,
-        .len = buffer.len,
+searcher_t searcher_init(strview_t needle) {
+    searcher_t s = {
+        .needle = needle,
+        .use_skip_table = needle.len >= COLLA_SEARCH_SKIP_TABLE_LEN,
     };
-}
 
-bool ibstr_is_finished(ibstream_t *ib) {
-    return !(ib && ibstr_remaining(ib) > 0);
-}
+    if (!s.use_skip_table) {
+        return s;
+    }
 
-usize ibstr_tell(ibstream_t *ib) {
-    return ib && ib->cur ? ib->cur - ib->beg : 0;
-}
+    // shifting less than we could is always safe, so it's fine to cap them
+    u16 max_shift = (u16)MIN(needle.len, UINT16_MAX);
+    for (usize i = 0; i < arrlen(s.skip); ++i) {
+        s.skip[i] = max_shift;
+        s.rskip[i] = max_shift;
+    }
 
-usize ibstr_remaining(ibstream_t *ib) {
-    return ib ? ib->len - ibstr_tell(ib) : 0;
-}
+    // distance from the last byte, used when the window moves forward
+    for (usize i = 0; i < (needle.len - 1); ++i) {
+        usize shift = needle.len - 1 - i;
+        s.skip[(u8)needle.buf[i]] = (u16)MIN(shift, UINT16_MAX);
+    }
 
-usize ibstr_read(ibstream_t *ib, void *buffer, usize len) {
-    usize rem = ibstr_remaining(ib);
-    if (len > rem) len = rem;
-    memmove(buffer, ib->cur, len);
-    ib->cur += len;
-    return len;
-}
+    // distance from the first byte, used when the window moves backward
+    for (usize i = needle.len - 1; i > 0; --i) {
+        s.rskip[(u8)needle.buf[i]] = (u16)MIN(i, UINT16_MAX);
+    }
 
-void ibstr_skip(ibstream_t *ib, usize count) {
-    usize rem = ibstr_remaining(ib);
-    if (count > rem) count = rem;
-    ib->cur += count;
+    return s;
 }
 
-bool ibstr_get_u8(ibstream_t *ib, u8 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+static usize search__horspool(const searcher_t *s, const char *hay, usize len) {
+    const char *needle = s->needle.buf;
+    usize nlen = s->needle.len;
+    char last = needle[nlen - 1];
 
-bool ibstr_get_u16(ibstream_t *ib, u16 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+    usize i = 0;
+    while ((i + nlen) <= len) {
+        char c = hay[i + nlen - 1];
+        if (c == last && memcmp(hay + i, needle, nlen - 1) == 0) {
+            return i;
+        }
+        i += s->skip[(u8)c];
+    }
 
-bool ibstr_get_u32(ibstream_t *ib, u32 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+    return STR_NONE;
 }
 
-bool ibstr_get_u64(ibstream_t *ib, u64 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+static usize search__horspool_reverse(const searcher_t *s, const char *hay, usize len) {
+    const char *needle = s->needle.buf;
+    usize nlen = s->needle.len;
+    if (len < nlen) return STR_NONE;
 
-bool ibstr_get_i8(ibstream_t *ib, i8 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+    usize i = len - nlen;
+    while (true) {
+        char c = hay[i];
+        if (c == needle[0] && memcmp(hay + i + 1, needle + 1, nlen - 1) == 0) {
+            return i;
+        }
+        usize shift = s->rskip[(u8)c];
+        if (i < shift) {
+            break;
+        }
+        i -= shift;
+    }
 
-bool ibstr_get_i16(ibstream_t *ib, i16 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+    return STR_NONE;
 }
 
-bool ibstr_get_i32(ibstream_t *ib, i32 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+// s is NULL or has no skip tables for short needles, then the pair kernels are used
+static usize search__find(const searcher_t *s, strview_t needle, strview_t ctx, usize from) {
+    if (from > ctx.len) return STR_NONE;
 
-bool ibstr_get_i64(ibstream_t *ib, i64 *out) {
-    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
-}
+    strview_t hay = strv(ctx.buf + from, ctx.len - from);
+    usize nlen = needle.len;
+    usize found = STR_NONE;
 
-// == REGEX ========================================================
+    if (nlen == 0) {
+        return from;
+    }
+    else if (nlen > hay.len) {
+        return STR_NONE;
+    }
+    else if (nlen == 1) {
+        found = scan_find(hay, needle.buf[0]);
+    }
+    else if (s && s->use_skip_table) {
+        found = search__horspool(s, hay.buf, hay.len);
+    }
+    else {
+        found = scan__get_kernels()->pair_find(hay.buf, hay.len, needle.buf, nlen);
+    }
 
-// adapted from rob pike regular expression matcher
+    return found != STR_NONE ? from + found : STR_NONE;
+}
 
-bool rg__match_here(instream_t r, instream_t t);
+static usize search__rfind(const searcher_t *s, strview_t needle, strview_t ctx, usize from_right) {
+    if (ctx.len == 0) return STR_NONE;
+    if (from_right > ctx.len) from_right = ctx.len;
 
-bool rg__match_star(char c, instream_t r, instream_t t) {
-    do {
-        if (rg__match_here(r, t)) {
-            return true;
-        }
-    } while (!istr_is_finished(&t) && (istr_get(&t) == c || c == '.'));
-    return false;
-}
+    strview_t hay = strv(ctx.buf, ctx.len - from_right);
+    usize nlen = needle.len;
 
-bool rg__match_here(instream_t r, instream_t t) {
-    char rc  = istr_peek(&r);
-    char rcn = istr_peek_next(&r);
-    if (rc == '\0') {
-        return true;
+    if (nlen == 0) {
+        return hay.len;
     }
-    if (rcn == '*') {
-        istr_skip(&r, 2);
-        return rg__match_star(rc, r, t);
+    else if (nlen > hay.len) {
+        return STR_NONE;
     }
-    if (rc == '$' && rcn == '\0') {
-        return istr_peek(&t) == '\0';
+    else if (nlen == 1) {
+        return scan_rfind(hay, needle.buf[0]);
     }
-    if (!istr_is_finished(&t) && (rc == '.' || rc == istr_peek(&t))) {
-        istr_skip(&r, 1);
-        istr_skip(&t, 1);
-        return rg__match_here(r, t);
+    else if (s && s->use_skip_table) {
+        return search__horspool_reverse(s, hay.buf, hay.len);
+    }
+    else {
+        return scan__get_kernels()->pair_rfind(hay.buf, hay.len, needle.buf, nlen);
     }
-    return false;
 }
 
-bool rg__matches_impl(instream_t r, instream_t t) {
-    do {
-        if (rg__match_here(r, t)) {
-            return true;
-        }
-    } while (istr_get(&t) != '\0');
-    return false;
+usize searcher_find(const searcher_t *s, strview_t ctx, usize from) {
+    return search__find(s, s->needle, ctx, from);
 }
 
-bool rg_matches(strview_t rg, strview_t text) {
-    if (strv_contains(rg, '*')) {
-        instream_t r = istr_init(rg);
-        instream_t t = istr_init(text);
-        return rg__matches_impl(r, t);
-    }
-    else {
-        return strv_equals(rg, text);
-    }
+usize searcher_rfind(const searcher_t *s, strview_t ctx, usize from_right) {
+    return search__rfind(s, s->needle, ctx, from_right);
 }
 
-///////////////////////////////////////////////////
-// glob has the following special characters:
-//  - * matches any string
-//  - ? matches any character
-//  - [ start a match group
-//    - cannot be empty, so this matches either
-//      ] or [:
-//      [][]
-//      []]
-//    - if theres a - between two characters, it
-//      matches a range:
-//      [A-Za-z0-9] is equal to 
-//      [ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789]
-//    - if there's a !, it negates the match,
-//      so [!abc] matches anything but a, b, or c
-//    - if there's a + after the last square bracket,
-//      it matches 1+ times
-
-// g: abc*_d?f[0-9]+c
-// t: abcdef_def901c
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g: bc*_d?f[0-9]+c
-// t: bcdef_def901c
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g: c*_d?f[0-9]+c
-// t: cdef_def901c
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g: *_d?f[0-9]+c
-// t: def_def901c
-// ---------------- 
-// g[0] == * -> ++g, star match
-//   g: _d?f[0-9]+c
-//   t: def_def901c
-//   c = _
-// ---------------- 
-//   g[0] != t[0]
-//   star: ++t
-//   g: _d?f[0-9]+c
-//   t: ef_def901c
-// ---------------- 
-//   g[0] != t[0]
-//   star: ++t
-//   g: _d?f[0-9]+c
-//   t: f_def901c
-// ---------------- 
-//   g[0] != t[0]
-//   star: ++t
-//   g: _d?f[0-9]+c
-//   t: _def901c
-// ---------------- 
-//   g[0] == t[0]
-//   ++g, ++t
-//   g: d?f[0-9]+c
-//   t: def901c
-//   return true from star
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g: ?f[0-9]+c
-// t: ef901c
-// ---------------- 
-// g[0] == ? -> ++g, ++t
-// g: f[0-9]+c
-// t: f901c
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g: [0-9]+c
-// t: 901c
-// ---------------- 
-// g[0] == [
-// begin square:
-//   -- grab pattern
-//   s = strv_empty 
-//   while (s == strv_empty)
-//      s += g.getUntil(])
-//   matches_multi = g.peek() == '+'
-//   s: 0-9 
-//   -- parse pattern
-//   type: match
-//   multi: matches_multi
-//   ranges[MAX_RANGES] = {
-//      { from: 0, to: 9 }
-//   }
-// ---------------- 
-//   matched_once = false
-//   do {
-//     if (!s.inRange(t[0])) {
-//        break;
-//     }
-//     matched_once true
-//     ++t
-//   } while (s.multi);
-//   return matched_atleast_once
-// ---------------- 
-//     t: 901c
-//     t[0] == 9 -> in range = true
-//     ++t
-//     t: 01c
-//     t[0] == 0 -> in rage
-//     ++t
-//     t: 1c
-//     t[0] == 1 -> in rage
-//     ++t
-//     t: c
-//     t[0] == 1 -> not in rage
-//     return true
-// ---------------- 
-// g: c
-// t: c
-// ---------------- 
-// g[0] == t[0] -> ++g, ++t
-// g:
-// t:
-// ---------------- 
-// g is empty -> return true
-//
+// == CTYPE ========================================================
 
-bool glob__match_here(instream_t *g, instream_t *t);
+bool char_is_space(char c) {
+    return (c >= '\t' && c <= '\r') || c == ' ';
+}
 
-bool glob__match_star(instream_t *g, instream_t *t) {
-    char c = istr_get(g);
-    do {
-        if (istr_get(t) == c) {
-            return true;
-        }
-    } while (!istr_is_finished(t));
-    return false;
+bool char_is_alpha(char c) {
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
 }
 
-#define GLOB_MAX_RANGES 128
+bool char_is_num(char c) {
+    return c >= '0' && c <= '9';
+}
 
-typedef struct {
-    char from;
-    char to;
-} glob_range_t;
+bool char_is_hex(char c) {
+    c = char_lower(c);
+    return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'f');
+}
 
-typedef struct {
-    bool multi;
-    bool exclude;
-    glob_range_t ranges[GLOB_MAX_RANGES];
-    int range_count;
-} glob_pat_t;
-
-bool glob__pat_is_in_range(glob_pat_t *pat, char c) {
-    for (int i = 0; i < pat->range_count; ++i) {
-        if (c >= pat->ranges[i].from &&
-            c <= pat->ranges[i].to
-        ) {
-            return true;
-        }
-    }
-    return false;
+char char_lower(char c) {
+    return c >= 'A' && c <= 'Z' ? c + 32 : c;
 }
 
-bool glob__match_pattern(instream_t *t, strview_t pat, bool multi) {
-    glob_pat_t p = {
-        .multi = multi,
-        .exclude = pat.buf[0] == '!',
-    };
-    for (usize i = 0; i < pat.len; ++i) {
-        char from = '\0', to = '\0';
-        if (i > 0 && pat.buf[i] == '-' && (i + 1) < pat.len) {
-            from = pat.buf[i - 1];
-            to = pat.buf[i + 1];
-            ++i;
-        }
-        else if ((i + 1) >= pat.len || pat.buf[i+1] != '-') {
-            from = to = pat.buf[i];
-        }
-        if (from && to) {
-            p.ranges[p.range_count++] = (glob_range_t){ from, to };
-        }
-    }
+char char_upper(char c) {
+    return c >= 'a' && c <= 'z' ? c - 32 : c;
+}
 
-    bool matched_atleast_once = false;
-    do {
-        char c = istr_peek(t);
-        bool is_in_range = glob__pat_is_in_range(&p, c);
-        if ((!is_in_range && !p.exclude) || (is_in_range && p.exclude)) {
-            break;
-        }
-        matched_atleast_once = true;
-        istr_skip(t, 1);
-    } while (p.multi);
+// == INPUT STREAM =================================================
 
-    return matched_atleast_once;
+instream_t istr_init(strview_t str) {
+	return (instream_t) {
+		.beg = str.buf,
+        .cur = str.buf,
+        .len = str.len,
+	};
 }
 
-bool glob__match_here(instream_t *g, instream_t *t) {
-    char gc  = istr_peek(g);
-    if (gc == '*') {
-        istr_skip(g, 1);
-        if (istr_is_finished(g)) {
-            // set t (text) to empty, as the rest of the patter is sure to match
-            *t = istr_init(STRV_EMPTY);
-            return true;
-        }
-        return glob__match_star(g, t);
-    }
-    if (gc == '[') {
-        // skip [
-        istr_skip(g, 1);
-        strview_t pattern = istr_get_view(g, ']');
-        if (pattern.len == 0) {
-            istr_skip(g, 1);
-            pattern = istr_get_view(g, ']');
-            // add first ]
-            pattern.buf--;
-            pattern.len++;
-        }
-        // skip ]
-        istr_skip(g, 1);
-        bool multi = false;
-        if (istr_peek(g) == '+') {
-            istr_skip(g, 1);
-            multi = true;
-        }
-        return glob__match_pattern(t, pattern, multi);
-    }
-    if (!istr_is_finished(t) && (gc == '?' || gc == istr_peek(t))) {
-        istr_skip(g, 1);
-        istr_skip(t, 1);
-        return true;
-    }
+char istr_get(instream_t *ctx) {
+    return istr_remaining(ctx) ? *ctx->cur++ : '\0';
+}
 
-    return false;
+char istr_peek(instream_t *ctx) {
+    return istr_remaining(ctx) ? *ctx->cur : '\0';
 }
 
-bool glob__impl(instream_t *g, instream_t *t) {
-    while (!istr_is_finished(g) && !istr_is_finished(t)) {
-        if (!glob__match_here(g, t)) {
-            return false;
-        }
-    }
-    return istr_get(g) == '\0' && istr_get(t) == '\0';
+char istr_peek_next(instream_t *ctx) {
+    return istr_remaining(ctx) > 1 ? *(ctx->cur + 1) : '\0';
 }
 
-bool glob_matches(strview_t glob, strview_t text) {
-    instream_t g = istr_init(glob);
-    instream_t t = istr_init(text);
-    return glob__impl(&g, &t);
+char istr_prev(instream_t *ctx) {
+    return istr_tell(ctx) ? *(ctx->cur - 1) : '\0';
 }
 
-// == ARENA ========================================================
+char istr_prev_prev(instream_t *ctx) {
+    return istr_tell(ctx) > 1 ? *(ctx->cur - 2) : '\0';
+}
 
-static uptr arena__align(uptr ptr, usize align) {
-    return (ptr + (align - 1)) & ~(align - 1);
+void istr_ignore(instream_t *ctx, char delim) {
+    if (istr_is_finished(ctx)) return;
+    strview_t rem = strv(ctx->cur, istr_remaining(ctx));
+    usize pos = scan_find(rem, delim);
+    ctx->cur += pos != STR_NONE ? pos : rem.len;
 }
 
-static arena_t arena__make_virtual(usize size);
-static arena_t arena__make_malloc(usize size);
-static arena_t arena__make_static(u8 *buf, usize len);
+void istr_ignore_and_skip(instream_t *ctx, char delim) {
+    istr_ignore(ctx, delim);
+    istr_skip(ctx, 1);
+}
 
-static void *arena__alloc_common(const arena_alloc_desc_t *desc);
-static void *arena__alloc_malloc_always(const arena_alloc_desc_t *desc);
+void istr_skip(instream_t *ctx, usize n) {
+    if (!ctx) return;
+    usize rem = istr_remaining(ctx);
+    if (n > rem) n = rem;
+    ctx->cur += n;
+}
 
-static void arena__free_virtual(arena_t *arena);
-static void arena__free_malloc(arena_t *arena);
+void istr_skip_whitespace(instream_t *ctx) {
+    while (!istr_is_finished(ctx) && char_is_space(*ctx->cur)) {
+        ctx->cur++;
+    }
+}
 
-arena_t malloc_arena = {
-    .type = ARENA_MALLOC_ALWAYS,
-};
+void istr_rewind(instream_t *ctx) {
+    if (ctx) ctx->cur = ctx->beg;
+}
 
-arena_t arena_init(const arena_desc_t *desc) {
-    arena_t out = {0};
+void istr_rewind_n(instream_t *ctx, usize amount) {
+    if (!ctx) return;
+    usize rem = istr_remaining(ctx);
+    ctx->cur -= MIN(amount, rem);
+}
 
-    if (desc) {
-        switch (desc->type) {
-            case ARENA_VIRTUAL:       out = arena__make_virtual(desc->size); break;
-            case ARENA_MALLOC:        out = arena__make_malloc(desc->size); break;
-            case ARENA_STATIC:        out = arena__make_static(desc->static_buffer, desc->size); break;
-            case ARENA_MALLOC_ALWAYS: out = malloc_arena; break;
-		    default: break;  
-        }
-    }
+usize istr_tell(instream_t *ctx) {
+    return ctx ? ctx->cur - ctx->beg : 0;
+}
 
-    return out;
+usize istr_remaining(instream_t *ctx) {
+    return ctx ? ctx->len - (ctx->cur - ctx->beg) : 0;
+}
+ 
+bool istr_is_finished(instream_t *ctx) {
+    return !(ctx && istr_remaining(ctx) > 0);
 }
 
-void arena_cleanup(arena_t *arena) {
-    if (!arena) {
-        return;
+bool istr_get_bool(instream_t *ctx, bool *val) {
+    if (!ctx || !ctx->cur || !val) return false;
+    usize rem = istr_remaining(ctx);
+    if (rem >= 4 && memcmp(ctx->cur, "true", 4) == 0) {
+        *val = true;
+        ctx->cur += 4;
+        return true;
     }
-    
-    switch (arena->type) {
-        case ARENA_VIRTUAL: arena__free_virtual(arena); break;
-        case ARENA_MALLOC:  arena__free_malloc(arena);  break;
-        // ARENA_STATIC does not need to be freed
-        default: break;  
+    if (rem >= 5 && memcmp(ctx->cur, "false", 5) == 0) {
+        *val = false;
+        ctx->cur += 5;
+        return true;
     }
-    
-    memset(arena, 0, sizeof(arena_t));
-}
-
-arena_t arena_scratch(arena_t *arena, usize size) {
-    u8 *buffer = alloc(arena, u8, size, ALLOC_SOFT_FAIL | ALLOC_NOZERO);
-    return arena__make_static(buffer, buffer ? size : 0);
+    return false;
 }
 
-void *arena_alloc(const arena_alloc_desc_t *desc) {
-    if (!desc || !desc->arena || desc->arena->type == ARENA_TYPE_NONE) {
-        return NULL;
+bool istr_get_u8(instream_t *ctx, u8 *val) {
+    u64 out = 0;
+    bool result = istr_get_u64(ctx, &out) && out <= UINT8_MAX;
+    if (result) {
+        *val = (u8)out;
     }
+    return result;
+}
 
-    arena_t *arena = desc->arena;
-
-    u8 *ptr = NULL;
-
-    switch (arena->type) {
-        case ARENA_MALLOC_ALWAYS:
-            ptr = arena__alloc_malloc_always(desc);
-            break;
-        default:
-            ptr = arena__alloc_common(desc);
-            break; 
+bool istr_get_u16(instream_t *ctx, u16 *val) {
+    u64 out = 0;
+    bool result = istr_get_u64(ctx, &out) && out <= UINT16_MAX;
+    if (result) {
+        *val = (u16)out;
     }
+    return result;
+}
 
-    if (!ptr && desc->flags & ALLOC_SOFT_FAIL) {
-        return NULL;
+bool istr_get_u32(instream_t *ctx, u32 *val) {
+    u64 out = 0;
+    bool result = istr_get_u64(ctx, &out) && out <= UINT32_MAX;
+    if (result) {
+        *val = (u32)out;
     }
-
-    usize total = desc->size * desc->count;
-
-    return desc->flags & ALLOC_NOZERO ? ptr : memset(ptr, 0, total);
+    return result;
 }
 
-usize arena_tell(arena_t *arena) {
-    return arena ? arena->cur - arena->beg : 0;
+// true if all 8 bytes are ascii digits
+static inline bool istr__is_digits8(u64 v) {
+    return (((v & 0xF0F0F0F0F0F0F0F0ull) | (((v + 0x0606060606060606ull) & 0xF0F0F0F0F0F0F0F0ull) >> 4)) == 0x3333333333333333ull);
 }
 
-usize arena_remaining(arena_t *arena) {
-    return arena && (arena->cur < arena->end) ? arena->end - arena->cur : 0;
+// value of 8 ascii digits read as a little endian u64, the first digit being the most significant
+static inline u64 istr__parse_digits8(u64 v) {
+    const u64 mask = 0x000000FF000000FFull;
+    const u64 mul1 = 100 + (1000000ull << 32);
+    const u64 mul2 = 1 + (10000ull << 32);
+    v -= 0x3030303030303030ull;
+    v = (v * 10) + (v >> 8);
+    return (((v & mask) * mul1) + (((v >> 16) & mask) * mul2)) >> 32;
 }
 
-usize arena_capacity(arena_t *arena) {
-	return arena ? arena->end - arena->beg : 0;
-}
+// reads decimal digits, 8 at a time when it can. stops before overflowing and sets *overflow
+static const char *istr__parse_digits(const char *cur, const char *end, u64 *val, usize *count, bool *overflow) {
+    u64 out = *val;
+    const char *start = cur;
 
-void arena_rewind(arena_t *arena, usize from_start) {
-    if (!arena) {
-        return;
+    // 8 digits more can't overflow as long as out is still less than 10^11
+    while ((end - cur) >= 8 && out < 100000000000ull) {
+        u64 chunk = 0;
+        memcpy(&chunk, cur, sizeof(chunk));
+        if (!istr__is_digits8(chunk)) {
+            break;
+        }
+        out = out * 100000000 + istr__parse_digits8(chunk);
+        cur += 8;
     }
 
-    colla_assert(arena_tell(arena) >= from_start);
+    while (cur < end && char_is_num(*cur)) {
+        u64 digit = *cur - '0';
+        if (out > (UINT64_MAX - digit) / 10) {
+            *overflow = true;
+            break;
+        }
+        out = out * 10 + digit;
+        cur++;
+    }
 
-    arena->cur = arena->beg + from_start;
+    *val = out;
+    *count += cur - start;
+    return cur;
 }
 
-void arena_pop(arena_t *arena, usize amount) {
-    if (!arena) {
-        return;
+static const char *istr__skip_space(const char *cur, const char *end) {
+    while (cur < end && char_is_space(*cur)) {
+        cur++;
     }
-    usize position = arena_tell(arena);
-    if (!position) {
-        return;
-    }
-    arena_rewind(arena, position - amount);
+    return cur;
 }
 
-// == VIRTUAL ARENA ====================================================================================================
+static bool istr__parse_u64(instream_t *ctx, u64 *val, bool allow_minus, bool *is_negative) {
+    const char *end = ctx->beg + ctx->len;
+    const char *cur = istr__skip_space(ctx->cur, end);
 
-static arena_t arena__make_virtual(usize size) {
-    usize alloc_size = 0;
-    u8 *ptr = os_reserve(size, &alloc_size);
-    if (!os_commit(ptr, 1)) {
-        os_release(ptr, alloc_size);
-        ptr = NULL;
+    *is_negative = false;
+    if (cur < end && (*cur == '+' || (allow_minus && *cur == '-'))) {
+        *is_negative = *cur == '-';
+        cur++;
     }
 
-    return (arena_t){
-        .beg = ptr,
-        .cur = ptr,
-        .end = ptr ? ptr + alloc_size : NULL,
-        .type = ARENA_VIRTUAL,
-    };
-}
+    u64 out = 0;
+    usize digits = 0;
+    bool overflow = false;
+
+    if ((end - cur) > 2 && cur[0] == '0' && (cur[1] == 'x' || cur[1] == 'X') && char_is_hex(cur[2])) {
+        cur += 2;
+        while (cur < end && char_is_hex(*cur)) {
+            if (out >> 60) {
+                return false;
+            }
+            char c = char_lower(*cur++);
+            out = (out << 4) | (u64)(char_is_num(c) ? c - '0' : c - 'a' + 10);
+            digits++;
+        }
+    }
+    else {
+        cur = istr__parse_digits(cur, end, &out, &digits, &overflow);
+    }
 
-static void arena__free_virtual(arena_t *arena) {
-    if (!arena->beg) {
-        return;
+    if (digits == 0 || overflow) {
+        return false;
     }
 
-    os_release(arena->beg, arena_capacity(arena));
+    ctx->cur = cur;
+    *val = out;
+    return true;
 }
 
-// == MALLOC ARENA =====================================================================================================
-
-static arena_t arena__make_malloc(usize size) {
-    u8 *ptr = os_alloc(size);
-    colla_assert(ptr);
-    return (arena_t) {
-        .beg = ptr,
-        .cur = ptr,
-        .end = ptr ? ptr + size : NULL,
-        .type = ARENA_MALLOC,
-    };
+bool istr_get_u64(instream_t *ctx, u64 *val) {
+    if (!ctx || !ctx->cur || !val) return false;
+    bool is_negative = false;
+    return istr__parse_u64(ctx, val, false, &is_negative);
 }
 
-static void arena__free_malloc(arena_t *arena) {
-    os_free(arena->beg);
+bool istr_get_i8(instream_t *ctx, i8 *val) {
+    i64 out = 0;
+    bool result = istr_get_i64(ctx, &out) && out >= INT8_MIN && out <= INT8_MAX;
+    if (result) {
+        *val = (i8)out;
+    }
+    return result;
 }
 
-// == ARENA ALLOC ======================================================================================================
-
-static void *arena__alloc_common(const arena_alloc_desc_t *desc) {
-    usize total = desc->size * desc->count;
-    arena_t *arena = desc->arena;
-
-    arena->cur = (u8 *)arena__align((uptr)arena->cur, desc->align);
-    bool soft_fail = desc->flags & ALLOC_SOFT_FAIL;
-
-    if (total > arena_remaining(arena)) {
-        if (!soft_fail) {
-            fatal("finished space in arena, tried to allocate %_$$$dB out of %_$$$dB (total: %_$$$dB)\n", total, arena_remaining(arena), (usize)(arena->end - arena->beg));
-        }
-        return NULL;
+bool istr_get_i16(instream_t *ctx, i16 *val) {
+    i64 out = 0;
+    bool result = istr_get_i64(ctx, &out) && out >= INT16_MIN && out <= INT16_MAX;
+    if (result) {
+        *val = (i16)out;
     }
+    return result;
+}
 
-    if (arena->type == ARENA_VIRTUAL) {
-        usize allocated = arena_tell(arena);
-        usize page_end = os_pad_to_page(allocated);
-        usize new_cur = allocated + total;
-
-        if (new_cur > page_end) {
-            usize page_size = os_get_system_info().page_size;
-            usize prev_page = os_pad_to_page(allocated ? allocated - page_size : 0);
-            usize next_page = os_pad_to_page(new_cur);
-            usize num_of_pages = (next_page - prev_page) / page_size;
-            colla_assert(num_of_pages > 0);
-
-            if (!os_commit(arena->beg + prev_page, num_of_pages)) {
-                if (!soft_fail) {
-                    fatal("failed to commit memory for virtual arena, tried to commit %zu pages\n", num_of_pages);
-                }
-                return NULL;
-            }
-        }
+bool istr_get_i32(instream_t *ctx, i32 *val) {
+    i64 out = 0;
+    bool result = istr_get_i64(ctx, &out) && out >= INT32_MIN && out <= INT32_MAX;
+    if (result) {
+        *val = (i32)out;
     }
-
-    u8 *ptr = arena->cur;
-    arena->cur += total;
-
-    return ptr;
+    return result;
 }
 
-static void *arena__alloc_malloc_always(const arena_alloc_desc_t *desc) {
-    usize total = desc->size * desc->count;
+bool istr_get_i64(instream_t *ctx, i64 *val) {
+    if (!ctx || !ctx->cur || !val) return false;
+    instream_t in = *ctx;
+    u64 out = 0;
+    bool is_negative = false;
 
-    u8 *ptr = os_alloc(total);
-    if (!ptr && !(desc->flags & ALLOC_SOFT_FAIL)) {
-        fatal("alloc call failed for %_$$$dB", total);
+    if (!istr__parse_u64(&in, &out, true, &is_negative)) {
+        return false;
     }
 
-    return ptr;
-}
-
-// == STATIC ARENA =====================================================================================================
+    if (is_negative) {
+        if (out > (u64)INT64_MAX + 1) {
+            return false;
+        }
+        *val = (i64)(0 - out);
+    }
+    else {
+        if (out > INT64_MAX) {
+            return false;
+        }
+        *val = (i64)out;
+    }
 
-static arena_t arena__make_static(u8 *buf, usize len) {
-    return (arena_t) {
-        .beg = buf,
-        .cur = buf,
-        .end = buf ? buf + len : NULL,
-        .type = ARENA_STATIC,
-    };
+    ctx->cur = in.cur;
+    return true;
 }
 
-// == HANDLE ====================================
-
-oshandle_t os_handle_zero(void) {
-	return (oshandle_t){0};
-}
+// powers of ten that are exact as doubles
+static const double istr__pow10[] = {
+    1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22,
+};
 
-bool os_handle_match(oshandle_t a, oshandle_t b) {
-	return a.data == b.data;
-}
+// 128 bit approximations of 10^-348 to 10^347, rounded down, with the top bit
+// set: { high 64 bits, low 64 bits }. these are the same as the ones in go's
+// strconv and wuffs, for the eisel-lemire algorithm
+#define ISTR__POW10_128_MIN -348
+#define ISTR__POW10_128_MAX 347
+
+static const u64 istr__pow10_128[][2] = {
+    { 0xFA8FD5A0081C0288ull, 0x1732C869CD60E453ull }, // 1e-348
+    { 0x9C99E58405118195ull, 0x0E7FBD42205C8EB4ull }, // 1e-347
+    { 0xC3C05EE50655E1FAull, 0x521FAC92A873B261ull }, // 1e-346
+    { 0xF4B0769E47EB5A78ull, 0xE6A797B752909EF9ull }, // 1e-345
+    { 0x98EE4A22ECF3188Bull, 0x9028BED2939A635Cull }, // 1e-344
+    { 0xBF29DCABA82FDEAEull, 0x7432EE873880FC33ull }, // 1e-343
+    { 0xEEF453D6923BD65Aull, 0x113FAA2906A13B3Full }, // 1e-342
+    { 0x9558B4661B6565F8ull, 0x4AC7CA59A424C507ull }, // 1e-341
+    { 0xBAAEE17FA23EBF76ull, 0x5D79BCF00D2DF649ull }, // 1e-340
+    { 0xE95A99DF8ACE6F53ull, 0xF4D82C2C107973DCull }, // 1e-339
+    { 0x91D8A02BB6C10594ull, 0x79071B9B8A4BE869ull }, // 1e-338
+    { 0xB64EC836A47146F9ull, 0x9748E2826CDEE284ull }, // 1e-337
+    { 0xE3E27A444D8D98B7ull, 0xFD1B1B2308169B25ull }, // 1e-336
+    { 0x8E6D8C6AB0787F72ull, 0xFE30F0F5E50E20F7ull }, // 1e-335
+    { 0xB208EF855C969F4Full, 0xBDBD2D335E51A935ull }, // 1e-334
+    { 0xDE8B2B66B3BC4723ull, 0xAD2C788035E61382ull }, // 1e-333
+    { 0x8B16FB203055AC76ull, 0x4C3BCB5021AFCC31ull }, // 1e-332
+    { 0xADDCB9E83C6B1793ull, 0xDF4ABE242A1BBF3Dull }, // 1e-331
+    { 0xD953E8624B85DD78ull, 0xD71D6DAD34A2AF0Dull }, // 1e-330
+    { 0x87D4713D6F33AA6Bull, 0x8672648C40E5AD68ull }, // 1e-329
+    { 0xA9C98D8CCB009506ull, 0x680EFDAF511F18C2ull }, // 1e-328
+    { 0xD43BF0EFFDC0BA48ull, 0x0212BD1B2566DEF2ull }, // 1e-327
+    { 0x84A57695FE98746Dull, 0x014BB630F7604B57ull }, // 1e-326
+    { 0xA5CED43B7E3E9188ull, 0x419EA3BD35385E2Dull }, // 1e-325
+    { 0xCF42894A5DCE35EAull, 0x52064CAC828675B9ull }, // 1e-324
+    { 0x818995CE7AA0E1B2ull, 0x7343EFEBD1940993ull }, // 1e-323
+    { 0xA1EBFB4219491A1Full, 0x1014EBE6C5F90BF8ull }, // 1e-322
+    { 0xCA66FA129F9B60A6ull, 0xD41A26E077774EF6ull }, // 1e-321
+    { 0xFD00B897478238D0ull, 0x8920B098955522B4ull }, // 1e-320
+    { 0x9E20735E8CB16382ull, 0x55B46E5F5D5535B0ull }, // 1e-319
+    { 0xC5A890362FDDBC62ull, 0xEB2189F734AA831Dull }, // 1e-318
+    { 0xF712B443BBD52B7Bull, 0xA5E9EC7501D523E4ull }, // 1e-317
+    { 0x9A6BB0AA55653B2Dull, 0x47B233C92125366Eull }, // 1e-316
+    { 0xC1069CD4EABE89F8ull, 0x999EC0BB696E840Aull }, // 1e-315
+    { 0xF148440A256E2C76ull, 0xC00670EA43CA250Dull }, // 1e-314
+    { 0x96CD2A865764DBCAull, 0x380406926A5E5728ull }, // 1e-313
+    { 0xBC807527ED3E12BCull, 0xC605083704F5ECF2ull }, // 1e-312
+    { 0xEBA09271E88D976Bull, 0xF7864A44C633682Eull }, // 1e-311
+    { 0x93445B8731587EA3ull, 0x7AB3EE6AFBE0211Dull }, // 1e-310
+    { 0xB8157268FDAE9E4Cull, 0x5960EA05BAD82964ull }, // 1e-309
+    { 0xE61ACF033D1A45DFull, 0x6FB92487298E33BDull }, // 1e-308
+    { 0x8FD0C16206306BABull, 0xA5D3B6D479F8E056ull }, // 1e-307
+    { 0xB3C4F1BA87BC8696ull, 0x8F48A4899877186Cull }, // 1e-306
+    { 0xE0B62E2929ABA83Cull, 0x331ACDABFE94DE87ull }, // 1e-305
+    { 0x8C71DCD9BA0B4925ull, 0x9FF0C08B7F1D0B14ull }, // 1e-304
+    { 0xAF8E5410288E1B6Full, 0x07ECF0AE5EE44DD9ull }, // 1e-303
+    { 0xDB71E91432B1A24Aull, 0xC9E82CD9F69D6150ull }, // 1e-302
+    { 0x892731AC9FAF056Eull, 0xBE311C083A225CD2ull }, // 1e-301
+    { 0xAB70FE17C79AC6CAull, 0x6DBD630A48AAF406ull }, // 1e-300
+    { 0xD64D3D9DB981787Dull, 0x092CBBCCDAD5B108ull }, // 1e-299
+    { 0x85F0468293F0EB4Eull, 0x25BBF56008C58EA5ull }, // 1e-298
+    { 0xA76C582338ED2621ull, 0xAF2AF2B80AF6F24Eull }, // 1e-297
+    { 0xD1476E2C07286FAAull, 0x1AF5AF660DB4AEE1ull }, // 1e-296
+    { 0x82CCA4DB847945CAull, 0x50D98D9FC890ED4Dull }, // 1e-295
+    { 0xA37FCE126597973Cull, 0xE50FF107BAB528A0ull }, // 1e-294
+    { 0xCC5FC196FEFD7D0Cull, 0x1E53ED49A96272C8ull }, // 1e-293
+    { 0xFF77B1FCBEBCDC4Full, 0x25E8E89C13BB0F7Aull }, // 1e-292
+    { 0x9FAACF3DF73609B1ull, 0x77B191618C54E9ACull }, // 1e-291
+    { 0xC795830D75038C1Dull, 0xD59DF5B9EF6A2417ull }, // 1e-290
+    { 0xF97AE3D0D2446F25ull, 0x4B0573286B44AD1Dull }, // 1e-289
+    { 0x9BECCE62836AC577ull, 0x4EE367F9430AEC32ull }, // 1e-288
+    { 0xC2E801FB244576D5ull, 0x229C41F793CDA73Full }, // 1e-287
+    { 0xF3A20279ED56D48Aull, 0x6B43527578C1110Full }, // 1e-286
+    { 0x9845418C345644D6ull, 0x830A13896B78AAA9ull }, // 1e-285
+    { 0xBE5691EF416BD60Cull, 0x23CC986BC656D553ull }, // 1e-284
+    { 0xEDEC366B11C6CB8Full, 0x2CBFBE86B7EC8AA8ull }, // 1e-283
+    { 0x94B3A202EB1C3F39ull, 0x7BF7D71432F3D6A9ull }, // 1e-282
+    { 0xB9E08A83A5E34F07ull, 0xDAF5CCD93FB0CC53ull }, // 1e-281
+    { 0xE858AD248F5C22C9ull, 0xD1B3400F8F9CFF68ull }, // 1e-280
+    { 0x91376C36D99995BEull, 0x23100809B9C21FA1ull }, // 1e-279
+    { 0xB58547448FFFFB2Dull, 0xABD40A0C2832A78Aull }, // 1e-278
+    { 0xE2E69915B3FFF9F9ull, 0x16C90C8F323F516Cull }, // 1e-277
+    { 0x8DD01FAD907FFC3Bull, 0xAE3DA7D97F6792E3ull }, // 1e-276
+    { 0xB1442798F49FFB4Aull, 0x99CD11CFDF41779Cull }, // 1e-275
+    { 0xDD95317F31C7FA1Dull, 0x40405643D711D583ull }, // 1e-274
+    { 0x8A7D3EEF7F1CFC52ull, 0x482835EA666B2572ull }, // 1e-273
+    { 0xAD1C8EAB5EE43B66ull, 0xDA3243650005EECFull }, // 1e-272
+    { 0xD863B256369D4A40ull, 0x90BED43E40076A82ull }, // 1e-271
+    { 0x873E4F75E2224E68ull, 0x5A7744A6E804A291ull }, // 1e-270
+    { 0xA90DE3535AAAE202ull, 0x711515D0A205CB36ull }, // 1e-269
+    { 0xD3515C2831559A83ull, 0x0D5A5B44CA873E03ull }, // 1e-268
+    { 0x8412D9991ED58091ull, 0xE858790AFE9486C2ull }, // 1e-267
+    { 0xA5178FFF668AE0B6ull, 0x626E974DBE39A872ull }, // 1e-266
+    { 0xCE5D73FF402D98E3ull, 0xFB0A3D212DC8128Full }, // 1e-265
+    { 0x80FA687F881C7F8Eull, 0x7CE66634BC9D0B99ull }, // 1e-264
+    { 0xA139029F6A239F72ull, 0x1C1FFFC1EBC44E80ull }, // 1e-263
+    { 0xC987434744AC874Eull, 0xA327FFB266B56220ull }, // 1e-262
+    { 0xFBE9141915D7A922ull, 0x4BF1FF9F0062BAA8ull }, // 1e-261
+    { 0x9D71AC8FADA6C9B5ull, 0x6F773FC3603DB4A9ull }, // 1e-260
+    { 0xC4CE17B399107C22ull, 0xCB550FB4384D21D3ull }, // 1e-259
+    { 0xF6019DA07F549B2Bull, 0x7E2A53A146606A48ull }, // 1e-258
+    { 0x99C102844F94E0FBull, 0x2EDA7444CBFC426Dull }, // 1e-257
+    { 0xC0314325637A1939ull, 0xFA911155FEFB5308ull }, // 1e-256
+    { 0xF03D93EEBC589F88ull, 0x793555AB7EBA27CAull }, // 1e-255
+    { 0x96267C7535B763B5ull, 0x4BC1558B2F3458DEull }, // 1e-254
+    { 0xBBB01B9283253CA2ull, 0x9EB1AAEDFB016F16ull }, // 1e-253
+    { 0xEA9C227723EE8BCBull, 0x465E15A979C1CADCull }, // 1e-252
+    { 0x92A1958A7675175Full, 0x0BFACD89EC191EC9ull }, // 1e-251
+    { 0xB749FAED14125D36ull, 0xCEF980EC671F667Bull }, // 1e-250
+    { 0xE51C79A85916F484ull, 0x82B7E12780E7401Aull }, // 1e-249
+    { 0x8F31CC0937AE58D2ull, 0xD1B2ECB8B0908810ull }, // 1e-248
+    { 0xB2FE3F0B8599EF07ull, 0x861FA7E6DCB4AA15ull }, // 1e-247
+    { 0xDFBDCECE67006AC9ull, 0x67A791E093E1D49Aull }, // 1e-246
+    { 0x8BD6A141006042BDull, 0xE0C8BB2C5C6D24E0ull }, // 1e-245
+    { 0xAECC49914078536Dull, 0x58FAE9F773886E18ull }, // 1e-244
+    { 0xDA7F5BF590966848ull, 0xAF39A475506A899Eull }, // 1e-243
+    { 0x888F99797A5E012Dull, 0x6D8406C952429603ull }, // 1e-242
+    { 0xAAB37FD7D8F58178ull, 0xC8E5087BA6D33B83ull }, // 1e-241
+    { 0xD5605FCDCF32E1D6ull, 0xFB1E4A9A90880A64ull }, // 1e-240
+    { 0x855C3BE0A17FCD26ull, 0x5CF2EEA09A55067Full }, // 1e-239
+    { 0xA6B34AD8C9DFC06Full, 0xF42FAA48C0EA481Eull }, // 1e-238
+    { 0xD0601D8EFC57B08Bull, 0xF13B94DAF124DA26ull }, // 1e-237
+    { 0x823C12795DB6CE57ull, 0x76C53D08D6B70858ull }, // 1e-236
+    { 0xA2CB1717B52481EDull, 0x54768C4B0C64CA6Eull }, // 1e-235
+    { 0xCB7DDCDDA26DA268ull, 0xA9942F5DCF7DFD09ull }, // 1e-234
+    { 0xFE5D54150B090B02ull, 0xD3F93B35435D7C4Cull }, // 1e-233
+    { 0x9EFA548D26E5A6E1ull, 0xC47BC5014A1A6DAFull }, // 1e-232
+    { 0xC6B8E9B0709F109Aull, 0x359AB6419CA1091Bull }, // 1e-231
+    { 0xF867241C8CC6D4C0ull, 0xC30163D203C94B62ull }, // 1e-230
+    { 0x9B407691D7FC44F8ull, 0x79E0DE63425DCF1Dull }, // 1e-229
+    { 0xC21094364DFB5636ull, 0x985915FC12F542E4ull }, // 1e-228
+    { 0xF294B943E17A2BC4ull, 0x3E6F5B7B17B2939Dull }, // 1e-227
+    { 0x979CF3CA6CEC5B5Aull, 0xA705992CEECF9C42ull }, // 1e-226
+    { 0xBD8430BD08277231ull, 0x50C6FF782A838353ull }, // 1e-225
+    { 0xECE53CEC4A314EBDull, 0xA4F8BF5635246428ull }, // 1e-224
+    { 0x940F4613AE5ED136ull, 0x871B7795E136BE99ull }, // 1e-223
+    { 0xB913179899F68584ull, 0x28E2557B59846E3Full }, // 1e-222
+    { 0xE757DD7EC07426E5ull, 0x331AEADA2FE589CFull }, // 1e-221
+    { 0x9096EA6F3848984Full, 0x3FF0D2C85DEF7621ull }, // 1e-220
+    { 0xB4BCA50B065ABE63ull, 0x0FED077A756B53A9ull }, // 1e-219
+    { 0xE1EBCE4DC7F16DFBull, 0xD3E8495912C62894ull }, // 1e-218
+    { 0x8D3360F09CF6E4BDull, 0x64712DD7ABBBD95Cull }, // 1e-217
+    { 0xB080392CC4349DECull, 0xBD8D794D96AACFB3ull }, // 1e-216
+    { 0xDCA04777F541C567ull, 0xECF0D7A0FC5583A0ull }, // 1e-215
+    { 0x89E42CAAF9491B60ull, 0xF41686C49DB57244ull }, // 1e-214
+    { 0xAC5D37D5B79B6239ull, 0x311C2875C522CED5ull }, // 1e-213
+    { 0xD77485CB25823AC7ull, 0x7D633293366B828Bull }, // 1e-212
+    { 0x86A8D39EF77164BCull, 0xAE5DFF9C02033197ull }, // 1e-211
+    { 0xA8530886B54DBDEBull, 0xD9F57F830283FDFCull }, // 1e-210
+    { 0xD267CAA862A12D66ull, 0xD072DF63C324FD7Bull }, // 1e-209
+    { 0x8380DEA93DA4BC60ull, 0x4247CB9E59F71E6Dull }, // 1e-208
+    { 0xA46116538D0DEB78ull, 0x52D9BE85F074E608ull }, // 1e-207
+    { 0xCD795BE870516656ull, 0x67902E276C921F8Bull }, // 1e-206
+    { 0x806BD9714632DFF6ull, 0x00BA1CD8A3DB53B6ull }, // 1e-205
+    { 0xA086CFCD97BF97F3ull, 0x80E8A40ECCD228A4ull }, // 1e-204
+    { 0xC8A883C0FDAF7DF0ull, 0x6122CD128006B2CDull }, // 1e-203
+    { 0xFAD2A4B13D1B5D6Cull, 0x796B805720085F81ull }, // 1e-202
+    { 0x9CC3A6EEC6311A63ull, 0xCBE3303674053BB0ull }, // 1e-201
+    { 0xC3F490AA77BD60FCull, 0xBEDBFC4411068A9Cull }, // 1e-200
+    { 0xF4F1B4D515ACB93Bull, 0xEE92FB5515482D44ull }, // 1e-199
+    { 0x991711052D8BF3C5ull, 0x751BDD152D4D1C4Aull }, // 1e-198
+    { 0xBF5CD54678EEF0B6ull, 0xD262D45A78A0635Dull }, // 1e-197
+    { 0xEF340A98172AACE4ull, 0x86FB897116C87C34ull }, // 1e-196
+    { 0x9580869F0E7AAC0Eull, 0xD45D35E6AE3D4DA0ull }, // 1e-195
+    { 0xBAE0A846D2195712ull, 0x8974836059CCA109ull }, // 1e-194
+    { 0xE998D258869FACD7ull, 0x2BD1A438703FC94Bull }, // 1e-193
+    { 0x91FF83775423CC06ull, 0x7B6306A34627DDCFull }, // 1e-192
+    { 0xB67F6455292CBF08ull, 0x1A3BC84C17B1D542ull }, // 1e-191
+    { 0xE41F3D6A7377EECAull, 0x20CABA5F1D9E4A93ull }, // 1e-190
+    { 0x8E938662882AF53Eull, 0x547EB47B7282EE9Cull }, // 1e-189
+    { 0xB23867FB2A35B28Dull, 0xE99E619A4F23AA43ull }, // 1e-188
+    { 0xDEC681F9F4C31F31ull, 0x6405FA00E2EC94D4ull }, // 1e-187
+    { 0x8B3C113C38F9F37Eull, 0xDE83BC408DD3DD04ull }, // 1e-186
+    { 0xAE0B158B4738705Eull, 0x9624AB50B148D445ull }, // 1e-185
+    { 0xD98DDAEE19068C76ull, 0x3BADD624DD9B0957ull }, // 1e-184
+    { 0x87F8A8D4CFA417C9ull, 0xE54CA5D70A80E5D6ull }, // 1e-183
+    { 0xA9F6D30A038D1DBCull, 0x5E9FCF4CCD211F4Cull }, // 1e-182
+    { 0xD47487CC8470652Bull, 0x7647C3200069671Full }, // 1e-181
+    { 0x84C8D4DFD2C63F3Bull, 0x29ECD9F40041E073ull }, // 1e-180
+    { 0xA5FB0A17C777CF09ull, 0xF468107100525890ull }, // 1e-179
+    { 0xCF79CC9DB955C2CCull, 0x7182148D4066EEB4ull }, // 1e-178
+    { 0x81AC1FE293D599BFull, 0xC6F14CD848405530ull }, // 1e-177
+    { 0xA21727DB38CB002Full, 0xB8ADA00E5A506A7Cull }, // 1e-176
+    { 0xCA9CF1D206FDC03Bull, 0xA6D90811F0E4851Cull }, // 1e-175
+    { 0xFD442E4688BD304Aull, 0x908F4A166D1DA663ull }, // 1e-174
+    { 0x9E4A9CEC15763E2Eull, 0x9A598E4E043287FEull }, // 1e-173
+    { 0xC5DD44271AD3CDBAull, 0x40EFF1E1853F29FDull }, // 1e-172
+    { 0xF7549530E188C128ull, 0xD12BEE59E68EF47Cull }, // 1e-171
+    { 0x9A94DD3E8CF578B9ull, 0x82BB74F8301958CEull }, // 1e-170
+    { 0xC13A148E3032D6E7ull, 0xE36A52363C1FAF01ull }, // 1e-169
+    { 0xF18899B1BC3F8CA1ull, 0xDC44E6C3CB279AC1ull }, // 1e-168
+    { 0x96F5600F15A7B7E5ull, 0x29AB103A5EF8C0B9ull }, // 1e-167
+    { 0xBCB2B812DB11A5DEull, 0x7415D448F6B6F0E7ull }, // 1e-166
+    { 0xEBDF661791D60F56ull, 0x111B495B3464AD21ull }, // 1e-165
+    { 0x936B9FCEBB25C995ull, 0xCAB10DD900BEEC34ull }, // 1e-164
+    { 0xB84687C269EF3BFBull, 0x3D5D514F40EEA742ull }, // 1e-163
+    { 0xE65829B3046B0AFAull, 0x0CB4A5A3112A5112ull }, // 1e-162
+    { 0x8FF71A0FE2C2E6DCull, 0x47F0E785EABA72ABull }, // 1e-161
+    { 0xB3F4E093DB73A093ull, 0x59ED216765690F56ull }, // 1e-160
+    { 0xE0F218B8D25088B8ull, 0x306869C13EC3532Cull }, // 1e-159
+    { 0x8C974F7383725573ull, 0x1E414218C73A13FBull }, // 1e-158
+    { 0xAFBD2350644EEACFull, 0xE5D1929EF90898FAull }, // 1e-157
+    { 0xDBAC6C247D62A583ull, 0xDF45F746B74ABF39ull }, // 1e-156
+    { 0x894BC396CE5DA772ull, 0x6B8BBA8C328EB783ull }, // 1e-155
+    { 0xAB9EB47C81F5114Full, 0x066EA92F3F326564ull }, // 1e-154
+    { 0xD686619BA27255A2ull, 0xC80A537B0EFEFEBDull }, // 1e-153
+    { 0x8613FD0145877585ull, 0xBD06742CE95F5F36ull }, // 1e-152
+    { 0xA798FC4196E952E7ull, 0x2C48113823B73704ull }, // 1e-151
+    { 0xD17F3B51FCA3A7A0ull, 0xF75A15862CA504C5ull }, // 1e-150
+    { 0x82EF85133DE648C4ull, 0x9A984D73DBE722FBull }, // 1e-149
+    { 0xA3AB66580D5FDAF5ull, 0xC13E60D0D2E0EBBAull }, // 1e-148
+    { 0xCC963FEE10B7D1B3ull, 0x318DF905079926A8ull }, // 1e-147
+    { 0xFFBBCFE994E5C61Full, 0xFDF17746497F7052ull }, // 1e-146
+    { 0x9FD561F1FD0F9BD3ull, 0xFEB6EA8BEDEFA633ull }, // 1e-145
+    { 0xC7CABA6E7C5382C8ull, 0xFE64A52EE96B8FC0ull }, // 1e-144
+    { 0xF9BD690A1B68637Bull, 0x3DFDCE7AA3C673B0ull }, // 1e-143
+    { 0x9C1661A651213E2Dull, 0x06BEA10CA65C084Eull }, // 1e-142
+    { 0xC31BFA0FE5698DB8ull, 0x486E494FCFF30A62ull }, // 1e-141
+    { 0xF3E2F893DEC3F126ull, 0x5A89DBA3C3EFCCFAull }, // 1e-140
+    { 0x986DDB5C6B3A76B7ull, 0xF89629465A75E01Cull }, // 1e-139
+    { 0xBE89523386091465ull, 0xF6BBB397F1135823ull }, // 1e-138
+    { 0xEE2BA6C0678B597Full, 0x746AA07DED582E2Cull }, // 1e-137
+    { 0x94DB483840B717EFull, 0xA8C2A44EB4571CDCull }, // 1e-136
+    { 0xBA121A4650E4DDEBull, 0x92F34D62616CE413ull }, // 1e-135
+    { 0xE896A0D7E51E1566ull, 0x77B020BAF9C81D17ull }, // 1e-134
+    { 0x915E2486EF32CD60ull, 0x0ACE1474DC1D122Eull }, // 1e-133
+    { 0xB5B5ADA8AAFF80B8ull, 0x0D819992132456BAull }, // 1e-132
+    { 0xE3231912D5BF60E6ull, 0x10E1FFF697ED6C69ull }, // 1e-131
+    { 0x8DF5EFABC5979C8Full, 0xCA8D3FFA1EF463C1ull }, // 1e-130
+    { 0xB1736B96B6FD83B3ull, 0xBD308FF8A6B17CB2ull }, // 1e-129
+    { 0xDDD0467C64BCE4A0ull, 0xAC7CB3F6D05DDBDEull }, // 1e-128
+    { 0x8AA22C0DBEF60EE4ull, 0x6BCDF07A423AA96Bull }, // 1e-127
+    { 0xAD4AB7112EB3929Dull, 0x86C16C98D2C953C6ull }, // 1e-126
+    { 0xD89D64D57A607744ull, 0xE871C7BF077BA8B7ull }, // 1e-125
+    { 0x87625F056C7C4A8Bull, 0x11471CD764AD4972ull }, // 1e-124
+    { 0xA93AF6C6C79B5D2Dull, 0xD598E40D3DD89BCFull }, // 1e-123
+    { 0xD389B47879823479ull, 0x4AFF1D108D4EC2C3ull }, // 1e-122
+    { 0x843610CB4BF160CBull, 0xCEDF722A585139BAull }, // 1e-121
+    { 0xA54394FE1EEDB8FEull, 0xC2974EB4EE658828ull }, // 1e-120
+    { 0xCE947A3DA6A9273Eull, 0x733D226229FEEA32ull }, // 1e-119
+    { 0x811CCC668829B887ull, 0x0806357D5A3F525Full }, // 1e-118
+    { 0xA163FF802A3426A8ull, 0xCA07C2DCB0CF26F7ull }, // 1e-117
+    { 0xC9BCFF6034C13052ull, 0xFC89B393DD02F0B5ull }, // 1e-116
+    { 0xFC2C3F3841F17C67ull, 0xBBAC2078D443ACE2ull }, // 1e-115
+    { 0x9D9BA7832936EDC0ull, 0xD54B944B84AA4C0Dull }, // 1e-114
+    { 0xC5029163F384A931ull, 0x0A9E795E65D4DF11ull }, // 1e-113
+    { 0xF64335BCF065D37Dull, 0x4D4617B5FF4A16D5ull }, // 1e-112
+    { 0x99EA0196163FA42Eull, 0x504BCED1BF8E4E45ull }, // 1e-111
+    { 0xC06481FB9BCF8D39ull, 0xE45EC2862F71E1D6ull }, // 1e-110
+    { 0xF07DA27A82C37088ull, 0x5D767327BB4E5A4Cull }, // 1e-109
+    { 0x964E858C91BA2655ull, 0x3A6A07F8D510F86Full }, // 1e-108
+    { 0xBBE226EFB628AFEAull, 0x890489F70A55368Bull }, // 1e-107
+    { 0xEADAB0ABA3B2DBE5ull, 0x2B45AC74CCEA842Eull }, // 1e-106
+    { 0x92C8AE6B464FC96Full, 0x3B0B8BC90012929Dull }, // 1e-105
+    { 0xB77ADA0617E3BBCBull, 0x09CE6EBB40173744ull }, // 1e-104
+    { 0xE55990879DDCAABDull, 0xCC420A6A101D0515ull }, // 1e-103
+    { 0x8F57FA54C2A9EAB6ull, 0x9FA946824A12232Dull }, // 1e-102
+    { 0xB32DF8E9F3546564ull, 0x47939822DC96ABF9ull }, // 1e-101
+    { 0xDFF9772470297EBDull, 0x59787E2B93BC56F7ull }, // 1e-100
+    { 0x8BFBEA76C619EF36ull, 0x57EB4EDB3C55B65Aull }, // 1e-99
+    { 0xAEFAE51477A06B03ull, 0xEDE622920B6B23F1ull }, // 1e-98
+    { 0xDAB99E59958885C4ull, 0xE95FAB368E45ECEDull }, // 1e-97
+    { 0x88B402F7FD75539Bull, 0x11DBCB0218EBB414ull }, // 1e-96
+    { 0xAAE103B5FCD2A881ull, 0xD652BDC29F26A119ull }, // 1e-95
+    { 0xD59944A37C0752A2ull, 0x4BE76D3346F0495Full }, // 1e-94
+    { 0x857FCAE62D8493A5ull, 0x6F70A4400C562DDBull }, // 1e-93
+    { 0xA6DFBD9FB8E5B88Eull, 0xCB4CCD500F6BB952ull }, // 1e-92
+    { 0xD097AD07A71F26B2ull, 0x7E2000A41346A7A7ull }, // 1e-91
+    { 0x825ECC24C873782Full, 0x8ED400668C0C28C8ull }, // 1e-90
+    { 0xA2F67F2DFA90563Bull, 0x728900802F0F32FAull }, // 1e-89
+    { 0xCBB41EF979346BCAull, 0x4F2B40A03AD2FFB9ull }, // 1e-88
+    { 0xFEA126B7D78186BCull, 0xE2F610C84987BFA8ull }, // 1e-87
+    { 0x9F24B832E6B0F436ull, 0x0DD9CA7D2DF4D7C9ull }, // 1e-86
+    { 0xC6EDE63FA05D3143ull, 0x91503D1C79720DBBull }, // 1e-85
+    { 0xF8A95FCF88747D94ull, 0x75A44C6397CE912Aull }, // 1e-84
+    { 0x9B69DBE1B548CE7Cull, 0xC986AFBE3EE11ABAull }, // 1e-83
+    { 0xC24452DA229B021Bull, 0xFBE85BADCE996168ull }, // 1e-82
+    { 0xF2D56790AB41C2A2ull, 0xFAE27299423FB9C3ull }, // 1e-81
+    { 0x97C560BA6B0919A5ull, 0xDCCD879FC967D41Aull }, // 1e-80
+    { 0xBDB6B8E905CB600Full, 0x5400E987BBC1C920ull }, // 1e-79
+    { 0xED246723473E3813ull, 0x290123E9AAB23B68ull }, // 1e-78
+    { 0x9436C0760C86E30Bull, 0xF9A0B6720AAF6521ull }, // 1e-77
+    { 0xB94470938FA89BCEull, 0xF808E40E8D5B3E69ull }, // 1e-76
+    { 0xE7958CB87392C2C2ull, 0xB60B1D1230B20E04ull }, // 1e-75
+    { 0x90BD77F3483BB9B9ull, 0xB1C6F22B5E6F48C2ull }, // 1e-74
+    { 0xB4ECD5F01A4AA828ull, 0x1E38AEB6360B1AF3ull }, // 1e-73
+    { 0xE2280B6C20DD5232ull, 0x25C6DA63C38DE1B0ull }, // 1e-72
+    { 0x8D590723948A535Full, 0x579C487E5A38AD0Eull }, // 1e-71
+    { 0xB0AF48EC79ACE837ull, 0x2D835A9DF0C6D851ull }, // 1e-70
+    { 0xDCDB1B2798182244ull, 0xF8E431456CF88E65ull }, // 1e-69
+    { 0x8A08F0F8BF0F156Bull, 0x1B8E9ECB641B58FFull }, // 1e-68
+    { 0xAC8B2D36EED2DAC5ull, 0xE272467E3D222F3Full }, // 1e-67
+    { 0xD7ADF884AA879177ull, 0x5B0ED81DCC6ABB0Full }, // 1e-66
+    { 0x86CCBB52EA94BAEAull, 0x98E947129FC2B4E9ull }, // 1e-65
+    { 0xA87FEA27A539E9A5ull, 0x3F2398D747B36224ull }, // 1e-64
+    { 0xD29FE4B18E88640Eull, 0x8EEC7F0D19A03AADull }, // 1e-63
+    { 0x83A3EEEEF9153E89ull, 0x1953CF68300424ACull }, // 1e-62
+    { 0xA48CEAAAB75A8E2Bull, 0x5FA8C3423C052DD7ull }, // 1e-61
+    { 0xCDB02555653131B6ull, 0x3792F412CB06794Dull }, // 1e-60
+    { 0x808E17555F3EBF11ull, 0xE2BBD88BBEE40BD0ull }, // 1e-59
+    { 0xA0B19D2AB70E6ED6ull, 0x5B6ACEAEAE9D0EC4ull }, // 1e-58
+    { 0xC8DE047564D20A8Bull, 0xF245825A5A445275ull }, // 1e-57
+    { 0xFB158592BE068D2Eull, 0xEED6E2F0F0D56712ull }, // 1e-56
+    { 0x9CED737BB6C4183Dull, 0x55464DD69685606Bull }, // 1e-55
+    { 0xC428D05AA4751E4Cull, 0xAA97E14C3C26B886ull }, // 1e-54
+    { 0xF53304714D9265DFull, 0xD53DD99F4B3066A8ull }, // 1e-53
+    { 0x993FE2C6D07B7FABull, 0xE546A8038EFE4029ull }, // 1e-52
+    { 0xBF8FDB78849A5F96ull, 0xDE98520472BDD033ull }, // 1e-51
+    { 0xEF73D256A5C0F77Cull, 0x963E66858F6D4440ull }, // 1e-50
+    { 0x95A8637627989AADull, 0xDDE7001379A44AA8ull }, // 1e-49
+    { 0xBB127C53B17EC159ull, 0x5560C018580D5D52ull }, // 1e-48
+    { 0xE9D71B689DDE71AFull, 0xAAB8F01E6E10B4A6ull }, // 1e-47
+    { 0x9226712162AB070Dull, 0xCAB3961304CA70E8ull }, // 1e-46
+    { 0xB6B00D69BB55C8D1ull, 0x3D607B97C5FD0D22ull }, // 1e-45
+    { 0xE45C10C42A2B3B05ull, 0x8CB89A7DB77C506Aull }, // 1e-44
+    { 0x8EB98A7A9A5B04E3ull, 0x77F3608E92ADB242ull }, // 1e-43
+    { 0xB267ED1940F1C61Cull, 0x55F038B237591ED3ull }, // 1e-42
+    { 0xDF01E85F912E37A3ull, 0x6B6C46DEC52F6688ull }, // 1e-41
+    { 0x8B61313BBABCE2C6ull, 0x2323AC4B3B3DA015ull }, // 1e-40
+    { 0xAE397D8AA96C1B77ull, 0xABEC975E0A0D081Aull }, // 1e-39
+    { 0xD9C7DCED53C72255ull, 0x96E7BD358C904A21ull }, // 1e-38
+    { 0x881CEA14545C7575ull, 0x7E50D64177DA2E54ull }, // 1e-37
+    { 0xAA242499697392D2ull, 0xDDE50BD1D5D0B9E9ull }, // 1e-36
+    { 0xD4AD2DBFC3D07787ull, 0x955E4EC64B44E864ull }, // 1e-35
+    { 0x84EC3C97DA624AB4ull, 0xBD5AF13BEF0B113Eull }, // 1e-34
+    { 0xA6274BBDD0FADD61ull, 0xECB1AD8AEACDD58Eull }, // 1e-33
+    { 0xCFB11EAD453994BAull, 0x67DE18EDA5814AF2ull }, // 1e-32
+    { 0x81CEB32C4B43FCF4ull, 0x80EACF948770CED7ull }, // 1e-31
+    { 0xA2425FF75E14FC31ull, 0xA1258379A94D028Dull }, // 1e-30
+    { 0xCAD2F7F5359A3B3Eull, 0x096EE45813A04330ull }, // 1e-29
+    { 0xFD87B5F28300CA0Dull, 0x8BCA9D6E188853FCull }, // 1e-28
+    { 0x9E74D1B791E07E48ull, 0x775EA264CF55347Dull }, // 1e-27
+    { 0xC612062576589DDAull, 0x95364AFE032A819Dull }, // 1e-26
+    { 0xF79687AED3EEC551ull, 0x3A83DDBD83F52204ull }, // 1e-25
+    { 0x9ABE14CD44753B52ull, 0xC4926A9672793542ull }, // 1e-24
+    { 0xC16D9A0095928A27ull, 0x75B7053C0F178293ull }, // 1e-23
+    { 0xF1C90080BAF72CB1ull, 0x5324C68B12DD6338ull }, // 1e-22
+    { 0x971DA05074DA7BEEull, 0xD3F6FC16EBCA5E03ull }, // 1e-21
+    { 0xBCE5086492111AEAull, 0x88F4BB1CA6BCF584ull }, // 1e-20
+    { 0xEC1E4A7DB69561A5ull, 0x2B31E9E3D06C32E5ull }, // 1e-19
+    { 0x9392EE8E921D5D07ull, 0x3AFF322E62439FCFull }, // 1e-18
+    { 0xB877AA3236A4B449ull, 0x09BEFEB9FAD487C2ull }, // 1e-17
+    { 0xE69594BEC44DE15Bull, 0x4C2EBE687989A9B3ull }, // 1e-16
+    { 0x901D7CF73AB0ACD9ull, 0x0F9D37014BF60A10ull }, // 1e-15
+    { 0xB424DC35095CD80Full, 0x538484C19EF38C94ull }, // 1e-14
+    { 0xE12E13424BB40E13ull, 0x2865A5F206B06FB9ull }, // 1e-13
+    { 0x8CBCCC096F5088CBull, 0xF93F87B7442E45D3ull }, // 1e-12
+    { 0xAFEBFF0BCB24AAFEull, 0xF78F69A51539D748ull }, // 1e-11
+    { 0xDBE6FECEBDEDD5BEull, 0xB573440E5A884D1Bull }, // 1e-10
+    { 0x89705F4136B4A597ull, 0x31680A88F8953030ull }, // 1e-9
+    { 0xABCC77118461CEFCull, 0xFDC20D2B36BA7C3Dull }, // 1e-8
+    { 0xD6BF94D5E57A42BCull, 0x3D32907604691B4Cull }, // 1e-7
+    { 0x8637BD05AF6C69B5ull, 0xA63F9A49C2C1B10Full }, // 1e-6
+    { 0xA7C5AC471B478423ull, 0x0FCF80DC33721D53ull }, // 1e-5
+    { 0xD1B71758E219652Bull, 0xD3C36113404EA4A8ull }, // 1e-4
+    { 0x83126E978D4FDF3Bull, 0x645A1CAC083126E9ull }, // 1e-3
+    { 0xA3D70A3D70A3D70Aull, 0x3D70A3D70A3D70A3ull }, // 1e-2
+    { 0xCCCCCCCCCCCCCCCCull, 0xCCCCCCCCCCCCCCCCull }, // 1e-1
+    { 0x8000000000000000ull, 0x0000000000000000ull }, // 1e0
+    { 0xA000000000000000ull, 0x0000000000000000ull }, // 1e1
+    { 0xC800000000000000ull, 0x0000000000000000ull }, // 1e2
+    { 0xFA00000000000000ull, 0x0000000000000000ull }, // 1e3
+    { 0x9C40000000000000ull, 0x0000000000000000ull }, // 1e4
+    { 0xC350000000000000ull, 0x0000000000000000ull }, // 1e5
+    { 0xF424000000000000ull, 0x0000000000000000ull }, // 1e6
+    { 0x9896800000000000ull, 0x0000000000000000ull }, // 1e7
+    { 0xBEBC200000000000ull, 0x0000000000000000ull }, // 1e8
+    { 0xEE6B280000000000ull, 0x0000000000000000ull }, // 1e9
+    { 0x9502F90000000000ull, 0x0000000000000000ull }, // 1e10
+    { 0xBA43B74000000000ull, 0x0000000000000000ull }, // 1e11
+    { 0xE8D4A51000000000ull, 0x0000000000000000ull }, // 1e12
+    { 0x9184E72A00000000ull, 0x0000000000000000ull }, // 1e13
+    { 0xB5E620F480000000ull, 0x0000000000000000ull }, // 1e14
+    { 0xE35FA931A0000000ull, 0x0000000000000000ull }, // 1e15
+    { 0x8E1BC9BF04000000ull, 0x0000000000000000ull }, // 1e16
+    { 0xB1A2BC2EC5000000ull, 0x0000000000000000ull }, // 1e17
+    { 0xDE0B6B3A76400000ull, 0x0000000000000000ull }, // 1e18
+    { 0x8AC7230489E80000ull, 0x0000000000000000ull }, // 1e19
+    { 0xAD78EBC5AC620000ull, 0x0000000000000000ull }, // 1e20
+    { 0xD8D726B7177A8000ull, 0x0000000000000000ull }, // 1e21
+    { 0x878678326EAC9000ull, 0x0000000000000000ull }, // 1e22
+    { 0xA968163F0A57B400ull, 0x0000000000000000ull }, // 1e23
+    { 0xD3C21BCECCEDA100ull, 0x0000000000000000ull }, // 1e24
+    { 0x84595161401484A0ull, 0x0000000000000000ull }, // 1e25
+    { 0xA56FA5B99019A5C8ull, 0x0000000000000000ull }, // 1e26
+    { 0xCECB8F27F4200F3Aull, 0x0000000000000000ull }, // 1e27
+    { 0x813F3978F8940984ull, 0x4000000000000000ull }, // 1e28
+    { 0xA18F07D736B90BE5ull, 0x5000000000000000ull }, // 1e29
+    { 0xC9F2C9CD04674EDEull, 0xA400000000000000ull }, // 1e30
+    { 0xFC6F7C4045812296ull, 0x4D00000000000000ull }, // 1e31
+    { 0x9DC5ADA82B70B59Dull, 0xF020000000000000ull }, // 1e32
+    { 0xC5371912364CE305ull, 0x6C28000000000000ull }, // 1e33
+    { 0xF684DF56C3E01BC6ull, 0xC732000000000000ull }, // 1e34
+    { 0x9A130B963A6C115Cull, 0x3C7F400000000000ull }, // 1e35
+    { 0xC097CE7BC90715B3ull, 0x4B9F100000000000ull }, // 1e36
+    { 0xF0BDC21ABB48DB20ull, 0x1E86D40000000000ull }, // 1e37
+    { 0x96769950B50D88F4ull, 0x1314448000000000ull }, // 1e38
+    { 0xBC143FA4E250EB31ull, 0x17D955A000000000ull }, // 1e39
+    { 0xEB194F8E1AE525FDull, 0x5DCFAB0800000000ull }, // 1e40
+    { 0x92EFD1B8D0CF37BEull, 0x5AA1CAE500000000ull }, // 1e41
+    { 0xB7ABC627050305ADull, 0xF14A3D9E40000000ull }, // 1e42
+    { 0xE596B7B0C643C719ull, 0x6D9CCD05D0000000ull }, // 1e43
+    { 0x8F7E32CE7BEA5C6Full, 0xE4820023A2000000ull }, // 1e44
+    { 0xB35DBF821AE4F38Bull, 0xDDA2802C8A800000ull }, // 1e45
+    { 0xE0352F62A19E306Eull, 0xD50B2037AD200000ull }, // 1e46
+    { 0x8C213D9DA502DE45ull, 0x4526F422CC340000ull }, // 1e47
+    { 0xAF298D050E4395D6ull, 0x9670B12B7F410000ull }, // 1e48
+    { 0xDAF3F04651D47B4Cull, 0x3C0CDD765F114000ull }, // 1e49
+    { 0x88D8762BF324CD0Full, 0xA5880A69FB6AC800ull }, // 1e50
+    { 0xAB0E93B6EFEE0053ull, 0x8EEA0D047A457A00ull }, // 1e51
+    { 0xD5D238A4ABE98068ull, 0x72A4904598D6D880ull }, // 1e52
+    { 0x85A36366EB71F041ull, 0x47A6DA2B7F864750ull }, // 1e53
+    { 0xA70C3C40A64E6C51ull, 0x999090B65F67D924ull }, // 1e54
+    { 0xD0CF4B50CFE20765ull, 0xFFF4B4E3F741CF6Dull }, // 1e55
+    { 0x82818F1281ED449Full, 0xBFF8F10E7A8921A4ull }, // 1e56
+    { 0xA321F2D7226895C7ull, 0xAFF72D52192B6A0Dull }, // 1e57
+    { 0xCBEA6F8CEB02BB39ull, 0x9BF4F8A69F764490ull }, // 1e58
+    { 0xFEE50B7025C36A08ull, 0x02F236D04753D5B4ull }, // 1e59
+    { 0x9F4F2726179A2245ull, 0x01D762422C946590ull }, // 1e60
+    { 0xC722F0EF9D80AAD6ull, 0x424D3AD2B7B97EF5ull }, // 1e61
+    { 0xF8EBAD2B84E0D58Bull, 0xD2E0898765A7DEB2ull }, // 1e62
+    { 0x9B934C3B330C8577ull, 0x63CC55F49F88EB2Full }, // 1e63
+    { 0xC2781F49FFCFA6D5ull, 0x3CBF6B71C76B25FBull }, // 1e64
+    { 0xF316271C7FC3908Aull, 0x8BEF464E3945EF7Aull }, // 1e65
+    { 0x97EDD871CFDA3A56ull, 0x97758BF0E3CBB5ACull }, // 1e66
+    { 0xBDE94E8E43D0C8ECull, 0x3D52EEED1CBEA317ull }, // 1e67
+    { 0xED63A231D4C4FB27ull, 0x4CA7AAA863EE4BDDull }, // 1e68
+    { 0x945E455F24FB1CF8ull, 0x8FE8CAA93E74EF6Aull }, // 1e69
+    { 0xB975D6B6EE39E436ull, 0xB3E2FD538E122B44ull }, // 1e70
+    { 0xE7D34C64A9C85D44ull, 0x60DBBCA87196B616ull }, // 1e71
+    { 0x90E40FBEEA1D3A4Aull, 0xBC8955E946FE31CDull }, // 1e72
+    { 0xB51D13AEA4A488DDull, 0x6BABAB6398BDBE41ull }, // 1e73
+    { 0xE264589A4DCDAB14ull, 0xC696963C7EED2DD1ull }, // 1e74
+    { 0x8D7EB76070A08AECull, 0xFC1E1DE5CF543CA2ull }, // 1e75
+    { 0xB0DE65388CC8ADA8ull, 0x3B25A55F43294BCBull }, // 1e76
+    { 0xDD15FE86AFFAD912ull, 0x49EF0EB713F39EBEull }, // 1e77
+    { 0x8A2DBF142DFCC7ABull, 0x6E3569326C784337ull }, // 1e78
+    { 0xACB92ED9397BF996ull, 0x49C2C37F07965404ull }, // 1e79
+    { 0xD7E77A8F87DAF7FBull, 0xDC33745EC97BE906ull }, // 1e80
+    { 0x86F0AC99B4E8DAFDull, 0x69A028BB3DED71A3ull }, // 1e81
+    { 0xA8ACD7C0222311BCull, 0xC40832EA0D68CE0Cull }, // 1e82
+    { 0xD2D80DB02AABD62Bull, 0xF50A3FA490C30190ull }, // 1e83
+    { 0x83C7088E1AAB65DBull, 0x792667C6DA79E0FAull }, // 1e84
+    { 0xA4B8CAB1A1563F52ull, 0x577001B891185938ull }, // 1e85
+    { 0xCDE6FD5E09ABCF26ull, 0xED4C0226B55E6F86ull }, // 1e86
+    { 0x80B05E5AC60B6178ull, 0x544F8158315B05B4ull }, // 1e87
+    { 0xA0DC75F1778E39D6ull, 0x696361AE3DB1C721ull }, // 1e88
+    { 0xC913936DD571C84Cull, 0x03BC3A19CD1E38E9ull }, // 1e89
+    { 0xFB5878494ACE3A5Full, 0x04AB48A04065C723ull }, // 1e90
+    { 0x9D174B2DCEC0E47Bull, 0x62EB0D64283F9C76ull }, // 1e91
+    { 0xC45D1DF942711D9Aull, 0x3BA5D0BD324F8394ull }, // 1e92
+    { 0xF5746577930D6500ull, 0xCA8F44EC7EE36479ull }, // 1e93
+    { 0x9968BF6ABBE85F20ull, 0x7E998B13CF4E1ECBull }, // 1e94
+    { 0xBFC2EF456AE276E8ull, 0x9E3FEDD8C321A67Eull }, // 1e95
+    { 0xEFB3AB16C59B14A2ull, 0xC5CFE94EF3EA101Eull }, // 1e96
+    { 0x95D04AEE3B80ECE5ull, 0xBBA1F1D158724A12ull }, // 1e97
+    { 0xBB445DA9CA61281Full, 0x2A8A6E45AE8EDC97ull }, // 1e98
+    { 0xEA1575143CF97226ull, 0xF52D09D71A3293BDull }, // 1e99
+    { 0x924D692CA61BE758ull, 0x593C2626705F9C56ull }, // 1e100
+    { 0xB6E0C377CFA2E12Eull, 0x6F8B2FB00C77836Cull }, // 1e101
+    { 0xE498F455C38B997Aull, 0x0B6DFB9C0F956447ull }, // 1e102
+    { 0x8EDF98B59A373FECull, 0x4724BD4189BD5EACull }, // 1e103
+    { 0xB2977EE300C50FE7ull, 0x58EDEC91EC2CB657ull }, // 1e104
+    { 0xDF3D5E9BC0F653E1ull, 0x2F2967B66737E3EDull }, // 1e105
+    { 0x8B865B215899F46Cull, 0xBD79E0D20082EE74ull }, // 1e106
+    { 0xAE67F1E9AEC07187ull, 0xECD8590680A3AA11ull }, // 1e107
+    { 0xDA01EE641A708DE9ull, 0xE80E6F4820CC9495ull }, // 1e108
+    { 0x884134FE908658B2ull, 0x3109058D147FDCDDull }, // 1e109
+    { 0xAA51823E34A7EEDEull, 0xBD4B46F0599FD415ull }, // 1e110
+    { 0xD4E5E2CDC1D1EA96ull, 0x6C9E18AC7007C91Aull }, // 1e111
+    { 0x850FADC09923329Eull, 0x03E2CF6BC604DDB0ull }, // 1e112
+    { 0xA6539930BF6BFF45ull, 0x84DB8346B786151Cull }, // 1e113
+    { 0xCFE87F7CEF46FF16ull, 0xE612641865679A63ull }, // 1e114
+    { 0x81F14FAE158C5F6Eull, 0x4FCB7E8F3F60C07Eull }, // 1e115
+    { 0xA26DA3999AEF7749ull, 0xE3BE5E330F38F09Dull }, // 1e116
+    { 0xCB090C8001AB551Cull, 0x5CADF5BFD3072CC5ull }, // 1e117
+    { 0xFDCB4FA002162A63ull, 0x73D9732FC7C8F7F6ull }, // 1e118
+    { 0x9E9F11C4014DDA7Eull, 0x2867E7FDDCDD9AFAull }, // 1e119
+    { 0xC646D63501A1511Dull, 0xB281E1FD541501B8ull }, // 1e120
+    { 0xF7D88BC24209A565ull, 0x1F225A7CA91A4226ull }, // 1e121
+    { 0x9AE757596946075Full, 0x3375788DE9B06958ull }, // 1e122
+    { 0xC1A12D2FC3978937ull, 0x0052D6B1641C83AEull }, // 1e123
+    { 0xF209787BB47D6B84ull, 0xC0678C5DBD23A49Aull }, // 1e124
+    { 0x9745EB4D50CE6332ull, 0xF840B7BA963646E0ull }, // 1e125
+    { 0xBD176620A501FBFFull, 0xB650E5A93BC3D898ull }, // 1e126
+    { 0xEC5D3FA8CE427AFFull, 0xA3E51F138AB4CEBEull }, // 1e127
+    { 0x93BA47C980E98CDFull, 0xC66F336C36B10137ull }, // 1e128
+    { 0xB8A8D9BBE123F017ull, 0xB80B0047445D4184ull }, // 1e129
+    { 0xE6D3102AD96CEC1Dull, 0xA60DC059157491E5ull }, // 1e130
+    { 0x9043EA1AC7E41392ull, 0x87C89837AD68DB2Full }, // 1e131
+    { 0xB454E4A179DD1877ull, 0x29BABE4598C311FBull }, // 1e132
+    { 0xE16A1DC9D8545E94ull, 0xF4296DD6FEF3D67Aull }, // 1e133
+    { 0x8CE2529E2734BB1Dull, 0x1899E4A65F58660Cull }, // 1e134
+    { 0xB01AE745B101E9E4ull, 0x5EC05DCFF72E7F8Full }, // 1e135
+    { 0xDC21A1171D42645Dull, 0x76707543F4FA1F73ull }, // 1e136
+    { 0x899504AE72497EBAull, 0x6A06494A791C53A8ull }, // 1e137
+    { 0xABFA45DA0EDBDE69ull, 0x0487DB9D17636892ull }, // 1e138
+    { 0xD6F8D7509292D603ull, 0x45A9D2845D3C42B6ull }, // 1e139
+    { 0x865B86925B9BC5C2ull, 0x0B8A2392BA45A9B2ull }, // 1e140
+    { 0xA7F26836F282B732ull, 0x8E6CAC7768D7141Eull }, // 1e141
+    { 0xD1EF0244AF2364FFull, 0x3207D795430CD926ull }, // 1e142
+    { 0x8335616AED761F1Full, 0x7F44E6BD49E807B8ull }, // 1e143
+    { 0xA402B9C5A8D3A6E7ull, 0x5F16206C9C6209A6ull }, // 1e144
+    { 0xCD036837130890A1ull, 0x36DBA887C37A8C0Full }, // 1e145
+    { 0x802221226BE55A64ull, 0xC2494954DA2C9789ull }, // 1e146
+    { 0xA02AA96B06DEB0FDull, 0xF2DB9BAA10B7BD6Cull }, // 1e147
+    { 0xC83553C5C8965D3Dull, 0x6F92829494E5ACC7ull }, // 1e148
+    { 0xFA42A8B73ABBF48Cull, 0xCB772339BA1F17F9ull }, // 1e149
+    { 0x9C69A97284B578D7ull, 0xFF2A760414536EFBull }, // 1e150
+    { 0xC38413CF25E2D70Dull, 0xFEF5138519684ABAull }, // 1e151
+    { 0xF46518C2EF5B8CD1ull, 0x7EB258665FC25D69ull }, // 1e152
+    { 0x98BF2F79D5993802ull, 0xEF2F773FFBD97A61ull }, // 1e153
+    { 0xBEEEFB584AFF8603ull, 0xAAFB550FFACFD8FAull }, // 1e154
+    { 0xEEAABA2E5DBF6784ull, 0x95BA2A53F983CF38ull }, // 1e155
+    { 0x952AB45CFA97A0B2ull, 0xDD945A747BF26183ull }, // 1e156
+    { 0xBA756174393D88DFull, 0x94F971119AEEF9E4ull }, // 1e157
+    { 0xE912B9D1478CEB17ull, 0x7A37CD5601AAB85Dull }, // 1e158
+    { 0x91ABB422CCB812EEull, 0xAC62E055C10AB33Aull }, // 1e159
+    { 0xB616A12B7FE617AAull, 0x577B986B314D6009ull }, // 1e160
+    { 0xE39C49765FDF9D94ull, 0xED5A7E85FDA0B80Bull }, // 1e161
+    { 0x8E41ADE9FBEBC27Dull, 0x14588F13BE847307ull }, // 1e162
+    { 0xB1D219647AE6B31Cull, 0x596EB2D8AE258FC8ull }, // 1e163
+    { 0xDE469FBD99A05FE3ull, 0x6FCA5F8ED9AEF3BBull }, // 1e164
+    { 0x8AEC23D680043BEEull, 0x25DE7BB9480D5854ull }, // 1e165
+    { 0xADA72CCC20054AE9ull, 0xAF561AA79A10AE6Aull }, // 1e166
+    { 0xD910F7FF28069DA4ull, 0x1B2BA1518094DA04ull }, // 1e167
+    { 0x87AA9AFF79042286ull, 0x90FB44D2F05D0842ull }, // 1e168
+    { 0xA99541BF57452B28ull, 0x353A1607AC744A53ull }, // 1e169
+    { 0xD3FA922F2D1675F2ull, 0x42889B8997915CE8ull }, // 1e170
+    { 0x847C9B5D7C2E09B7ull, 0x69956135FEBADA11ull }, // 1e171
+    { 0xA59BC234DB398C25ull, 0x43FAB9837E699095ull }, // 1e172
+    { 0xCF02B2C21207EF2Eull, 0x94F967E45E03F4BBull }, // 1e173
+    { 0x8161AFB94B44F57Dull, 0x1D1BE0EEBAC278F5ull }, // 1e174
+    { 0xA1BA1BA79E1632DCull, 0x6462D92A69731732ull }, // 1e175
+    { 0xCA28A291859BBF93ull, 0x7D7B8F7503CFDCFEull }, // 1e176
+    { 0xFCB2CB35E702AF78ull, 0x5CDA735244C3D43Eull }, // 1e177
+    { 0x9DEFBF01B061ADABull, 0x3A0888136AFA64A7ull }, // 1e178
+    { 0xC56BAEC21C7A1916ull, 0x088AAA1845B8FDD0ull }, // 1e179
+    { 0xF6C69A72A3989F5Bull, 0x8AAD549E57273D45ull }, // 1e180
+    { 0x9A3C2087A63F6399ull, 0x36AC54E2F678864Bull }, // 1e181
+    { 0xC0CB28A98FCF3C7Full, 0x84576A1BB416A7DDull }, // 1e182
+    { 0xF0FDF2D3F3C30B9Full, 0x656D44A2A11C51D5ull }, // 1e183
+    { 0x969EB7C47859E743ull, 0x9F644AE5A4B1B325ull }, // 1e184
+    { 0xBC4665B596706114ull, 0x873D5D9F0DDE1FEEull }, // 1e185
+    { 0xEB57FF22FC0C7959ull, 0xA90CB506D155A7EAull }, // 1e186
+    { 0x9316FF75DD87CBD8ull, 0x09A7F12442D588F2ull }, // 1e187
+    { 0xB7DCBF5354E9BECEull, 0x0C11ED6D538AEB2Full }, // 1e188
+    { 0xE5D3EF282A242E81ull, 0x8F1668C8A86DA5FAull }, // 1e189
+    { 0x8FA475791A569D10ull, 0xF96E017D694487BCull }, // 1e190
+    { 0xB38D92D760EC4455ull, 0x37C981DCC395A9ACull }, // 1e191
+    { 0xE070F78D3927556Aull, 0x85BBE253F47B1417ull }, // 1e192
+    { 0x8C469AB843B89562ull, 0x93956D7478CCEC8Eull }, // 1e193
+    { 0xAF58416654A6BABBull, 0x387AC8D1970027B2ull }, // 1e194
+    { 0xDB2E51BFE9D0696Aull, 0x06997B05FCC0319Eull }, // 1e195
+    { 0x88FCF317F22241E2ull, 0x441FECE3BDF81F03ull }, // 1e196
+    { 0xAB3C2FDDEEAAD25Aull, 0xD527E81CAD7626C3ull }, // 1e197
+    { 0xD60B3BD56A5586F1ull, 0x8A71E223D8D3B074ull }, // 1e198
+    { 0x85C7056562757456ull, 0xF6872D5667844E49ull }, // 1e199
+    { 0xA738C6BEBB12D16Cull, 0xB428F8AC016561DBull }, // 1e200
+    { 0xD106F86E69D785C7ull, 0xE13336D701BEBA52ull }, // 1e201
+    { 0x82A45B450226B39Cull, 0xECC0024661173473ull }, // 1e202
+    { 0xA34D721642B06084ull, 0x27F002D7F95D0190ull }, // 1e203
+    { 0xCC20CE9BD35C78A5ull, 0x31EC038DF7B441F4ull }, // 1e204
+    { 0xFF290242C83396CEull, 0x7E67047175A15271ull }, // 1e205
+    { 0x9F79A169BD203E41ull, 0x0F0062C6E984D386ull }, // 1e206
+    { 0xC75809C42C684DD1ull, 0x52C07B78A3E60868ull }, // 1e207
+    { 0xF92E0C3537826145ull, 0xA7709A56CCDF8A82ull }, // 1e208
+    { 0x9BBCC7A142B17CCBull, 0x88A66076400BB691ull }, // 1e209
+    { 0xC2ABF989935DDBFEull, 0x6ACFF893D00EA435ull }, // 1e210
+    { 0xF356F7EBF83552FEull, 0x0583F6B8C4124D43ull }, // 1e211
+    { 0x98165AF37B2153DEull, 0xC3727A337A8B704Aull }, // 1e212
+    { 0xBE1BF1B059E9A8D6ull, 0x744F18C0592E4C5Cull }, // 1e213
+    { 0xEDA2EE1C7064130Cull, 0x1162DEF06F79DF73ull }, // 1e214
+    { 0x9485D4D1C63E8BE7ull, 0x8ADDCB5645AC2BA8ull }, // 1e215
+    { 0xB9A74A0637CE2EE1ull, 0x6D953E2BD7173692ull }, // 1e216
+    { 0xE8111C87C5C1BA99ull, 0xC8FA8DB6CCDD0437ull }, // 1e217
+    { 0x910AB1D4DB9914A0ull, 0x1D9C9892400A22A2ull }, // 1e218
+    { 0xB54D5E4A127F59C8ull, 0x2503BEB6D00CAB4Bull }, // 1e219
+    { 0xE2A0B5DC971F303Aull, 0x2E44AE64840FD61Dull }, // 1e220
+    { 0x8DA471A9DE737E24ull, 0x5CEAECFED289E5D2ull }, // 1e221
+    { 0xB10D8E1456105DADull, 0x7425A83E872C5F47ull }, // 1e222
+    { 0xDD50F1996B947518ull, 0xD12F124E28F77719ull }, // 1e223
+    { 0x8A5296FFE33CC92Full, 0x82BD6B70D99AAA6Full }, // 1e224
+    { 0xACE73CBFDC0BFB7Bull, 0x636CC64D1001550Bull }, // 1e225
+    { 0xD8210BEFD30EFA5Aull, 0x3C47F7E05401AA4Eull }, // 1e226
+    { 0x8714A775E3E95C78ull, 0x65ACFAEC34810A71ull }, // 1e227
+    { 0xA8D9D1535CE3B396ull, 0x7F1839A741A14D0Dull }, // 1e228
+    { 0xD31045A8341CA07Cull, 0x1EDE48111209A050ull }, // 1e229
+    { 0x83EA2B892091E44Dull, 0x934AED0AAB460432ull }, // 1e230
+    { 0xA4E4B66B68B65D60ull, 0xF81DA84D5617853Full }, // 1e231
+    { 0xCE1DE40642E3F4B9ull, 0x36251260AB9D668Eull }, // 1e232
+    { 0x80D2AE83E9CE78F3ull, 0xC1D72B7C6B426019ull }, // 1e233
+    { 0xA1075A24E4421730ull, 0xB24CF65B8612F81Full }, // 1e234
+    { 0xC94930AE1D529CFCull, 0xDEE033F26797B627ull }, // 1e235
+    { 0xFB9B7CD9A4A7443Cull, 0x169840EF017DA3B1ull }, // 1e236
+    { 0x9D412E0806E88AA5ull, 0x8E1F289560EE864Eull }, // 1e237
+    { 0xC491798A08A2AD4Eull, 0xF1A6F2BAB92A27E2ull }, // 1e238
+    { 0xF5B5D7EC8ACB58A2ull, 0xAE10AF696774B1DBull }, // 1e239
+    { 0x9991A6F3D6BF1765ull, 0xACCA6DA1E0A8EF29ull }, // 1e240
+    { 0xBFF610B0CC6EDD3Full, 0x17FD090A58D32AF3ull }, // 1e241
+    { 0xEFF394DCFF8A948Eull, 0xDDFC4B4CEF07F5B0ull }, // 1e242
+    { 0x95F83D0A1FB69CD9ull, 0x4ABDAF101564F98Eull }, // 1e243
+    { 0xBB764C4CA7A4440Full, 0x9D6D1AD41ABE37F1ull }, // 1e244
+    { 0xEA53DF5FD18D5513ull, 0x84C86189216DC5EDull }, // 1e245
+    { 0x92746B9BE2F8552Cull, 0x32FD3CF5B4E49BB4ull }, // 1e246
+    { 0xB7118682DBB66A77ull, 0x3FBC8C33221DC2A1ull }, // 1e247
+    { 0xE4D5E82392A40515ull, 0x0FABAF3FEAA5334Aull }, // 1e248
+    { 0x8F05B1163BA6832Dull, 0x29CB4D87F2A7400Eull }, // 1e249
+    { 0xB2C71D5BCA9023F8ull, 0x743E20E9EF511012ull }, // 1e250
+    { 0xDF78E4B2BD342CF6ull, 0x914DA9246B255416ull }, // 1e251
+    { 0x8BAB8EEFB6409C1Aull, 0x1AD089B6C2F7548Eull }, // 1e252
+    { 0xAE9672ABA3D0C320ull, 0xA184AC2473B529B1ull }, // 1e253
+    { 0xDA3C0F568CC4F3E8ull, 0xC9E5D72D90A2741Eull }, // 1e254
+    { 0x8865899617FB1871ull, 0x7E2FA67C7A658892ull }, // 1e255
+    { 0xAA7EEBFB9DF9DE8Dull, 0xDDBB901B98FEEAB7ull }, // 1e256
+    { 0xD51EA6FA85785631ull, 0x552A74227F3EA565ull }, // 1e257
+    { 0x8533285C936B35DEull, 0xD53A88958F87275Full }, // 1e258
+    { 0xA67FF273B8460356ull, 0x8A892ABAF368F137ull }, // 1e259
+    { 0xD01FEF10A657842Cull, 0x2D2B7569B0432D85ull }, // 1e260
+    { 0x8213F56A67F6B29Bull, 0x9C3B29620E29FC73ull }, // 1e261
+    { 0xA298F2C501F45F42ull, 0x8349F3BA91B47B8Full }, // 1e262
+    { 0xCB3F2F7642717713ull, 0x241C70A936219A73ull }, // 1e263
+    { 0xFE0EFB53D30DD4D7ull, 0xED238CD383AA0110ull }, // 1e264
+    { 0x9EC95D1463E8A506ull, 0xF4363804324A40AAull }, // 1e265
+    { 0xC67BB4597CE2CE48ull, 0xB143C6053EDCD0D5ull }, // 1e266
+    { 0xF81AA16FDC1B81DAull, 0xDD94B7868E94050Aull }, // 1e267
+    { 0x9B10A4E5E9913128ull, 0xCA7CF2B4191C8326ull }, // 1e268
+    { 0xC1D4CE1F63F57D72ull, 0xFD1C2F611F63A3F0ull }, // 1e269
+    { 0xF24A01A73CF2DCCFull, 0xBC633B39673C8CECull }, // 1e270
+    { 0x976E41088617CA01ull, 0xD5BE0503E085D813ull }, // 1e271
+    { 0xBD49D14AA79DBC82ull, 0x4B2D8644D8A74E18ull }, // 1e272
+    { 0xEC9C459D51852BA2ull, 0xDDF8E7D60ED1219Eull }, // 1e273
+    { 0x93E1AB8252F33B45ull, 0xCABB90E5C942B503ull }, // 1e274
+    { 0xB8DA1662E7B00A17ull, 0x3D6A751F3B936243ull }, // 1e275
+    { 0xE7109BFBA19C0C9Dull, 0x0CC512670A783AD4ull }, // 1e276
+    { 0x906A617D450187E2ull, 0x27FB2B80668B24C5ull }, // 1e277
+    { 0xB484F9DC9641E9DAull, 0xB1F9F660802DEDF6ull }, // 1e278
+    { 0xE1A63853BBD26451ull, 0x5E7873F8A0396973ull }, // 1e279
+    { 0x8D07E33455637EB2ull, 0xDB0B487B6423E1E8ull }, // 1e280
+    { 0xB049DC016ABC5E5Full, 0x91CE1A9A3D2CDA62ull }, // 1e281
+    { 0xDC5C5301C56B75F7ull, 0x7641A140CC7810FBull }, // 1e282
+    { 0x89B9B3E11B6329BAull, 0xA9E904C87FCB0A9Dull }, // 1e283
+    { 0xAC2820D9623BF429ull, 0x546345FA9FBDCD44ull }, // 1e284
+    { 0xD732290FBACAF133ull, 0xA97C177947AD4095ull }, // 1e285
+    { 0x867F59A9D4BED6C0ull, 0x49ED8EABCCCC485Dull }, // 1e286
+    { 0xA81F301449EE8C70ull, 0x5C68F256BFFF5A74ull }, // 1e287
+    { 0xD226FC195C6A2F8Cull, 0x73832EEC6FFF3111ull }, // 1e288
+    { 0x83585D8FD9C25DB7ull, 0xC831FD53C5FF7EABull }, // 1e289
+    { 0xA42E74F3D032F525ull, 0xBA3E7CA8B77F5E55ull }, // 1e290
+    { 0xCD3A1230C43FB26Full, 0x28CE1BD2E55F35EBull }, // 1e291
+    { 0x80444B5E7AA7CF85ull, 0x7980D163CF5B81B3ull }, // 1e292
+    { 0xA0555E361951C366ull, 0xD7E105BCC332621Full }, // 1e293
+    { 0xC86AB5C39FA63440ull, 0x8DD9472BF3FEFAA7ull }, // 1e294
+    { 0xFA856334878FC150ull, 0xB14F98F6F0FEB951ull }, // 1e295
+    { 0x9C935E00D4B9D8D2ull, 0x6ED1BF9A569F33D3ull }, // 1e296
+    { 0xC3B8358109E84F07ull, 0x0A862F80EC4700C8ull }, // 1e297
+    { 0xF4A642E14C6262C8ull, 0xCD27BB612758C0FAull }, // 1e298
+    { 0x98E7E9CCCFBD7DBDull, 0x8038D51CB897789Cull }, // 1e299
+    { 0xBF21E44003ACDD2Cull, 0xE0470A63E6BD56C3ull }, // 1e300
+    { 0xEEEA5D5004981478ull, 0x1858CCFCE06CAC74ull }, // 1e301
+    { 0x95527A5202DF0CCBull, 0x0F37801E0C43EBC8ull }, // 1e302
+    { 0xBAA718E68396CFFDull, 0xD30560258F54E6BAull }, // 1e303
+    { 0xE950DF20247C83FDull, 0x47C6B82EF32A2069ull }, // 1e304
+    { 0x91D28B7416CDD27Eull, 0x4CDC331D57FA5441ull }, // 1e305
+    { 0xB6472E511C81471Dull, 0xE0133FE4ADF8E952ull }, // 1e306
+    { 0xE3D8F9E563A198E5ull, 0x58180FDDD97723A6ull }, // 1e307
+    { 0x8E679C2F5E44FF8Full, 0x570F09EAA7EA7648ull }, // 1e308
+    { 0xB201833B35D63F73ull, 0x2CD2CC6551E513DAull }, // 1e309
+    { 0xDE81E40A034BCF4Full, 0xF8077F7EA65E58D1ull }, // 1e310
+    { 0x8B112E86420F6191ull, 0xFB04AFAF27FAF782ull }, // 1e311
+    { 0xADD57A27D29339F6ull, 0x79C5DB9AF1F9B563ull }, // 1e312
+    { 0xD94AD8B1C7380874ull, 0x18375281AE7822BCull }, // 1e313
+    { 0x87CEC76F1C830548ull, 0x8F2293910D0B15B5ull }, // 1e314
+    { 0xA9C2794AE3A3C69Aull, 0xB2EB3875504DDB22ull }, // 1e315
+    { 0xD433179D9C8CB841ull, 0x5FA60692A46151EBull }, // 1e316
+    { 0x849FEEC281D7F328ull, 0xDBC7C41BA6BCD333ull }, // 1e317
+    { 0xA5C7EA73224DEFF3ull, 0x12B9B522906C0800ull }, // 1e318
+    { 0xCF39E50FEAE16BEFull, 0xD768226B34870A00ull }, // 1e319
+    { 0x81842F29F2CCE375ull, 0xE6A1158300D46640ull }, // 1e320
+    { 0xA1E53AF46F801C53ull, 0x60495AE3C1097FD0ull }, // 1e321
+    { 0xCA5E89B18B602368ull, 0x385BB19CB14BDFC4ull }, // 1e322
+    { 0xFCF62C1DEE382C42ull, 0x46729E03DD9ED7B5ull }, // 1e323
+    { 0x9E19DB92B4E31BA9ull, 0x6C07A2C26A8346D1ull }, // 1e324
+    { 0xC5A05277621BE293ull, 0xC7098B7305241885ull }, // 1e325
+    { 0xF70867153AA2DB38ull, 0xB8CBEE4FC66D1EA7ull }, // 1e326
+    { 0x9A65406D44A5C903ull, 0x737F74F1DC043328ull }, // 1e327
+    { 0xC0FE908895CF3B44ull, 0x505F522E53053FF2ull }, // 1e328
+    { 0xF13E34AABB430A15ull, 0x647726B9E7C68FEFull }, // 1e329
+    { 0x96C6E0EAB509E64Dull, 0x5ECA783430DC19F5ull }, // 1e330
+    { 0xBC789925624C5FE0ull, 0xB67D16413D132072ull }, // 1e331
+    { 0xEB96BF6EBADF77D8ull, 0xE41C5BD18C57E88Full }, // 1e332
+    { 0x933E37A534CBAAE7ull, 0x8E91B962F7B6F159ull }, // 1e333
+    { 0xB80DC58E81FE95A1ull, 0x723627BBB5A4ADB0ull }, // 1e334
+    { 0xE61136F2227E3B09ull, 0xCEC3B1AAA30DD91Cull }, // 1e335
+    { 0x8FCAC257558EE4E6ull, 0x213A4F0AA5E8A7B1ull }, // 1e336
+    { 0xB3BD72ED2AF29E1Full, 0xA988E2CD4F62D19Dull }, // 1e337
+    { 0xE0ACCFA875AF45A7ull, 0x93EB1B80A33B8605ull }, // 1e338
+    { 0x8C6C01C9498D8B88ull, 0xBC72F130660533C3ull }, // 1e339
+    { 0xAF87023B9BF0EE6Aull, 0xEB8FAD7C7F8680B4ull }, // 1e340
+    { 0xDB68C2CA82ED2A05ull, 0xA67398DB9F6820E1ull }, // 1e341
+    { 0x892179BE91D43A43ull, 0x88083F8943A1148Cull }, // 1e342
+    { 0xAB69D82E364948D4ull, 0x6A0A4F6B948959B0ull }, // 1e343
+    { 0xD6444E39C3DB9B09ull, 0x848CE34679ABB01Cull }, // 1e344
+    { 0x85EAB0E41A6940E5ull, 0xF2D80E0C0C0B4E11ull }, // 1e345
+    { 0xA7655D1D2103911Full, 0x6F8E118F0F0E2195ull }, // 1e346
+    { 0xD13EB46469447567ull, 0x4B7195F2D2D1A9FBull }, // 1e347
+};
 
-bool os_handle_valid(oshandle_t handle) {
-	return !os_handle_match(handle, os_handle_zero());
+// high 64 bits of a * b, the low ones go in lo
+static inline u64 istr__mul64(u64 a, u64 b, u64 *lo) {
+#if (COLLA_GCC || COLLA_CLANG) && defined(__SIZEOF_INT128__)
+    unsigned __int128 r = (unsigned __int128)a * b;
+    *lo = (u64)r;
+    return (u64)(r >> 64);
+#elif COLLA_MSVC && COLLA_SCAN_X64
+    u64 hi = 0;
+    *lo = _umul128(a, b, &hi);
+    return hi;
+#else
+    u64 a_lo = (u32)a, a_hi = a >> 32;
+    u64 b_lo = (u32)b, b_hi = b >> 32;
+    u64 ll = a_lo * b_lo, lh = a_lo * b_hi;
+    u64 hl = a_hi * b_lo, hh = a_hi * b_hi;
+    u64 mid = (ll >> 32) + (u32)lh + (u32)hl;
+    *lo = (mid << 32) | (u32)ll;
+    return hh + (lh >> 32) + (hl >> 32) + (mid >> 32);
+#endif
 }
 
-// == LOGGING ===================================
+// eisel-lemire: mantissa * 10^exponent with one or two 64x128 bit multiplications.
+// returns false when the result is too close to halfway between two doubles to
+// tell, or it's a subnormal, zero or infinite, then strtod has to do it
+static bool istr__eisel_lemire(u64 mantissa, i64 exponent, bool is_negative, double *val) {
+    if (mantissa == 0 || exponent < ISTR__POW10_128_MIN || exponent > ISTR__POW10_128_MAX) {
+        return false;
+    }
 
-const char* os_log_level_strings[LOG_COL__COUNT] = {
-    [LOG_DEBUG] = "[DEBUG]:",
-    [LOG_INFO]  = "[INFO]:",
-    [LOG_WARN]  = "[WARN]:",
-    [LOG_ERR]   = "[ERR]:",
-    [LOG_FATAL] = "[FATAL]:",
-};
+    u32 clz = 63 - scan__msb64(mantissa);
+    mantissa <<= clz;
+    // 217706 / 2^16 is log2(10), the shift rounds down for negative exponents too
+    u64 exp2 = (u64)(((217706 * exponent) >> 16) + 64 + 1023) - clz;
 
-os_log_colour_e os_log_level_colours[LOG_COL__COUNT] = {
-    [LOG_DEBUG] = LOG_COL_BLUE,
-    [LOG_INFO]  = LOG_COL_GREEN,
-    [LOG_WARN]  = LOG_COL_YELLOW,
-    [LOG_ERR]   = LOG_COL_RED,
-    [LOG_FATAL] = LOG_COL_RED,
-};
+    const u64 *pow10 = istr__pow10_128[exponent - ISTR__POW10_128_MIN];
+    u64 lo = 0;
+    u64 hi = istr__mul64(mantissa, pow10[0], &lo);
 
-os_log_options_e os__log_opts = OS_LOG_SIMPLE;
-log_callback_t os__log_cbs[COLLA_LOG_MAX_CALLBACKS] = {0};
-i64 os__log_cbs_count = 0;
+    // the bits that decide the rounding could still change with the low half of the power
+    if ((hi & 0x1FF) == 0x1FF && lo + mantissa < mantissa) {
+        u64 low_lo = 0;
+        u64 low_hi = istr__mul64(mantissa, pow10[1], &low_lo);
+        u64 merged_hi = hi, merged_lo = lo + low_hi;
+        if (merged_lo < lo) {
+            merged_hi++;
+        }
+        if ((merged_hi & 0x1FF) == 0x1FF && merged_lo + 1 == 0 && low_lo + mantissa < mantissa) {
+            return false;
+        }
+        hi = merged_hi;
+        lo = merged_lo;
+    }
 
-void os_log__stdout(log_event_t *ev) {
-    bool notime = os__log_opts & OS_LOG_NOTIME;
-    bool nofile = os__log_opts & OS_LOG_NOFILE;
+    // down to 54 bits, then rounded to 53
+    u64 msb = hi >> 63;
+    u64 out = hi >> (msb + 9);
+    exp2 -= 1 ^ msb;
 
-    if (!notime) {
-        os_log_set_colour(LOG_COL_DARK_GREY);
-        fmt_print(
-            "%02d:%02d:%02d ", 
-            ev->time->tm_hour, 
-            ev->time->tm_min, 
-            ev->time->tm_sec
-        );
-        os_log_set_colour(LOG_COL_RESET);
+    if (lo == 0 && (hi & 0x1FF) == 0 && (out & 3) == 1) {
+        return false;
     }
 
-    if (ev->level != LOG_BASIC) {
-        os_log_set_colour(os_log_level_colours[ev->level]);
-        fmt_print("%-8s ", os_log_level_strings[ev->level]);
-        os_log_set_colour(LOG_COL_RESET);
+    out += out & 1;
+    out >>= 1;
+    if (out >> 53) {
+        out >>= 1;
+        exp2++;
     }
 
-    if (!nofile) {
-        os_log_set_colour(LOG_COL_DARK_GREY);
-        fmt_print("%s:%d ", ev->file, ev->line);
-        os_log_set_colour(LOG_COL_RESET);
+    // exp2 is unsigned, 0 and underflows are subnormals, 0x7FF and up are infinities
+    if (exp2 - 1 >= 0x7FF - 1) {
+        return false;
     }
 
-    fmt_printv(ev->fmt, ev->args);
-    fmt_print("\n");
+    u64 bits = (exp2 << 52) | (out & 0x000FFFFFFFFFFFFFull) | ((u64)is_negative << 63);
+    memcpy(val, &bits, sizeof(bits));
+    return true;
 }
 
-void os_log__fp(log_event_t *ev) {
-    u8 tmpbuf[KB(1)] = {0};
-    arena_t scratch = arena_make(ARENA_STATIC, sizeof(tmpbuf), tmpbuf);
+// numbers with a mantissa up to 2^53, so it's exact as a double, and an exponent up
+// to 22, so the power of ten is too, are converted with a single multiplication or
+// division, which is correctly rounded. any other mantissa that fits in 64 bits
+// (19 digits, %.17g included) goes through eisel-lemire, which gives up on about
+// one number in a billion. anything else (more digits, subnormals, overflows, hex,
+// inf, nan) is left to strtod. a copy that doesn't fit on the stack goes in a scratch
+// arena other than conflict, which is where the caller may be writing the result
+static bool istr__parse_num(instream_t *ctx, double *val, arena_t *conflict) {
+    const char *end = ctx->beg + ctx->len;
+    const char *cur = istr__skip_space(ctx->cur, end);
+    const char *start = cur;
+
+    bool is_negative = false;
+    if (cur < end && (*cur == '+' || *cur == '-')) {
+        is_negative = *cur == '-';
+        cur++;
+    }
+
+    u64 mantissa = 0;
+    usize int_digits = 0;
+    usize frac_digits = 0;
+    bool overflow = false;
+
+    cur = istr__parse_digits(cur, end, &mantissa, &int_digits, &overflow);
+    if (!overflow && cur < end && *cur == '.') {
+        cur = istr__parse_digits(cur + 1, end, &mantissa, &frac_digits, &overflow);
+    }
+
+    // hex numbers are left to strtod
+    bool is_hex = int_digits == 1 && mantissa == 0 && cur < end && (*cur == 'x' || *cur == 'X');
+
+    i64 exponent = 0;
+    if (!overflow && !is_hex && (int_digits + frac_digits) > 0 && cur < end && (*cur == 'e' || *cur == 'E')) {
+        const char *exp_start = cur++;
+        bool exp_negative = false;
+        if (cur < end && (*cur == '+' || *cur == '-')) {
+            exp_negative = *cur == '-';
+            cur++;
+        }
+        u64 exp_value = 0;
+        usize exp_digits = 0;
+        bool exp_overflow = false;
+        cur = istr__parse_digits(cur, end, &exp_value, &exp_digits, &exp_overflow);
+        if (exp_digits == 0) {
+            // "1e" is just 1, the e isn't part of the number
+            cur = exp_start;
+        }
+        else if (exp_overflow || exp_value > 100000) {
+            overflow = true;
+        }
+        else {
+            exponent = exp_negative ? -(i64)exp_value : (i64)exp_value;
+        }
+    }
 
-    oshandle_t fp = {0};
-    fp.data = (uptr)ev->udata;
+    exponent -= (i64)frac_digits;
 
-    bool notime = os__log_opts & OS_LOG_NOTIME;
-    bool nofile = os__log_opts & OS_LOG_NOFILE;
+    if ((int_digits + frac_digits) > 0 && !overflow && !is_hex &&
+        mantissa <= (1ull << 53) &&
+        exponent >= -22 && exponent <= 22
+    ) {
+        double out = (double)mantissa;
+        out = exponent < 0 ? out / istr__pow10[-exponent] : out * istr__pow10[exponent];
+        *val = is_negative ? -out : out;
+        ctx->cur = cur;
+        return true;
+    }
 
-    if (!notime) {
-        os_file_print(
-            scratch, 
-            fp, 
-            "%02d:%02d:%02d ", 
-            ev->time->tm_hour, 
-            ev->time->tm_min, 
-            ev->time->tm_sec
-        );
+    if ((int_digits + frac_digits) > 0 && !overflow && !is_hex &&
+        istr__eisel_lemire(mantissa, exponent, is_negative, val)
+    ) {
+        ctx->cur = cur;
+        return true;
     }
 
-    if (ev->level != LOG_BASIC) {
-        os_file_print(scratch, fp, "%-8s ", os_log_level_strings[ev->level]);
+    // strtod needs a null terminated string, only what could be part of a number is copied.
+    // this includes nan(...), numbers that don't fit on the stack go in a scratch arena.
+    // everything up to cur was already read as a number
+    usize len = cur - start;
+    while (start + len < end) {
+        char c = start[len];
+        bool is_symbol = c == '.' || c == '+' || c == '-' || c == '_' || c == '(' || c == ')';
+        if (!char_is_alpha(c) && !char_is_num(c) && !is_symbol) {
+            break;
+        }
+        len++;
     }
 
-    if (!nofile) {
-        os_file_print(scratch, fp, "%s:%d ", ev->file, ev->line);
+    char small[512];
+    char *buf = small;
+    arena_temp_t scratch = {0};
+    if (len >= sizeof(small)) {
+        scratch = scratch_begin(conflict);
+        buf = alloc(scratch.arena, char, len + 1, ALLOC_NOZERO);
     }
+    memcpy(buf, start, len);
+    buf[len] = '\0';
 
-    os_file_printv(scratch, fp, ev->fmt, ev->args);
-    os_file_putc(fp, '\n');
-}
+    char *buf_end = NULL;
+    *val = strtod(buf, &buf_end);
+    usize parsed = buf_end - buf;
+    scratch_end(&scratch);
 
-void os_log_set_options(os_log_options_e opt) {
-    os__log_opts = opt;
-}
+    if (parsed == 0) {
+        return false;
+    }
 
-os_log_options_e os_log_get_options(void) {
-    return os__log_opts;
+    ctx->cur = start + parsed;
+    return true;
 }
 
-void os_log_add_callback(log_callback_t cb) {
-    colla_assert(os__log_cbs_count < arrlen(os__log_cbs));
-    os__log_cbs[os__log_cbs_count++] = cb;
-}
+// conflict is the arena the caller is writing the number into, if any
+static bool istr__get_num(instream_t *ctx, double *val, arena_t *conflict) {
+    if (!ctx || !ctx->cur || !val) return false;
+    
+    if (!istr__parse_num(ctx, val, conflict)) {
+        warn("istrGetDouble: no valid conversion could be performed (%.5s)", ctx->cur);
+        return false;
+    }
+    else if(*val == HUGE_VAL || *val == -HUGE_VAL) {
+        warn("istrGetDouble: value read is out of the range of representable values");
+        return false;
+    }
 
-void os_log_add_fp(oshandle_t fp, os_log_level_e level) {
-    os_log_add_callback((log_callback_t){ 
-        .fn = os_log__fp, 
-        .udata = (void*)fp.data, 
-        .level = level 
-    });
+    return true;
 }
 
-void os__log_init(void) {
-    os_log_add_callback((log_callback_t){ .fn = os_log__stdout });
+bool istr_get_num(instream_t *ctx, double *val) {
+    return istr__get_num(ctx, val, NULL);
 }
 
-void os_log_print(const char *file, int line, os_log_level_e level, const char *fmt, ...) {
-    va_list args;
-    va_start(args, fmt);
-    os_log_printv(file, line, level, fmt, args);
-    va_end(args);
+bool istr_get_float(instream_t *ctx, float *val) {
+    double v = 0;
+    if (!istr_get_num(ctx, &v)) {
+        return false;
+    }
+    if (v >= HUGE_VALF || v <= -HUGE_VALF) {
+        return false;
+    }
+    *val = (float)v;
+    return true;
 }
 
-void os_log_printv(const char *file, int line, os_log_level_e level, const char *fmt, va_list args) {
-    time_t t = time(NULL);
-    struct tm log_time = { 0 };
-#define gettime(src, dst) localtime_s(&dst, &src)
-    log_event_t ev = {
-        .level = level,
-        .line = line,
-        .args = args,
-        .fmt = fmt,
-        .file = file,
-        .time = &log_time,
-    };
+strview_t istr_get_view(instream_t *ctx, char delim) {
+    if (!ctx || !ctx->cur) return STRV_EMPTY;
+    const char *from = ctx->cur;
+    istr_ignore(ctx, delim);
+    usize len = ctx->cur - from;
+    return strv(from, len);
+}
 
-    localtime_s(&log_time, &t);
-    for (int i = 0; i < os__log_cbs_count; ++i) {
-        if (os__log_cbs[i].level > level) {
-            continue;
-        }
-        ev.udata = os__log_cbs[i].udata;
-        os__log_cbs[i].fn(&ev);
+strview_t istr_get_view_either(instream_t *ctx, strview_t chars) {
+    if (!ctx || !ctx->cur) return STRV_EMPTY;
+    const char *from = ctx->cur;
+    while (!istr_is_finished(ctx) && !strv_contains(chars, *ctx->cur)) {
+        ctx->cur++;
     }
 
-    bool nocrash = os__log_opts & OS_LOG_NOCRASH;
+    usize len = ctx->cur - from;
+    return strv(from, len);
+}
 
-    if (!nocrash && level == LOG_FATAL) {
-        os_abort(1);
-    }
+strview_t istr_get_view_len(instream_t *ctx, usize len) {
+    if (!ctx || !ctx->cur) return STRV_EMPTY;
+    const char *from = ctx->cur;
+    istr_skip(ctx, len);
+    usize buflen = ctx->cur - from;
+    return (strview_t){ from, buflen };
 }
 
-// == FILE ======================================
+strview_t istr_get_line(instream_t *ctx) {
+    strview_t line = istr_get_view(ctx, '\n');
+    istr_skip(ctx, 1);
+    if (strv_ends_with(line, '\r')) {
+        line = strv_remove_suffix(line, 1);
+    }
+    return line;
+}
 
-void os_file_split_path(strview_t path, strview_t *dir, strview_t *name, strview_t *ext) {
-	usize dir_lin = strv_rfind(path, '/', 0);
-	usize dir_win = strv_rfind(path, '\\', 0);
-	dir_lin = dir_lin != STR_NONE ? dir_lin : 0;
-	dir_win = dir_win != STR_NONE ? dir_win : 0;
-	usize dir_pos = MAX(dir_lin, dir_win);
+strview_t istr_get_word(instream_t *ctx) {
+    strview_t word = istr_get_view_either(ctx, strv(" \t\v\r\n"));
+    return word;
+}
 
-	usize ext_pos = strv_rfind(path, '.', 0);
+// == OUTPUT STREAM ================================================
 
-	if (dir) {
-		*dir = strv_sub(path, 0, dir_pos);
-	}
-	if (name) {
-		*name = strv_sub(path, dir_pos ? dir_pos + 1 : 0, ext_pos);
-	}
-	if (ext) {
-		*ext = strv_sub(path, ext_pos, SIZE_MAX);
-	}
+outstream_t ostr_init(arena_t *exclusive_arena) {
+    return (outstream_t) {
+        .beg = (char *)(exclusive_arena ? exclusive_arena->cur : NULL),
+        .arena = exclusive_arena,
+    };
 }
 
-bool os_file_putc(oshandle_t handle, char c) {
-	return os_file_write(handle, &c, sizeof(c)) == sizeof(c);
+void ostr_clear(outstream_t *ctx) {
+    arena_pop(ctx->arena, ostr_tell(ctx));
 }
 
-bool os_file_puts(oshandle_t handle, strview_t str) {
-	return os_file_write(handle, str.buf, str.len) == str.len;
+usize ostr_tell(outstream_t *ctx) {
+    return ctx->arena ? (char *)ctx->arena->cur - ctx->beg : 0;
 }
 
-bool os_file_print(arena_t scratch, oshandle_t handle, const char *fmt, ...) {
-	va_list args;
-	va_start(args, fmt);
-	bool result = os_file_printv(scratch, handle, fmt, args);
-	va_end(args);
-	return result;
-}	
-
-bool os_file_printv(arena_t scratch, oshandle_t handle, const char *fmt, va_list args) {
-	str_t s = str_fmtv(&scratch, fmt, args);
-	return os_file_puts(handle, strv(s));
+char ostr_back(outstream_t *ctx) {
+    usize len = ostr_tell(ctx);
+    return len ? ctx->beg[len - 1] : '\0';
 }
 
-usize os_file_read_buf(oshandle_t handle, buffer_t *buf) {
-	return os_file_read(handle, buf->data, buf->len);
+str_t ostr_to_str(outstream_t *ctx) {
+    ostr_putc(ctx, '\0');
+
+    usize len = ostr_tell(ctx);
+
+    str_t out = {
+        .buf = ctx->beg,
+        .len = len ? len - 1 : 0,
+    };
+
+    memset(ctx, 0, sizeof(outstream_t));
+    return out;
 }
 
-usize os_file_write_buf(oshandle_t handle, buffer_t buf) {
-	return os_file_write(handle, buf.data, buf.len);
+strview_t ostr_as_view(outstream_t *ctx) {
+    return strv(ctx->beg, ostr_tell(ctx));
 }
 
-buffer_t os_file_read_all(arena_t *arena, strview_t path) {
-	oshandle_t fp = os_file_open(path, OS_FILE_READ);
-	if (!os_handle_valid(fp)) {
-		err("could not open file: %v", path);
-		return (buffer_t){0};
-	}
-	buffer_t out = os_file_read_all_fp(arena, fp);
-	os_file_close(fp);
-	return out;
+void ostr_rewind(outstream_t *ctx, usize from_beg) {
+    if (!ctx->arena) return;
+    ctx->arena->cur = (u8*)ctx->beg + from_beg;
 }
 
-buffer_t os_file_read_all_fp(arena_t *arena, oshandle_t handle) {
-	if (!os_handle_valid(handle)) return (buffer_t){0};
-	buffer_t out = {0};
-	
-	out.len = os_file_size(handle);
-	out.data = alloc(arena, u8, out.len);
-	usize read = os_file_read_buf(handle, &out);
-	
-	if (read != out.len) {
-		err("os_file_read_all_fp: read failed, should be %zu but is %zu", out.len, read);
-		arena_pop(arena, out.len);
-		return (buffer_t){0};
-	}
-	
-	return out;
+void ostr_pop(outstream_t *ctx, usize count) {
+    if (!ctx->arena) return;
+    arena_pop(ctx->arena, count);
 }
 
-str_t os_file_read_all_str(arena_t *arena, strview_t path) {
-	oshandle_t fp = os_file_open(path, OS_FILE_READ);
-	if (!os_handle_valid(fp)) {
-		err("could not open file %v: %v", path, os_get_error_string(os_get_last_error()));
-		return STR_EMPTY;
-	}
-	str_t out = os_file_read_all_str_fp(arena, fp);
-	os_file_close(fp);
-	return out;
+void ostr_print(outstream_t *ctx, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    ostr_printv(ctx, fmt, args);
+    va_end(args);
 }
 
-str_t os_file_read_all_str_fp(arena_t *arena, oshandle_t handle) {
-	if (!os_handle_valid(handle)) {
-		return STR_EMPTY;	
-	}
-	
-	str_t out = STR_EMPTY;
-	
-	out.len = os_file_size(handle);
-	out.buf = alloc(arena, u8, out.len + 1);
-	
-	usize read = os_file_read(handle, out.buf, out.len);
-	if (read != out.len) {
-		err("os_file_read_all_str_fp: read failed, should be %zu but is %zu", out.len, read);
-		arena_pop(arena, out.len + 1);	
-		return STR_EMPTY;
-	}
-	
-	return out;
+void ostr_printv(outstream_t *ctx, const char *fmt, va_list args) {
+    if (!ctx->arena) return;
+    str_fmtv(ctx->arena, fmt, args);
+    // remove null terminator
+    arena_pop(ctx->arena, 1);
 }
 
-bool os_file_write_all(strview_t name, buffer_t buffer) {
-	oshandle_t fp = os_file_open(name, OS_FILE_WRITE);
-	bool result = os_file_write_all_fp(fp, buffer);
-	os_file_close(fp);
-	return result;
+void ostr_putc(outstream_t *ctx, char c) {
+    if (!ctx->arena) return;
+    char *newc = alloc(ctx->arena, char);
+    *newc = c;
 }
 
-bool os_file_write_all_fp(oshandle_t handle, buffer_t buffer) {
-	return os_file_write(handle, buffer.data, buffer.len) == buffer.len;
+void ostr_puts(outstream_t *ctx, strview_t v) {
+    if (strv_is_empty(v)) return;
+    str(ctx->arena, v);
+    // remove null terminator
+    arena_pop(ctx->arena, 1);
 }
 
-bool os_file_write_all_str(strview_t name, strview_t data) {
-	oshandle_t fp = os_file_open(name, OS_FILE_WRITE);
-	bool result = os_file_write_all_str_fp(fp, data);
-	os_file_close(fp);
-	return result;
+void ostr_append_bool(outstream_t *ctx, bool val) {
+    ostr_puts(ctx, val ? strv("true") : strv("false"));
 }
 
-bool os_file_write_all_str_fp(oshandle_t handle, strview_t data) {
-	return os_file_write(handle, data.buf, data.len) == data.len;
+void ostr_append_uint(outstream_t *ctx, u64 val) {
+    ostr_print(ctx, "%I64u", val);
 }
 
-u64 os_file_time(strview_t path) {
-	oshandle_t fp = os_file_open(path, OS_FILE_READ);
-	u64 result = os_file_time_fp(fp);
-	os_file_close(fp);
-	return result;
+void ostr_append_int(outstream_t *ctx, i64 val) {
+    ostr_print(ctx, "%I64d", val);
 }
 
-bool os_file_has_changed(strview_t path, u64 last_change) {
-	u64 timestamp = os_file_time(path);
-	return timestamp > last_change;
+void ostr_append_num(outstream_t *ctx, double val) {
+    ostr_print(ctx, "%g", val);
 }
 
-// == PROCESS ===================================
+// == INPUT BINARY STREAM ==========================================
 
-bool os_run_cmd(arena_t scratch, os_cmd_t *cmd, os_cmd_options_t *options) {
-	oshandle_t proc = os_run_cmd_async(scratch, cmd, options);
-	return os_handle_valid(proc) ? os_process_wait(proc, OS_WAIT_INFINITE, NULL) : false;
+ibstream_t ibstr_init(buffer_t buffer) {
+    return (ibstream_t){
+        .beg = buffer.data,
+        .cur = buffer.data,
+        .len = buffer.len,
+    };
 }
 
-// == VMEM ======================================
+bool ibstr_is_finished(ibstream_t *ib) {
+    return !(ib && ibstr_remaining(ib) > 0);
+}
 
-usize os_pad_to_page(usize byte_count) {
-	usize page_size = os_get_system_info().page_size;
+usize ibstr_tell(ibstream_t *ib) {
+    return ib && ib->cur ? ib->cur - ib->beg : 0;
+}
 
-    if (byte_count == 0) {
-        return page_size;
-    }
+usize ibstr_remaining(ibstream_t *ib) {
+    return ib ? ib->len - ibstr_tell(ib) : 0;
+}
 
-    usize padding = page_size - (byte_count & (page_size - 1));
-    if (padding == page_size) {
-        padding = 0;
-    }
-    return byte_count + padding;
+usize ibstr_read(ibstream_t *ib, void *buffer, usize len) {
+    usize rem = ibstr_remaining(ib);
+    if (len > rem) len = rem;
+    memmove(buffer, ib->cur, len);
+    ib->cur += len;
+    return len;
 }
 
-// == THREAD ====================================
+void ibstr_skip(ibstream_t *ib, usize count) {
+    usize rem = ibstr_remaining(ib);
+    if (count > rem) count = rem;
+    ib->cur += count;
+}
 
-void os_barrier_sync(os_barrier_t *b) {
-    atomic_inc_i64(&b->thread_value);
+bool ibstr_get_u8(ibstream_t *ib, u8 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-    while (true) {
-        if (atomic_cmp_i64(&b->has_completed, 1, 1)) {
-            break;
-        }
-        i64 completed = 
-            atomic_cmp_i64(
-                &b->thread_value, 
-                b->thread_count, 
-                b->thread_count
-            ) == b->thread_count;
-        if (completed) {
-            atomic_set_i64(&b->has_completed, completed);
-            break;
-        }
-    }
+bool ibstr_get_u16(ibstream_t *ib, u16 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-    if (atomic_dec_i64(&b->thread_value) == 0) {
-        b->has_completed = 0;
-    }
+bool ibstr_get_u32(ibstream_t *ib, u32 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
 }
 
-i64range_t os_lane_range(u64 values_count) {
-    i64 thread_id = os_thread_id;
-    i64 thread_count = os_thread_count;
+bool ibstr_get_u64(ibstream_t *ib, u64 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-    i64 values_per_thread = values_count / thread_count;
-    i64 leftover_values_count = values_count % thread_count;
-    bool thread_has_leftover = thread_id < leftover_values_count;
-    i64 leftover_before_this_thread_id = thread_has_leftover ?
-        thread_id : leftover_values_count;
-    i64 thread_first_value = 
-        values_per_thread * thread_id + leftover_before_this_thread_id;
-    i64 thread_last_value =
-        thread_first_value + values_per_thread + thread_has_leftover;
+bool ibstr_get_i8(ibstream_t *ib, i8 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-    return (i64range_t){ thread_first_value, thread_last_value };
+bool ibstr_get_i16(ibstream_t *ib, i16 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
 }
 
-#if !COLLA_NO_CONDITION_VARIABLE
+bool ibstr_get_i32(ibstream_t *ib, i32 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-// == JOB QUEUE =================================
-
-int jq__worker_function(u64 thread_id, void *udata) {
-    COLLA_UNUSED(thread_id);
-    job_queue_t *q = udata;
+bool ibstr_get_i64(ibstream_t *ib, i64 *out) {
+    return ibstr_read(ib, out, sizeof(*out)) == sizeof(*out);
+}
 
-    // TODO: is this safe to not have an atomic variable?
-    while (!q->should_stop) {
-        job_t *job = jq_pop_job(q);
-        if (!job) {
-            if (q->stop_when_finished) {
-                break;
-            }
-            continue;
-        }
-        job->func(job->userdata);
-        os_mutex_lock(q->mutex);
-            list_push(q->freelist, job);
-        os_mutex_unlock(q->mutex);
-    }
+// == REGEX ========================================================
 
-    return 0;
-}
+// the pattern is parsed into a tree, which is compiled to a thompson nfa.
+// the nfa is then run as a dfa that is built lazily while matching, each
+// dfa state is the set of nfa instructions that are alive at that point.
+// when the cache is full it is thrown away and rebuilt, so matching is 
+// always linear in the length of the text
 
-job_queue_t *jq_init(arena_t *arena, int worker_count) {
-    job_queue_t *q = alloc(arena, job_queue_t);
-    q->mutex = os_mutex_create();
-    q->condvar = os_cond_create();
-    q->thread_count = worker_count ? worker_count : os_get_system_info().processor_count;
-    q->threads = alloc(arena, oshandle_t, q->thread_count);
+typedef struct rg__set_t rg__set_t;
+struct rg__set_t {
+    u64 bits[4];
+};
 
-    for (int i = 0; i < q->thread_count; ++i) {
-        q->threads[i] = os_thread_launch(jq__worker_function, q);
-    }
+typedef enum {
+    RG__NODE_EMPTY,
+    RG__NODE_SET,
+    RG__NODE_CAT,
+    RG__NODE_ALT,
+    RG__NODE_REPEAT,
+    RG__NODE_BOL,
+    RG__NODE_EOL,
+} rg__node_type_e;
+
+typedef struct rg__node_t rg__node_t;
+struct rg__node_t {
+    rg__node_type_e type;
+    rg__node_t *left;
+    rg__node_t *right;
+    i32 set;
+    // -1 if unbounded
+    i32 min, max;
+};
 
-    return q;
-}
+typedef enum {
+    RG__OP_SET,
+    RG__OP_SPLIT,
+    RG__OP_JMP,
+    RG__OP_BOL,
+    RG__OP_EOL,
+    RG__OP_MATCH,
+} rg__op_e;
+
+typedef struct rg__inst_t rg__inst_t;
+struct rg__inst_t {
+    rg__op_e op;
+    // set index for RG__OP_SET, jump target otherwise
+    i32 x;
+    i32 y;
+};
 
-void jq_stop(job_queue_t *queue) {
-    os_mutex_lock(queue->mutex);
-        job_t *remaining = queue->jobs;
-        list_push(queue->freelist, remaining);
-        queue->jobs = NULL;
-        queue->should_stop = true;
-        os_cond_broadcast(queue->condvar);
-    os_mutex_unlock(queue->mutex);
+struct rg_t {
+    rg__inst_t *insts;
+    i32 inst_count;
+    rg__set_t *sets;
+    // a literal every match has to contain, checked before running the dfa
+    bool has_prefilter;
+    searcher_t prefilter;
+};
 
-    for (int i = 0; i < queue->thread_count; ++i) {
-        os_thread_join(queue->threads[i], NULL);
-    }
+typedef struct rg__state_t rg__state_t;
+struct rg__state_t {
+    i32 *list;
+    i32 count;
+    u32 hash;
+    bool is_match;
+    bool match_at_end;
+};
 
-    os_mutex_free(queue->mutex);
-    os_cond_free(queue->condvar);
-}
+#define RG__DEAD    0
+#define RG__START   1
+#define RG__UNKNOWN -1
+
+struct rg_cache_t {
+    const rg_t *rg;
+
+    rg__state_t *states;
+    i32 state_count;
+    // COLLA_RG_DFA_MAX_STATES * 256 transitions
+    i32 *trans;
+    i32 *table;
+    u32 table_mask;
+    i32 *pool;
+    usize pool_used;
+    usize pool_cap;
+
+    // scratch used to build the states
+    i32 *sparse;
+    i32 *dense;
+    i32 dense_count;
+    i32 *stack;
+    i32 *list;
+    i32 *start_list;
+    i32 start_count;
+    // an empty text is at the beginning and at the end at the same time,
+    // which no state knows about
+    bool empty_match;
+};
 
-void jq_cleanup(job_queue_t *queue) {
-    os_mutex_lock(queue->mutex);
-        queue->stop_when_finished = true;
-        os_cond_broadcast(queue->condvar);
-    os_mutex_unlock(queue->mutex);
+// == parser ==
+
+typedef struct rg__parser_t rg__parser_t;
+struct rg__parser_t {
+    arena_t *arena;
+    instream_t in;
+    rg_flags_e flags;
+    rg__set_t *sets;
+    i32 set_count;
+    i32 node_count;
+    const char *error;
+};
 
-    for (int i = 0; i < queue->thread_count; ++i) {
-        os_thread_join(queue->threads[i], NULL);
-    }
+static rg__node_t *rg__parse_alt(rg__parser_t *p);
 
-    os_mutex_free(queue->mutex);
-    os_cond_free(queue->condvar);
+static void rg__set_add(rg__set_t *set, u8 c) {
+    set->bits[c >> 6] |= 1ull << (c & 63);
 }
 
-void jq_push(arena_t *arena, job_queue_t *queue, job_func_f *func, void *userdata) {
-    os_mutex_lock(queue->mutex);
-        job_t *job = queue->freelist;
-        list_pop(queue->freelist);
-        if (!job) {
-            job = alloc(arena, job_t);
-        }
-        job->func = func;
-        job->userdata = userdata;
-        list_push(queue->jobs, job);
-        os_cond_broadcast(queue->condvar);
-    os_mutex_unlock(queue->mutex);
+static bool rg__set_has(const rg__set_t *set, u8 c) {
+    return (set->bits[c >> 6] >> (c & 63)) & 1;
 }
 
-job_t *jq_pop_job(job_queue_t *queue) {
-    job_t *job = NULL;
-    os_mutex_lock(queue->mutex);
-        while (!queue->jobs && !queue->should_stop && !queue->stop_when_finished) {
-            os_cond_wait(queue->condvar, queue->mutex, OS_WAIT_INFINITE);
+static void rg__set_add_range(rg__parser_t *p, rg__set_t *set, u8 from, u8 to) {
+    bool ignore_case = p->flags & RG_IGNORE_CASE;
+    for (u32 c = from; c <= to; ++c) {
+        rg__set_add(set, (u8)c);
+        if (ignore_case && char_is_alpha((char)c)) {
+            rg__set_add(set, (u8)(char_lower((char)c)));
+            rg__set_add(set, (u8)(char_upper((char)c)));
         }
-        job = queue->jobs ;
-        list_pop(queue->jobs);
-    os_mutex_unlock(queue->mutex);
-    return job;
+    }
 }
 
-#endif
-
-// == INI ============================================
-
-void ini__parse(arena_t *arena, ini_t *ini, const iniopt_t *options);
-
-ini_t ini_parse(arena_t *arena, strview_t filename, iniopt_t *opt) {
-    oshandle_t fp = os_file_open(filename, OS_FILE_READ);
-    ini_t out = ini_parse_fp(arena, fp, opt);
-    os_file_close(fp);
-    return out;
+static void rg__set_invert(rg__set_t *set) {
+    for (int i = 0; i < 4; ++i) {
+        set->bits[i] = ~set->bits[i];
+    }
 }
 
-ini_t ini_parse_fp(arena_t *arena, oshandle_t file, iniopt_t *opt) {
-    str_t data = os_file_read_all_str_fp(arena, file);
-    return ini_parse_str(arena, strv(data), opt);
+static rg__node_t *rg__node(rg__parser_t *p, rg__node_type_e type) {
+    rg__node_t *node = alloc(p->arena, rg__node_t);
+    node->type = type;
+    p->node_count++;
+    return node;
 }
 
-ini_t ini_parse_str(arena_t *arena, strview_t str, iniopt_t *opt) {
-    ini_t out = {
-        .text = str,
-        .tables = NULL,
-    };
-    ini__parse(arena, &out, opt);
-    return out;
+static rg__node_t *rg__node_set(rg__parser_t *p, rg__set_t **set) {
+    rg__node_t *node = rg__node(p, RG__NODE_SET);
+    node->set = p->set_count++;
+    *set = &p->sets[node->set];
+    return node;
 }
 
-bool ini_is_valid(ini_t *ini) {
-    return ini && !strv_is_empty(ini->text);
+static char rg__unescape(char c) {
+    switch (c) {
+        case 'n': return '\n';
+        case 't': return '\t';
+        case 'r': return '\r';
+        case 'f': return '\f';
+        case 'v': return '\v';
+        case '0': return '\0';
+        default:  return c;
+    }
 }
 
-initable_t *ini_get_table(ini_t *ini, strview_t name) {
-    initable_t *t = ini ? ini->tables : NULL;
-    while (t) {
-        if (strv_equals(t->name, name)) {
-            return t;
-        }
-        t = t->next;
+// \d \w \s and their negated versions, returns false for anything else
+static bool rg__parse_class_escape(char c, rg__set_t *set) {
+    rg__set_t class = {0};
+
+    switch (c) {
+        case 'd': case 'D':
+            for (u8 i = '0'; i <= '9'; ++i) rg__set_add(&class, i);
+            break;
+        case 'w': case 'W':
+            for (u8 i = 'a'; i <= 'z'; ++i) rg__set_add(&class, i);
+            for (u8 i = 'A'; i <= 'Z'; ++i) rg__set_add(&class, i);
+            for (u8 i = '0'; i <= '9'; ++i) rg__set_add(&class, i);
+            rg__set_add(&class, '_');
+            break;
+        case 's': case 'S':
+            for (const char *s = " \t\n\r\v\f"; *s; ++s) rg__set_add(&class, *s);
+            break;
+        default:
+            return false;
     }
-    return NULL;
-}
 
-inivalue_t *ini_get(initable_t *table, strview_t key) {
-    inivalue_t *v = table ? table->values : NULL;
-    while (v) {
-        if (strv_equals(v->key, key)) {
-            return v;
-        }
-        v = v->next;
+    // the uppercase versions match everything else
+    if (c == 'D' || c == 'W' || c == 'S') {
+        rg__set_invert(&class);
     }
-    return NULL;
+
+    for (int i = 0; i < 4; ++i) {
+        set->bits[i] |= class.bits[i];
+    }
+
+    return true;
 }
 
-iniarray_t ini_as_arr(arena_t *arena, inivalue_t *value, char delim) {
-    strview_t v = value ? value->value : STRV_EMPTY;
-    if (!delim) delim = ' ';
+static rg__node_t *rg__parse_class(rg__parser_t *p) {
+    rg__set_t *set = NULL;
+    rg__node_t *node = rg__node_set(p, &set);
 
-    strview_t *beg = (strview_t *)arena->cur;
-    usize count = 0;
+    bool negate = istr_peek(&p->in) == '^';
+    if (negate) istr_skip(&p->in, 1);
 
-    usize start = 0;
-    for (usize i = 0; i < v.len; ++i) {
-        if (v.buf[i] == delim) {
-            strview_t arrval = strv_trim(strv_sub(v, start, i));
-            if (!strv_is_empty(arrval)) {
-                strview_t *newval = alloc(arena, strview_t);
-                *newval = arrval;
-                ++count;
+    bool first = true;
+    bool closed = false;
+
+    while (!istr_is_finished(&p->in)) {
+        char c = istr_get(&p->in);
+        // a ] right at the start is just a character
+        if (c == ']' && !first) {
+            closed = true;
+            break;
+        }
+        first = false;
+
+        if (c == '\\') {
+            c = istr_get(&p->in);
+            if (rg__parse_class_escape(c, set)) {
+                continue;
             }
-            start = i + 1;
+            c = rg__unescape(c);
         }
-    }
 
-    strview_t last = strv_trim(strv_sub(v, start, SIZE_MAX));
-    if (!strv_is_empty(last)) {
-        strview_t *newval = alloc(arena, strview_t);
-        *newval = last;
-        ++count;
-    }
+        char to = c;
+        if (istr_peek(&p->in) == '-' && 
+            istr_peek_next(&p->in) != ']' && 
+            istr_remaining(&p->in) > 1
+        ) {
+            istr_skip(&p->in, 1);
+            to = istr_get(&p->in);
+            if (to == '\\') {
+                to = rg__unescape(istr_get(&p->in));
+            }
+            if ((u8)to < (u8)c) {
+                p->error = "invalid range in character class";
+                return NULL;
+            }
+        }
 
-    return (iniarray_t){
-        .values = beg,
-        .count = count,
-    };
-}
+        rg__set_add_range(p, set, (u8)c, (u8)to);
+    }
 
-u64 ini_as_uint(inivalue_t *value) {
-    strview_t v = value ? value->value : STRV_EMPTY;
-    instream_t in = istr_init(v);
-    u64 out = 0;
-    if (!istr_get_u64(&in, &out)) {
-        out = 0;
+    if (!closed) {
+        p->error = "missing ]";
+        return NULL;
     }
-    return out;
-}
 
-i64 ini_as_int(inivalue_t *value) {
-    strview_t v = value ? value->value : STRV_EMPTY;
-    instream_t in = istr_init(v);
-    i64 out = 0;
-    if (!istr_get_i64(&in, &out)) {
-        out = 0;
+    if (negate) {
+        rg__set_invert(set);
     }
-    return out;
+
+    return node;
 }
 
-double ini_as_num(inivalue_t *value) {
-    strview_t v = value ? value->value : STRV_EMPTY;
-    instream_t in = istr_init(v);
-    double out = 0;
-    if (!istr_get_num(&in, &out)) {
-        out = 0;
+static rg__node_t *rg__parse_atom(rg__parser_t *p) {
+    char c = istr_get(&p->in);
+    rg__set_t *set = NULL;
+
+    switch (c) {
+        case '(':
+        {
+            // non capturing groups are the same thing for us
+            if (istr_peek(&p->in) == '?' && istr_peek_next(&p->in) == ':') {
+                istr_skip(&p->in, 2);
+            }
+            rg__node_t *node = rg__parse_alt(p);
+            if (p->error) return NULL;
+            if (istr_get(&p->in) != ')') {
+                p->error = "missing )";
+                return NULL;
+            }
+            return node;
+        }
+        case '[':
+            return rg__parse_class(p);
+        case '.':
+        {
+            rg__node_t *node = rg__node_set(p, &set);
+            rg__set_add(set, '\n');
+            rg__set_invert(set);
+            return node;
+        }
+        case '^':
+            return rg__node(p, RG__NODE_BOL);
+        case '$':
+            return rg__node(p, RG__NODE_EOL);
+        case '*': case '+': case '?':
+            p->error = "nothing to repeat";
+            return NULL;
+        case '\\':
+        {
+            if (istr_is_finished(&p->in)) {
+                p->error = "trailing \\";
+                return NULL;
+            }
+            rg__node_t *node = rg__node_set(p, &set);
+            c = istr_get(&p->in);
+            if (!rg__parse_class_escape(c, set)) {
+                c = rg__unescape(c);
+                rg__set_add_range(p, set, (u8)c, (u8)c);
+            }
+            return node;
+        }
+        default:
+        {
+            rg__node_t *node = rg__node_set(p, &set);
+            rg__set_add_range(p, set, (u8)c, (u8)c);
+            return node;
+        }
     }
-    return out;
 }
 
-bool ini_as_bool(inivalue_t *value) {
-    strview_t v = value ? value->value : STRV_EMPTY;
-    instream_t in = istr_init(v);
-    bool out = 0;
-    if (!istr_get_bool(&in, &out)) {
-        out = 0;
+// parses {n}, {n,} and {n,m}, if it's anything else the { is a literal
+static bool rg__parse_bounds(rg__parser_t *p, i32 *min, i32 *max) {
+    instream_t backup = p->in;
+    istr_skip(&p->in, 1);
+
+    u32 n = 0;
+    if (!char_is_num(istr_peek(&p->in)) || !istr_get_u32(&p->in, &n)) {
+        p->in = backup;
+        return false;
     }
-    return out;
-}
+    *min = (i32)n;
+    *max = (i32)n;
 
-void ini_pretty_print(ini_t *ini, const ini_pretty_opts_t *options) {
-    ini_pretty_opts_t opt = {0};
-    if (options) {
-        memmove(&opt, options, sizeof(ini_pretty_opts_t));
+    if (istr_peek(&p->in) == ',') {
+        istr_skip(&p->in, 1);
+        *max = -1;
+        if (char_is_num(istr_peek(&p->in))) {
+            u32 m = 0;
+            istr_get_u32(&p->in, &m);
+            *max = (i32)m;
+        }
     }
 
-    if (!os_handle_valid(opt.custom_target)) {
-        opt.custom_target = os_stdout();
+    if (istr_get(&p->in) != '}') {
+        p->in = backup;
+        return false;
     }
 
-    if (!opt.use_custom_colours) {
-        os_log_colour_e default_col[INI_PRETTY_COLOUR__COUNT] = {
-            LOG_COL_YELLOW, // INI_PRETTY_COLOUR_KEY,
-            LOG_COL_GREEN,  // INI_PRETTY_COLOUR_VALUE,
-            LOG_COL_WHITE,  // INI_PRETTY_COLOUR_DIVIDER,
-            LOG_COL_RED,    // INI_PRETTY_COLOUR_TABLE,
-        };
-        memmove(opt.colours, default_col, sizeof(default_col));
+    if (n > COLLA_RG_MAX_REPEAT || *max > COLLA_RG_MAX_REPEAT) {
+        p->error = "repeat count too big";
+    }
+    else if (*max >= 0 && *max < *min) {
+        p->error = "invalid repeat range";
     }
 
-    for_each (t, ini->tables) {
-        if (!strv_equals(t->name, INI_ROOT)) {
-            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_TABLE]);
-            os_file_puts(opt.custom_target, strv("["));
-            os_file_puts(opt.custom_target, t->name);
-            os_file_puts(opt.custom_target, strv("]\n"));
-        }
+    return true;
+}
 
-        for_each (pair, t->values) {
-            if (strv_is_empty(pair->key) || strv_is_empty(pair->value)) continue;
-            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_KEY]);
-            os_file_puts(opt.custom_target, pair->key);
+static rg__node_t *rg__parse_repeat(rg__parser_t *p) {
+    rg__node_t *node = rg__parse_atom(p);
 
-            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_DIVIDER]);
-            os_file_puts(opt.custom_target, strv(" = "));
+    while (!p->error && !istr_is_finished(&p->in)) {
+        i32 min = 0, max = -1;
+        char c = istr_peek(&p->in);
 
-            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_VALUE]);
-            os_file_puts(opt.custom_target, pair->value);
-            
-            os_file_puts(opt.custom_target, strv("\n"));
+        if (c == '*') {
+            istr_skip(&p->in, 1);
+        }
+        else if (c == '+') {
+            istr_skip(&p->in, 1);
+            min = 1;
+        }
+        else if (c == '?') {
+            istr_skip(&p->in, 1);
+            max = 1;
         }
+        else if (c != '{' || !rg__parse_bounds(p, &min, &max)) {
+            break;
+        }
+
+        // lazy quantifiers match the same strings
+        if (istr_peek(&p->in) == '?') {
+            istr_skip(&p->in, 1);
+        }
+
+        rg__node_t *repeat = rg__node(p, RG__NODE_REPEAT);
+        repeat->left = node;
+        repeat->min = min;
+        repeat->max = max;
+        node = repeat;
     }
 
-    os_log_set_colour(LOG_COL_RESET);
+    return p->error ? NULL : node;
 }
 
-///// ini-private ////////////////////////////////////
-
-iniopt_t ini__get_options(const iniopt_t *options) {
-    iniopt_t out = {
-        .key_value_divider = '=',
-        .comment_vals = strv(";#"),
-    };
+static rg__node_t *rg__parse_cat(rg__parser_t *p) {
+    rg__node_t *node = rg__node(p, RG__NODE_EMPTY);
 
-#define SETOPT(v) out.v = options->v ? options->v : out.v
+    while (!p->error && !istr_is_finished(&p->in)) {
+        char c = istr_peek(&p->in);
+        if (c == '|' || c == ')') {
+            break;
+        }
 
-    if (options) {
-        SETOPT(key_value_divider);
-        SETOPT(merge_duplicate_keys);
-        SETOPT(merge_duplicate_tables);
-        out.comment_vals = strv_is_empty(options->comment_vals) ? out.comment_vals : options->comment_vals;
-    }
+        rg__node_t *next = rg__parse_repeat(p);
+        if (!next) {
+            return NULL;
+        }
 
-#undef SETOPT
+        if (node->type == RG__NODE_EMPTY) {
+            node = next;
+        }
+        else {
+            rg__node_t *cat = rg__node(p, RG__NODE_CAT);
+            cat->left = node;
+            cat->right = next;
+            node = cat;
+        }
+    }
 
-    return out;
+    return p->error ? NULL : node;
 }
 
-void ini__add_value(arena_t *arena, initable_t *table, instream_t *in, iniopt_t *opts) {
-    colla_assert(table);
+static rg__node_t *rg__parse_alt(rg__parser_t *p) {
+    rg__node_t *node = rg__parse_cat(p);
 
-    strview_t key = strv_trim(istr_get_view(in, opts->key_value_divider));
-    istr_skip(in, 1);
+    while (!p->error && istr_peek(&p->in) == '|') {
+        istr_skip(&p->in, 1);
+        rg__node_t *alt = rg__node(p, RG__NODE_ALT);
+        alt->left = node;
+        alt->right = rg__parse_cat(p);
+        node = alt;
+    }
 
-    strview_t value = strv_trim(istr_get_view(in, '\n'));
-    usize comment_pos = strv_find_either(value, opts->comment_vals, 0);
-    if (comment_pos != STR_NONE) {
-        value = strv_sub(value, 0, comment_pos);
+    return p->error ? NULL : node;
+}
+
+// == compiler ==
+
+// stops counting past COLLA_RG_MAX_INSTS, nested repeats like ((a{1000}){1000}){1000}
+// would overflow otherwise
+static i64 rg__node_size(rg__node_t *node) {
+    const i64 limit = (i64)COLLA_RG_MAX_INSTS + 1;
+    i64 size = 0;
+
+    switch (node->type) {
+        case RG__NODE_EMPTY:  
+            return 0;
+        case RG__NODE_SET:
+        case RG__NODE_BOL:
+        case RG__NODE_EOL:    
+            return 1;
+        case RG__NODE_CAT:    
+            return MIN(rg__node_size(node->left) + rg__node_size(node->right), limit);
+        case RG__NODE_ALT:    
+            return MIN(rg__node_size(node->left) + rg__node_size(node->right) + 2, limit);
+        case RG__NODE_REPEAT:
+        {
+            size = rg__node_size(node->left);
+            // both cases below are at most (size + 1) * reps + 2
+            i64 reps = node->max < 0 ? node->min + 1 : node->max;
+            if (reps > 0 && (size + 1) > limit / reps) {
+                return limit;
+            }
+            if (node->max < 0) {
+                size = size * node->min + size + 2;
+            }
+            else {
+                size = size * node->min + (size + 1) * (node->max - node->min);
+            }
+            return MIN(size, limit);
+        }
     }
-    istr_skip(in, 1);
-    inivalue_t *newval = NULL;
-    
-    if (opts->merge_duplicate_keys) {
-        newval = table->values;
-        while (newval) {
-            if (strv_equals(newval->key, key)) {
+
+    return size;
+}
+
+typedef struct rg__emitter_t rg__emitter_t;
+struct rg__emitter_t {
+    rg__inst_t *insts;
+    i32 count;
+};
+
+static i32 rg__emit_inst(rg__emitter_t *e, rg__op_e op, i32 x) {
+    e->insts[e->count] = (rg__inst_t){ .op = op, .x = x };
+    return e->count++;
+}
+
+static void rg__emit(rg__emitter_t *e, rg__node_t *node) {
+    switch (node->type) {
+        case RG__NODE_EMPTY:
+            break;
+        case RG__NODE_SET:
+            rg__emit_inst(e, RG__OP_SET, node->set);
+            break;
+        case RG__NODE_BOL:
+            rg__emit_inst(e, RG__OP_BOL, 0);
+            break;
+        case RG__NODE_EOL:
+            rg__emit_inst(e, RG__OP_EOL, 0);
+            break;
+        case RG__NODE_CAT:
+            rg__emit(e, node->left);
+            rg__emit(e, node->right);
+            break;
+        case RG__NODE_ALT:
+        {
+            i32 split = rg__emit_inst(e, RG__OP_SPLIT, e->count + 1);
+            rg__emit(e, node->left);
+            i32 jmp = rg__emit_inst(e, RG__OP_JMP, 0);
+            e->insts[split].y = e->count;
+            rg__emit(e, node->right);
+            e->insts[jmp].x = e->count;
+            break;
+        }
+        case RG__NODE_REPEAT:
+        {
+            for (i32 i = 0; i < node->min; ++i) {
+                rg__emit(e, node->left);
+            }
+
+            if (node->max < 0) {
+                i32 loop = rg__emit_inst(e, RG__OP_SPLIT, e->count + 1);
+                rg__emit(e, node->left);
+                rg__emit_inst(e, RG__OP_JMP, loop);
+                e->insts[loop].y = e->count;
                 break;
             }
-            newval = newval->next;
+
+            // every optional copy can skip to the end, chain the 
+            // splits through y and patch them once we know where it is
+            i32 chain = -1;
+            for (i32 i = node->min; i < node->max; ++i) {
+                i32 split = rg__emit_inst(e, RG__OP_SPLIT, e->count + 1);
+                e->insts[split].y = chain;
+                chain = split;
+                rg__emit(e, node->left);
+            }
+            while (chain >= 0) {
+                i32 next = e->insts[chain].y;
+                e->insts[chain].y = e->count;
+                chain = next;
+            }
+            break;
         }
     }
+}
 
-    if (newval) {
-        newval->value = value;
+static void rg__flatten_cat(rg__node_t *node, rg__node_t **out, i32 *count) {
+    if (node->type == RG__NODE_CAT) {
+        rg__flatten_cat(node->left, out, count);
+        rg__flatten_cat(node->right, out, count);
     }
     else {
-        newval = alloc(arena, inivalue_t);
-        newval->key = key;
-        newval->value = value;
-
-        if (!table->values) {
-            table->values = newval;
+        out[(*count)++] = node;
+    }
+}
+
+// returns the byte if the set only contains one
+static bool rg__set_single(const rg__set_t *set, u8 *byte) {
+    i32 found = 0;
+    for (int i = 0; i < 4; ++i) {
+        if (!set->bits[i]) continue;
+        found += scan__popcount64(set->bits[i]);
+        *byte = (u8)(i * 64 + scan__ctz64(set->bits[i]));
+    }
+    return found == 1;
+}
+
+// the longest run of single bytes in the top level sequence, every 
+// match must contain it. with ignore case letters are not single bytes 
+// anymore, so they naturally stop the run
+static strview_t rg__required_literal(arena_t *arena, rg__parser_t *p, rg__node_t *root) {
+    rg__node_t **nodes = alloc(arena, rg__node_t *, p->node_count);
+    i32 count = 0;
+    rg__flatten_cat(root, nodes, &count);
+
+    char *run = alloc(arena, char, count);
+    i32 best_beg = 0, best_len = 0;
+    i32 cur_beg = 0, cur_len = 0;
+
+    for (i32 i = 0; i < count; ++i) {
+        u8 byte = 0;
+        if (nodes[i]->type == RG__NODE_SET && rg__set_single(&p->sets[nodes[i]->set], &byte)) {
+            if (cur_len == 0) cur_beg = i;
+            run[i] = (char)byte;
+            cur_len++;
+            if (cur_len > best_len) {
+                best_beg = cur_beg;
+                best_len = cur_len;
+            }
         }
         else {
-            table->tail->next = newval;
+            cur_len = 0;
         }
-
-        table->tail = newval;
     }
+
+    return strv(run + best_beg, best_len);
 }
 
-void ini__add_table(arena_t *arena, ini_t *ctx, instream_t *in, iniopt_t *options) {
-    istr_skip(in, 1); // skip [
-    strview_t name = istr_get_view(in, ']');
-    istr_skip(in, 1); // skip ]
-    initable_t *table = NULL;
+rg_t *rg_compile(arena_t *arena, strview_t pattern, rg_flags_e flags) {
+    rg__parser_t p = {
+        .arena = arena,
+        .in = istr_init(pattern),
+        .flags = flags,
+        // every atom is at least one character, plus the any set for the search loop
+        .sets = alloc(arena, rg__set_t, pattern.len + 1),
+    };
 
-    if (options->merge_duplicate_tables) {
-        table = ctx->tables;
-        while (table) {
-            if (strv_equals(table->name, name)) {
-                break;
-            }
-            table = table->next;
-        }
+    usize arena_start = arena_tell(arena);
+
+    rg__node_t *root = rg__parse_alt(&p);
+    if (!p.error && !istr_is_finished(&p.in)) {
+        p.error = "unmatched )";
+    }
+    if (p.error) {
+        err("invalid regex %v: %s", pattern, p.error);
+        arena_rewind(arena, arena_start);
+        return NULL;
     }
 
-    if (!table) {
-        table = alloc(arena, initable_t);
+    i64 size = rg__node_size(root);
+    // + search loop (3) + match
+    if ((size + 4) > COLLA_RG_MAX_INSTS) {
+        err("regex %v is too big", pattern);
+        arena_rewind(arena, arena_start);
+        return NULL;
+    }
 
-        table->name = name;
+    rg_t *rg = alloc(arena, rg_t);
+    rg->sets = p.sets;
 
-        if (!ctx->tables) {
-            ctx->tables = table;
-        }
-        else {
-            ctx->tail->next = table;
-        }
+    rg__emitter_t e = {
+        .insts = alloc(arena, rg__inst_t, size + 4),
+    };
 
-        ctx->tail = table;
+    // unless the pattern starts with ^ we look for a match anywhere, 
+    // which is the same as starting with an implicit .*
+    rg__node_t *first = root;
+    while (first->type == RG__NODE_CAT) {
+        first = first->left;
     }
 
-    istr_ignore_and_skip(in, '\n');
-    while (!istr_is_finished(in)) {
-        switch (istr_peek(in)) {
-            case '\n': // fallthrough
-            case '\r':
-                return;
-            case '#':  // fallthrough
-            case ';':
-                istr_ignore_and_skip(in, '\n');
-                break;
-            default:
-                ini__add_value(arena, table, in, options);
-                break;
-        }
+    if (first->type != RG__NODE_BOL) {
+        i32 any = p.set_count++;
+        rg__set_invert(&rg->sets[any]);
+        // 0: split 3, 1
+        // 1: any
+        // 2: jmp 0
+        rg__emit_inst(&e, RG__OP_SPLIT, 3);
+        e.insts[0].y = 1;
+        rg__emit_inst(&e, RG__OP_SET, any);
+        rg__emit_inst(&e, RG__OP_JMP, 0);
+    }
+
+    rg__emit(&e, root);
+    rg__emit_inst(&e, RG__OP_MATCH, 0);
+
+    rg->insts = e.insts;
+    rg->inst_count = e.count;
+
+    strview_t literal = rg__required_literal(arena, &p, root);
+    if (literal.len) {
+        rg->has_prefilter = true;
+        rg->prefilter = searcher_init(literal);
     }
+
+    return rg;
 }
 
-void ini__parse(arena_t *arena, ini_t *ini, const iniopt_t *options) {
-    iniopt_t opts = ini__get_options(options);
+// == dfa ==
 
-    initable_t *root = alloc(arena, initable_t);
-    root->name = INI_ROOT;
-    ini->tables = root;
-    ini->tail = root;
+static void rg__sparse_clear(rg_cache_t *c) {
+    c->dense_count = 0;
+}
 
-    instream_t in = istr_init(ini->text);
+static bool rg__sparse_has(rg_cache_t *c, i32 pc) {
+    i32 index = c->sparse[pc];
+    return index < c->dense_count && c->dense[index] == pc;
+}
 
-    while (!istr_is_finished(&in)) {
-        istr_skip_whitespace(&in);
-        switch (istr_peek(&in)) {
-            case '[':
-                ini__add_table(arena, ini, &in, &opts);
+static void rg__sparse_add(rg_cache_t *c, i32 pc) {
+    c->sparse[pc] = c->dense_count;
+    c->dense[c->dense_count++] = pc;
+}
+
+// follows every jump from pc, adding all the instructions reached
+static void rg__closure(rg_cache_t *c, i32 pc, bool at_begin) {
+    const rg__inst_t *insts = c->rg->insts;
+    i32 top = 0;
+    c->stack[top++] = pc;
+
+    while (top > 0) {
+        pc = c->stack[--top];
+        if (rg__sparse_has(c, pc)) {
+            continue;
+        }
+        rg__sparse_add(c, pc);
+
+        const rg__inst_t *inst = &insts[pc];
+        switch (inst->op) {
+            case RG__OP_JMP:
+                c->stack[top++] = inst->x;
                 break;
-            case '#': // fallthrough
-            case ';':
-                istr_ignore_and_skip(&in, '\n');
+            case RG__OP_SPLIT:
+                c->stack[top++] = inst->y;
+                c->stack[top++] = inst->x;
+                break;
+            case RG__OP_BOL:
+                if (at_begin) c->stack[top++] = pc + 1;
                 break;
+            // $ is only checked once we reach the end of the text
             default:
-                ini__add_value(arena, ini->tables, &in, &opts);
                 break;
         }
     }
 }
 
-// == JSON ===========================================
+// whether reaching the end of the text from pc ends up in a match
+static bool rg__matches_at_end(rg_cache_t *c, i32 pc, bool at_begin) {
+    const rg__inst_t *insts = c->rg->insts;
+    rg__sparse_clear(c);
+    i32 top = 0;
+    c->stack[top++] = pc;
 
-bool json__parse_obj(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out);
-bool json__parse_value(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out);
+    while (top > 0) {
+        pc = c->stack[--top];
+        if (rg__sparse_has(c, pc)) {
+            continue;
+        }
+        rg__sparse_add(c, pc);
+
+        const rg__inst_t *inst = &insts[pc];
+        switch (inst->op) {
+            case RG__OP_MATCH: 
+                return true;
+            case RG__OP_JMP:   
+                c->stack[top++] = inst->x; 
+                break;
+            case RG__OP_SPLIT:
+                c->stack[top++] = inst->y;
+                c->stack[top++] = inst->x;
+                break;
+            case RG__OP_EOL:
+                c->stack[top++] = pc + 1;
+                break;
+            case RG__OP_BOL:
+                if (at_begin) c->stack[top++] = pc + 1;
+                break;
+            default:
+                break;
+        }
+    }
 
-json_t *json_parse(arena_t *arena, strview_t filename, jsonflags_e flags) {
-    str_t data = os_file_read_all_str(arena, filename);
-    return json_parse_str(arena, strv(data), flags);
+    return false;
 }
 
-json_t *json_parse_str(arena_t *arena, strview_t str, jsonflags_e flags) {
-    arena_t before = *arena;
-
-    json_t *root = alloc(arena, json_t);
-    root->type = JSON_OBJECT;
-
-    instream_t in = istr_init(str);
+static int rg__compare_pc(const void *a, const void *b) {
+    return *(const i32 *)a - *(const i32 *)b;
+}
 
-    if (flags & JSON_ONLY_OBJECT_START) {
-        if (!json__parse_obj(arena, &in, flags, &root->object)) {
-            // reset arena
-            *arena = before;
-            return NULL;
-        }
-    }
-    else {
-        if (!json__parse_value(arena, &in, flags, &root)) {
-            *arena = before;
-            return NULL;
+// only the instructions that do something when the next byte comes in
+// are part of a state, sorted so that the same set is always the same state
+static i32 rg__make_list(rg_cache_t *c, i32 *list) {
+    const rg__inst_t *insts = c->rg->insts;
+    i32 count = 0;
+    for (i32 i = 0; i < c->dense_count; ++i) {
+        rg__op_e op = insts[c->dense[i]].op;
+        if (op == RG__OP_SET || op == RG__OP_MATCH || op == RG__OP_EOL) {
+            list[count++] = c->dense[i];
         }
     }
-    
-    return root;
+    qsort(list, count, sizeof(*list), rg__compare_pc);
+    return count;
 }
 
-json_t *json_get(json_t *node, strview_t key) {
-    if (!node) return NULL;
-
-    if (node->type != JSON_OBJECT) {
-        return NULL;
+static u32 rg__hash_list(i32 *list, i32 count) {
+    u32 hash = 2166136261u;
+    for (i32 i = 0; i < count; ++i) {
+        hash = (hash ^ (u32)list[i]) * 16777619u;
     }
+    return hash;
+}
 
-    node = node->object;
+// returns RG__UNKNOWN if the cache is full
+static i32 rg__state_get(rg_cache_t *c, i32 *list, i32 count) {
+    u32 hash = rg__hash_list(list, count);
+    u32 slot = hash & c->table_mask;
 
-    while (node) {
-        if (strv_equals(node->key, key)) {
-            return node;
+    while (c->table[slot] != RG__UNKNOWN) {
+        rg__state_t *state = &c->states[c->table[slot]];
+        if (state->hash == hash && state->count == count && 
+            (count == 0 || memcmp(state->list, list, sizeof(*list) * count) == 0)
+        ) {
+            return c->table[slot];
         }
-        node = node->next;
+        slot = (slot + 1) & c->table_mask;
     }
 
-    return NULL;
-}
-
-void json__pretty_print_value(json_t *value, int indent, const json_pretty_opts_t *options);
+    if (c->state_count >= COLLA_RG_DFA_MAX_STATES || (c->pool_used + count) > c->pool_cap) {
+        return RG__UNKNOWN;
+    }
 
-void json_pretty_print(json_t *root, const json_pretty_opts_t *options) {
-    json_pretty_opts_t default_options = { 0 };
-    if (options) {
-        memmove(&default_options, options, sizeof(json_pretty_opts_t));
+    i32 id = c->state_count++;
+    rg__state_t *state = &c->states[id];
+    *state = (rg__state_t){
+        .list = c->pool + c->pool_used,
+        .count = count,
+        .hash = hash,
+    };
+    if (count) {
+        memcpy(state->list, list, sizeof(*list) * count);
     }
+    c->pool_used += count;
+    c->table[slot] = id;
 
-    if (!os_handle_valid(default_options.custom_target)) {
-        default_options.custom_target = os_stdout();
+    i32 *trans = c->trans + (usize)id * 256;
+    for (int i = 0; i < 256; ++i) {
+        trans[i] = id == RG__DEAD ? RG__DEAD : RG__UNKNOWN;
     }
-    if (!default_options.use_custom_colours) {
-        os_log_colour_e default_col[JSON_PRETTY_COLOUR__COUNT] = {
-            LOG_COL_YELLOW,    // JSON_PRETTY_COLOUR_KEY,
-            LOG_COL_CYAN,      // JSON_PRETTY_COLOUR_STRING,
-            LOG_COL_BLUE,      // JSON_PRETTY_COLOUR_NUM,
-            LOG_COL_DARK_GREY, // JSON_PRETTY_COLOUR_NULL,
-            LOG_COL_GREEN,     // JSON_PRETTY_COLOUR_TRUE,
-            LOG_COL_RED,       // JSON_PRETTY_COLOUR_FALSE,
-        };
-        memmove(default_options.colours, default_col, sizeof(default_col));
+
+    const rg__inst_t *insts = c->rg->insts;
+    for (i32 i = 0; i < count; ++i) {
+        const rg__inst_t *inst = &insts[list[i]];
+        if (inst->op == RG__OP_MATCH) {
+            state->is_match = true;
+            state->match_at_end = true;
+        }
+        else if (inst->op == RG__OP_EOL && !state->match_at_end) {
+            state->match_at_end = rg__matches_at_end(c, list[i] + 1, false);
+        }
     }
 
-    json__pretty_print_value(root, 0, &default_options);
-    os_file_putc(default_options.custom_target, '\n');
+    return id;
 }
 
-///// json-private ///////////////////////////////////
+static void rg__cache_reset(rg_cache_t *c) {
+    c->state_count = 0;
+    c->pool_used = 0;
+    memset(c->table, 0xff, sizeof(*c->table) * (c->table_mask + 1));
+    rg__state_get(c, NULL, 0);
+    rg__state_get(c, c->start_list, c->start_count);
+}
 
-#define json__ensure(c) json__check_char(in, c)
+static i32 rg__step(rg_cache_t *c, i32 from, u8 byte) {
+    const rg__inst_t *insts = c->rg->insts;
+    const rg__set_t *sets = c->rg->sets;
+    rg__state_t *state = &c->states[from];
 
-bool json__check_char(instream_t *in, char c) {
-    if (istr_get(in) == c) {
-        return true;
+    rg__sparse_clear(c);
+    for (i32 i = 0; i < state->count; ++i) {
+        const rg__inst_t *inst = &insts[state->list[i]];
+        if (inst->op == RG__OP_SET && rg__set_has(&sets[inst->x], byte)) {
+            rg__closure(c, state->list[i] + 1, false);
+        }
     }
-    istr_rewind_n(in, 1);
-    return false;
-}
 
-bool json__is_value_finished(instream_t *in) {
-    usize old_pos = istr_tell(in);
-    
-    istr_skip_whitespace(in);
-    switch(istr_peek(in)) {
-        case '}': // fallthrough
-        case ']': // fallthrough
-        case ',':
-            return true;
+    i32 count = rg__make_list(c, c->list);
+    i32 next = rg__state_get(c, c->list, count);
+    if (next == RG__UNKNOWN) {
+        // throw everything away and start again, the 
+        // transition is not cached as from doesn't exist anymore
+        rg__cache_reset(c);
+        return rg__state_get(c, c->list, count);
     }
 
-    in->cur = in->beg + old_pos;
-    return false;
+    c->trans[(usize)from * 256 + byte] = next;
+    return next;
 }
 
-bool json__parse_null(instream_t *in) {
-    strview_t null_view = istr_get_view_len(in, 4);
-    bool is_valid = true;
-    
-    if (!strv_equals(null_view, strv("null"))) {
-        is_valid = false;
-    }
+rg_cache_t *rg_cache_init(arena_t *arena, const rg_t *rg) {
+    if (!rg) return NULL;
 
-    if (!json__is_value_finished(in)) {
-        is_valid = false;
+    i32 inst_count = rg->inst_count;
+    usize table_size = COLLA_RG_DFA_MAX_STATES * 2;
+
+    rg_cache_t *c = alloc(arena, rg_cache_t);
+    c->rg         = rg;
+    c->states     = alloc(arena, rg__state_t, COLLA_RG_DFA_MAX_STATES);
+    c->trans      = alloc(arena, i32, COLLA_RG_DFA_MAX_STATES * 256, ALLOC_NOZERO);
+    c->table      = alloc(arena, i32, table_size, ALLOC_NOZERO);
+    c->table_mask = (u32)(table_size - 1);
+    c->pool_cap   = MAX((usize)inst_count * 64, KB(64));
+    c->pool       = alloc(arena, i32, c->pool_cap, ALLOC_NOZERO);
+    c->sparse     = alloc(arena, i32, inst_count);
+    c->dense      = alloc(arena, i32, inst_count);
+    c->stack      = alloc(arena, i32, inst_count * 2 + 2);
+    c->list       = alloc(arena, i32, inst_count);
+    c->start_list = alloc(arena, i32, inst_count);
+
+    rg__sparse_clear(c);
+    rg__closure(c, 0, true);
+    c->start_count = rg__make_list(c, c->start_list);
+
+    for (i32 i = 0; i < c->start_count && !c->empty_match; ++i) {
+        const rg__inst_t *inst = &rg->insts[c->start_list[i]];
+        c->empty_match = inst->op == RG__OP_MATCH || 
+                         (inst->op == RG__OP_EOL && rg__matches_at_end(c, c->start_list[i] + 1, true));
     }
 
-    return is_valid;
+    rg__cache_reset(c);
+
+    return c;
 }
 
-bool json__parse_array(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
-    json_t *head = NULL;
-    
-    if (!json__ensure('[')) {
-        goto fail;
+bool rg_match(rg_cache_t *cache, strview_t text) {
+    if (!cache) return false;
+
+    const rg_t *rg = cache->rg;
+    if (rg->has_prefilter && searcher_find(&rg->prefilter, text, 0) == STR_NONE) {
+        return false;
     }
 
-    istr_skip_whitespace(in);
+    if (text.len == 0) {
+        return cache->empty_match;
+    }
 
-    // if it is an empty array
-    if (istr_peek(in) == ']') {
-        istr_skip(in, 1);
-        goto success;
+    i32 state = RG__START;
+    if (cache->states[state].is_match) {
+        return true;
     }
-    
-    if (!json__parse_value(arena, in, flags, &head)) {
-        goto fail;
+
+    for (usize i = 0; i < text.len; ++i) {
+        u8 byte = (u8)text.buf[i];
+        i32 next = cache->trans[(usize)state * 256 + byte];
+        if (next == RG__UNKNOWN) {
+            next = rg__step(cache, state, byte);
+        }
+        if (next == RG__DEAD) {
+            return false;
+        }
+        state = next;
+        if (cache->states[state].is_match) {
+            return true;
+        }
     }
 
-    json_t *cur = head;
-    
-    while (true) {
-        istr_skip_whitespace(in);
-        switch (istr_get(in)) {
-            case ']':
-                goto success;
-            case ',':
-            {
-                istr_skip_whitespace(in);
-                // trailing comma
-                if (istr_peek(in) == ']') {
-                    if (flags & JSON_NO_TRAILING_COMMAS) {
-                        goto fail;
-                    }
-                    else {
-                        continue;
-                    }
-                }
-
-                json_t *next = NULL;
-                if (!json__parse_value(arena, in, flags, &next)) {
-                    goto fail;
-                }
-                cur->next = next;
-                next->prev = cur;
-                cur = next;
-                break;
-            }
-            default:
-                istr_rewind_n(in, 1);
-                goto fail;
-        }
-    }
+    return cache->states[state].match_at_end;
+}
 
-success:
-    *out = head;
-    return true;
-fail:
-    *out = NULL;
-    return false;
+bool rg_matches(strview_t rg, strview_t text) {
+    arena_t arena = arena_make(ARENA_VIRTUAL, MB(16));
+    rg_cache_t *cache = rg_cache_init(&arena, rg_compile(&arena, rg, RG_DEFAULT));
+    bool result = rg_match(cache, text);
+    arena_cleanup(&arena);
+    return result;
 }
 
-bool json__parse_string(arena_t *arena, instream_t *in, strview_t *out) {
-    COLLA_UNUSED(arena);
-    *out = STRV_EMPTY;
+///////////////////////////////////////////////////
+// glob has the following special characters:
+//  - * matches any string
+//  - ? matches any character
+//  - [ start a match group
+//    - cannot be empty, so this matches either
+//      ] or [:
+//      [][]
+//      []]
+//    - if theres a - between two characters, it
+//      matches a range:
+//      [A-Za-z0-9] is equal to 
+//      [ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789]
+//    - if there's a !, it negates the match,
+//      so [!abc] matches anything but a, b, or c
+//    - if there's a + after the last square bracket,
+//      it matches 1+ times
+//
+// the pattern is compiled to a list of elements, the stars split it 
+// in segments: the first one has to match at the start of the text and 
+// the last one at the end, the ones in the middle are matched at the 
+// first place they fit. before any of that the literal prefix, suffix
+// and the longest literal in the middle are checked, which is usually
+// enough to reject most texts
+
+typedef enum {
+    GLOB__LITERAL,
+    GLOB__ANY,
+    GLOB__CLASS,
+    GLOB__STAR,
+} glob__elem_e;
+
+typedef struct glob__elem_t glob__elem_t;
+struct glob__elem_t {
+    glob__elem_e type;
+    // class matches one or more times
+    bool multi;
+    // literal: offset and length in literals, class: index in classes
+    u32 beg;
+    u32 len;
+};
 
-    istr_skip_whitespace(in); 
+struct glob_prog_t {
+    glob__elem_t *elems;
+    u32 elem_count;
+    rg__set_t *classes;
+    char *literals;
+    bool ignore_case;
+    usize min_len;
+    strview_t prefix;
+    strview_t suffix;
+    bool has_required;
+    searcher_t required;
+};
 
-    if (!json__ensure('"')) {
-        goto fail;
+static glob__elem_t *glob__push(glob_prog_t *g, glob__elem_e type) {
+    glob__elem_t *elem = &g->elems[g->elem_count++];
+    *elem = (glob__elem_t){ .type = type };
+    return elem;
+}
+
+static void glob__push_char(glob_prog_t *g, u32 *lit_len, char c) {
+    glob__elem_t *last = g->elem_count ? &g->elems[g->elem_count - 1] : NULL;
+    if (!last || last->type != GLOB__LITERAL) {
+        last = glob__push(g, GLOB__LITERAL);
+        last->beg = *lit_len;
     }
+    g->literals[(*lit_len)++] = g->ignore_case ? char_lower(c) : c;
+    last->len++;
+}
 
-    const char *from = in->cur;
-    
-    for (; !istr_is_finished(in) && *in->cur != '"'; ++in->cur) {
-        if (istr_peek(in) == '\\') {
-            ++in->cur;
+// returns false if the group is not closed, in which case [ is just a character
+static bool glob__parse_class(glob_prog_t *g, instream_t *in, u32 class_index) {
+    instream_t backup = *in;
+    rg__set_t *set = &g->classes[class_index];
+    *set = (rg__set_t){0};
+
+    bool negate = istr_peek(in) == '!';
+    if (negate) istr_skip(in, 1);
+
+    bool first = true;
+    bool closed = false;
+
+    while (!istr_is_finished(in)) {
+        char from = istr_get(in);
+        if (from == ']' && !first) {
+            closed = true;
+            break;
+        }
+        first = false;
+
+        char to = from;
+        if (istr_peek(in) == '-' && istr_remaining(in) > 1 && istr_peek_next(in) != ']') {
+            istr_skip(in, 1);
+            to = istr_get(in);
+        }
+
+        for (u32 c = (u8)from; c <= (u8)to; ++c) {
+            rg__set_add(set, (u8)c);
+            if (g->ignore_case) {
+                rg__set_add(set, (u8)char_lower((char)c));
+                rg__set_add(set, (u8)char_upper((char)c));
+            }
         }
     }
-    
-    usize len = in->cur - from;
 
-    *out = strv(from, len);
+    if (!closed) {
+        *in = backup;
+        return false;
+    }
 
-    if (!json__ensure('"')) {
-        goto fail;
+    if (negate) {
+        rg__set_invert(set);
     }
 
     return true;
-fail:
-    return false;
 }
 
-bool json__parse_pair(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
-    strview_t key = {0};
-    if (!json__parse_string(arena, in, &key)) {
-        goto fail;
-    }
+glob_prog_t *glob_compile(arena_t *arena, strview_t glob, glob_flags_e flags) {
+    glob_prog_t *g = alloc(arena, glob_prog_t);
+    g->ignore_case = flags & GLOB_IGNORE_CASE;
+    g->elems    = alloc(arena, glob__elem_t, glob.len + 1);
+    g->classes  = alloc(arena, rg__set_t, glob.len / 2 + 1);
+    g->literals = alloc(arena, char, glob.len + 1);
 
-    // skip preamble
-    istr_skip_whitespace(in);
-    if (!json__ensure(':')) {
-        goto fail;
+    u32 lit_len = 0;
+    u32 class_count = 0;
+
+    instream_t in = istr_init(glob);
+    while (!istr_is_finished(&in)) {
+        char c = istr_get(&in);
+        switch (c) {
+            case '*':
+                // a** is the same as a*
+                if (!g->elem_count || g->elems[g->elem_count - 1].type != GLOB__STAR) {
+                    glob__push(g, GLOB__STAR);
+                }
+                break;
+            case '?':
+                glob__push(g, GLOB__ANY);
+                g->min_len++;
+                break;
+            case '[':
+                if (glob__parse_class(g, &in, class_count)) {
+                    glob__elem_t *elem = glob__push(g, GLOB__CLASS);
+                    elem->beg = class_count++;
+                    if (istr_peek(&in) == '+') {
+                        istr_skip(&in, 1);
+                        elem->multi = true;
+                    }
+                    g->min_len++;
+                    break;
+                }
+                glob__push_char(g, &lit_len, c);
+                g->min_len++;
+                break;
+            default:
+                glob__push_char(g, &lit_len, c);
+                g->min_len++;
+                break;
+        }
     }
 
-    if (!json__parse_value(arena, in, flags, out)) {
-        goto fail;
+    if (g->elem_count == 0) {
+        return g;
     }
+
+    glob__elem_t *first = &g->elems[0];
+    glob__elem_t *last = &g->elems[g->elem_count - 1];
     
-    (*out)->key = key;
-    return true;
+    if (first->type == GLOB__LITERAL) {
+        g->prefix = strv(g->literals + first->beg, first->len);
+    }
+    // without stars the whole text is checked from the start anyway
+    if (last->type == GLOB__LITERAL && last != first) {
+        g->suffix = strv(g->literals + last->beg, last->len);
+    }
 
-fail: 
-    *out = NULL;
-    return false;
-}
+    // the longest literal that is neither the prefix nor the suffix,
+    // the searcher can't ignore case so skip it if it has letters
+    strview_t required = STRV_EMPTY;
+    for (u32 i = 1; (i + 1) < g->elem_count; ++i) {
+        glob__elem_t *elem = &g->elems[i];
+        if (elem->type != GLOB__LITERAL || elem->len <= required.len) {
+            continue;
+        }
+        strview_t lit = strv(g->literals + elem->beg, elem->len);
+        bool has_letters = false;
+        for (usize k = 0; k < lit.len && g->ignore_case; ++k) {
+            has_letters |= char_is_alpha(lit.buf[k]);
+        }
+        if (!has_letters) {
+            required = lit;
+        }
+    }
 
-bool json__parse_obj(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
-    if (!json__ensure('{')) {
-        goto fail;
+    if (required.len) {
+        g->has_required = true;
+        g->required = searcher_init(required);
     }
 
-    istr_skip_whitespace(in);
+    return g;
+}
 
-    // if it is an empty object
-    if (istr_peek(in) == '}') {
-        istr_skip(in, 1);
-        *out = NULL;
+static bool glob__literal_eq(const glob_prog_t *g, const char *text, strview_t lit) {
+    if (lit.len == 0) {
         return true;
     }
-
-    json_t *head = NULL;
-    if (!json__parse_pair(arena, in, flags, &head)) {
-        goto fail;
+    if (!g->ignore_case) {
+        return memcmp(text, lit.buf, lit.len) == 0;
     }
-    json_t *cur = head;
+    for (usize i = 0; i < lit.len; ++i) {
+        if (char_lower(text[i]) != lit.buf[i]) {
+            return false;
+        }
+    }
+    return true;
+}
 
-    while (true) {
-        istr_skip_whitespace(in);
-        switch (istr_get(in)) {
-            case '}':
-                goto success;
-            case ',':
+// matches the elements [beg, end) at pos, returns where it stopped or STR_NONE.
+// [..]+ classes take as much as they can, segments with them go through glob__match_runs
+static usize glob__match_segment(const glob_prog_t *g, u32 beg, u32 end, strview_t text, usize pos) {
+    for (u32 i = beg; i < end; ++i) {
+        const glob__elem_t *elem = &g->elems[i];
+        switch (elem->type) {
+            case GLOB__LITERAL:
+                if ((text.len - pos) < elem->len || 
+                    !glob__literal_eq(g, text.buf + pos, strv(g->literals + elem->beg, elem->len))
+                ) {
+                    return STR_NONE;
+                }
+                pos += elem->len;
+                break;
+            case GLOB__ANY:
+                if (pos >= text.len) return STR_NONE;
+                pos++;
+                break;
+            case GLOB__CLASS:
             {
-                istr_skip_whitespace(in);
-                // trailing commas
-                if (!(flags & JSON_NO_TRAILING_COMMAS) && istr_peek(in) == '}') {
-                    goto success;
+                const rg__set_t *set = &g->classes[elem->beg];
+                if (pos >= text.len || !rg__set_has(set, (u8)text.buf[pos])) {
+                    return STR_NONE;
                 }
-
-                json_t *next = NULL;
-                if (!json__parse_pair(arena, in, flags, &next)) {
-                    goto fail;
+                pos++;
+                while (elem->multi && pos < text.len && rg__set_has(set, (u8)text.buf[pos])) {
+                    pos++;
                 }
-                cur->next = next;
-                next->prev = cur;
-                cur = next;
                 break;
             }
-            default:
-                istr_rewind_n(in, 1);
-                goto fail;
+            case GLOB__STAR:
+                break;
         }
     }
+    return pos;
+}
 
-success:
-    *out = head;
-    return true;
-fail:
-    *out = NULL;
-    return false;
+// a segment with [..]+ classes can end in more than one place, so every position
+// it can be at is kept, one element at a time. reach and next have text.len + 1
+// entries, reach goes in with where the segment can start, the result is where it can end
+static bool *glob__reach_segment(const glob_prog_t *g, u32 beg, u32 end, strview_t text, bool *reach, bool *next) {
+    usize len = text.len;
+    for (u32 i = beg; i < end; ++i) {
+        const glob__elem_t *elem = &g->elems[i];
+        memset(next, 0, len + 1);
+        switch (elem->type) {
+            case GLOB__LITERAL:
+            {
+                strview_t lit = strv(g->literals + elem->beg, elem->len);
+                for (usize p = 0; p + lit.len <= len; ++p) {
+                    if (reach[p] && glob__literal_eq(g, text.buf + p, lit)) {
+                        next[p + lit.len] = true;
+                    }
+                }
+                break;
+            }
+            case GLOB__ANY:
+                for (usize p = 0; p < len; ++p) {
+                    next[p + 1] = reach[p];
+                }
+                break;
+            case GLOB__CLASS:
+            {
+                const rg__set_t *set = &g->classes[elem->beg];
+                for (usize p = 0; p < len; ++p) {
+                    // a run can go on from anywhere it already got to
+                    bool can_start = reach[p] || (elem->multi && next[p]);
+                    next[p + 1] = can_start && rg__set_has(set, (u8)text.buf[p]);
+                }
+                break;
+            }
+            case GLOB__STAR:
+                continue;
+        }
+        bool *tmp = reach;
+        reach = next;
+        next = tmp;
+    }
+    return reach;
 }
 
-bool json__parse_value(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
-    json_t *val = alloc(arena, json_t);
+// first place the segment [beg, end) can end when it starts anywhere in [from, to],
+// if must_end is set the only place it can end is the end of the text
+static usize glob__match_runs(arena_t scratch, const glob_prog_t *g, u32 beg, u32 end, strview_t text, usize from, usize to, bool must_end) {
+    bool buffer[2][256];
+    bool *reach = buffer[0];
+    bool *next = buffer[1];
+    if (text.len >= arrlen(buffer[0])) {
+        reach = alloc(&scratch, bool, text.len + 1, ALLOC_NOZERO);
+        next = alloc(&scratch, bool, text.len + 1, ALLOC_NOZERO);
+    }
 
-    istr_skip_whitespace(in);
+    memset(reach, 0, text.len + 1);
+    for (usize p = from; p <= to; ++p) {
+        reach[p] = true;
+    }
+    bool *ends = glob__reach_segment(g, beg, end, text, reach, next);
 
-    switch (istr_peek(in)) {
-        // object
-        case '{':
-            if (!json__parse_obj(arena, in, flags, &val->object)) {
-                goto fail;
-            }
-            val->type = JSON_OBJECT;
-            break;
-        // array
-        case '[':
-            if (!json__parse_array(arena, in, flags, &val->array)) {
-                goto fail;
-            }
-            val->type = JSON_ARRAY;
-            break;
-        // string
-        case '"':
-            if (!json__parse_string(arena, in, &val->string)) {
-                goto fail;
-            }
-            val->type = JSON_STRING;
-            break;
-        // boolean
-        case 't': // fallthrough
-        case 'f':
-            if (!istr_get_bool(in, &val->boolean)) {
-                goto fail;
-            }
-            val->type = JSON_BOOL;
-            break;
-        // null
-        case 'n': 
-            if (!json__parse_null(in)) {
-                goto fail;
-            }
-            val->type = JSON_NULL;
-            break;
-        // comment
-        case '/':
-            err("TODO comments");
-            break;
-        // number
-        default:
-            if (!istr_get_num(in, &val->number)) {
-                goto fail;
+    usize result = STR_NONE;
+    if (must_end) {
+        result = ends[text.len] ? text.len : STR_NONE;
+    }
+    else {
+        for (usize p = from; p <= text.len; ++p) {
+            if (ends[p]) {
+                result = p;
+                break;
             }
-            val->type = JSON_NUMBER;
-            break;
+        }
     }
 
-    *out = val;
+    return result;
+}
+
+static bool glob__is_fixed(const glob_prog_t *g, u32 beg, u32 end) {
+    for (u32 i = beg; i < end; ++i) {
+        if (g->elems[i].multi) {
+            return false;
+        }
+    }
     return true;
-fail:
-    *out = NULL;
-    return false;
+}
+
+bool glob_match(arena_t scratch, const glob_prog_t *g, strview_t text) {
+    if (text.len < g->min_len) {
+        return false;
+    }
+    if (!glob__literal_eq(g, text.buf, g->prefix) ||
+        !glob__literal_eq(g, text.buf + text.len - g->suffix.len, g->suffix)
+    ) {
+        return false;
+    }
+    if (g->has_required && searcher_find(&g->required, text, 0) == STR_NONE) {
+        return false;
+    }
+
+    u32 count = g->elem_count;
+    u32 i = 0;
+    while (i < count && g->elems[i].type != GLOB__STAR) {
+        i++;
+    }
+
+    // the first segment is anchored at the start, and at the end too if there is no star.
+    // otherwise the earliest place it can end leaves the most text for the rest
+    usize pos = glob__is_fixed(g, 0, i) ?
+        glob__match_segment(g, 0, i, text, 0) :
+        glob__match_runs(scratch, g, 0, i, text, 0, 0, i == count);
+    if (pos == STR_NONE) {
+        return false;
+    }
+    if (i == count) {
+        return pos == text.len;
+    }
+
+    while (true) {
+        // skip the star
+        i++;
+        if (i == count) {
+            return true;
+        }
+
+        u32 seg_beg = i;
+        bool is_fixed = true;
+        while (i < count && g->elems[i].type != GLOB__STAR) {
+            is_fixed &= !g->elems[i].multi;
+            i++;
+        }
+
+        if (i == count) {
+            // the last segment has to end with the text, if it has 
+            // a fixed length there is only one place it can start
+            if (is_fixed) {
+                usize seg_len = 0;
+                for (u32 k = seg_beg; k < count; ++k) {
+                    seg_len += g->elems[k].type == GLOB__LITERAL ? g->elems[k].len : 1;
+                }
+                if (seg_len > (text.len - pos)) return false;
+                return glob__match_segment(g, seg_beg, count, text, text.len - seg_len) == text.len;
+            }
+            return glob__match_runs(scratch, g, seg_beg, count, text, pos, text.len, true) == text.len;
+        }
+
+        // segments in the middle take the first place they end at
+        usize next = STR_NONE;
+        if (is_fixed) {
+            for (usize start = pos; start <= text.len && next == STR_NONE; ++start) {
+                next = glob__match_segment(g, seg_beg, i, text, start);
+            }
+        }
+        else {
+            next = glob__match_runs(scratch, g, seg_beg, i, text, pos, text.len, false);
+        }
+        if (next == STR_NONE) {
+            return false;
+        }
+        pos = next;
+    }
+}
+
+bool glob_matches(strview_t glob, strview_t text) {
+    u8 buffer[KB(16)];
+    arena_t arena = glob.len <= 256 && text.len <= KB(1) ?
+        arena_make(ARENA_STATIC, sizeof(buffer), buffer) : 
+        arena_make(ARENA_VIRTUAL, MB(1) + text.len * 2);
+    glob_prog_t *prog = glob_compile(&arena, glob, GLOB_DEFAULT);
+    bool result = glob_match(arena, prog, text);
+    arena_cleanup(&arena);
+    return result;
+}
+
+// == ARENA ========================================================
+
+static uptr arena__align(uptr ptr, usize align) {
+    return (ptr + (align - 1)) & ~(align - 1);
+}
+
+static arena_t arena__make_virtual(const arena_desc_t *desc);
+static arena_t arena__make_malloc(usize size);
+static arena_t arena__make_static(u8 *buf, usize len);
+
+static void *arena__alloc_common(const arena_alloc_desc_t *desc);
+static void *arena__alloc_malloc_always(const arena_alloc_desc_t *desc);
+
+static void arena__free_virtual(arena_t *arena);
+static void arena__free_malloc(arena_t *arena);
+
+static void arena__stats_init(arena_t *arena, const arena_desc_t *desc);
+static void arena__stats_alloc(arena_t *arena, const arena_alloc_desc_t *desc, usize total);
+
+arena_t malloc_arena = {
+    .type = ARENA_MALLOC_ALWAYS,
+};
+
+arena_t arena_init(const arena_desc_t *desc) {
+    arena_t out = {0};
+
+    if (desc) {
+        switch (desc->type) {
+            case ARENA_VIRTUAL:       out = arena__make_virtual(desc); break;
+            case ARENA_MALLOC:        out = arena__make_malloc(desc->size); break;
+            case ARENA_STATIC:        out = arena__make_static(desc->static_buffer, desc->size); break;
+            case ARENA_MALLOC_ALWAYS: out = malloc_arena; break;
+		    default: break;  
+        }
+        arena__stats_init(&out, desc);
+    }
+
+    return out;
+}
+
+void arena_cleanup(arena_t *arena) {
+    if (!arena) {
+        return;
+    }
+    
+    switch (arena->type) {
+        case ARENA_VIRTUAL: arena__free_virtual(arena); break;
+        case ARENA_MALLOC:  arena__free_malloc(arena);  break;
+        // ARENA_STATIC does not need to be freed
+        default: break;  
+    }
+
+    if (arena->stats) {
+        arena->stats->released = true;
+    }
+    
+    memset(arena, 0, sizeof(arena_t));
+}
+
+arena_t arena_scratch(arena_t *arena, usize size) {
+    u8 *buffer = alloc(arena, u8, size, ALLOC_SOFT_FAIL | ALLOC_NOZERO);
+    return arena__make_static(buffer, buffer ? size : 0);
+}
+
+void *arena_alloc(const arena_alloc_desc_t *desc) {
+    if (!desc || !desc->arena || desc->arena->type == ARENA_TYPE_NONE) {
+        return NULL;
+    }
+
+    arena_t *arena = desc->arena;
+
+    u8 *ptr = NULL;
+
+    switch (arena->type) {
+        case ARENA_MALLOC_ALWAYS:
+            ptr = arena__alloc_malloc_always(desc);
+            break;
+        default:
+            ptr = arena__alloc_common(desc);
+            break; 
+    }
+
+    if (!ptr && desc->flags & ALLOC_SOFT_FAIL) {
+        return NULL;
+    }
+
+    usize total = desc->size * desc->count;
+
+    if (arena->stats) {
+        arena__stats_alloc(arena, desc, total);
+    }
+
+    return desc->flags & ALLOC_NOZERO ? ptr : memset(ptr, 0, total);
+}
+
+usize arena_tell(arena_t *arena) {
+    return arena ? arena->cur - arena->beg : 0;
+}
+
+usize arena_remaining(arena_t *arena) {
+    return arena && (arena->cur < arena->end) ? arena->end - arena->cur : 0;
+}
+
+usize arena_capacity(arena_t *arena) {
+	return arena ? arena->end - arena->beg : 0;
+}
+
+void arena_rewind(arena_t *arena, usize from_start) {
+    if (!arena) {
+        return;
+    }
+
+    colla_assert(arena_tell(arena) >= from_start);
+
+    arena->cur = arena->beg + from_start;
+
+    if (arena->stats) {
+        arena->stats->rewind_count++;
+    }
+}
+
+void arena_pop(arena_t *arena, usize amount) {
+    if (!arena) {
+        return;
+    }
+    usize position = arena_tell(arena);
+    if (!position) {
+        return;
+    }
+    arena_rewind(arena, position - amount);
+}
+
+arena_temp_t arena_temp_begin(arena_t *arena) {
+    return (arena_temp_t){
+        .arena = arena,
+        .pos = arena_tell(arena),
+    };
+}
+
+void arena_temp_end(arena_temp_t *temp) {
+    if (!temp || !temp->arena) {
+        return;
+    }
+    arena_rewind(temp->arena, temp->pos);
+    temp->arena = NULL;
+}
+
+// == SCRATCH ==========================================================================================================
+
+thread_local arena_t scratch__pool[COLLA_SCRATCH_COUNT] = {0};
+
+static bool scratch__conflicts(arena_t *arena, arena_t **conflicts) {
+    for (int i = 0; i <= COLLA_SCRATCH_MAX_CONFLICTS; ++i) {
+        if (conflicts[i] && conflicts[i]->beg == arena->beg) {
+            return true;
+        }
+    }
+    return false;
+}
+
+arena_temp_t scratch__begin(arena_t **conflicts) {
+    for (int i = 0; i < COLLA_SCRATCH_COUNT; ++i) {
+        arena_t *arena = &scratch__pool[i];
+        if (arena->type == ARENA_TYPE_NONE) {
+            *arena = arena_make(
+                ARENA_VIRTUAL, COLLA_SCRATCH_SIZE, 
+                .decommit_threshold = COLLA_SCRATCH_DECOMMIT_THRESHOLD,
+                .name = "scratch"
+            );
+        }
+        if (!scratch__conflicts(arena, conflicts)) {
+            return arena_temp_begin(arena);
+        }
+    }
+
+    fatal("all %d scratch arenas are already in use", COLLA_SCRATCH_COUNT);
+    return (arena_temp_t){0};
+}
+
+void scratch_release(void) {
+    for (int i = 0; i < COLLA_SCRATCH_COUNT; ++i) {
+        arena_cleanup(&scratch__pool[i]);
+    }
+}
+
+// == ARENA STATS ======================================================================================================
+
+bool arena__stats_enabled = false;
+arena_stats_t *arena__stats_table = NULL;
+i64 arena__stats_count = 0;
+
+void arena_stats_enable(bool enable) {
+#if COLLA_NO_ARENA_STATS
+    COLLA_UNUSED(enable);
+#else
+    if (enable && !arena__stats_table) {
+        arena__stats_table = os_alloc(sizeof(arena_stats_t) * COLLA_ARENA_STATS_MAX_ARENAS);
+        if (!arena__stats_table) {
+            err("failed to allocate the arena stats table");
+            return;
+        }
+        memset(arena__stats_table, 0, sizeof(arena_stats_t) * COLLA_ARENA_STATS_MAX_ARENAS);
+    }
+    arena__stats_enabled = enable;
+#endif
+}
+
+bool arena_stats_is_enabled(void) {
+    return arena__stats_enabled;
+}
+
+arena_stats_t *arena_stats_get(int *out_count) {
+    i64 count = MIN(atomic_get_i64(&arena__stats_count), COLLA_ARENA_STATS_MAX_ARENAS);
+    if (out_count) *out_count = (int)count;
+    return arena__stats_table;
+}
+
+static void arena__stats_init(arena_t *arena, const arena_desc_t *desc) {
+    if (!arena__stats_enabled || !arena->beg || arena->type == ARENA_MALLOC_ALWAYS) {
+        return;
+    }
+
+    i64 index = atomic_inc_i64(&arena__stats_count) - 1;
+    if (index >= COLLA_ARENA_STATS_MAX_ARENAS) {
+        return;
+    }
+
+    arena_stats_t *stats = &arena__stats_table[index];
+    stats->name = desc->name ? desc->name : "unnamed";
+    stats->file = desc->file;
+    stats->line = desc->line;
+    stats->type = arena->type;
+    stats->capacity = arena_capacity(arena);
+    if (arena->type == ARENA_VIRTUAL) {
+        // arena__make_virtual always commits the first block
+        stats->committed = MIN(arena->commit_size, arena_capacity(arena));
+        stats->commit_count = 1;
+    }
+
+    arena->stats = stats;
+}
+
+static void arena__stats_alloc(arena_t *arena, const arena_alloc_desc_t *desc, usize total) {
+    arena_stats_t *stats = arena->stats;
+    stats->alloc_count++;
+    stats->allocated += total;
+    stats->peak = MAX(stats->peak, arena_tell(arena));
+
+    // call sites are string literals, so the pointer is enough to tell them apart
+    uptr hash = ((uptr)desc->file >> 3) ^ ((uptr)desc->line * 2654435761u);
+    for (int i = 0; i < COLLA_ARENA_STATS_MAX_SITES; ++i) {
+        arena_site_t *site = &stats->sites[(hash + i) & (COLLA_ARENA_STATS_MAX_SITES - 1)];
+        if (!site->file) {
+            site->file = desc->file;
+            site->line = desc->line;
+        }
+        if (site->file == desc->file && site->line == desc->line) {
+            site->count++;
+            site->bytes += total;
+            return;
+        }
+    }
+
+    stats->other_sites_count++;
+    stats->other_sites_bytes += total;
+}
+
+void arena_stats_print(void) {
+    int count = 0;
+    arena_stats_t *table = arena_stats_get(&count);
+    if (!table || count == 0) {
+        return;
+    }
+
+    print(
+        "%-12s %-28s %10s %10s %10s %10s %10s %10s %8s\n", 
+        "arena", "made at", "allocs", "allocated", "peak", "committed", "returned", "capacity", "rewinds"
+    );
+
+    for (int i = 0; i < count; ++i) {
+        arena_stats_t *stats = &table[i];
+        char location[256];
+        fmt_buffer(location, sizeof(location), "%s:%d", stats->file ? stats->file : "?", stats->line);
+
+        print(
+            "%-12s %-28s %10zu %$$$10zu %$$$10zu %$$$10zu %$$$10zu %$$$10zu %8zu%s\n",
+            stats->name, location, stats->alloc_count, stats->allocated, stats->peak,
+            stats->committed, stats->decommitted, stats->capacity, stats->rewind_count,
+            stats->released || stats->type == ARENA_STATIC ? "" : " (not freed)"
+        );
+
+        // print the biggest call sites first, the table is tiny so just
+        // pick the max every time
+        bool printed[COLLA_ARENA_STATS_MAX_SITES] = {0};
+        for (int k = 0; k < 5; ++k) {
+            int best = -1;
+            for (int s = 0; s < COLLA_ARENA_STATS_MAX_SITES; ++s) {
+                if (!stats->sites[s].file || printed[s]) continue;
+                if (best < 0 || stats->sites[s].bytes > stats->sites[best].bytes) {
+                    best = s;
+                }
+            }
+            if (best < 0) break;
+            printed[best] = true;
+
+            arena_site_t *site = &stats->sites[best];
+            fmt_buffer(location, sizeof(location), "%s:%d", site->file, site->line);
+            print("%-12s %-28s %10zu %$$$10zu\n", "", location, site->count, site->bytes);
+        }
+
+        if (stats->other_sites_count) {
+            print("%-12s %-28s %10zu %$$$10zu\n", "", "other", stats->other_sites_count, stats->other_sites_bytes);
+        }
+    }
+
+    if (atomic_get_i64(&arena__stats_count) > COLLA_ARENA_STATS_MAX_ARENAS) {
+        print("%lld arenas were not tracked, bump COLLA_ARENA_STATS_MAX_ARENAS\n", atomic_get_i64(&arena__stats_count) - COLLA_ARENA_STATS_MAX_ARENAS);
+    }
+}
+
+// == VIRTUAL ARENA ====================================================================================================
+
+// virtual arenas keep this in a header right before beg, in the first block that
+// is committed anyway, this way every copy of the arena agrees on what is committed
+typedef struct arena__virtual_t arena__virtual_t;
+struct arena__virtual_t {
+    usize committed; // from the start of the header
+    usize decommitted;
+    usize decommit_threshold;
+    u64 decommit_interval;
+    u64 last_decommit;
+};
+
+// keeps beg aligned to a cache line
+#define ARENA__VIRTUAL_HEADER 64
+static_assert(sizeof(arena__virtual_t) <= ARENA__VIRTUAL_HEADER);
+
+static arena__virtual_t *arena__virtual_info(arena_t *arena) {
+    return arena && arena->type == ARENA_VIRTUAL && arena->beg ? (arena__virtual_t *)(arena->beg - ARENA__VIRTUAL_HEADER) : NULL;
+}
+
+// block needs to be a power of two
+static usize arena__pad_to(usize value, usize block) {
+    return (value + (block - 1)) & ~(block - 1);
+}
+
+// from and to are offsets from the start of the header
+static bool arena__commit(arena_t *arena, usize from, usize to) {
+    usize page_size = os_get_system_info().page_size;
+    u8 *base = arena->beg - ARENA__VIRTUAL_HEADER;
+    if (!os_commit(base + from, (to - from) / page_size)) {
+        return false;
+    }
+    if (arena->flags & ARENA_PREFAULT) {
+        os_prefault(base + from, to - from);
+    }
+    return true;
+}
+
+static arena_t arena__make_virtual(const arena_desc_t *desc) {
+    usize page_size = os_get_system_info().page_size;
+    bool is_huge = desc->flags & (ARENA_HUGE_PAGES | ARENA_HUGETLB);
+    usize commit_size = MAX(desc->commit_size, is_huge ? COLLA_HUGE_PAGE_SIZE : page_size);
+
+    // round up to a power of two, so that it can be used as a mask
+    usize pow2 = page_size;
+    while (pow2 < commit_size) pow2 <<= 1;
+    commit_size = pow2;
+
+    usize alloc_size = 0;
+    u8 *ptr = is_huge ?
+        os_reserve_huge(desc->size + ARENA__VIRTUAL_HEADER, &alloc_size, desc->flags & ARENA_HUGETLB) :
+        os_reserve(desc->size + ARENA__VIRTUAL_HEADER, &alloc_size);
+
+    if (!ptr) {
+        return (arena_t){ .type = ARENA_VIRTUAL };
+    }
+
+    arena_t out = {
+        .beg = ptr + ARENA__VIRTUAL_HEADER,
+        .cur = ptr + ARENA__VIRTUAL_HEADER,
+        .end = ptr + alloc_size,
+        .type = ARENA_VIRTUAL,
+        .flags = desc->flags,
+        .commit_size = commit_size,
+    };
+
+    usize first_block = MIN(commit_size, alloc_size);
+    if (!arena__commit(&out, 0, first_block)) {
+        os_release(ptr, alloc_size);
+        return (arena_t){ .type = ARENA_VIRTUAL };
+    }
+
+    arena__virtual_t *info = arena__virtual_info(&out);
+    *info = (arena__virtual_t){
+        .committed = first_block,
+        .decommit_threshold = desc->decommit_threshold,
+        .decommit_interval = desc->decommit_interval_ms,
+        .last_decommit = desc->decommit_interval_ms ? os_time_ms() : 0,
+    };
+
+    return out;
+}
+
+static void arena__free_virtual(arena_t *arena) {
+    if (!arena->beg) {
+        return;
+    }
+
+    os_release(arena->beg - ARENA__VIRTUAL_HEADER, arena_capacity(arena) + ARENA__VIRTUAL_HEADER);
+}
+
+void arena_trim(arena_t *arena) {
+    arena__virtual_t *info = arena__virtual_info(arena);
+    if (!info || (!info->decommit_threshold && !info->decommit_interval)) {
+        return;
+    }
+
+    // keep half of the threshold committed, so that an arena going up
+    // and down around the same size doesn't keep committing/decommitting
+    usize pos = ARENA__VIRTUAL_HEADER + arena_tell(arena);
+    usize reserved = ARENA__VIRTUAL_HEADER + arena_capacity(arena);
+    usize keep = arena__pad_to(pos + info->decommit_threshold / 2, arena->commit_size);
+    keep = MIN(MAX(keep, arena->commit_size), reserved);
+
+    if (info->committed <= keep) {
+        return;
+    }
+
+    bool over_threshold = info->decommit_threshold && (info->committed - pos) > info->decommit_threshold;
+    bool timer_expired = false;
+    if (!over_threshold && info->decommit_interval) {
+        u64 now = os_time_ms();
+        timer_expired = (now - info->last_decommit) >= info->decommit_interval;
+    }
+
+    if (!over_threshold && !timer_expired) {
+        return;
+    }
+
+    usize amount = info->committed - keep;
+    if (!os_decommit(arena->beg - ARENA__VIRTUAL_HEADER + keep, amount, arena->flags & ARENA_LAZY_DECOMMIT)) {
+        return;
+    }
+
+    info->committed = keep;
+    info->decommitted += amount;
+    if (info->decommit_interval) {
+        info->last_decommit = os_time_ms();
+    }
+
+    if (arena->stats) {
+        arena->stats->decommitted += amount;
+    }
+}
+
+usize arena_decommitted_bytes(arena_t *arena) {
+    arena__virtual_t *info = arena__virtual_info(arena);
+    return info ? info->decommitted : 0;
+}
+
+// == MALLOC ARENA =====================================================================================================
+
+static arena_t arena__make_malloc(usize size) {
+    u8 *ptr = os_alloc(size);
+    colla_assert(ptr);
+    return (arena_t) {
+        .beg = ptr,
+        .cur = ptr,
+        .end = ptr ? ptr + size : NULL,
+        .type = ARENA_MALLOC,
+    };
+}
+
+static void arena__free_malloc(arena_t *arena) {
+    os_free(arena->beg);
+}
+
+// == ARENA ALLOC ======================================================================================================
+
+static void *arena__alloc_common(const arena_alloc_desc_t *desc) {
+    usize total = desc->size * desc->count;
+    arena_t *arena = desc->arena;
+
+    arena->cur = (u8 *)arena__align((uptr)arena->cur, desc->align);
+    bool soft_fail = desc->flags & ALLOC_SOFT_FAIL;
+
+    if (total > arena_remaining(arena)) {
+        if (!soft_fail) {
+            fatal("finished space in arena, tried to allocate %_$$$dB out of %_$$$dB (total: %_$$$dB)\n", total, arena_remaining(arena), (usize)(arena->end - arena->beg));
+        }
+        return NULL;
+    }
+
+    arena__virtual_t *info = arena__virtual_info(arena);
+    if (info) {
+        usize new_cur = ARENA__VIRTUAL_HEADER + arena_tell(arena) + total;
+
+        if (new_cur > info->committed) {
+            usize next_block = MIN(arena__pad_to(new_cur, arena->commit_size), ARENA__VIRTUAL_HEADER + arena_capacity(arena));
+
+            if (!arena__commit(arena, info->committed, next_block)) {
+                if (!soft_fail) {
+                    fatal("failed to commit memory for virtual arena, tried to commit %_$$$dB\n", next_block - info->committed);
+                }
+                return NULL;
+            }
+            info->committed = next_block;
+
+            if (arena->stats) {
+                arena->stats->commit_count++;
+                arena->stats->committed = MAX(arena->stats->committed, next_block);
+            }
+        }
+    }
+
+    u8 *ptr = arena->cur;
+    arena->cur += total;
+
+    return ptr;
+}
+
+static void *arena__alloc_malloc_always(const arena_alloc_desc_t *desc) {
+    usize total = desc->size * desc->count;
+
+    u8 *ptr = os_alloc(total);
+    if (!ptr && !(desc->flags & ALLOC_SOFT_FAIL)) {
+        fatal("alloc call failed for %_$$$dB", total);
+    }
+
+    return ptr;
+}
+
+// == STATIC ARENA =====================================================================================================
+
+static arena_t arena__make_static(u8 *buf, usize len) {
+    return (arena_t) {
+        .beg = buf,
+        .cur = buf,
+        .end = buf ? buf + len : NULL,
+        .type = ARENA_STATIC,
+    };
+}
+
+// == POOL =============================================================================================================
+
+pool_t pool_init(arena_t *arena, usize size, usize align) {
+    // every free object stores the pointer to the next one
+    align = MAX(align, alignof(void *));
+    size = arena__align(MAX(size, sizeof(void *)), align);
+    return (pool_t){
+        .arena = arena,
+        .size = size,
+        .align = align,
+    };
+}
+
+void *pool_alloc_desc(pool_alloc_desc_t *desc) {
+    pool_t *pool = desc->pool;
+    if (!pool->free && atomic_get_i64(&pool->remote_free)) {
+        pool->free = (void *)atomic_set_i64(&pool->remote_free, 0);
+    }
+
+    u8 *ptr = pool->free;
+
+    if (ptr) {
+        pool->free = *(void **)ptr;
+    }
+    else {
+        if ((usize)(pool->block_end - pool->block_cur) < pool->size) {
+            usize block_size = MAX(pool->size, COLLA_POOL_BLOCK_SIZE);
+            pool->block_cur = alloc(pool->arena, u8, block_size, ALLOC_NOZERO, pool->align);
+            pool->block_end = pool->block_cur + block_size;
+        }
+        ptr = pool->block_cur;
+        pool->block_cur += pool->size;
+    }
+
+    if (desc->flags & ALLOC_NOZERO) {
+        return ptr;
+    }
+    return memset(ptr, 0, pool->size);
+}
+
+void pool_free(pool_t *pool, void *ptr) {
+    if (!ptr) return;
+    *(void **)ptr = pool->free;
+    pool->free = ptr;
+}
+
+void pool_free_remote(pool_t *pool, void *ptr) {
+    if (!ptr) return;
+    // the owner only ever takes the whole list, so there is no ABA problem
+    i64 head = atomic_get_i64(&pool->remote_free);
+    while (true) {
+        *(i64 *)ptr = head;
+        i64 prev = atomic_cmp_i64(&pool->remote_free, (i64)ptr, head);
+        if (prev == head) break;
+        head = prev;
+    }
+}
+
+// == SLAB =============================================================================================================
+
+static int slab__class(usize size) {
+    int class = 0;
+    usize class_size = COLLA_SLAB_MIN_SIZE;
+    while (class_size < size && class < COLLA_SLAB_CLASS_COUNT) {
+        class_size <<= 1;
+        class++;
+    }
+    return class;
+}
+
+slab_t slab_init(arena_t *arena) {
+    slab_t slab = { .arena = arena };
+    for (int i = 0; i < COLLA_SLAB_CLASS_COUNT; ++i) {
+        slab.classes[i] = pool_init(arena, (usize)COLLA_SLAB_MIN_SIZE << i, 16);
+    }
+    return slab;
+}
+
+void *slab_alloc(slab_t *slab, usize size) {
+    int class = slab__class(size);
+    if (class >= COLLA_SLAB_CLASS_COUNT) {
+        return alloc(slab->arena, u8, size, .align = 16);
+    }
+    return pool_alloc(&slab->classes[class]);
+}
+
+void slab_free(slab_t *slab, void *ptr, usize size) {
+    int class = slab__class(size);
+    if (class < COLLA_SLAB_CLASS_COUNT) {
+        pool_free(&slab->classes[class], ptr);
+    }
+}
+
+void slab_free_remote(slab_t *slab, void *ptr, usize size) {
+    int class = slab__class(size);
+    if (class < COLLA_SLAB_CLASS_COUNT) {
+        pool_free_remote(&slab->classes[class], ptr);
+    }
+}
+
+// == HASH MAP =========================================================================================================
+
+#define HMAP__GROUP   16
+#define HMAP__EMPTY   0x80
+#define HMAP__DELETED 0xFE
+
+// bit i is set if the control byte i of the group is equal to byte
+static inline u32 hmap__match(const u8 *group, u8 byte) {
+#if COLLA_SCAN_X64
+    __m128i ctrl = _mm_load_si128((const __m128i *)group);
+    return (u32)_mm_movemask_epi8(_mm_cmpeq_epi8(ctrl, _mm_set1_epi8((char)byte)));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HMAP__GROUP; ++i) {
+        mask |= (u32)(group[i] == byte) << i;
+    }
+    return mask;
+#endif
+}
+
+// empty and deleted are the only control bytes with the high bit set
+static inline u32 hmap__match_free(const u8 *group) {
+#if COLLA_SCAN_X64
+    return (u32)_mm_movemask_epi8(_mm_load_si128((const __m128i *)group));
+#else
+    u32 mask = 0;
+    for (u32 i = 0; i < HMAP__GROUP; ++i) {
+        mask |= (u32)(group[i] >> 7) << i;
+    }
+    return mask;
+#endif
+}
+
+static inline u8 hmap__h2(u64 hash) {
+    return (u8)(hash >> 57);
+}
+
+static inline bool hmap__key_equals(strview_t a, strview_t b) {
+    if (a.len != b.len) return false;
+    if (a.buf == b.buf) return true;
+    return a.buf && b.buf && memcmp(a.buf, b.buf, a.len) == 0;
+}
+
+static usize hmap__find_free(hmap_t *map, u64 hash) {
+    usize mask = map->cap / HMAP__GROUP - 1;
+    usize group = hash & mask;
+    // triangular steps visit every group when the count is a power of two
+    for (usize step = 1; ; ++step) {
+        u32 free = hmap__match_free(map->ctrl + group * HMAP__GROUP);
+        if (free) {
+            return group * HMAP__GROUP + scan__ctz64(free);
+        }
+        group = (group + step) & mask;
+    }
+}
+
+static void hmap__resize(hmap_t *map, usize cap) {
+    u8 *old_ctrl = map->ctrl;
+    hmap_entry_t *old_entries = map->entries;
+    usize old_cap = map->cap;
+
+    map->ctrl = alloc(map->arena, u8, cap, ALLOC_NOZERO, HMAP__GROUP);
+    map->entries = alloc(map->arena, hmap_entry_t, cap, ALLOC_NOZERO);
+    map->cap = cap;
+    map->deleted = 0;
+    memset(map->ctrl, HMAP__EMPTY, cap);
+
+    for (usize i = 0; i < old_cap; ++i) {
+        if (old_ctrl[i] & 0x80) continue;
+        usize index = hmap__find_free(map, old_entries[i].hash);
+        map->ctrl[index] = old_ctrl[i];
+        map->entries[index] = old_entries[i];
+    }
+}
+
+hmap_t hmap_init(arena_t *arena, usize count) {
+    hmap_t map = { .arena = arena };
+    if (count) {
+        usize cap = HMAP__GROUP;
+        while (cap * 7 / 8 < count) {
+            cap <<= 1;
+        }
+        hmap__resize(&map, cap);
+    }
+    return map;
+}
+
+u64 hmap_hash(strview_t key) {
+    const u8 *data = (const u8 *)key.buf;
+    usize len = key.len;
+    u64 hash = 0x9E3779B97F4A7C15ull ^ (key.len * 0xFF51AFD7ED558CCDull);
+
+    while (len >= 8) {
+        u64 v;
+        memcpy(&v, data, 8);
+        hash = (hash ^ v) * 0xBF58476D1CE4E5B9ull;
+        hash ^= hash >> 31;
+        data += 8;
+        len -= 8;
+    }
+
+    // fixed size reads for the tail, the length is already in the hash
+    if (len >= 4) {
+        u32 lo, hi;
+        memcpy(&lo, data, 4);
+        memcpy(&hi, data + len - 4, 4);
+        hash = (hash ^ (((u64)hi << 32) | lo)) * 0xBF58476D1CE4E5B9ull;
+    }
+    else if (len) {
+        u64 v = ((u64)data[0] << 16) | ((u64)data[len >> 1] << 8) | data[len - 1];
+        hash = (hash ^ v) * 0xBF58476D1CE4E5B9ull;
+    }
+
+    return hmap_hash_u64(hash);
+}
+
+u64 hmap_hash_u64(u64 key) {
+    // splitmix64 finalizer, the top 7 bits end up in the control bytes
+    // so they have to depend on every bit of the key
+    key ^= key >> 30;
+    key *= 0xBF58476D1CE4E5B9ull;
+    key ^= key >> 27;
+    key *= 0x94D049BB133111EBull;
+    key ^= key >> 31;
+    return key;
+}
+
+hmap_entry_t *hmap_get_hashed(hmap_t *map, strview_t key, u64 hash) {
+    if (!map->cap) return NULL;
+
+    usize mask = map->cap / HMAP__GROUP - 1;
+    usize group = hash & mask;
+    u8 h2 = hmap__h2(hash);
+
+    for (usize step = 1; ; ++step) {
+        const u8 *ctrl = map->ctrl + group * HMAP__GROUP;
+        u32 match = hmap__match(ctrl, h2);
+        while (match) {
+            hmap_entry_t *entry = &map->entries[group * HMAP__GROUP + scan__ctz64(match)];
+            if (entry->hash == hash && hmap__key_equals(entry->key, key)) {
+                return entry;
+            }
+            match &= match - 1;
+        }
+        // the key would have been put in this group
+        if (hmap__match(ctrl, HMAP__EMPTY)) {
+            return NULL;
+        }
+        group = (group + step) & mask;
+    }
+}
+
+hmap_entry_t *hmap_set_hashed(hmap_t *map, strview_t key, u64 hash, void *value) {
+    hmap_entry_t *entry = hmap_get_hashed(map, key, hash);
+    if (entry) {
+        entry->value = value;
+        return entry;
+    }
+
+    if ((map->count + map->deleted + 1) * 8 > map->cap * 7) {
+        // if it's mostly tombstones, cleaning them up is enough
+        usize cap = map->cap ? map->cap : HMAP__GROUP;
+        if ((map->count + 1) * 16 > cap * 7) {
+            cap <<= 1;
+        }
+        hmap__resize(map, cap);
+    }
+
+    usize index = hmap__find_free(map, hash);
+    if (map->ctrl[index] == HMAP__DELETED) {
+        map->deleted--;
+    }
+    map->ctrl[index] = hmap__h2(hash);
+    map->count++;
+
+    entry = &map->entries[index];
+    *entry = (hmap_entry_t){
+        .key = key,
+        .hash = hash,
+        .value = value,
+    };
+    return entry;
+}
+
+bool hmap_remove_hashed(hmap_t *map, strview_t key, u64 hash) {
+    hmap_entry_t *entry = hmap_get_hashed(map, key, hash);
+    if (!entry) return false;
+
+    usize index = entry - map->entries;
+    // a group that still has an empty slot was never full, so no lookup
+    // went past it and the slot can go back to empty
+    if (hmap__match(map->ctrl + (index & ~(usize)(HMAP__GROUP - 1)), HMAP__EMPTY)) {
+        map->ctrl[index] = HMAP__EMPTY;
+    }
+    else {
+        map->ctrl[index] = HMAP__DELETED;
+        map->deleted++;
+    }
+    map->count--;
+    return true;
+}
+
+hmap_entry_t *hmap_get(hmap_t *map, strview_t key) {
+    return hmap_get_hashed(map, key, hmap_hash(key));
+}
+
+hmap_entry_t *hmap_set(hmap_t *map, strview_t key, void *value) {
+    return hmap_set_hashed(map, key, hmap_hash(key), value);
+}
+
+bool hmap_remove(hmap_t *map, strview_t key) {
+    return hmap_remove_hashed(map, key, hmap_hash(key));
+}
+
+hmap_entry_t *hmap_get_u64(hmap_t *map, u64 key) {
+    return hmap_get_hashed(map, (strview_t){ .len = key }, hmap_hash_u64(key));
+}
+
+hmap_entry_t *hmap_set_u64(hmap_t *map, u64 key, void *value) {
+    return hmap_set_hashed(map, (strview_t){ .len = key }, hmap_hash_u64(key), value);
+}
+
+bool hmap_remove_u64(hmap_t *map, u64 key) {
+    return hmap_remove_hashed(map, (strview_t){ .len = key }, hmap_hash_u64(key));
+}
+
+hmap_entry_t *hmap_next(hmap_t *map, hmap_entry_t *prev) {
+    usize index = prev ? (usize)(prev - map->entries) + 1 : 0;
+    for (; index < map->cap; ++index) {
+        if (!(map->ctrl[index] & 0x80)) {
+            return &map->entries[index];
+        }
+    }
+    return NULL;
+}
+
+// == HANDLE ====================================
+
+oshandle_t os_handle_zero(void) {
+	return (oshandle_t){0};
+}
+
+bool os_handle_match(oshandle_t a, oshandle_t b) {
+	return a.data == b.data;
+}
+
+bool os_handle_valid(oshandle_t handle) {
+	return !os_handle_match(handle, os_handle_zero());
+}
+
+// == LOGGING ===================================
+
+const char* os_log_level_strings[LOG_COL__COUNT] = {
+    [LOG_DEBUG] = "[DEBUG]:",
+    [LOG_INFO]  = "[INFO]:",
+    [LOG_WARN]  = "[WARN]:",
+    [LOG_ERR]   = "[ERR]:",
+    [LOG_FATAL] = "[FATAL]:",
+};
+
+os_log_colour_e os_log_level_colours[LOG_COL__COUNT] = {
+    [LOG_DEBUG] = LOG_COL_BLUE,
+    [LOG_INFO]  = LOG_COL_GREEN,
+    [LOG_WARN]  = LOG_COL_YELLOW,
+    [LOG_ERR]   = LOG_COL_RED,
+    [LOG_FATAL] = LOG_COL_RED,
+};
+
+os_log_options_e os__log_opts = OS_LOG_SIMPLE;
+log_callback_t os__log_cbs[COLLA_LOG_MAX_CALLBACKS] = {0};
+i64 os__log_cbs_count = 0;
+
+void os_log__stdout(log_event_t *ev) {
+    bool notime = os__log_opts & OS_LOG_NOTIME;
+    bool nofile = os__log_opts & OS_LOG_NOFILE;
+
+    if (!notime) {
+        os_log_set_colour(LOG_COL_DARK_GREY);
+        fmt_print(
+            "%02d:%02d:%02d ", 
+            ev->time->tm_hour, 
+            ev->time->tm_min, 
+            ev->time->tm_sec
+        );
+        os_log_set_colour(LOG_COL_RESET);
+    }
+
+    if (ev->level != LOG_BASIC) {
+        os_log_set_colour(os_log_level_colours[ev->level]);
+        fmt_print("%-8s ", os_log_level_strings[ev->level]);
+        os_log_set_colour(LOG_COL_RESET);
+    }
+
+    if (!nofile) {
+        os_log_set_colour(LOG_COL_DARK_GREY);
+        fmt_print("%s:%d ", ev->file, ev->line);
+        os_log_set_colour(LOG_COL_RESET);
+    }
+
+    fmt_printv(ev->fmt, ev->args);
+    fmt_print("\n");
+}
+
+void os_log__fp(log_event_t *ev) {
+    u8 tmpbuf[KB(1)] = {0};
+    arena_t scratch = arena_make(ARENA_STATIC, sizeof(tmpbuf), tmpbuf);
+
+    oshandle_t fp = {0};
+    fp.data = (uptr)ev->udata;
+
+    bool notime = os__log_opts & OS_LOG_NOTIME;
+    bool nofile = os__log_opts & OS_LOG_NOFILE;
+
+    if (!notime) {
+        os_file_print(
+            scratch, 
+            fp, 
+            "%02d:%02d:%02d ", 
+            ev->time->tm_hour, 
+            ev->time->tm_min, 
+            ev->time->tm_sec
+        );
+    }
+
+    if (ev->level != LOG_BASIC) {
+        os_file_print(scratch, fp, "%-8s ", os_log_level_strings[ev->level]);
+    }
+
+    if (!nofile) {
+        os_file_print(scratch, fp, "%s:%d ", ev->file, ev->line);
+    }
+
+    os_file_printv(scratch, fp, ev->fmt, ev->args);
+    os_file_putc(fp, '\n');
+}
+
+void os_log_set_options(os_log_options_e opt) {
+    os__log_opts = opt;
+}
+
+os_log_options_e os_log_get_options(void) {
+    return os__log_opts;
+}
+
+void os_log_add_callback(log_callback_t cb) {
+    colla_assert(os__log_cbs_count < arrlen(os__log_cbs));
+    os__log_cbs[os__log_cbs_count++] = cb;
+}
+
+void os_log_add_fp(oshandle_t fp, os_log_level_e level) {
+    os_log_add_callback((log_callback_t){ 
+        .fn = os_log__fp, 
+        .udata = (void*)fp.data, 
+        .level = level 
+    });
+}
+
+void os__log_init(void) {
+    os_log_add_callback((log_callback_t){ .fn = os_log__stdout });
+}
+
+void os_log_print(const char *file, int line, os_log_level_e level, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    os_log_printv(file, line, level, fmt, args);
+    va_end(args);
+}
+
+void os_log_printv(const char *file, int line, os_log_level_e level, const char *fmt, va_list args) {
+    time_t t = time(NULL);
+    struct tm log_time = { 0 };
+#define gettime(src, dst) localtime_s(&dst, &src)
+    log_event_t ev = {
+        .level = level,
+        .line = line,
+        .args = args,
+        .fmt = fmt,
+        .file = file,
+        .time = &log_time,
+    };
+
+    localtime_s(&log_time, &t);
+    for (int i = 0; i < os__log_cbs_count; ++i) {
+        if (os__log_cbs[i].level > level) {
+            continue;
+        }
+        ev.udata = os__log_cbs[i].udata;
+        os__log_cbs[i].fn(&ev);
+    }
+
+    bool nocrash = os__log_opts & OS_LOG_NOCRASH;
+
+    if (!nocrash && level == LOG_FATAL) {
+        os_abort(1);
+    }
+}
+
+// == FILE ======================================
+
+void os_file_split_path(strview_t path, strview_t *dir, strview_t *name, strview_t *ext) {
+	usize dir_lin = strv_rfind(path, '/', 0);
+	usize dir_win = strv_rfind(path, '\\', 0);
+	dir_lin = dir_lin != STR_NONE ? dir_lin : 0;
+	dir_win = dir_win != STR_NONE ? dir_win : 0;
+	usize dir_pos = MAX(dir_lin, dir_win);
+
+	usize ext_pos = strv_rfind(path, '.', 0);
+
+	if (dir) {
+		*dir = strv_sub(path, 0, dir_pos);
+	}
+	if (name) {
+		*name = strv_sub(path, dir_pos ? dir_pos + 1 : 0, ext_pos);
+	}
+	if (ext) {
+		*ext = strv_sub(path, ext_pos, SIZE_MAX);
+	}
+}
+
+bool os_file_putc(oshandle_t handle, char c) {
+	return os_file_write(handle, &c, sizeof(c)) == sizeof(c);
+}
+
+bool os_file_puts(oshandle_t handle, strview_t str) {
+	return os_file_write(handle, str.buf, str.len) == str.len;
+}
+
+bool os_file_print(arena_t scratch, oshandle_t handle, const char *fmt, ...) {
+	va_list args;
+	va_start(args, fmt);
+	bool result = os_file_printv(scratch, handle, fmt, args);
+	va_end(args);
+	return result;
+}	
+
+bool os_file_printv(arena_t scratch, oshandle_t handle, const char *fmt, va_list args) {
+	str_t s = str_fmtv(&scratch, fmt, args);
+	return os_file_puts(handle, strv(s));
+}
+
+usize os_file_read_buf(oshandle_t handle, buffer_t *buf) {
+	return os_file_read(handle, buf->data, buf->len);
+}
+
+usize os_file_write_buf(oshandle_t handle, buffer_t buf) {
+	return os_file_write(handle, buf.data, buf.len);
+}
+
+buffer_t os_file_read_all(arena_t *arena, strview_t path) {
+	oshandle_t fp = os_file_open(path, OS_FILE_READ);
+	if (!os_handle_valid(fp)) {
+		err("could not open file: %v", path);
+		return (buffer_t){0};
+	}
+	buffer_t out = os_file_read_all_fp(arena, fp);
+	os_file_close(fp);
+	return out;
+}
+
+buffer_t os_file_read_all_fp(arena_t *arena, oshandle_t handle) {
+	if (!os_handle_valid(handle)) return (buffer_t){0};
+	buffer_t out = {0};
+	
+	out.len = os_file_size(handle);
+	out.data = alloc(arena, u8, out.len);
+	usize read = os_file_read_buf(handle, &out);
+	
+	if (read != out.len) {
+		err("os_file_read_all_fp: read failed, should be %zu but is %zu", out.len, read);
+		arena_pop(arena, out.len);
+		return (buffer_t){0};
+	}
+	
+	return out;
+}
+
+os_file_view_t os_file_map(arena_t *arena, oshandle_t handle) {
+    os_file_view_t view = {0};
+    if (!os_handle_valid(handle)) {
+        return view;
+    }
+
+    if (os__file_map(handle, &view)) {
+        return view;
+    }
+
+    // can't map it, read it in chunks as we don't know the size
+    outstream_t out = ostr_init(arena);
+    char buffer[KB(10)] = {0};
+    while (true) {
+        usize read = os_file_read(handle, buffer, sizeof(buffer));
+        if (read == 0) {
+            break;
+        }
+        ostr_puts(&out, strv(buffer, read));
+    }
+    view.data = strv(ostr_to_str(&out));
+
+    return view;
+}
+
+void os_file_unmap(os_file_view_t *view) {
+    if (view->base) {
+        os__file_unmap(view);
+    }
+    *view = (os_file_view_t){0};
+}
+
+chunkstream_t chunk_init(arena_t *arena, oshandle_t handle, usize block_size) {
+    chunkstream_t cs = {
+        .handle = handle,
+        .arena = arena,
+    };
+
+    if (!os_handle_valid(handle)) {
+        cs.is_finished = true;
+        return cs;
+    }
+
+    if (os__file_map(handle, &cs.view)) {
+        cs.buf = (char *)cs.view.data.buf;
+        cs.cap = cs.end = cs.view.data.len;
+        cs.is_finished = true;
+        return cs;
+    }
+
+    cs.cap = block_size ? block_size : COLLA_CHUNK_BLOCK_SIZE;
+    cs.buf = alloc(arena, char, cs.cap, ALLOC_NOZERO);
+    return cs;
+}
+
+void chunk_cleanup(chunkstream_t *cs) {
+    os_file_unmap(&cs->view);
+    *cs = (chunkstream_t){0};
+}
+
+bool chunk_is_mapped(chunkstream_t *cs) {
+    return cs->view.base != NULL;
+}
+
+static bool chunk__fill(chunkstream_t *cs) {
+    if (cs->is_finished) {
+        return false;
+    }
+
+    usize remaining = cs->end - cs->beg;
+
+    // carry over the unread data
+    if (cs->beg > 0) {
+        memmove(cs->buf, cs->buf + cs->beg, remaining);
+        cs->beg = 0;
+        cs->end = remaining;
+    }
+
+    // a single record is bigger than the whole buffer
+    if (cs->end == cs->cap) {
+        usize new_cap = cs->cap * 2;
+        char *new_buf = alloc(cs->arena, char, new_cap, ALLOC_NOZERO);
+        memcpy(new_buf, cs->buf, cs->end);
+        cs->buf = new_buf;
+        cs->cap = new_cap;
+    }
+
+    // a single read, os_file_read would wait on a pipe until the buffer is full
+    usize read = os__file_read_some(cs->handle, cs->buf + cs->end, cs->cap - cs->end);
+    if (read == 0) {
+        cs->is_finished = true;
+        return false;
+    }
+
+    cs->end += read;
+    return true;
+}
+
+static strview_t chunk__consume(chunkstream_t *cs, usize len, usize skip) {
+    strview_t out = strv(cs->buf + cs->beg, len);
+    cs->beg += len + skip;
+    cs->offset += len + skip;
+    return out;
+}
+
+bool chunk_get_line(chunkstream_t *cs, strview_t *line) {
+    if (!chunk_get_delim(cs, '\n', line)) {
+        return false;
+    }
+    if (line->len && line->buf[line->len - 1] == '\r') {
+        line->len--;
+    }
+    return true;
+}
+
+bool chunk_get_delim(chunkstream_t *cs, char delim, strview_t *record) {
+    // only look at the new data after a refill
+    usize scanned = 0;
+
+    while (true) {
+        const char *start = cs->buf + cs->beg;
+        usize available = cs->end - cs->beg;
+
+        usize found = scan_find(strv(start + scanned, available - scanned), delim);
+        if (found != STR_NONE) {
+            *record = chunk__consume(cs, scanned + found, 1);
+            cs->terminated = true;
+            return true;
+        }
+
+        scanned = available;
+
+        if (!chunk__fill(cs)) {
+            if (available == 0) {
+                return false;
+            }
+            *record = chunk__consume(cs, available, 0);
+            cs->terminated = false;
+            return true;
+        }
+    }
+}
+
+bool chunk_get_fixed(chunkstream_t *cs, usize size, strview_t *record) {
+    while ((cs->end - cs->beg) < size && chunk__fill(cs)) {
+        // keep reading
+    }
+
+    usize available = cs->end - cs->beg;
+    if (available == 0) {
+        return false;
+    }
+
+    usize len = MIN(available, size);
+    *record = chunk__consume(cs, len, 0);
+    cs->terminated = len == size;
+    return true;
+}
+
+bool chunk_get_any(chunkstream_t *cs, strview_t *record) {
+    // at most one read, so a pipe that only has a few bytes doesn't block
+    if (cs->end == cs->beg && !chunk__fill(cs)) {
+        return false;
+    }
+
+    *record = chunk__consume(cs, cs->end - cs->beg, 0);
+    cs->terminated = true;
+    return true;
+}
+
+str_t os_file_read_all_str(arena_t *arena, strview_t path) {
+	oshandle_t fp = os_file_open(path, OS_FILE_READ);
+	if (!os_handle_valid(fp)) {
+		err("could not open file %v: %v", path, os_get_error_string(os_get_last_error()));
+		return STR_EMPTY;
+	}
+	str_t out = os_file_read_all_str_fp(arena, fp);
+	os_file_close(fp);
+	return out;
+}
+
+str_t os_file_read_all_str_fp(arena_t *arena, oshandle_t handle) {
+	if (!os_handle_valid(handle)) {
+		return STR_EMPTY;	
+	}
+	
+	str_t out = STR_EMPTY;
+	
+	out.len = os_file_size(handle);
+	out.buf = alloc(arena, u8, out.len + 1);
+	
+	usize read = os_file_read(handle, out.buf, out.len);
+	if (read != out.len) {
+		err("os_file_read_all_str_fp: read failed, should be %zu but is %zu", out.len, read);
+		arena_pop(arena, out.len + 1);	
+		return STR_EMPTY;
+	}
+	
+	return out;
+}
+
+bool os_file_write_all(strview_t name, buffer_t buffer) {
+	oshandle_t fp = os_file_open(name, OS_FILE_WRITE);
+	bool result = os_file_write_all_fp(fp, buffer);
+	os_file_close(fp);
+	return result;
+}
+
+bool os_file_write_all_fp(oshandle_t handle, buffer_t buffer) {
+	return os_file_write(handle, buffer.data, buffer.len) == buffer.len;
+}
+
+bool os_file_write_all_str(strview_t name, strview_t data) {
+	oshandle_t fp = os_file_open(name, OS_FILE_WRITE);
+	bool result = os_file_write_all_str_fp(fp, data);
+	os_file_close(fp);
+	return result;
+}
+
+bool os_file_write_all_str_fp(oshandle_t handle, strview_t data) {
+	return os_file_write(handle, data.buf, data.len) == data.len;
+}
+
+u64 os_file_time(strview_t path) {
+	oshandle_t fp = os_file_open(path, OS_FILE_READ);
+	u64 result = os_file_time_fp(fp);
+	os_file_close(fp);
+	return result;
+}
+
+bool os_file_has_changed(strview_t path, u64 last_change) {
+	u64 timestamp = os_file_time(path);
+	return timestamp > last_change;
+}
+
+// == PROCESS ===================================
+
+bool os_run_cmd(arena_t scratch, os_cmd_t *cmd, os_cmd_options_t *options) {
+	oshandle_t proc = os_run_cmd_async(scratch, cmd, options);
+	return os_handle_valid(proc) ? os_process_wait(proc, OS_WAIT_INFINITE, NULL) : false;
+}
+
+// == VMEM ======================================
+
+usize os_pad_to_page(usize byte_count) {
+	usize page_size = os_get_system_info().page_size;
+
+    if (byte_count == 0) {
+        return page_size;
+    }
+
+    usize padding = page_size - (byte_count & (page_size - 1));
+    if (padding == page_size) {
+        padding = 0;
+    }
+    return byte_count + padding;
+}
+
+// == THREAD ====================================
+
+void os_barrier_sync(os_barrier_t *b) {
+    i64 generation = atomic_get_i64(&b->generation);
+
+    // last one in, reset the counter before releasing everyone so 
+    // the next barrier starts from zero
+    if (atomic_inc_i64(&b->thread_value) == b->thread_count) {
+        atomic_set_i64(&b->thread_value, 0);
+        atomic_inc_i64(&b->generation);
+        os__wake_all_on_address(&b->generation);
+        return;
+    }
+
+    // most of the time the other threads are not far behind, 
+    // so spin for a bit before going to sleep
+    for (int i = 0; i < COLLA_BARRIER_SPIN_COUNT; ++i) {
+        if (atomic_get_i64(&b->generation) != generation) {
+            return;
+        }
+        os__cpu_pause();
+    }
+
+    while (atomic_get_i64(&b->generation) == generation) {
+        os__wait_on_address(&b->generation, generation);
+    }
+}
+
+i64range_t os_lane_range(u64 values_count) {
+    i64 thread_id = os_thread_id;
+    i64 thread_count = os_thread_count;
+
+    i64 values_per_thread = values_count / thread_count;
+    i64 leftover_values_count = values_count % thread_count;
+    bool thread_has_leftover = thread_id < leftover_values_count;
+    i64 leftover_before_this_thread_id = thread_has_leftover ?
+        thread_id : leftover_values_count;
+    i64 thread_first_value = 
+        values_per_thread * thread_id + leftover_before_this_thread_id;
+    i64 thread_last_value =
+        thread_first_value + values_per_thread + thread_has_leftover;
+
+    return (i64range_t){ thread_first_value, thread_last_value };
+}
+
+#if !COLLA_NO_CONDITION_VARIABLE
+
+// == JOB QUEUE =================================
+
+typedef struct jq__ring_t jq__ring_t;
+struct jq__ring_t {
+    i64 mask;
+    job_t **jobs;
+};
+
+// chase-lev deque, only the owner touches bottom and pushes/pops
+// from there, thieves take jobs from top
+struct jq_worker_t {
+    i64 top;
+    // keep top and bottom on different cache lines so that thieves
+    // don't keep invalidating the owner's line
+    u8 padding0[56];
+    i64 bottom;
+    i64 ring; // jq__ring_t *
+    job_t *freelist;
+    job_queue_t *queue;
+    int index;
+    u8 padding1[20];
+};
+
+thread_local jq_worker_t *jq__self = NULL;
+thread_local jq_group_t *jq__group = NULL;
+// jobs running on this thread, more than one when a job waits on a group
+thread_local int jq__depth = 0;
+
+jq_worker_t *jq__get_self(job_queue_t *q) {
+    return jq__self && jq__self->queue == q ? jq__self : NULL;
+}
+
+jq__ring_t *jq__ring_make(arena_t *arena, i64 size) {
+    jq__ring_t *ring = alloc(arena, jq__ring_t);
+    ring->mask = size - 1;
+    ring->jobs = alloc(arena, job_t *, size, ALLOC_NOZERO);
+    return ring;
+}
+
+// the old ring is never freed, a thief could still be reading from it
+jq__ring_t *jq__ring_grow(arena_t *arena, jq__ring_t *ring, i64 top, i64 bottom) {
+    jq__ring_t *new_ring = jq__ring_make(arena, (ring->mask + 1) * 2);
+    for (i64 i = top; i < bottom; ++i) {
+        new_ring->jobs[i & new_ring->mask] = ring->jobs[i & ring->mask];
+    }
+    return new_ring;
+}
+
+void jq__deque_push(arena_t *arena, jq_worker_t *w, job_t *job) {
+    i64 bottom = w->bottom;
+    i64 top = atomic_get_i64(&w->top);
+    jq__ring_t *ring = (jq__ring_t *)w->ring;
+
+    if ((bottom - top) > ring->mask) {
+        ring = jq__ring_grow(arena, ring, top, bottom);
+        atomic_set_i64(&w->ring, (i64)ring);
+    }
+
+    ring->jobs[bottom & ring->mask] = job;
+    atomic_set_i64(&w->bottom, bottom + 1);
+}
+
+job_t *jq__deque_pop(jq_worker_t *w) {
+    i64 bottom = w->bottom - 1;
+    jq__ring_t *ring = (jq__ring_t *)w->ring;
+    atomic_set_i64(&w->bottom, bottom);
+    i64 top = atomic_get_i64(&w->top);
+
+    if (top > bottom) {
+        // empty
+        atomic_set_i64(&w->bottom, bottom + 1);
+        return NULL;
+    }
+
+    job_t *job = ring->jobs[bottom & ring->mask];
+
+    if (top == bottom) {
+        // last job, race against the thieves for it
+        if (atomic_cmp_i64(&w->top, top + 1, top) != top) {
+            job = NULL;
+        }
+        atomic_set_i64(&w->bottom, bottom + 1);
+    }
+
+    return job;
+}
+
+job_t *jq__deque_steal(jq_worker_t *w) {
+    i64 top = atomic_get_i64(&w->top);
+    i64 bottom = atomic_get_i64(&w->bottom);
+
+    if (top >= bottom) {
+        return NULL;
+    }
+
+    jq__ring_t *ring = (jq__ring_t *)atomic_get_i64(&w->ring);
+    job_t *job = ring->jobs[top & ring->mask];
+
+    if (atomic_cmp_i64(&w->top, top + 1, top) != top) {
+        // someone else got it first
+        return NULL;
+    }
+
+    return job;
+}
+
+job_t *jq__pop_injected(job_queue_t *q) {
+    if (atomic_get_i64(&q->injected_count) == 0) {
+        return NULL;
+    }
+
+    job_t *job = NULL;
+    os_mutex_lock(q->mutex);
+        job = q->jobs;
+        if (job) {
+            list_pop(q->jobs);
+            atomic_dec_i64(&q->injected_count);
+        }
+    os_mutex_unlock(q->mutex);
+    return job;
+}
+
+job_t *jq__steal(job_queue_t *q, jq_worker_t *self) {
+    int slot_count = jq_slot_count(q);
+    int start = self ? self->index + 1 : 0;
+    for (int i = 0; i < slot_count; ++i) {
+        jq_worker_t *victim = &q->workers[(start + i) % slot_count];
+        if (victim == self) {
+            continue;
+        }
+        job_t *job = jq__deque_steal(victim);
+        if (job) {
+            return job;
+        }
+    }
+    return NULL;
+}
+
+job_t *jq__try_pop(job_queue_t *q, jq_worker_t *self) {
+    job_t *job = self ? jq__deque_pop(self) : NULL;
+    if (!job) job = jq__pop_injected(q);
+    if (!job) job = jq__steal(q, self);
+    return job;
+}
+
+bool jq__has_work(job_queue_t *q) {
+    if (atomic_get_i64(&q->injected_count) > 0) {
+        return true;
+    }
+    for (int i = 0; i < jq_slot_count(q); ++i) {
+        jq_worker_t *w = &q->workers[i];
+        if (atomic_get_i64(&w->bottom) > atomic_get_i64(&w->top)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool jq__is_done(job_queue_t *q) {
+    return atomic_get_i64(&q->should_stop) ||
+        (atomic_get_i64(&q->stop_when_finished) && atomic_get_i64(&q->pending) == 0);
+}
+
+void jq__wake_one(job_queue_t *q) {
+    if (atomic_get_i64(&q->sleeping) > 0) {
+        os_mutex_lock(q->mutex);
+            // the signal could go to a thread that won't take the job
+            if (atomic_get_i64(&q->waiting) > 0) {
+                os_cond_broadcast(q->condvar);
+            }
+            else {
+                os_cond_signal(q->condvar);
+            }
+        os_mutex_unlock(q->mutex);
+    }
+}
+
+void jq__wake_all(job_queue_t *q) {
+    os_mutex_lock(q->mutex);
+        os_cond_broadcast(q->condvar);
+    os_mutex_unlock(q->mutex);
+}
+
+void jq__run_job(job_queue_t *q, jq_worker_t *self, job_t *job) {
+    jq_group_t *group = job->group;
+    jq_group_t *prev_group = jq__group;
+
+    // give the scratch arenas back as the job found them, otherwise
+    // a long running queue keeps growing them with every job
+    usize scratch_pos[COLLA_SCRATCH_COUNT];
+    for (int i = 0; i < COLLA_SCRATCH_COUNT; ++i) {
+        scratch_pos[i] = arena_tell(&scratch__pool[i]);
+    }
+
+    jq__group = group;
+    jq__depth++;
+    job->func(job->userdata);
+    jq__depth--;
+    jq__group = prev_group;
+
+    // only a worker that isn't inside another job knows that nothing past the
+    // position is still in use, a helping thread or an outer job could have copies
+    bool can_trim = jq__depth == 0 && self && self != &q->workers[q->thread_count];
+    for (int i = 0; i < COLLA_SCRATCH_COUNT; ++i) {
+        arena_rewind(&scratch__pool[i], scratch_pos[i]);
+        if (can_trim) {
+            arena_trim(&scratch__pool[i]);
+        }
+    }
+
+    if (self) {
+        list_push(self->freelist, job);
+    }
+    else {
+        os_mutex_lock(q->mutex);
+            list_push(q->freelist, job);
+        os_mutex_unlock(q->mutex);
+    }
+
+    bool should_wake = false;
+    // don't touch the group after this, the waiter could be gone already
+    if (group && atomic_dec_i64(&group->pending) == 0) {
+        should_wake = true;
+    }
+    if (atomic_dec_i64(&q->pending) == 0 && atomic_get_i64(&q->stop_when_finished)) {
+        should_wake = true;
+    }
+    if (should_wake) {
+        jq__wake_all(q);
+    }
+}
+
+void jq__push(arena_t *arena, job_queue_t *queue, jq_group_t *group, job_func_f *func, void *userdata) {
+    jq_worker_t *self = jq__get_self(queue);
+
+    // count it before it's visible, otherwise a worker could finish it
+    // and see no pending jobs while the parent is still running
+    atomic_inc_i64(&queue->pending);
+    if (group) {
+        atomic_inc_i64(&group->pending);
+    }
+
+    if (self) {
+        job_t *job = self->freelist;
+        if (job) {
+            list_pop(self->freelist);
+        }
+        else {
+            job = alloc(arena, job_t);
+        }
+        job->func = func;
+        job->userdata = userdata;
+        job->group = group;
+        jq__deque_push(arena, self, job);
+    }
+    else {
+        os_mutex_lock(queue->mutex);
+            job_t *job = queue->freelist;
+            list_pop(queue->freelist);
+            if (!job) {
+                job = alloc(arena, job_t);
+            }
+            job->func = func;
+            job->userdata = userdata;
+            job->group = group;
+            list_push(queue->jobs, job);
+            atomic_inc_i64(&queue->injected_count);
+        os_mutex_unlock(queue->mutex);
+    }
+
+    jq__wake_one(queue);
+}
+
+int jq__worker_function(u64 thread_id, void *udata) {
+    COLLA_UNUSED(thread_id);
+    jq_worker_t *self = udata;
+    job_queue_t *q = self->queue;
+    jq__self = self;
+
+    while (true) {
+        job_t *job = jq_pop_job(q);
+        if (!job) {
+            break;
+        }
+        jq__run_job(q, self, job);
+    }
+
+    jq__self = NULL;
+    return 0;
+}
+
+job_queue_t *jq_init(arena_t *arena, int worker_count) {
+    job_queue_t *q = alloc(arena, job_queue_t);
+    q->mutex = os_mutex_create();
+    q->condvar = os_cond_create();
+    q->thread_count = worker_count ? worker_count : os_get_system_info().processor_count;
+    q->threads = alloc(arena, oshandle_t, q->thread_count);
+    q->workers = alloc(arena, jq_worker_t, jq_slot_count(q));
+
+    for (int i = 0; i < jq_slot_count(q); ++i) {
+        jq_worker_t *w = &q->workers[i];
+        w->queue = q;
+        w->index = i;
+        w->ring = (i64)jq__ring_make(arena, COLLA_JQ_DEQUE_SIZE);
+    }
+
+    for (int i = 0; i < q->thread_count; ++i) {
+        q->threads[i] = os_thread_launch(jq__worker_function, &q->workers[i]);
+    }
+
+    return q;
+}
+
+void jq_stop(job_queue_t *queue) {
+    atomic_set_i64(&queue->should_stop, true);
+    jq__wake_all(queue);
+
+    for (int i = 0; i < queue->thread_count; ++i) {
+        os_thread_join(queue->threads[i], NULL);
+    }
+
+    os_mutex_free(queue->mutex);
+    os_cond_free(queue->condvar);
+}
+
+void jq_cleanup(job_queue_t *queue) {
+    atomic_set_i64(&queue->stop_when_finished, true);
+    jq__wake_all(queue);
+
+    for (int i = 0; i < queue->thread_count; ++i) {
+        os_thread_join(queue->threads[i], NULL);
+    }
+
+    os_mutex_free(queue->mutex);
+    os_cond_free(queue->condvar);
+}
+
+void jq_push(arena_t *arena, job_queue_t *queue, job_func_f *func, void *userdata) {
+    jq__push(arena, queue, NULL, func, userdata);
+}
+
+job_t *jq_pop_job(job_queue_t *queue) {
+    jq_worker_t *self = jq__get_self(queue);
+
+    while (!jq__is_done(queue)) {
+        job_t *job = jq__try_pop(queue, self);
+        if (job) {
+            return job;
+        }
+
+        // nothing to do, park until someone pushes a job. sleeping is 
+        // incremented before checking for work so that a push either
+        // sees us sleeping or we see its job
+        os_mutex_lock(queue->mutex);
+            atomic_inc_i64(&queue->sleeping);
+            while (!jq__has_work(queue) && !jq__is_done(queue)) {
+                os_cond_wait(queue->condvar, queue->mutex, OS_WAIT_INFINITE);
+            }
+            atomic_dec_i64(&queue->sleeping);
+        os_mutex_unlock(queue->mutex);
+    }
+
+    return NULL;
+}
+
+jq_group_t *jq_group_create(arena_t *arena, job_queue_t *queue) {
+    jq_group_t *group = alloc(arena, jq_group_t);
+    group->queue = queue;
+    return group;
+}
+
+void jq_group_push(arena_t *arena, jq_group_t *group, job_func_f *func, void *userdata) {
+    jq__push(arena, group->queue, group, func, userdata);
+}
+
+void jq_group_wait(jq_group_t *group) {
+    job_queue_t *q = group->queue;
+    jq_worker_t *self = jq__get_self(q);
+    jq_worker_t *prev_self = jq__self;
+    bool is_helper = false;
+
+    // a thread outside the pool runs jobs from the spare slot, otherwise
+    // it would share its os_thread_id with one of the workers
+    if (!self && atomic_cmp_i64(&q->helper_busy, true, false) == false) {
+        self = &q->workers[q->thread_count];
+        jq__self = self;
+        is_helper = true;
+    }
+    if (!self) {
+        atomic_inc_i64(&q->waiting);
+    }
+
+    while (atomic_get_i64(&group->pending) > 0) {
+        if (atomic_get_i64(&q->should_stop)) {
+            break;
+        }
+
+        // help out instead of just waiting
+        job_t *job = self ? jq__try_pop(q, self) : NULL;
+        if (job) {
+            jq__run_job(q, self, job);
+            continue;
+        }
+
+        // the group's jobs are all running on other threads
+        os_mutex_lock(q->mutex);
+            atomic_inc_i64(&q->sleeping);
+            while (
+                !(self && jq__has_work(q)) && 
+                atomic_get_i64(&group->pending) > 0 &&
+                !atomic_get_i64(&q->should_stop)
+            ) {
+                os_cond_wait(q->condvar, q->mutex, OS_WAIT_INFINITE);
+            }
+            atomic_dec_i64(&q->sleeping);
+        os_mutex_unlock(q->mutex);
+    }
+
+    if (!self) {
+        atomic_dec_i64(&q->waiting);
+    }
+    if (is_helper) {
+        // jobs left in the slot's deque can still be stolen by the workers
+        jq__self = prev_self;
+        atomic_set_i64(&q->helper_busy, false);
+    }
+}
+
+jq_group_t *jq_current_group(void) {
+    return jq__group;
+}
+
+int jq_slot_count(job_queue_t *queue) {
+    return queue->thread_count + 1;
+}
+
+int jq_worker_index(void) {
+    return jq__self ? jq__self->index : -1;
+}
+
+#endif
+
+// == INI ============================================
+
+void ini__parse(arena_t *arena, ini_t *ini, const iniopt_t *options);
+void ini__load_table(arena_t *arena, ini_t *ini, initable_t *table);
+void ini__add_values(arena_t *arena, initable_t *table, instream_t *in, iniopt_t *options);
+inivalue_t *ini__find_value(arena_t *arena, initable_t *table, strview_t key);
+
+ini_t ini_parse(arena_t *arena, strview_t filename, iniopt_t *opt) {
+    oshandle_t fp = os_file_open(filename, OS_FILE_READ);
+    ini_t out = ini_parse_fp(arena, fp, opt);
+    os_file_close(fp);
+    return out;
+}
+
+ini_t ini_parse_fp(arena_t *arena, oshandle_t file, iniopt_t *opt) {
+    str_t data = os_file_read_all_str_fp(arena, file);
+    return ini_parse_str(arena, strv(data), opt);
+}
+
+ini_t ini_parse_str(arena_t *arena, strview_t str, iniopt_t *opt) {
+    ini_t out = {
+        .text = str,
+        .tables = NULL,
+    };
+    ini__parse(arena, &out, opt);
+    return out;
+}
+
+bool ini_is_valid(ini_t *ini) {
+    return ini && !strv_is_empty(ini->text);
+}
+
+initable_t *ini_get_table(arena_t *arena, ini_t *ini, strview_t name) {
+    hmap_entry_t *entry = ini ? hmap_get(&ini->index, name) : NULL;
+    if (!entry) {
+        return NULL;
+    }
+    initable_t *table = entry->value;
+    ini__load_table(arena, ini, table);
+    return table;
+}
+
+initable_t *ini_load_table(arena_t *arena, ini_t *ini, initable_t *table) {
+    if (table) {
+        ini__load_table(arena, ini, table);
+    }
+    return table;
+}
+
+inivalue_t *ini_get(arena_t *arena, initable_t *table, strview_t key) {
+    return table ? ini__find_value(arena, table, key) : NULL;
+}
+
+iniarray_t ini_as_arr(arena_t *arena, inivalue_t *value, char delim) {
+    strview_t v = value ? value->value : STRV_EMPTY;
+    if (!delim) delim = ' ';
+
+    strview_t *beg = (strview_t *)arena->cur;
+    usize count = 0;
+
+    usize start = 0;
+    for (usize i = 0; i < v.len; ++i) {
+        if (v.buf[i] == delim) {
+            strview_t arrval = strv_trim(strv_sub(v, start, i));
+            if (!strv_is_empty(arrval)) {
+                strview_t *newval = alloc(arena, strview_t);
+                *newval = arrval;
+                ++count;
+            }
+            start = i + 1;
+        }
+    }
+
+    strview_t last = strv_trim(strv_sub(v, start, SIZE_MAX));
+    if (!strv_is_empty(last)) {
+        strview_t *newval = alloc(arena, strview_t);
+        *newval = last;
+        ++count;
+    }
+
+    return (iniarray_t){
+        .values = beg,
+        .count = count,
+    };
+}
+
+u64 ini_as_uint(inivalue_t *value) {
+    strview_t v = value ? value->value : STRV_EMPTY;
+    instream_t in = istr_init(v);
+    u64 out = 0;
+    if (!istr_get_u64(&in, &out)) {
+        out = 0;
+    }
+    return out;
+}
+
+i64 ini_as_int(inivalue_t *value) {
+    strview_t v = value ? value->value : STRV_EMPTY;
+    instream_t in = istr_init(v);
+    i64 out = 0;
+    if (!istr_get_i64(&in, &out)) {
+        out = 0;
+    }
+    return out;
+}
+
+double ini_as_num(inivalue_t *value) {
+    strview_t v = value ? value->value : STRV_EMPTY;
+    instream_t in = istr_init(v);
+    double out = 0;
+    if (!istr_get_num(&in, &out)) {
+        out = 0;
+    }
+    return out;
+}
+
+bool ini_as_bool(inivalue_t *value) {
+    strview_t v = value ? value->value : STRV_EMPTY;
+    instream_t in = istr_init(v);
+    bool out = 0;
+    if (!istr_get_bool(&in, &out)) {
+        out = 0;
+    }
+    return out;
+}
+
+void ini_pretty_print(ini_t *ini, const ini_pretty_opts_t *options) {
+    ini_pretty_opts_t opt = {0};
+    if (options) {
+        memmove(&opt, options, sizeof(ini_pretty_opts_t));
+    }
+
+    if (!os_handle_valid(opt.custom_target)) {
+        opt.custom_target = os_stdout();
+    }
+
+    if (!opt.use_custom_colours) {
+        os_log_colour_e default_col[INI_PRETTY_COLOUR__COUNT] = {
+            LOG_COL_YELLOW, // INI_PRETTY_COLOUR_KEY,
+            LOG_COL_GREEN,  // INI_PRETTY_COLOUR_VALUE,
+            LOG_COL_WHITE,  // INI_PRETTY_COLOUR_DIVIDER,
+            LOG_COL_RED,    // INI_PRETTY_COLOUR_TABLE,
+        };
+        memmove(opt.colours, default_col, sizeof(default_col));
+    }
+
+    arena_temp_t scratch = scratch_begin();
+
+    for_each (table, ini->tables) {
+        // lazy tables are parsed in a copy, the ini doesn't keep values from the scratch arena
+        initable_t lazy = {0};
+        initable_t *t = table;
+        if (!strv_is_empty(table->lazy_body)) {
+            instream_t in = istr_init(table->lazy_body);
+            ini__add_values(scratch.arena, &lazy, &in, &ini->opts);
+            lazy.name = table->name;
+            t = &lazy;
+        }
+
+        if (!strv_equals(t->name, INI_ROOT)) {
+            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_TABLE]);
+            os_file_puts(opt.custom_target, strv("["));
+            os_file_puts(opt.custom_target, t->name);
+            os_file_puts(opt.custom_target, strv("]\n"));
+        }
+
+        for_each (pair, t->values) {
+            if (strv_is_empty(pair->key) || strv_is_empty(pair->value)) continue;
+            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_KEY]);
+            os_file_puts(opt.custom_target, pair->key);
+
+            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_DIVIDER]);
+            os_file_puts(opt.custom_target, strv(" = "));
+
+            os_log_set_colour(opt.colours[INI_PRETTY_COLOUR_VALUE]);
+            os_file_puts(opt.custom_target, pair->value);
+            
+            os_file_puts(opt.custom_target, strv("\n"));
+        }
+    }
+
+    scratch_end(&scratch);
+    os_log_set_colour(LOG_COL_RESET);
+}
+
+///// ini-private ////////////////////////////////////
+
+iniopt_t ini__get_options(const iniopt_t *options) {
+    iniopt_t out = {
+        .key_value_divider = '=',
+        .comment_vals = strv(";#"),
+    };
+
+#define SETOPT(v) out.v = options->v ? options->v : out.v
+
+    if (options) {
+        SETOPT(key_value_divider);
+        SETOPT(merge_duplicate_keys);
+        SETOPT(merge_duplicate_tables);
+        SETOPT(lazy_tables);
+        out.comment_vals = strv_is_empty(options->comment_vals) ? out.comment_vals : options->comment_vals;
+    }
+
+#undef SETOPT
+
+    return out;
+}
+
+void ini__add_value(arena_t *arena, initable_t *table, instream_t *in, iniopt_t *opts) {
+    colla_assert(table);
+
+    strview_t key = strv_trim(istr_get_view(in, opts->key_value_divider));
+    istr_skip(in, 1);
+
+    strview_t value = strv_trim(istr_get_view(in, '\n'));
+    usize comment_pos = strv_find_either(value, opts->comment_vals, 0);
+    if (comment_pos != STR_NONE) {
+        value = strv_sub(value, 0, comment_pos);
+    }
+    istr_skip(in, 1);
+
+    if (opts->merge_duplicate_keys) {
+        inivalue_t *oldval = ini__find_value(arena, table, key);
+        if (oldval) {
+            oldval->value = value;
+            return;
+        }
+    }
+
+    inivalue_t *newval = alloc(arena, inivalue_t);
+    newval->key = key;
+    newval->value = value;
+
+    if (!table->values) {
+        table->values = newval;
+    }
+    else {
+        table->tail->next = newval;
+    }
+
+    table->tail = newval;
+    table->count++;
+
+    // ini_get returns the first one of duplicate keys. the index only keeps the
+    // arena while it's being changed, so it can't be left with one that's gone
+    if (table->keys.cap && !hmap_get(&table->keys, key)) {
+        table->keys.arena = arena;
+        hmap_set(&table->keys, key, newval);
+        table->keys.arena = NULL;
+    }
+}
+
+inivalue_t *ini__find_value(arena_t *arena, initable_t *table, strview_t key) {
+    if (table->count < COLLA_INI_INDEX_MIN || (!arena && !table->keys.cap)) {
+        for_each (v, table->values) {
+            if (strv_equals(v->key, key)) {
+                return v;
+            }
+        }
+        return NULL;
+    }
+
+    if (!table->keys.cap) {
+        table->keys = hmap_init(arena, table->count);
+        for_each (v, table->values) {
+            if (!hmap_get(&table->keys, v->key)) {
+                hmap_set(&table->keys, v->key, v);
+            }
+        }
+        table->keys.arena = NULL;
+    }
+
+    hmap_entry_t *entry = hmap_get(&table->keys, key);
+    return entry ? entry->value : NULL;
+}
+
+// a table goes on until an empty line
+void ini__add_values(arena_t *arena, initable_t *table, instream_t *in, iniopt_t *options) {
+    while (!istr_is_finished(in)) {
+        switch (istr_peek(in)) {
+            case '\n': // fallthrough
+            case '\r':
+                return;
+            case '#':  // fallthrough
+            case ';':
+                istr_ignore_and_skip(in, '\n');
+                break;
+            default:
+                ini__add_value(arena, table, in, options);
+                break;
+        }
+    }
+}
+
+void ini__skip_values(instream_t *in) {
+    while (!istr_is_finished(in)) {
+        char c = istr_peek(in);
+        if (c == '\n' || c == '\r') {
+            return;
+        }
+        istr_ignore_and_skip(in, '\n');
+    }
+}
+
+void ini__load_table(arena_t *arena, ini_t *ini, initable_t *table) {
+    if (strv_is_empty(table->lazy_body)) {
+        return;
+    }
+    colla_assert(arena, "lazy table [%v] needs an arena to be parsed in", table->name);
+    instream_t in = istr_init(table->lazy_body);
+    table->lazy_body = STRV_EMPTY;
+    ini__add_values(arena, table, &in, &ini->opts);
+}
+
+void ini__add_table(arena_t *arena, ini_t *ctx, instream_t *in, iniopt_t *options) {
+    istr_skip(in, 1); // skip [
+    strview_t name = istr_get_view(in, ']');
+    istr_skip(in, 1); // skip ]
+
+    u64 hash = hmap_hash(name);
+    hmap_entry_t *entry = hmap_get_hashed(&ctx->index, name, hash);
+    initable_t *table = NULL;
+
+    if (entry && options->merge_duplicate_tables) {
+        table = entry->value;
+        // the new values have to go after the old ones
+        ini__load_table(arena, ctx, table);
+    }
+    else {
+        table = alloc(arena, initable_t);
+        table->name = name;
+
+        if (!ctx->tables) {
+            ctx->tables = table;
+        }
+        else {
+            ctx->tail->next = table;
+        }
+
+        ctx->tail = table;
+
+        // ini_get_table returns the first one of duplicate tables
+        if (!entry) {
+            hmap_set_hashed(&ctx->index, name, hash, table);
+        }
+    }
+
+    istr_ignore_and_skip(in, '\n');
+
+    // a table that already has values is parsed now to keep them in order
+    if (options->lazy_tables && !table->values) {
+        const char *start = in->cur;
+        ini__skip_values(in);
+        table->lazy_body = strv_init_len(start, in->cur - start);
+        return;
+    }
+
+    ini__add_values(arena, table, in, options);
+}
+
+void ini__parse(arena_t *arena, ini_t *ini, const iniopt_t *options) {
+    ini->opts = ini__get_options(options);
+    iniopt_t opts = ini->opts;
+
+    initable_t *root = alloc(arena, initable_t);
+    root->name = INI_ROOT;
+    ini->tables = root;
+    ini->tail = root;
+    ini->index = hmap_init(arena, 0);
+    hmap_set(&ini->index, root->name, root);
+
+    instream_t in = istr_init(ini->text);
+
+    while (!istr_is_finished(&in)) {
+        istr_skip_whitespace(&in);
+        switch (istr_peek(&in)) {
+            case '[':
+                ini__add_table(arena, ini, &in, &opts);
+                break;
+            case '#': // fallthrough
+            case ';':
+                istr_ignore_and_skip(&in, '\n');
+                break;
+            default:
+                ini__add_value(arena, ini->tables, &in, &opts);
+                break;
+        }
+    }
+
+    // the names only change while parsing, the arena may be gone after
+    ini->index.arena = NULL;
+}
+
+// == JSON ===========================================
+
+struct json_index_t {
+    usize count;
+    // the ends of the children when they were counted, to notice new ones
+    json_t *first;
+    json_t *last;
+    json_t **items;
+    hmap_t keys;
+};
+
+bool json__parse_obj(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out, usize *count);
+bool json__parse_value(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out);
+void json__add_index(arena_t *arena, json_t *node, usize count);
+
+json_t *json_parse(arena_t *arena, strview_t filename, jsonflags_e flags) {
+    str_t data = os_file_read_all_str(arena, filename);
+    return json_parse_str(arena, strv(data), flags);
+}
+
+json_t *json_parse_str(arena_t *arena, strview_t str, jsonflags_e flags) {
+    arena_t before = *arena;
+
+    json_t *root = alloc(arena, json_t);
+    root->type = JSON_OBJECT;
+
+    instream_t in = istr_init(str);
+
+    if (flags & JSON_ONLY_OBJECT_START) {
+        usize count = 0;
+        if (!json__parse_obj(arena, &in, flags, &root->object, &count)) {
+            // reset arena
+            *arena = before;
+            return NULL;
+        }
+        json__add_index(arena, root, count);
+    }
+    else {
+        if (!json__parse_value(arena, &in, flags, &root)) {
+            *arena = before;
+            return NULL;
+        }
+    }
+    
+    return root;
+}
+
+// false if children were added at either end since they were counted,
+// then they are counted again and the items and keys are taken again
+static bool json__index_is_fresh(json_t *node, json_index_t *index) {
+    return index->first == node->object && (!index->last || !index->last->next);
+}
+
+static void json__index_count(json_t *node, json_index_t *index) {
+    index->items = NULL;
+    index->keys = (hmap_t){0};
+    index->count = 0;
+    index->first = node->object;
+    index->last = NULL;
+    for_each (child, node->object) {
+        index->last = child;
+        index->count++;
+    }
+}
+
+// NULL when there is no arena to build the items in, then the caller walks the children
+static json_index_t *json__get_items(arena_t *arena, json_t *node) {
+    json_index_t *index = node->index;
+    if (!json__index_is_fresh(node, index)) {
+        json__index_count(node, index);
+    }
+    if (!index->items) {
+        if (!arena || !index->count) {
+            return NULL;
+        }
+        index->items = alloc(arena, json_t *, index->count, ALLOC_NOZERO);
+        usize i = 0;
+        for_each (child, node->object) {
+            index->items[i++] = child;
+        }
+    }
+    return index;
+}
+
+json_t *json_get(arena_t *arena, json_t *node, strview_t key) {
+    if (!node) return NULL;
+
+    if (node->type != JSON_OBJECT) {
+        return NULL;
+    }
+
+    json_index_t *index = node->index ? json__get_items(arena, node) : NULL;
+    if (index) {
+        if (!index->keys.cap) {
+            // sized for every key so it never grows, and never uses the arena again
+            index->keys = hmap_init(arena, index->count);
+            // backwards so that the first of duplicate keys wins, like the linear search
+            for (usize i = index->count; i > 0; --i) {
+                hmap_set(&index->keys, index->items[i - 1]->key, index->items[i - 1]);
+            }
+            index->keys.arena = NULL;
+        }
+        hmap_entry_t *entry = hmap_get(&index->keys, key);
+        return entry ? entry->value : NULL;
+    }
+
+    node = node->object;
+
+    while (node) {
+        if (strv_equals(node->key, key)) {
+            return node;
+        }
+        node = node->next;
+    }
+
+    return NULL;
+}
+
+json_t *json_at(arena_t *arena, json_t *node, usize index) {
+    if (!node || (node->type != JSON_ARRAY && node->type != JSON_OBJECT)) {
+        return NULL;
+    }
+
+    json_index_t *items = node->index ? json__get_items(arena, node) : NULL;
+    if (items) {
+        return index < items->count ? items->items[index] : NULL;
+    }
+
+    // array and object share the same pointer
+    json_t *child = node->array;
+    for (usize i = 0; i < index && child; ++i) {
+        child = child->next;
+    }
+    return child;
+}
+
+usize json_len(json_t *node) {
+    if (!node || (node->type != JSON_ARRAY && node->type != JSON_OBJECT)) {
+        return 0;
+    }
+
+    if (node->index) {
+        if (!json__index_is_fresh(node, node->index)) {
+            json__index_count(node, node->index);
+        }
+        return node->index->count;
+    }
+
+    usize count = 0;
+    for_each (child, node->array) {
+        count++;
+    }
+    return count;
+}
+
+// the pretty printer walks either a json_t tree or a tape through this
+typedef struct json__cursor_t json__cursor_t;
+struct json__cursor_t {
+    json_t *node;
+    json_tape_t *tape;
+    usize index;
+};
+
+void json__pretty_print_value(json__cursor_t cursor, int indent, const json_pretty_opts_t *options);
+
+static json_pretty_opts_t json__pretty_options(const json_pretty_opts_t *options) {
+    json_pretty_opts_t default_options = { 0 };
+    if (options) {
+        memmove(&default_options, options, sizeof(json_pretty_opts_t));
+    }
+
+    if (!os_handle_valid(default_options.custom_target)) {
+        default_options.custom_target = os_stdout();
+    }
+    if (!default_options.use_custom_colours) {
+        os_log_colour_e default_col[JSON_PRETTY_COLOUR__COUNT] = {
+            LOG_COL_YELLOW,    // JSON_PRETTY_COLOUR_KEY,
+            LOG_COL_CYAN,      // JSON_PRETTY_COLOUR_STRING,
+            LOG_COL_BLUE,      // JSON_PRETTY_COLOUR_NUM,
+            LOG_COL_DARK_GREY, // JSON_PRETTY_COLOUR_NULL,
+            LOG_COL_GREEN,     // JSON_PRETTY_COLOUR_TRUE,
+            LOG_COL_RED,       // JSON_PRETTY_COLOUR_FALSE,
+        };
+        memmove(default_options.colours, default_col, sizeof(default_col));
+    }
+
+    return default_options;
+}
+
+void json_pretty_print(json_t *root, const json_pretty_opts_t *options) {
+    json_pretty_opts_t default_options = json__pretty_options(options);
+    json__pretty_print_value((json__cursor_t){ .node = root }, 0, &default_options);
+    os_file_putc(default_options.custom_target, '\n');
+}
+
+///// json-private ///////////////////////////////////
+
+#define json__ensure(c) json__check_char(in, c)
+
+bool json__check_char(instream_t *in, char c) {
+    if (istr_get(in) == c) {
+        return true;
+    }
+    istr_rewind_n(in, 1);
+    return false;
+}
+
+bool json__is_value_finished(instream_t *in) {
+    usize old_pos = istr_tell(in);
+    
+    istr_skip_whitespace(in);
+    switch(istr_peek(in)) {
+        case '}': // fallthrough
+        case ']': // fallthrough
+        case ',':
+            return true;
+    }
+
+    in->cur = in->beg + old_pos;
+    return false;
+}
+
+bool json__parse_null(instream_t *in) {
+    strview_t null_view = istr_get_view_len(in, 4);
+    bool is_valid = true;
+    
+    if (!strv_equals(null_view, strv("null"))) {
+        is_valid = false;
+    }
+
+    if (!json__is_value_finished(in)) {
+        is_valid = false;
+    }
+
+    return is_valid;
+}
+
+void json__add_index(arena_t *arena, json_t *node, usize count) {
+    if (count < COLLA_JSON_INDEX_MIN) {
+        return;
+    }
+    // the items are taken on the first query
+    node->index = alloc(arena, json_index_t);
+    json__index_count(node, node->index);
+}
+
+bool json__parse_array(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out, usize *count) {
+    json_t *head = NULL;
+    *count = 0;
+    
+    if (!json__ensure('[')) {
+        goto fail;
+    }
+
+    istr_skip_whitespace(in);
+
+    // if it is an empty array
+    if (istr_peek(in) == ']') {
+        istr_skip(in, 1);
+        goto success;
+    }
+    
+    if (!json__parse_value(arena, in, flags, &head)) {
+        goto fail;
+    }
+
+    json_t *cur = head;
+    *count = 1;
+    
+    while (true) {
+        istr_skip_whitespace(in);
+        switch (istr_get(in)) {
+            case ']':
+                goto success;
+            case ',':
+            {
+                istr_skip_whitespace(in);
+                // trailing comma
+                if (istr_peek(in) == ']') {
+                    if (flags & JSON_NO_TRAILING_COMMAS) {
+                        goto fail;
+                    }
+                    else {
+                        continue;
+                    }
+                }
+
+                json_t *next = NULL;
+                if (!json__parse_value(arena, in, flags, &next)) {
+                    goto fail;
+                }
+                cur->next = next;
+                next->prev = cur;
+                cur = next;
+                (*count)++;
+                break;
+            }
+            default:
+                istr_rewind_n(in, 1);
+                goto fail;
+        }
+    }
+
+success:
+    *out = head;
+    return true;
+fail:
+    *out = NULL;
+    return false;
+}
+
+bool json__parse_string(arena_t *arena, instream_t *in, strview_t *out) {
+    COLLA_UNUSED(arena);
+    *out = STRV_EMPTY;
+
+    istr_skip_whitespace(in); 
+
+    if (!json__ensure('"')) {
+        goto fail;
+    }
+
+    const char *from = in->cur;
+    
+    for (; !istr_is_finished(in) && *in->cur != '"'; ++in->cur) {
+        // a \ at the very end would skip past it
+        if (istr_peek(in) == '\\' && istr_remaining(in) > 1) {
+            ++in->cur;
+        }
+    }
+    
+    usize len = in->cur - from;
+
+    *out = strv(from, len);
+
+    if (!json__ensure('"')) {
+        goto fail;
+    }
+
+    return true;
+fail:
+    return false;
+}
+
+bool json__parse_pair(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
+    strview_t key = {0};
+    if (!json__parse_string(arena, in, &key)) {
+        goto fail;
+    }
+
+    // skip preamble
+    istr_skip_whitespace(in);
+    if (!json__ensure(':')) {
+        goto fail;
+    }
+
+    if (!json__parse_value(arena, in, flags, out)) {
+        goto fail;
+    }
+    
+    (*out)->key = key;
+    return true;
+
+fail: 
+    *out = NULL;
+    return false;
+}
+
+bool json__parse_obj(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out, usize *count) {
+    *count = 0;
+
+    if (!json__ensure('{')) {
+        goto fail;
+    }
+
+    istr_skip_whitespace(in);
+
+    // if it is an empty object
+    if (istr_peek(in) == '}') {
+        istr_skip(in, 1);
+        *out = NULL;
+        return true;
+    }
+
+    json_t *head = NULL;
+    if (!json__parse_pair(arena, in, flags, &head)) {
+        goto fail;
+    }
+    json_t *cur = head;
+    *count = 1;
+
+    while (true) {
+        istr_skip_whitespace(in);
+        switch (istr_get(in)) {
+            case '}':
+                goto success;
+            case ',':
+            {
+                istr_skip_whitespace(in);
+                // trailing commas
+                if (!(flags & JSON_NO_TRAILING_COMMAS) && istr_peek(in) == '}') {
+                    goto success;
+                }
+
+                json_t *next = NULL;
+                if (!json__parse_pair(arena, in, flags, &next)) {
+                    goto fail;
+                }
+                cur->next = next;
+                next->prev = cur;
+                cur = next;
+                (*count)++;
+                break;
+            }
+            default:
+                istr_rewind_n(in, 1);
+                goto fail;
+        }
+    }
+
+success:
+    *out = head;
+    return true;
+fail:
+    *out = NULL;
+    return false;
+}
+
+bool json__parse_value(arena_t *arena, instream_t *in, jsonflags_e flags, json_t **out) {
+    json_t *val = alloc(arena, json_t);
+    usize count = 0;
+
+    istr_skip_whitespace(in);
+
+    switch (istr_peek(in)) {
+        // object
+        case '{':
+            if (!json__parse_obj(arena, in, flags, &val->object, &count)) {
+                goto fail;
+            }
+            val->type = JSON_OBJECT;
+            json__add_index(arena, val, count);
+            break;
+        // array
+        case '[':
+            if (!json__parse_array(arena, in, flags, &val->array, &count)) {
+                goto fail;
+            }
+            val->type = JSON_ARRAY;
+            json__add_index(arena, val, count);
+            break;
+        // string
+        case '"':
+            if (!json__parse_string(arena, in, &val->string)) {
+                goto fail;
+            }
+            val->type = JSON_STRING;
+            break;
+        // boolean
+        case 't': // fallthrough
+        case 'f':
+            if (!istr_get_bool(in, &val->boolean)) {
+                goto fail;
+            }
+            val->type = JSON_BOOL;
+            break;
+        // null
+        case 'n': 
+            if (!json__parse_null(in)) {
+                goto fail;
+            }
+            val->type = JSON_NULL;
+            break;
+        // comment
+        case '/':
+            err("TODO comments");
+            break;
+        // number
+        default:
+            if (!istr__get_num(in, &val->number, arena)) {
+                goto fail;
+            }
+            val->type = JSON_NUMBER;
+            break;
+    }
+
+    *out = val;
+    return true;
+fail:
+    *out = NULL;
+    return false;
 }
 
 #undef json__ensure
 
-#define JSON_PRETTY_INDENT(ind) for (int i = 0; i < ind; ++i) os_file_puts(options->custom_target, strv("    "))
+static bool json__cursor_valid(json__cursor_t c) {
+    return c.tape ? c.index != SIZE_MAX : c.node != NULL;
+}
+
+// a json_t with the type, the key and the value of scalars
+static json_t json__cursor_get(json__cursor_t c) {
+    if (!c.tape) {
+        return *c.node;
+    }
+
+    json_elem_t *elem = &c.tape->elems[c.index];
+    json_t out = { .type = elem->type };
+    switch (elem->type) {
+        case JSON_STRING: out.string  = json_tape_str(c.tape, c.index); break;
+        case JSON_NUMBER: out.number  = elem->number;                   break;
+        case JSON_BOOL:   out.boolean = elem->boolean;                  break;
+        default: break;
+    }
+    if (c.index > 0 && c.tape->elems[c.index - 1].type == JSON_KEY) {
+        out.key = json_tape_str(c.tape, c.index - 1);
+    }
+    return out;
+}
+
+static json__cursor_t json__cursor_child(json__cursor_t c) {
+    if (!c.tape) {
+        return (json__cursor_t){ .node = c.node->array };
+    }
+
+    json_elem_t *elem = &c.tape->elems[c.index];
+    // the values of an object come after their key
+    usize child = c.index + (elem->type == JSON_OBJECT ? 2 : 1);
+    return (json__cursor_t){ .tape = c.tape, .index = child < elem->end ? child : SIZE_MAX };
+}
+
+static json__cursor_t json__cursor_next(json__cursor_t parent, json__cursor_t c) {
+    if (!c.tape) {
+        return (json__cursor_t){ .node = c.node->next };
+    }
+
+    json_elem_t *elem = &c.tape->elems[parent.index];
+    usize next = json_tape_next(c.tape, c.index) + (elem->type == JSON_OBJECT ? 1 : 0);
+    return (json__cursor_t){ .tape = c.tape, .index = next < elem->end ? next : SIZE_MAX };
+}
+
+#define JSON_PRETTY_INDENT(ind) for (int i = 0; i < ind; ++i) os_file_puts(options->custom_target, strv("    "))
+
+void json__pretty_print_value(json__cursor_t cursor, int indent, const json_pretty_opts_t *options) {
+    json_t value = json__cursor_get(cursor);
+    switch (value.type) {
+        case JSON_NULL:
+            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_NULL]);
+            os_file_puts(options->custom_target, strv("null"));
+            os_log_set_colour(LOG_COL_RESET);
+            break;
+        case JSON_STRING: 
+            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_STRING]);
+            os_file_putc(options->custom_target, '\"');
+            os_file_puts(options->custom_target, value.string);
+            os_file_putc(options->custom_target, '\"');
+            os_log_set_colour(LOG_COL_RESET);
+            break;
+        case JSON_NUMBER:
+        {
+            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_NUM]);
+            u8 scratchbuf[256];
+            arena_t scratch = arena_make(ARENA_STATIC, sizeof(scratchbuf), scratchbuf);
+            const char *fmt = "%g";
+            if (round(value.number) == value.number) {
+                fmt = "%.0f";
+            }
+            os_file_print(
+                scratch, 
+                options->custom_target, 
+                fmt, 
+                value.number
+            );
+            os_log_set_colour(LOG_COL_RESET);
+            break;
+        } 
+        case JSON_BOOL:
+            os_log_set_colour(options->colours[value.boolean ? JSON_PRETTY_COLOUR_TRUE : JSON_PRETTY_COLOUR_FALSE]);
+            os_file_puts(options->custom_target, value.boolean ? strv("true") : strv("false"));
+            os_log_set_colour(LOG_COL_RESET);
+            break;
+        case JSON_ARRAY:
+        case JSON_OBJECT:
+        {
+            bool is_object = value.type == JSON_OBJECT;
+            os_file_puts(options->custom_target, is_object ? strv("{\n") : strv("[\n"));
+            json__cursor_t child = json__cursor_child(cursor);
+            while (json__cursor_valid(child)) {
+                JSON_PRETTY_INDENT(indent + 1);
+                if (is_object) {
+                    os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_KEY]);
+                    os_file_putc(options->custom_target, '\"');
+                    os_file_puts(options->custom_target, json__cursor_get(child).key);
+                    os_file_putc(options->custom_target, '\"');
+                    os_log_set_colour(LOG_COL_RESET);
+
+                    os_file_puts(options->custom_target, strv(": "));
+                }
+
+                json__pretty_print_value(child, indent + 1, options);
+                child = json__cursor_next(cursor, child);
+                if (json__cursor_valid(child)) {
+                    os_file_putc(options->custom_target, ',');
+                }
+                os_file_putc(options->custom_target, '\n');
+            }
+            JSON_PRETTY_INDENT(indent);
+            os_file_putc(options->custom_target, is_object ? '}' : ']');
+            break;
+        }
+        case JSON_KEY:
+            break;
+    }
+}
+
+#undef JSON_PRETTY_INDENT
+
+// == JSON TAPE ======================================
+
+// stage one: find the structural characters (brackets, colons, commas, quotes and
+// the first char of numbers, booleans and nulls) outside of strings, 64 bytes at a time
+
+typedef struct json__block_t json__block_t;
+struct json__block_t {
+    u64 quote;
+    u64 backslash;
+    u64 op;
+    u64 ws;
+};
+
+typedef struct json__indexer_t json__indexer_t;
+struct json__indexer_t {
+    const u8 *buf;
+    usize len;
+    usize block_pos;
+    u64 prev_in_string;
+    u64 prev_escaped;
+    u64 prev_scalar;
+    usize *indices;
+    usize count;
+    usize cur;
+};
+
+static void json__classify(const u8 *p, json__block_t *block) {
+#if COLLA_SCAN_X64
+    *block = (json__block_t){0};
+    for (int i = 0; i < 4; ++i) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(p + i * 16));
+        // '[' | 0x20 is '{' and ']' | 0x20 is '}'
+        __m128i lower = _mm_or_si128(v, _mm_set1_epi8(0x20));
+        __m128i op = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(lower, _mm_set1_epi8('{')), _mm_cmpeq_epi8(lower, _mm_set1_epi8('}'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(':')), _mm_cmpeq_epi8(v, _mm_set1_epi8(',')))
+        );
+        __m128i ws = _mm_or_si128(
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\n'))),
+            _mm_or_si128(_mm_cmpeq_epi8(v, _mm_set1_epi8('\r')), _mm_cmpeq_epi8(v, _mm_set1_epi8('\t')))
+        );
+        u32 shift = i * 16;
+        block->quote     |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << shift;
+        block->backslash |= (u64)(u32)_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << shift;
+        block->op        |= (u64)(u32)_mm_movemask_epi8(op) << shift;
+        block->ws        |= (u64)(u32)_mm_movemask_epi8(ws) << shift;
+    }
+#else
+    *block = (json__block_t){0};
+    for (u32 i = 0; i < 64; ++i) {
+        u64 bit = 1ull << i;
+        switch (p[i]) {
+            case '"':  block->quote |= bit;     break;
+            case '\\': block->backslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',':
+                block->op |= bit;
+                break;
+            case ' ': case '\n': case '\r': case '\t':
+                block->ws |= bit;
+                break;
+        }
+    }
+#endif
+}
+
+// every backslash that is not escaped itself escapes the next character
+static u64 json__escaped(json__indexer_t *ix, u64 backslash) {
+    u64 escaped = ix->prev_escaped;
+    backslash &= ~ix->prev_escaped;
+    ix->prev_escaped = 0;
+
+    while (backslash) {
+        u32 i = scan__ctz64(backslash);
+        if (i == 63) {
+            ix->prev_escaped = 1;
+            break;
+        }
+        escaped |= 1ull << (i + 1);
+        backslash &= ~(3ull << i);
+    }
+
+    return escaped;
+}
+
+static u64 json__prefix_xor(u64 v) {
+    v ^= v << 1;
+    v ^= v << 2;
+    v ^= v << 4;
+    v ^= v << 8;
+    v ^= v << 16;
+    v ^= v << 32;
+    return v;
+}
+
+static u64 json__structurals(json__indexer_t *ix, const u8 *p) {
+    json__block_t block;
+    json__classify(p, &block);
+
+    u64 quote = block.quote & ~json__escaped(ix, block.backslash);
+    // from the opening quote (included) to the closing one (excluded)
+    u64 in_string = json__prefix_xor(quote) ^ ix->prev_in_string;
+    ix->prev_in_string = (u64)((i64)in_string >> 63);
+
+    u64 scalar = ~(block.op | block.ws | quote) & ~in_string;
+    u64 scalar_start = scalar & ~((scalar << 1) | ix->prev_scalar);
+    ix->prev_scalar = scalar >> 63;
+
+    return (block.op & ~in_string) | quote | scalar_start;
+}
+
+static void json__refill(json__indexer_t *ix) {
+    // locals so that the compiler doesn't have to assume that indices aliases ix
+    usize *indices = ix->indices;
+    usize count = 0;
+    usize block_pos = ix->block_pos;
+
+    // leave room for a full block
+    while (block_pos < ix->len && count <= COLLA_JSON_TAPE_BATCH - 64) {
+        u64 mask;
+        usize rem = ix->len - block_pos;
+        if (rem >= 64) {
+            mask = json__structurals(ix, ix->buf + block_pos);
+        }
+        else {
+            u8 last[64];
+            memset(last, ' ', sizeof(last));
+            memcpy(last, ix->buf + block_pos, rem);
+            mask = json__structurals(ix, last);
+        }
+
+        while (mask) {
+            indices[count++] = block_pos + scan__ctz64(mask);
+            mask &= mask - 1;
+        }
+        block_pos += 64;
+    }
+
+    ix->block_pos = block_pos;
+    ix->count = count;
+    ix->cur = 0;
+}
+
+static bool json__next(json__indexer_t *ix, usize *pos) {
+    if (ix->cur == ix->count) {
+        json__refill(ix);
+        if (ix->count == 0) {
+            return false;
+        }
+    }
+    *pos = ix->indices[ix->cur++];
+    return true;
+}
+
+// stage two: walk the structural characters and write the tape
+
+typedef struct json__tape_builder_t json__tape_builder_t;
+struct json__tape_builder_t {
+    arena_t *arena;
+    json_elem_t *elems;
+    usize count;
+    usize cap;
+};
+
+static json_elem_t *json__push_elem(json__tape_builder_t *tb, jsontype_e type) {
+    if (tb->count == tb->cap) {
+        usize grow = MAX(tb->cap, COLLA_JSON_TAPE_BATCH);
+        json_elem_t *more = alloc(tb->arena, json_elem_t, grow, ALLOC_NOZERO);
+        if (!tb->elems) {
+            tb->elems = more;
+        }
+        // nothing else uses the arena while parsing, so the tape is usually extended in place
+        else if (more != tb->elems + tb->cap) {
+            json_elem_t *moved = alloc(tb->arena, json_elem_t, tb->cap + grow, ALLOC_NOZERO);
+            memcpy(moved, tb->elems, tb->count * sizeof(json_elem_t));
+            tb->elems = moved;
+        }
+        tb->cap += grow;
+    }
+    json_elem_t *elem = &tb->elems[tb->count++];
+    elem->type = type;
+    elem->len = 0;
+    elem->offset = 0;
+    return elem;
+}
+
+static bool json__is_delim(char c) {
+    switch (c) {
+        case ' ': case '\n': case '\r': case '\t':
+        case ',': case ':': case '}': case ']':
+            return true;
+    }
+    return false;
+}
+
+static bool json__is_num_char(char c) {
+    switch (c) {
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+        case '-': case '+': case '.': case 'e': case 'E':
+            return true;
+    }
+    return false;
+}
+
+// atom is a number, true, false or null up to the next delimiter
+static bool json__parse_atom(arena_t *arena, strview_t atom, json_elem_t *out) {
+    *out = (json_elem_t){0};
+
+    if (strv_equals(atom, strv("true")) || strv_equals(atom, strv("false"))) {
+        out->type = JSON_BOOL;
+        out->boolean = atom.len == 4;
+        return true;
+    }
+    if (strv_equals(atom, strv("null"))) {
+        out->type = JSON_NULL;
+        return true;
+    }
+
+    // only json number characters, istr__parse_num would also accept hex, inf and nan
+    if (atom.len == 0) {
+        return false;
+    }
+    for (usize i = 0; i < atom.len; ++i) {
+        if (!json__is_num_char(atom.buf[i])) {
+            return false;
+        }
+    }
+
+    instream_t in = istr_init(atom);
+    out->type = JSON_NUMBER;
+    return istr__parse_num(&in, &out->number, arena) && istr_is_finished(&in);
+}
+
+static bool json__tape_atom(json__indexer_t *ix, json__tape_builder_t *tb, usize pos) {
+    usize end = pos;
+    while (end < ix->len && !json__is_delim(ix->buf[end])) {
+        end++;
+    }
+
+    json_elem_t atom;
+    if (!json__parse_atom(tb->arena, strv((const char *)ix->buf + pos, end - pos), &atom)) {
+        return false;
+    }
+
+    *json__push_elem(tb, atom.type) = atom;
+    return true;
+}
+
+static bool json__tape_string(json__indexer_t *ix, json__tape_builder_t *tb, usize pos, jsontype_e type) {
+    // closing quotes are structurals too
+    usize end = 0;
+    if (!json__next(ix, &end) || ix->buf[end] != '"') {
+        return false;
+    }
+    json_elem_t *elem = json__push_elem(tb, type);
+    elem->offset = pos + 1;
+    elem->len = (u32)(end - pos - 1);
+    return true;
+}
+
+static bool json__tape_build(json__indexer_t *ix, json__tape_builder_t *tb, jsonflags_e flags) {
+    usize stack[COLLA_JSON_MAX_DEPTH];
+    usize depth = 0;
+    usize pos = 0;
+
+    if (!json__next(ix, &pos)) {
+        return false;
+    }
+
+    if ((flags & JSON_ONLY_OBJECT_START) && ix->buf[pos] != '{') {
+        return false;
+    }
+
+value:
+    switch (ix->buf[pos]) {
+        case '{':
+        case '[':
+        {
+            if (depth == COLLA_JSON_MAX_DEPTH) {
+                return false;
+            }
+            stack[depth++] = tb->count;
+            json__push_elem(tb, ix->buf[pos] == '{' ? JSON_OBJECT : JSON_ARRAY);
+
+            char close = ix->buf[pos] == '{' ? '}' : ']';
+            if (!json__next(ix, &pos)) {
+                return false;
+            }
+            if (ix->buf[pos] == close) {
+                goto close_container;
+            }
+            if (close == '}') {
+                goto object_key;
+            }
+            goto value;
+        }
+        case '"':
+            if (!json__tape_string(ix, tb, pos, JSON_STRING)) {
+                return false;
+            }
+            break;
+        case '}': case ']': case ',': case ':':
+            return false;
+        default:
+            if (!json__tape_atom(ix, tb, pos)) {
+                return false;
+            }
+            break;
+    }
+
+after_value:
+    if (depth == 0) {
+        // only whitespace is allowed after the root value
+        return !json__next(ix, &pos);
+    }
+
+    tb->elems[stack[depth - 1]].count++;
+
+    if (!json__next(ix, &pos)) {
+        return false;
+    }
+
+    {
+        bool is_object = tb->elems[stack[depth - 1]].type == JSON_OBJECT;
+        char close = is_object ? '}' : ']';
+
+        if (ix->buf[pos] == close) {
+            goto close_container;
+        }
+        if (ix->buf[pos] != ',' || !json__next(ix, &pos)) {
+            return false;
+        }
+        if (ix->buf[pos] == close) {
+            if (flags & JSON_NO_TRAILING_COMMAS) {
+                return false;
+            }
+            goto close_container;
+        }
+        if (is_object) {
+            goto object_key;
+        }
+        goto value;
+    }
+
+object_key:
+    if (ix->buf[pos] != '"' || !json__tape_string(ix, tb, pos, JSON_KEY)) {
+        return false;
+    }
+    if (!json__next(ix, &pos) || ix->buf[pos] != ':' || !json__next(ix, &pos)) {
+        return false;
+    }
+    goto value;
+
+close_container:
+    {
+        json_elem_t *container = &tb->elems[stack[--depth]];
+        if ((container->type == JSON_OBJECT) != (ix->buf[pos] == '}')) {
+            return false;
+        }
+        container->end = (u32)tb->count;
+        // the count of the parent is incremented in after_value
+        goto after_value;
+    }
+}
+
+json_tape_t json_tape_parse(arena_t *arena, strview_t str, jsonflags_e flags) {
+    arena_t before = *arena;
+    json_tape_t tape = { .src = str };
+
+    arena_temp_t scratch = scratch_begin(arena);
+
+    json__indexer_t ix = {
+        .buf = (const u8 *)str.buf,
+        .len = str.len,
+        .indices = alloc(scratch.arena, usize, COLLA_JSON_TAPE_BATCH, ALLOC_NOZERO),
+    };
+    json__tape_builder_t tb = { .arena = arena };
+
+    bool ok = json__tape_build(&ix, &tb, flags) && !ix.prev_in_string;
+
+    scratch_end(&scratch);
+
+    if (!ok) {
+        *arena = before;
+        return tape;
+    }
+
+    // the tape grows by doubling, give back what the last growth didn't use
+    if (arena->cur == (u8 *)(tb.elems + tb.cap)) {
+        arena_pop(arena, (tb.cap - tb.count) * sizeof(json_elem_t));
+    }
+
+    tape.elems = tb.elems;
+    tape.count = tb.count;
+    return tape;
+}
+
+strview_t json_tape_str(json_tape_t *tape, usize index) {
+    json_elem_t *elem = &tape->elems[index];
+    if (elem->type != JSON_STRING && elem->type != JSON_KEY) {
+        return STRV_EMPTY;
+    }
+    return strv(tape->src.buf + elem->offset, elem->len);
+}
+
+usize json_tape_next(json_tape_t *tape, usize index) {
+    json_elem_t *elem = &tape->elems[index];
+    if (elem->type == JSON_OBJECT || elem->type == JSON_ARRAY) {
+        return elem->end;
+    }
+    return index + 1;
+}
+
+static json_t *json__from_tape(arena_t *arena, json_tape_t *tape, usize index) {
+    json_elem_t *elem = &tape->elems[index];
+    json_t *node = alloc(arena, json_t);
+    node->type = elem->type;
+
+    switch (elem->type) {
+        case JSON_STRING:  node->string = json_tape_str(tape, index); break;
+        case JSON_NUMBER:  node->number = elem->number;               break;
+        case JSON_BOOL:    node->boolean = elem->boolean;             break;
+        case JSON_OBJECT:
+        case JSON_ARRAY:
+        {
+            bool is_object = elem->type == JSON_OBJECT;
+            json_t *tail = NULL;
+            usize i = index + 1;
+            while (i < elem->end) {
+                strview_t key = STRV_EMPTY;
+                if (is_object) {
+                    key = json_tape_str(tape, i++);
+                }
+                json_t *child = json__from_tape(arena, tape, i);
+                child->key = key;
+                child->prev = tail;
+                if (tail) tail->next = child;
+                else      node->array = child;
+                tail = child;
+                i = json_tape_next(tape, i);
+            }
+            json__add_index(arena, node, elem->count);
+            break;
+        }
+        default: break;
+    }
+
+    return node;
+}
+
+json_t *json_from_tape(arena_t *arena, json_tape_t *tape) {
+    if (!tape->count) {
+        return NULL;
+    }
+    return json__from_tape(arena, tape, 0);
+}
+
+void json_tape_pretty_print(json_tape_t *tape, const json_pretty_opts_t *options) {
+    json_pretty_opts_t default_options = json__pretty_options(options);
+    if (tape->count) {
+        json__pretty_print_value((json__cursor_t){ .tape = tape }, 0, &default_options);
+    }
+    os_file_putc(default_options.custom_target, '\n');
+}
+
+// == JSON READER ====================================
+
+typedef enum {
+    JSON__READ_VALUE,        // root or after a colon
+    JSON__READ_ARRAY_FIRST,  // value or ]
+    JSON__READ_ARRAY_NEXT,   // value, or ] after a trailing comma
+    JSON__READ_OBJECT_FIRST, // key or }
+    JSON__READ_OBJECT_NEXT,  // key, or } after a trailing comma
+    JSON__READ_COLON,
+    JSON__READ_AFTER_VALUE,  // comma or end of the container
+    JSON__READ_STRING,       // inside of a string value
+    JSON__READ_KEY,          // inside of a key
+    JSON__READ_ATOM,         // inside of a number, true, false or null
+    JSON__READ_DONE,
+    JSON__READ_ERROR,
+} json__read_state_e;
+
+json_reader_t json_reader_init(arena_t *arena, jsonflags_e flags) {
+    return (json_reader_t){
+        .arena = arena,
+        .flags = flags,
+        .state = JSON__READ_VALUE,
+    };
+}
+
+void json_reader_feed(json_reader_t *r, strview_t chunk, bool is_last) {
+    r->chunk = chunk;
+    r->pos = 0;
+    r->is_last = is_last;
+    r->token_start = 0;
+}
+
+static json_event_e json__reader_error(json_reader_t *r) {
+    r->state = JSON__READ_ERROR;
+    return JSON_EVENT_ERROR;
+}
+
+static void json__reader_save(json_reader_t *r, strview_t part) {
+    if (part.len == 0) {
+        return;
+    }
+    if (r->partial_len + part.len > r->partial_cap) {
+        usize cap = MAX(r->partial_cap * 2, r->partial_len + part.len);
+        u8 *partial = alloc(r->arena, u8, cap, ALLOC_NOZERO);
+        if (r->partial_len) {
+            memcpy(partial, r->partial, r->partial_len);
+        }
+        r->partial = partial;
+        r->partial_cap = cap;
+    }
+    memcpy(r->partial + r->partial_len, part.buf, part.len);
+    r->partial_len += part.len;
+}
+
+static void json__reader_begin_token(json_reader_t *r, json__read_state_e state) {
+    r->state = state;
+    r->token_start = r->pos;
+    r->partial_len = 0;
+    r->in_partial = false;
+}
+
+// the token ends at end, if it started in another chunk it's put together in the buffer
+static strview_t json__reader_token(json_reader_t *r, usize end) {
+    strview_t part = strv(r->chunk.buf + r->token_start, end - r->token_start);
+    if (!r->in_partial) {
+        return part;
+    }
+    json__reader_save(r, part);
+    r->in_partial = false;
+    return strv((const char *)r->partial, r->partial_len);
+}
+
+// the chunk ended in the middle of a token
+static json_event_e json__reader_split_token(json_reader_t *r) {
+    json__reader_save(r, strv(r->chunk.buf + r->token_start, r->chunk.len - r->token_start));
+    r->in_partial = true;
+    r->token_start = 0;
+    return JSON_EVENT_NEED_INPUT;
+}
+
+// leaves pos on the closing quote, returns false if the chunk ended first
+static bool json__reader_scan_string(json_reader_t *r) {
+    const char *buf = r->chunk.buf;
+    usize len = r->chunk.len;
+    usize pos = r->pos;
+
+    if (r->escaped) {
+        if (pos == len) {
+            return false;
+        }
+        r->escaped = false;
+        pos++;
+    }
+
+    while (pos < len) {
+        strview_t rest = strv(buf + pos, len - pos);
+        usize quote = scan_find(rest, '"');
+        usize backslash = scan_find(strv(rest.buf, quote == STR_NONE ? rest.len : quote), '\\');
+
+        if (backslash != STR_NONE) {
+            pos += backslash + 1;
+            if (pos == len) {
+                r->escaped = true;
+                break;
+            }
+            pos++;
+            continue;
+        }
+
+        if (quote == STR_NONE) {
+            break;
+        }
+
+        r->pos = pos + quote;
+        return true;
+    }
+
+    r->pos = len;
+    return false;
+}
+
+static usize json__reader_key_start(json_reader_t *r, u32 depth) {
+    return depth ? r->key_ends[depth - 1] : 0;
+}
+
+// the key text is only kept for the depths above the current one, so a
+// new key replaces the one before it at the same depth
+static void json__reader_push_key(json_reader_t *r, strview_t key) {
+    u32 depth = r->depth - 1;
+    usize start = json__reader_key_start(r, depth);
+    if (start + key.len > r->key_text_cap) {
+        usize cap = MAX(r->key_text_cap * 2, start + key.len);
+        u8 *text = alloc(r->arena, u8, cap, ALLOC_NOZERO);
+        if (start) {
+            memcpy(text, r->key_text, start);
+        }
+        r->key_text = text;
+        r->key_text_cap = cap;
+    }
+    if (key.len) {
+        memcpy(r->key_text + start, key.buf, key.len);
+    }
+    r->key_hashes[depth] = hmap_hash(key);
+    r->key_ends[depth] = start + key.len;
+}
+
+static strview_t json__reader_key(json_reader_t *r, u32 depth) {
+    usize start = json__reader_key_start(r, depth);
+    return strv((const char *)r->key_text + start, r->key_ends[depth] - start);
+}
+
+static json_event_e json__reader_value(json_reader_t *r, json_event_e event) {
+    r->value_depth = r->depth;
+    r->state = r->depth ? JSON__READ_AFTER_VALUE : JSON__READ_DONE;
+    return event;
+}
+
+static json_event_e json__reader_begin(json_reader_t *r, jsontype_e kind) {
+    if (r->depth == COLLA_JSON_MAX_DEPTH) {
+        return json__reader_error(r);
+    }
+
+    if (r->depth == r->stack_cap) {
+        u32 cap = r->stack_cap ? r->stack_cap * 2 : 16;
+        u8 *kinds = alloc(r->arena, u8, cap, ALLOC_NOZERO);
+        u64 *key_hashes = alloc(r->arena, u64, cap, ALLOC_NOZERO);
+        usize *key_ends = alloc(r->arena, usize, cap, ALLOC_NOZERO);
+        u32 *indices = alloc(r->arena, u32, cap, ALLOC_NOZERO);
+        if (r->depth) {
+            memcpy(kinds, r->kinds, r->depth * sizeof(*kinds));
+            memcpy(key_hashes, r->key_hashes, r->depth * sizeof(*key_hashes));
+            memcpy(key_ends, r->key_ends, r->depth * sizeof(*key_ends));
+            memcpy(indices, r->indices, r->depth * sizeof(*indices));
+        }
+        r->kinds = kinds;
+        r->key_hashes = key_hashes;
+        r->key_ends = key_ends;
+        r->indices = indices;
+        r->stack_cap = cap;
+    }
+
+    r->value_depth = r->depth;
+    r->kinds[r->depth] = (u8)kind;
+    r->key_hashes[r->depth] = 0;
+    r->key_ends[r->depth] = json__reader_key_start(r, r->depth);
+    r->indices[r->depth] = 0;
+    r->depth++;
+
+    if (kind == JSON_OBJECT) {
+        r->state = JSON__READ_OBJECT_FIRST;
+        return JSON_EVENT_OBJECT_BEGIN;
+    }
+    r->state = JSON__READ_ARRAY_FIRST;
+    return JSON_EVENT_ARRAY_BEGIN;
+}
+
+static json_event_e json__reader_end(json_reader_t *r) {
+    jsontype_e kind = r->kinds[--r->depth];
+    json_event_e event = kind == JSON_OBJECT ? JSON_EVENT_OBJECT_END : JSON_EVENT_ARRAY_END;
+    return json__reader_value(r, event);
+}
+
+json_event_e json_reader_next(json_reader_t *r) {
+    const char *buf = r->chunk.buf;
+    usize len = r->chunk.len;
 
-void json__pretty_print_value(json_t *value, int indent, const json_pretty_opts_t *options) {
-    switch (value->type) {
-        case JSON_NULL:
-            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_NULL]);
-            os_file_puts(options->custom_target, strv("null"));
-            os_log_set_colour(LOG_COL_RESET);
-            break;
-        case JSON_ARRAY:
-            os_file_puts(options->custom_target, strv("[\n"));
-            for_each (node, value->array) {
-                JSON_PRETTY_INDENT(indent + 1);
-                json__pretty_print_value(node, indent + 1, options);
-                if (node->next) {
-                    os_file_putc(options->custom_target, ',');
+    while (true) {
+        switch (r->state) {
+            case JSON__READ_STRING:
+            case JSON__READ_KEY:
+            {
+                if (!json__reader_scan_string(r)) {
+                    if (r->is_last) {
+                        return json__reader_error(r);
+                    }
+                    return json__reader_split_token(r);
                 }
-                os_file_putc(options->custom_target, '\n');
+
+                r->str = json__reader_token(r, r->pos);
+                // skip the closing quote
+                r->pos++;
+
+                if (r->state == JSON__READ_KEY) {
+                    json__reader_push_key(r, r->str);
+                    r->state = JSON__READ_COLON;
+                    return JSON_EVENT_KEY;
+                }
+                return json__reader_value(r, JSON_EVENT_STRING);
             }
-            JSON_PRETTY_INDENT(indent);
-            os_file_putc(options->custom_target, ']');
-            break;
-        case JSON_STRING: 
-            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_STRING]);
-            os_file_putc(options->custom_target, '\"');
-            os_file_puts(options->custom_target, value->string);
-            os_file_putc(options->custom_target, '\"');
-            os_log_set_colour(LOG_COL_RESET);
-            break;
-        case JSON_NUMBER:
-        {
-            os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_NUM]);
-            u8 scratchbuf[256];
-            arena_t scratch = arena_make(ARENA_STATIC, sizeof(scratchbuf), scratchbuf);
-            const char *fmt = "%g";
-            if (round(value->number) == value->number) {
-                fmt = "%.0f";
+            case JSON__READ_ATOM:
+            {
+                while (r->pos < len && !json__is_delim(buf[r->pos])) {
+                    r->pos++;
+                }
+                if (r->pos == len && !r->is_last) {
+                    return json__reader_split_token(r);
+                }
+
+                json_elem_t atom;
+                if (!json__parse_atom(r->arena, json__reader_token(r, r->pos), &atom)) {
+                    return json__reader_error(r);
+                }
+
+                switch (atom.type) {
+                    case JSON_BOOL:
+                        r->boolean = atom.boolean;
+                        return json__reader_value(r, JSON_EVENT_BOOL);
+                    case JSON_NULL:
+                        return json__reader_value(r, JSON_EVENT_NULL);
+                    default:
+                        r->number = atom.number;
+                        return json__reader_value(r, JSON_EVENT_NUMBER);
+                }
             }
-            os_file_print(
-                scratch, 
-                options->custom_target, 
-                fmt, 
-                value->number
-            );
-            os_log_set_colour(LOG_COL_RESET);
-            break;
-        } 
-        case JSON_BOOL:
-            os_log_set_colour(options->colours[value->boolean ? JSON_PRETTY_COLOUR_TRUE : JSON_PRETTY_COLOUR_FALSE]);
-            os_file_puts(options->custom_target, value->boolean ? strv("true") : strv("false"));
-            os_log_set_colour(LOG_COL_RESET);
-            break;
-        case JSON_OBJECT:
-            os_file_puts(options->custom_target, strv("{\n"));
-            for_each(node, value->object) {
-                JSON_PRETTY_INDENT(indent + 1);
-                os_log_set_colour(options->colours[JSON_PRETTY_COLOUR_KEY]);
-                os_file_putc(options->custom_target, '\"');
-                os_file_puts(options->custom_target, node->key);
-                os_file_putc(options->custom_target, '\"');
-                os_log_set_colour(LOG_COL_RESET);
+            case JSON__READ_ERROR:
+                return JSON_EVENT_ERROR;
+            default:
+                break;
+        }
 
-                os_file_puts(options->custom_target, strv(": "));
+        while (r->pos < len && char_is_space(buf[r->pos])) {
+            r->pos++;
+        }
 
-                json__pretty_print_value(node, indent + 1, options);
-                if (node->next) {
-                    os_file_putc(options->custom_target, ',');
+        if (r->pos == len) {
+            if (!r->is_last) {
+                return JSON_EVENT_NEED_INPUT;
+            }
+            if (r->state == JSON__READ_DONE) {
+                return JSON_EVENT_DONE;
+            }
+            return json__reader_error(r);
+        }
+
+        char c = buf[r->pos];
+
+        switch (r->state) {
+            case JSON__READ_COLON:
+                if (c != ':') {
+                    return json__reader_error(r);
                 }
-                os_file_putc(options->custom_target, '\n');
+                r->pos++;
+                r->state = JSON__READ_VALUE;
+                continue;
+
+            case JSON__READ_AFTER_VALUE:
+            {
+                bool is_object = r->kinds[r->depth - 1] == JSON_OBJECT;
+                if (c == (is_object ? '}' : ']')) {
+                    r->pos++;
+                    return json__reader_end(r);
+                }
+                if (c != ',') {
+                    return json__reader_error(r);
+                }
+                r->pos++;
+                if (is_object) {
+                    r->state = JSON__READ_OBJECT_NEXT;
+                }
+                else {
+                    r->indices[r->depth - 1]++;
+                    r->state = JSON__READ_ARRAY_NEXT;
+                }
+                continue;
             }
-            JSON_PRETTY_INDENT(indent);
-            os_file_putc(options->custom_target, '}');
-            break;
+
+            case JSON__READ_OBJECT_FIRST:
+            case JSON__READ_OBJECT_NEXT:
+                if (c == '}' && (r->state == JSON__READ_OBJECT_FIRST || !(r->flags & JSON_NO_TRAILING_COMMAS))) {
+                    r->pos++;
+                    return json__reader_end(r);
+                }
+                if (c != '"') {
+                    return json__reader_error(r);
+                }
+                r->pos++;
+                json__reader_begin_token(r, JSON__READ_KEY);
+                continue;
+
+            case JSON__READ_ARRAY_FIRST:
+            case JSON__READ_ARRAY_NEXT:
+                if (c == ']' && (r->state == JSON__READ_ARRAY_FIRST || !(r->flags & JSON_NO_TRAILING_COMMAS))) {
+                    r->pos++;
+                    return json__reader_end(r);
+                }
+                // fallthrough
+            case JSON__READ_VALUE:
+                if (r->depth == 0 && (r->flags & JSON_ONLY_OBJECT_START) && c != '{') {
+                    return json__reader_error(r);
+                }
+                switch (c) {
+                    case '{':
+                        r->pos++;
+                        return json__reader_begin(r, JSON_OBJECT);
+                    case '[':
+                        r->pos++;
+                        return json__reader_begin(r, JSON_ARRAY);
+                    case '"':
+                        r->pos++;
+                        json__reader_begin_token(r, JSON__READ_STRING);
+                        continue;
+                    case '}': case ']': case ',': case ':':
+                        return json__reader_error(r);
+                    default:
+                        json__reader_begin_token(r, JSON__READ_ATOM);
+                        continue;
+                }
+
+            // only whitespace is allowed after the root
+            default:
+                return json__reader_error(r);
+        }
+    }
+}
+
+json_path_t json_path_init(arena_t *arena, strview_t path) {
+    // every segment is at least one char
+    json_path_t out = {
+        .segments = alloc(arena, u64, path.len),
+        .is_index = alloc(arena, bool, path.len),
+        .keys = alloc(arena, strview_t, path.len),
+    };
+
+    // the keys are views in the path, so it is copied
+    path = strv(str(arena, path));
+    instream_t in = istr_init(path);
+    while (!istr_is_finished(&in)) {
+        switch (istr_peek(&in)) {
+            case '.':
+                istr_skip(&in, 1);
+                break;
+            case '[':
+            {
+                istr_skip(&in, 1);
+                u64 index = 0;
+                if (!istr_get_u64(&in, &index) || istr_get(&in) != ']') {
+                    err("invalid index in json path: %v", path);
+                    return (json_path_t){0};
+                }
+                out.is_index[out.count] = true;
+                out.segments[out.count++] = index;
+                break;
+            }
+            default:
+            {
+                strview_t key = istr_get_view_either(&in, strv(".["));
+                out.keys[out.count] = key;
+                out.segments[out.count++] = hmap_hash(key);
+                break;
+            }
+        }
+    }
+
+    return out;
+}
+
+bool json_reader_at(json_reader_t *r, json_path_t *path) {
+    if (r->value_depth != path->count) {
+        return false;
+    }
+    for (u32 i = 0; i < path->count; ++i) {
+        if (path->is_index[i]) {
+            if (r->kinds[i] != JSON_ARRAY || r->indices[i] != path->segments[i]) {
+                return false;
+            }
+        }
+        else if (r->kinds[i] != JSON_OBJECT ||
+                 r->key_hashes[i] != path->segments[i] ||
+                 !strv_equals(json__reader_key(r, i), path->keys[i]))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+json_event_e json_reader_select(json_reader_t *r, json_path_t *paths, int count, int *match) {
+    while (true) {
+        json_event_e event = json_reader_next(r);
+        switch (event) {
+            case JSON_EVENT_NEED_INPUT:
+            case JSON_EVENT_DONE:
+            case JSON_EVENT_ERROR:
+                return event;
+            case JSON_EVENT_KEY:
+            case JSON_EVENT_OBJECT_END:
+            case JSON_EVENT_ARRAY_END:
+                continue;
+            default:
+                break;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (json_reader_at(r, &paths[i])) {
+                *match = i;
+                return event;
+            }
+        }
+    }
+}
+
+// == XML ============================================
+
+xmltag_t *xml__parse_tag(arena_t *arena, instream_t *in);
+
+xml_t xml_parse(arena_t *arena, strview_t filename) {
+    str_t str = os_file_read_all_str(arena, filename);
+    return xml_parse_str(arena, strv(str));
+}
+
+xml_t xml_parse_str(arena_t *arena, strview_t xmlstr) {
+    xml_t out = {
+        .text = xmlstr,
+        .root = alloc(arena, xmltag_t),
+    };
+    
+    instream_t in = istr_init(xmlstr);
+
+    while (!istr_is_finished(&in)) {
+        const char *start = in.cur;
+        xmltag_t *tag = xml__parse_tag(arena, &in);
+
+        // meta tags, or text outside of any tag that would never be consumed
+        if (!tag) {
+            if (in.cur == start) break;
+            continue;
+        }
+
+        if (out.tail) out.tail->next = tag;
+        else          out.root->child = tag;
+
+        out.tail = tag;
+    }
+
+    return out;
+}
+
+xmltag_t *xml_get_tag(xmltag_t *parent, strview_t key, bool recursive) {
+    xmltag_t *t = parent ? parent->child : NULL;
+    while (t) {
+        if (strv_equals(key, t->key)) {
+            return t;
+        }
+        if (recursive && t->child) {
+            xmltag_t *out = xml_get_tag(t, key, recursive);
+            if (out) {
+                return out;
+            }
+        }
+        t = t->next;
+    }
+    return NULL;
+}
+
+strview_t xml_get_attribute(xmltag_t *tag, strview_t key) {
+    xmlattr_t *a = tag ? tag->attributes : NULL;
+    while (a) {
+        if (strv_equals(key, a->key)) {
+            return a->value;
+        }
+        a = a->next;
+    }
+    return STRV_EMPTY;
+}
+
+///// xml-private ////////////////////////////////////
+
+xmlattr_t *xml__parse_attr(arena_t *arena, instream_t *in) {
+    if (istr_peek(in) != ' ') {
+        return NULL;
+    }
+
+    strview_t key = strv_trim(istr_get_view(in, '='));
+    istr_skip(in, 1); // skip =
+    istr_skip_whitespace(in);
+    if (istr_peek(in) == '"') {
+        istr_skip(in, 1);
+    }
+    strview_t val = strv_trim(istr_get_view_either(in, strv("\">")));
+    if (istr_peek(in) != '>') {
+        istr_skip(in, 1); // skip "
     }
+    
+    if (strv_is_empty(key) || strv_is_empty(val)) {
+        warn("key or value empty");
+        return NULL;
+    }
+    
+    xmlattr_t *attr = alloc(arena, xmlattr_t);
+    attr->key = key;
+    attr->value = val;
+    return attr;
 }
 
-#undef JSON_PRETTY_INDENT
+xmltag_t *xml__parse_tag(arena_t *arena, instream_t *in) {
+    istr_skip_whitespace(in);
+
+    // we're either parsing the body, or we have finished the object
+    if (istr_peek(in) != '<' || istr_peek_next(in) == '/') {
+        return NULL;
+    }
+
+    istr_skip(in, 1); // skip <
+
+    // meta tag, we don't care about these
+    if (istr_peek(in) == '?') {
+        istr_ignore_and_skip(in, '\n');
+        return NULL;
+    }
+
+    xmltag_t *tag = alloc(arena, xmltag_t);
+
+    tag->key = strv_trim(istr_get_view_either(in, strv(" />")));
+
+    xmlattr_t *attr = xml__parse_attr(arena, in);
+    while (attr) {
+        attr->next = tag->attributes;
+        tag->attributes = attr;
+        attr = xml__parse_attr(arena, in);
+    }
+
+    // this tag does not have children, return
+    if (istr_peek(in) == '/') {
+        istr_skip(in, 2); // skip / and >
+        return tag;
+    }
+
+    istr_skip(in, 1); // skip >
+
+    xmltag_t *child = xml__parse_tag(arena, in);
+    while (child) {
+        if (tag->tail) {
+            tag->tail->next = child;
+            tag->tail = child;
+        }
+        else {
+            tag->child = tag->tail = child;
+        }
+        child = xml__parse_tag(arena, in);
+    }
+
+    // parse content
+    istr_skip_whitespace(in);
+    tag->content = istr_get_view(in, '<');
 
+    // closing tag
+    istr_skip(in, 2); // skip < and /
+    strview_t closing = strv_trim(istr_get_view(in, '>'));
+    if (!strv_equals(tag->key, closing)) {
+        warn("opening and closing tags are different!: (%v) != (%v)", tag->key, closing);
+    }
+    istr_skip(in, 1); // skip >
+    return tag;
+}
 
-// == XML ============================================
+// == HTML ===========================================
 
-xmltag_t *xml__parse_tag(arena_t *arena, instream_t *in);
+htmltag_t *html__parse_tag(arena_t *arena, instream_t *in);
 
-xml_t xml_parse(arena_t *arena, strview_t filename) {
-    str_t str = os_file_read_all_str(arena, filename);
-    return xml_parse_str(arena, strv(str));
+html_t html_parse(arena_t *arena, strview_t filename) {
+   str_t str = os_file_read_all_str(arena, filename);
+   return html_parse_str(arena, strv(str));
 }
 
-xml_t xml_parse_str(arena_t *arena, strview_t xmlstr) {
-    xml_t out = {
-        .text = xmlstr,
+html_t html_parse_str(arena_t *arena, strview_t str) {
+    html_t out = {
+        .text = str,
         .root = alloc(arena, xmltag_t),
     };
-    
-    instream_t in = istr_init(xmlstr);
+
+    instream_t in = istr_init(str);
 
     while (!istr_is_finished(&in)) {
-        xmltag_t *tag = xml__parse_tag(arena, &in);
+        htmltag_t *tag = html__parse_tag(arena, &in);
 
         if (out.tail) out.tail->next = tag;
-        else          out.root->child = tag;
+        else          out.root->children = tag;
 
         out.tail = tag;
     }
@@ -2706,14 +8131,14 @@ xml_t xml_parse_str(arena_t *arena, strview_t xmlstr) {
     return out;
 }
 
-xmltag_t *xml_get_tag(xmltag_t *parent, strview_t key, bool recursive) {
-    xmltag_t *t = parent ? parent->child : NULL;
+htmltag_t *html__get_tag_internal(htmltag_t *parent, str_t key, bool recursive) {
+    htmltag_t *t = parent ? parent->children : NULL;
     while (t) {
-        if (strv_equals(key, t->key)) {
+        if (str_equals(key, t->key)) {
             return t;
         }
-        if (recursive && t->child) {
-            xmltag_t *out = xml_get_tag(t, key, recursive);
+        if (recursive && t->children) {
+            htmltag_t *out = html__get_tag_internal(t, key, recursive);
             if (out) {
                 return out;
             }
@@ -2723,7 +8148,14 @@ xmltag_t *xml_get_tag(xmltag_t *parent, strview_t key, bool recursive) {
     return NULL;
 }
 
-strview_t xml_get_attribute(xmltag_t *tag, strview_t key) {
+htmltag_t *html_get_tag(htmltag_t *parent, strview_t key, bool recursive) {
+    u8 tmpbuf[KB(1)];
+    arena_t scratch = arena_make(ARENA_STATIC, sizeof(tmpbuf), tmpbuf);
+    str_t upper = strv_to_upper(&scratch, key);
+    return html__get_tag_internal(parent, upper, recursive);
+}
+
+strview_t html_get_attribute(htmltag_t *tag, strview_t key) {
     xmlattr_t *a = tag ? tag->attributes : NULL;
     while (a) {
         if (strv_equals(key, a->key)) {
@@ -2734,308 +8166,893 @@ strview_t xml_get_attribute(xmltag_t *tag, strview_t key) {
     return STRV_EMPTY;
 }
 
-///// xml-private ////////////////////////////////////
+///// html-private ///////////////////////////////////
 
-xmlattr_t *xml__parse_attr(arena_t *arena, instream_t *in) {
-    if (istr_peek(in) != ' ') {
-        return NULL;
+/*
+
+special rules:
+ <p> tag does not need to be closed when followed by
+    address, article, aside, blockquote, details, dialog, div,
+    dl, fieldset, figcaption, figure, footer, form, h1, h2, h3,
+    h4, h5, h6, header, hgroup, hr, main, menu, nav, ol, p, pre,
+    search, section, table, or ul
+*/
+
+strview_t html_closing_p_tags[] = {
+    cstrv("ADDRESS"),
+    cstrv("ARTICLE"),
+    cstrv("ASIDE"),
+    cstrv("BLOCKQUOTE"),
+    cstrv("DETAILS"),
+    cstrv("DIALOG"),
+    cstrv("DIV"),
+    cstrv("DL"),
+    cstrv("FIELDSET"),
+    cstrv("FIGCAPTION"),
+    cstrv("FIGURE"),
+    cstrv("FOOTER"),
+    cstrv("FORM"),
+    cstrv("H1"),
+    cstrv("H2"),
+    cstrv("H3"),
+    cstrv("H4"),
+    cstrv("H5"),
+    cstrv("H6"),
+    cstrv("HEADER"),
+    cstrv("HGROUP"),
+    cstrv("HR"),
+    cstrv("MAIN"),
+    cstrv("MENU"),
+    cstrv("NAV"),
+    cstrv("OL"),
+    cstrv("P"),
+    cstrv("PRE"),
+    cstrv("SEARCH"),
+    cstrv("SECTION"),
+    cstrv("TABLE"),
+    cstrv("UL"),
+};
+
+bool html__closes_p_tag(strview_t tag) {
+    for (int i = 0; i < arrlen(html_closing_p_tags); ++i) {
+        if (strv_equals(html_closing_p_tags[i], tag)) {
+            return true;
+        }
     }
 
-    strview_t key = strv_trim(istr_get_view(in, '='));
-    istr_skip(in, 1); // skip =
-    strview_t val = strv_trim(istr_get_view_either(in, strv("\">")));
-    if (istr_peek(in) != '>') {
-        istr_skip(in, 1); // skip "
+    return false;
+}
+
+htmltag_t *html__parse_tag(arena_t *arena, instream_t *in) {
+    istr_skip_whitespace(in);
+
+    // we're either parsing the body, or we have finished the object
+    if (istr_peek(in) != '<' || istr_peek_next(in) == '/') {
+        return NULL;
     }
-    
-    if (strv_is_empty(key) || strv_is_empty(val)) {
-        warn("key or value empty");
+
+    istr_skip(in, 1); // skip <
+
+    // meta tag, we don't care about these
+    if (istr_peek(in) == '?') {
+        istr_ignore_and_skip(in, '\n');
         return NULL;
     }
+
+    htmltag_t *tag = alloc(arena, htmltag_t);
+
+    tag->key = strv_to_upper(
+        arena, 
+        strv_trim(istr_get_view_either(in, strv(" />")))
+    );
+
+    xmlattr_t *attr = xml__parse_attr(arena, in);
+    while (attr) {
+        attr->next = tag->attributes;
+        tag->attributes = attr;
+        attr = xml__parse_attr(arena, in);
+    }
+
+    // this tag does not have children, return
+    if (istr_peek(in) == '/') {
+        istr_skip(in, 2); // skip / and >
+        return tag;
+    }
+
+    istr_skip(in, 1); // skip >
+
+    bool is_p_tag = strv_equals(strv(tag->key), strv("P"));
+    while (!istr_is_finished(in)) {
+        istr_skip_whitespace(in);
+        strview_t content = strv_trim(istr_get_view(in, '<'));
     
-    xmlattr_t *attr = alloc(arena, xmlattr_t);
-    attr->key = key;
-    attr->value = val;
-    return attr;
+        // skip <
+        istr_skip(in, 1);
+    
+        bool is_closing = istr_peek(in) == '/';
+        if (is_closing) {
+            istr_skip(in, 1);
+        }
+
+ 
+        arena_t scratch = *arena;
+        instream_t scratch_in = *in;
+        str_t next_tag = strv_to_upper(&scratch, strv_trim(istr_get_view_either(&scratch_in, strv(" >"))));
+        
+        // rewind <
+        istr_rewind_n(in, 1);
+
+        // if we don't have children, it means this is the only content
+        // otherwise, it means this is content in-between other tags,
+        // if so: create an empty tag with the content and add it as a child
+        if (!strv_is_empty(content)) {
+            if (tag->children == NULL) {
+                tag->content = content;
+            }
+            else {
+                htmltag_t *empty = alloc(arena, htmltag_t);
+                empty->content = content;
+                olist_push(tag->children, tag->tail, empty);
+            }
+        }
+
+        bool close_tag = 
+            (is_closing && str_equals(tag->key, next_tag)) ||
+            (is_p_tag   && html__closes_p_tag(strv(next_tag)));
+
+        if (close_tag) {
+            if (is_closing) {
+                istr_skip(in, 2 + next_tag.len);
+            }
+            break;
+        }
+
+        htmltag_t *child = html__parse_tag(arena, in);
+        if (tag->tail) {
+            (tag->tail)->next = (child);
+            (tag->tail) = (child);
+        } 
+        else {
+            (tag->children) = (tag->tail) = (child);
+        }
+    }
+
+    return tag;
+}
+
+// == XML READER =====================================
+
+typedef enum {
+    XML__READ_CONTENT, // between tags
+    XML__READ_TEXT,
+    XML__READ_MARKUP,  // after a <
+    XML__READ_RAW,     // content of html script and style
+    XML__READ_RAW_END, // closing tag after the raw content
+    XML__READ_DONE,
+    XML__READ_ERROR,
+} xml__read_state_e;
+
+typedef enum {
+    XML__MARKUP_UNKNOWN,
+    XML__MARKUP_BANG,    // <! that could still be anything
+    XML__MARKUP_OPEN,
+    XML__MARKUP_CLOSE,
+    XML__MARKUP_COMMENT,
+    XML__MARKUP_CDATA,
+    XML__MARKUP_PI,      // <? ?>
+    XML__MARKUP_DECL,    // <!DOCTYPE >
+} xml__markup_e;
+
+strview_t html__void_tags[] = {
+    cstrv("area"),
+    cstrv("base"),
+    cstrv("br"),
+    cstrv("col"),
+    cstrv("embed"),
+    cstrv("hr"),
+    cstrv("img"),
+    cstrv("input"),
+    cstrv("link"),
+    cstrv("meta"),
+    cstrv("param"),
+    cstrv("source"),
+    cstrv("track"),
+    cstrv("wbr"),
+};
+
+static bool xml__name_equals(strview_t a, strview_t b, bool ignore_case) {
+    if (a.len != b.len) {
+        return false;
+    }
+    if (a.len == 0) {
+        return true;
+    }
+    if (!ignore_case) {
+        return memcmp(a.buf, b.buf, a.len) == 0;
+    }
+    for (usize i = 0; i < a.len; ++i) {
+        if (char_lower(a.buf[i]) != char_lower(b.buf[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool xml__name_in(strview_t name, strview_t *list, usize count) {
+    for (usize i = 0; i < count; ++i) {
+        if (xml__name_equals(name, list[i], true)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+xml_reader_t xml_reader_init(arena_t *arena, xmlflags_e flags) {
+    return (xml_reader_t){
+        .arena = arena,
+        .flags = flags,
+        .state = XML__READ_CONTENT,
+    };
+}
+
+void xml_reader_feed(xml_reader_t *r, strview_t chunk, bool is_last) {
+    r->chunk = chunk;
+    r->pos = 0;
+    r->is_last = is_last;
+    r->token_start = 0;
+}
+
+// in html a < that can't start a tag is just text, like in 3 < 4
+static bool xml__is_markup_start(char c) {
+    return char_is_alpha(c) || c == '/' || c == '!' || c == '?';
+}
+
+static xml_event_e xml__reader_error(xml_reader_t *r) {
+    r->state = XML__READ_ERROR;
+    r->pending_ends = 0;
+    r->pending_begin = false;
+    return XML_EVENT_ERROR;
+}
+
+static void xml__reader_save(xml_reader_t *r, strview_t part) {
+    if (part.len == 0) {
+        return;
+    }
+    if (r->partial_len + part.len > r->partial_cap) {
+        usize cap = MAX(r->partial_cap * 2, r->partial_len + part.len);
+        u8 *partial = alloc(r->arena, u8, cap, ALLOC_NOZERO);
+        if (r->partial_len) {
+            memcpy(partial, r->partial, r->partial_len);
+        }
+        r->partial = partial;
+        r->partial_cap = cap;
+    }
+    memcpy(r->partial + r->partial_len, part.buf, part.len);
+    r->partial_len += part.len;
+}
+
+static void xml__reader_begin_token(xml_reader_t *r, xml__read_state_e state) {
+    r->state = state;
+    r->token_start = r->pos;
+    r->partial_len = 0;
+    r->in_partial = false;
+    r->markup = XML__MARKUP_UNKNOWN;
+    r->seen = 0;
+    r->match = 0;
+    r->quote = 0;
+}
+
+// the token ends at end, if it started in another chunk it's put together in the buffer
+static strview_t xml__reader_token(xml_reader_t *r, usize end) {
+    strview_t part = strv(r->chunk.buf + r->token_start, end - r->token_start);
+    if (!r->in_partial) {
+        return part;
+    }
+    xml__reader_save(r, part);
+    r->in_partial = false;
+    return strv((const char *)r->partial, r->partial_len);
+}
+
+// the chunk ended in the middle of a token
+static xml_event_e xml__reader_split_token(xml_reader_t *r) {
+    xml__reader_save(r, strv(r->chunk.buf + r->token_start, r->chunk.len - r->token_start));
+    r->in_partial = true;
+    r->token_start = 0;
+    return XML_EVENT_NEED_INPUT;
 }
 
-xmltag_t *xml__parse_tag(arena_t *arena, instream_t *in) {
-    istr_skip_whitespace(in);
+static strview_t xml__reader_name_at(xml_reader_t *r, u32 index) {
+    usize start = r->name_offsets[index];
+    usize end = index + 1 < r->depth ? r->name_offsets[index + 1] : r->names_len;
+    return strv((const char *)r->names + start, end - start);
+}
 
-    // we're either parsing the body, or we have finished the object
-    if (istr_peek(in) != '<' || istr_peek_next(in) == '/') {
-        return NULL;
+static bool xml__reader_push(xml_reader_t *r, strview_t name) {
+    if (r->depth == COLLA_XML_MAX_DEPTH) {
+        return false;
     }
 
-    istr_skip(in, 1); // skip <
+    if (r->depth == r->stack_cap) {
+        u32 cap = r->stack_cap ? r->stack_cap * 2 : 16;
+        u32 *offsets = alloc(r->arena, u32, cap, ALLOC_NOZERO);
+        if (r->depth) {
+            memcpy(offsets, r->name_offsets, r->depth * sizeof(*offsets));
+        }
+        r->name_offsets = offsets;
+        r->stack_cap = cap;
+    }
 
-    // meta tag, we don't care about these
-    if (istr_peek(in) == '?') {
-        istr_ignore_and_skip(in, '\n');
-        return NULL;
+    if (r->names_len + name.len > r->names_cap) {
+        usize cap = MAX(r->names_cap * 2, MAX(r->names_len + name.len, 256));
+        u8 *names = alloc(r->arena, u8, cap, ALLOC_NOZERO);
+        if (r->names_len) {
+            memcpy(names, r->names, r->names_len);
+        }
+        r->names = names;
+        r->names_cap = cap;
     }
 
-    xmltag_t *tag = alloc(arena, xmltag_t);
+    r->name_offsets[r->depth++] = (u32)r->names_len;
+    memcpy(r->names + r->names_len, name.buf, name.len);
+    r->names_len += name.len;
+    return true;
+}
 
-    tag->key = strv_trim(istr_get_view_either(in, strv(" >")));
+// the name stays in the buffer until the next push
+static void xml__reader_pop(xml_reader_t *r) {
+    r->name = xml__reader_name_at(r, r->depth - 1);
+    r->names_len = r->name_offsets[--r->depth];
+}
 
-    xmlattr_t *attr = xml__parse_attr(arena, in);
-    while (attr) {
-        attr->next = tag->attributes;
-        tag->attributes = attr;
-        attr = xml__parse_attr(arena, in);
+static xml_event_e xml__reader_begin(xml_reader_t *r) {
+    if (!xml__reader_push(r, r->pending_name)) {
+        return xml__reader_error(r);
     }
 
-    // this tag does not have children, return
-    if (istr_peek(in) == '/') {
-        istr_skip(in, 2); // skip / and >
-        return tag;
+    r->name = r->pending_name;
+    r->attributes = r->pending_attributes;
+    r->attr_cursor = 0;
+
+    if (r->self_closing) {
+        r->pending_ends = 1;
+    }
+    else if (r->flags & XML_HTML &&
+        (xml__name_equals(r->name, strv("script"), true) || xml__name_equals(r->name, strv("style"), true))
+    ) {
+        xml__reader_begin_token(r, XML__READ_RAW);
     }
 
-    istr_skip(in, 1); // skip >
+    return XML_EVENT_TAG_BEGIN;
+}
 
-    xmltag_t *child = xml__parse_tag(arena, in);
-    while (child) {
-        if (tag->tail) {
-            tag->tail->next = child;
-            tag->tail = child;
+// leaves pos after the >, returns false if the chunk ended first
+static bool xml__reader_scan_markup(xml_reader_t *r) {
+    const char *buf = r->chunk.buf;
+    usize len = r->chunk.len;
+
+    while (r->pos < len) {
+        bool is_tag = r->markup == XML__MARKUP_OPEN || r->markup == XML__MARKUP_CLOSE || r->markup == XML__MARKUP_DECL;
+        if (is_tag && !r->match) {
+            // nothing matters until the end of the tag, an = or the end of a quoted value
+            usize start = r->pos;
+            if (r->quote) {
+                while (r->pos < len && buf[r->pos] != r->quote) r->pos++;
+            }
+            else {
+                while (r->pos < len && buf[r->pos] != '>' && buf[r->pos] != '=') r->pos++;
+            }
+            r->seen += (u32)(r->pos - start);
+            if (r->pos == len) {
+                break;
+            }
         }
-        else {
-            tag->child = tag->tail = child;
+
+        char c = buf[r->pos++];
+        u32 seen = r->seen++;
+
+        switch (r->markup) {
+            case XML__MARKUP_UNKNOWN:
+                switch (c) {
+                    case '!': r->markup = XML__MARKUP_BANG;  break;
+                    case '?': r->markup = XML__MARKUP_PI;    break;
+                    case '/': r->markup = XML__MARKUP_CLOSE; break;
+                    case '>': return true;
+                    default:  r->markup = XML__MARKUP_OPEN;  break;
+                }
+                break;
+
+            case XML__MARKUP_BANG:
+                switch (c) {
+                    case '-': r->markup = XML__MARKUP_COMMENT; break;
+                    case '[': r->markup = XML__MARKUP_CDATA;   break;
+                    case '>': return true;
+                    default:  r->markup = XML__MARKUP_DECL;    break;
+                }
+                break;
+
+            case XML__MARKUP_COMMENT:
+                // second - of the opening <!--
+                if (seen == 2) {
+                    break;
+                }
+                if (c == '-') {
+                    r->match = MIN(r->match + 1, 2);
+                }
+                else if (c == '>' && r->match == 2) {
+                    return true;
+                }
+                else {
+                    r->match = 0;
+                }
+                break;
+
+            case XML__MARKUP_CDATA:
+                if (c == ']') {
+                    r->match = MIN(r->match + 1, 2);
+                }
+                else if (c == '>' && r->match == 2) {
+                    return true;
+                }
+                else {
+                    r->match = 0;
+                }
+                break;
+
+            case XML__MARKUP_PI:
+                if (c == '>' && r->match) {
+                    return true;
+                }
+                r->match = c == '?';
+                break;
+
+            default:
+                // only quotes after an = start a value, html allows unquoted ones
+                if (r->quote) {
+                    if (c == r->quote) {
+                        r->quote = 0;
+                    }
+                }
+                else if ((c == '"' || c == '\'') && r->match) {
+                    r->quote = c;
+                }
+                else if (c == '>') {
+                    return true;
+                }
+                r->match = c == '=' || (r->match && char_is_space(c));
+                break;
         }
-        child = xml__parse_tag(arena, in);
     }
 
-    // parse content
-    istr_skip_whitespace(in);
-    tag->content = istr_get_view(in, '<');
+    return false;
+}
 
-    // closing tag
-    istr_skip(in, 2); // skip < and /
-    strview_t closing = strv_trim(istr_get_view(in, '>'));
-    if (!strv_equals(tag->key, closing)) {
-        warn("opening and closing tags are different!: (%v) != (%v)", tag->key, closing);
+static bool xml__reader_close(xml_reader_t *r, strview_t name) {
+    bool is_html = r->flags & XML_HTML;
+
+    u32 index = r->depth;
+    while (index > 0 && !xml__name_equals(xml__reader_name_at(r, index - 1), name, is_html)) {
+        index--;
     }
-    istr_skip(in, 1); // skip >
-    return tag;
-}
 
-// == HTML ===========================================
+    if (index == 0) {
+        // html ignores closing tags that were never opened, like </br>
+        return is_html;
+    }
 
-htmltag_t *html__parse_tag(arena_t *arena, instream_t *in);
+    if (!is_html && index != r->depth) {
+        return false;
+    }
 
-html_t html_parse(arena_t *arena, strview_t filename) {
-   str_t str = os_file_read_all_str(arena, filename);
-   return html_parse_str(arena, strv(str));
+    // html closes every tag that is still open inside this one
+    r->pending_ends = r->depth - index + 1;
+    return true;
 }
 
-html_t html_parse_str(arena_t *arena, strview_t str) {
-    html_t out = {
-        .text = str,
-        .root = alloc(arena, xmltag_t),
-    };
+static bool xml__reader_open(xml_reader_t *r, strview_t token) {
+    bool is_html = r->flags & XML_HTML;
 
-    instream_t in = istr_init(str);
+    usize name_len = 0;
+    while (name_len < token.len && !char_is_space(token.buf[name_len]) && token.buf[name_len] != '/') {
+        name_len++;
+    }
 
-    while (!istr_is_finished(&in)) {
-        htmltag_t *tag = html__parse_tag(arena, &in);
+    strview_t name = strv_sub(token, 0, name_len);
+    if (strv_is_empty(name)) {
+        return false;
+    }
 
-        if (out.tail) out.tail->next = tag;
-        else          out.root->children = tag;
+    strview_t attributes = strv_trim(strv_remove_prefix(token, name_len));
+    r->self_closing = strv_ends_with(attributes, '/');
+    if (r->self_closing) {
+        attributes = strv_trim(strv_sub(attributes, 0, attributes.len - 1));
+    }
 
-        out.tail = tag;
+    if (is_html) {
+        r->self_closing |= xml__name_in(name, html__void_tags, arrlen(html__void_tags));
+
+        // <p> doesn't need to be closed before a block
+        if (r->depth > 0 &&
+            xml__name_equals(xml__reader_name_at(r, r->depth - 1), strv("p"), true) &&
+            xml__name_in(name, html_closing_p_tags, arrlen(html_closing_p_tags))
+        ) {
+            r->pending_ends = 1;
+        }
     }
 
-    return out;
+    r->pending_name = name;
+    r->pending_attributes = attributes;
+    r->pending_begin = true;
+    return true;
 }
 
-htmltag_t *html__get_tag_internal(htmltag_t *parent, str_t key, bool recursive) {
-    htmltag_t *t = parent ? parent->children : NULL;
-    while (t) {
-        if (str_equals(key, t->key)) {
-            return t;
-        }
-        if (recursive && t->children) {
-            htmltag_t *out = html__get_tag_internal(t, key, recursive);
-            if (out) {
-                return out;
+// returns false if there is nothing to report yet
+static bool xml__reader_markup(xml_reader_t *r, strview_t token, xml_event_e *event) {
+    switch (r->markup) {
+        case XML__MARKUP_OPEN:
+            if (!xml__reader_open(r, token)) {
+                *event = xml__reader_error(r);
+                return true;
+            }
+            return false;
+
+        case XML__MARKUP_CLOSE:
+            if (!xml__reader_close(r, strv_trim(strv_remove_prefix(token, 1)))) {
+                *event = xml__reader_error(r);
+                return true;
+            }
+            return false;
+
+        case XML__MARKUP_CDATA:
+        {
+            strview_t open = strv("![CDATA[");
+            if (!strv_starts_with_view(token, open)) {
+                return false;
             }
+            r->text = strv_sub(token, open.len, token.len - 2);
+            *event = XML_EVENT_TEXT;
+            return true;
         }
-        t = t->next;
+
+        case XML__MARKUP_UNKNOWN:
+            // <>
+            *event = xml__reader_error(r);
+            return true;
+
+        // comments, <?xml ?> and <!DOCTYPE >
+        default:
+            return false;
     }
-    return NULL;
 }
 
-htmltag_t *html_get_tag(htmltag_t *parent, strview_t key, bool recursive) {
-    u8 tmpbuf[KB(1)];
-    arena_t scratch = arena_make(ARENA_STATIC, sizeof(tmpbuf), tmpbuf);
-    str_t upper = strv_to_upper(&scratch, key);
-    return html__get_tag_internal(parent, upper, recursive);
-}
+// leaves pos after the </name of the raw tag, returns false if the chunk ended first
+static bool xml__reader_scan_raw(xml_reader_t *r) {
+    const char *buf = r->chunk.buf;
+    usize len = r->chunk.len;
+    strview_t name = xml__reader_name_at(r, r->depth - 1);
 
-strview_t html_get_attribute(htmltag_t *tag, strview_t key) {
-    xmlattr_t *a = tag ? tag->attributes : NULL;
-    while (a) {
-        if (strv_equals(key, a->key)) {
-            return a->value;
+    while (r->pos < len) {
+        char c = buf[r->pos++];
+        if (r->match < 2) {
+            r->match = c == "</"[r->match] ? r->match + 1 : c == '<';
+        }
+        else if (char_lower(c) == char_lower(name.buf[r->match - 2])) {
+            if (++r->match - 2 == name.len) {
+                return true;
+            }
+        }
+        else {
+            r->match = c == '<';
         }
-        a = a->next;
     }
-    return STRV_EMPTY;
+
+    return false;
 }
 
-///// html-private ///////////////////////////////////
+xml_event_e xml_reader_next(xml_reader_t *r) {
+    const char *buf = r->chunk.buf;
+    usize len = r->chunk.len;
 
-/*
+    while (true) {
+        if (r->pending_ends) {
+            r->pending_ends--;
+            xml__reader_pop(r);
+            return XML_EVENT_TAG_END;
+        }
 
-special rules:
- <p> tag does not need to be closed when followed by
-    address, article, aside, blockquote, details, dialog, div,
-    dl, fieldset, figcaption, figure, footer, form, h1, h2, h3,
-    h4, h5, h6, header, hgroup, hr, main, menu, nav, ol, p, pre,
-    search, section, table, or ul
-*/
+        if (r->pending_begin) {
+            r->pending_begin = false;
+            return xml__reader_begin(r);
+        }
 
-strview_t html_closing_p_tags[] = {
-    cstrv("ADDRESS"),
-    cstrv("ARTICLE"),
-    cstrv("ASIDE"),
-    cstrv("BLOCKQUOTE"),
-    cstrv("DETAILS"),
-    cstrv("DIALOG"),
-    cstrv("DIV"),
-    cstrv("DL"),
-    cstrv("FIELDSET"),
-    cstrv("FIGCAPTION"),
-    cstrv("FIGURE"),
-    cstrv("FOOTER"),
-    cstrv("FORM"),
-    cstrv("H1"),
-    cstrv("H2"),
-    cstrv("H3"),
-    cstrv("H4"),
-    cstrv("H5"),
-    cstrv("H6"),
-    cstrv("HEADER"),
-    cstrv("HGROUP"),
-    cstrv("HR"),
-    cstrv("MAIN"),
-    cstrv("MENU"),
-    cstrv("NAV"),
-    cstrv("OL"),
-    cstrv("P"),
-    cstrv("PRE"),
-    cstrv("SEARCH"),
-    cstrv("SECTION"),
-    cstrv("TABLE"),
-    cstrv("UL"),
-};
+        switch (r->state) {
+            case XML__READ_CONTENT:
+                if (r->split_lt) {
+                    // the tag starts with the < at the end of the last chunk
+                    r->split_lt = false;
+                    xml__reader_begin_token(r, XML__READ_MARKUP);
+                    xml__reader_save(r, strv("<"));
+                    r->in_partial = true;
+                    continue;
+                }
+                if (r->pos == len) {
+                    if (!r->is_last) {
+                        return XML_EVENT_NEED_INPUT;
+                    }
+                    if (r->depth && !(r->flags & XML_HTML)) {
+                        return xml__reader_error(r);
+                    }
+                    // html closes whatever is still open
+                    r->pending_ends = r->depth;
+                    r->state = XML__READ_DONE;
+                    continue;
+                }
+                if (buf[r->pos] == '<') {
+                    // the token starts with the < in case it turns out to be text
+                    xml__reader_begin_token(r, XML__READ_MARKUP);
+                    r->pos++;
+                }
+                else {
+                    xml__reader_begin_token(r, XML__READ_TEXT);
+                }
+                continue;
 
-bool html__closes_p_tag(strview_t tag) {
-    for (int i = 0; i < arrlen(html_closing_p_tags); ++i) {
-        if (strv_equals(html_closing_p_tags[i], tag)) {
-            return true;
+            case XML__READ_TEXT:
+            {
+                if (r->split_lt) {
+                    if (r->pos == len && !r->is_last) {
+                        return xml__reader_split_token(r);
+                    }
+                    if (r->pos < len && xml__is_markup_start(buf[r->pos])) {
+                        // the text ends before the <, the content state starts the tag with it
+                        r->state = XML__READ_CONTENT;
+                        strview_t token = xml__reader_token(r, r->pos);
+                        r->text = strv_trim(strv_remove_suffix(token, 1));
+                        if (strv_is_empty(r->text)) {
+                            continue;
+                        }
+                        return XML_EVENT_TEXT;
+                    }
+                    r->split_lt = false;
+                }
+
+                usize end = scan_find(strv(buf + r->pos, len - r->pos), '<');
+                // in html skip the < that can't start a tag
+                while ((r->flags & XML_HTML) && end != STR_NONE) {
+                    usize next = r->pos + end + 1;
+                    if (next < len && xml__is_markup_start(buf[next])) {
+                        break;
+                    }
+                    if (next == len && !r->is_last) {
+                        // the next chunk decides
+                        r->split_lt = true;
+                        end = STR_NONE;
+                        break;
+                    }
+                    usize more = scan_find(strv(buf + next, len - next), '<');
+                    end = more == STR_NONE ? STR_NONE : next - r->pos + more;
+                }
+                if (end == STR_NONE) {
+                    if (!r->is_last) {
+                        return xml__reader_split_token(r);
+                    }
+                    r->pos = len;
+                }
+                else {
+                    r->pos += end;
+                }
+
+                r->state = XML__READ_CONTENT;
+                r->text = strv_trim(xml__reader_token(r, r->pos));
+                if (strv_is_empty(r->text)) {
+                    continue;
+                }
+                return XML_EVENT_TEXT;
+            }
+
+            case XML__READ_MARKUP:
+            {
+                if ((r->flags & XML_HTML) && r->markup == XML__MARKUP_UNKNOWN && r->seen == 0) {
+                    if (r->pos == len && !r->is_last) {
+                        return xml__reader_split_token(r);
+                    }
+                    if (r->pos == len || !xml__is_markup_start(buf[r->pos])) {
+                        // keeps the token, which starts with the <
+                        r->state = XML__READ_TEXT;
+                        continue;
+                    }
+                }
+
+                if (!xml__reader_scan_markup(r)) {
+                    if (r->is_last) {
+                        return xml__reader_error(r);
+                    }
+                    return xml__reader_split_token(r);
+                }
+
+                r->state = XML__READ_CONTENT;
+                // without the < and the >
+                strview_t token = strv_remove_prefix(xml__reader_token(r, r->pos - 1), 1);
+
+                xml_event_e event;
+                if (xml__reader_markup(r, token, &event)) {
+                    return event;
+                }
+                continue;
+            }
+
+            case XML__READ_RAW:
+            {
+                if (!xml__reader_scan_raw(r)) {
+                    if (r->is_last) {
+                        return xml__reader_error(r);
+                    }
+                    return xml__reader_split_token(r);
+                }
+
+                r->state = XML__READ_RAW_END;
+                strview_t token = xml__reader_token(r, r->pos);
+                // without the </name
+                token.len -= 2 + xml__reader_name_at(r, r->depth - 1).len;
+                r->text = strv_trim(token);
+                if (strv_is_empty(r->text)) {
+                    continue;
+                }
+                return XML_EVENT_TEXT;
+            }
+
+            case XML__READ_RAW_END:
+            {
+                usize end = scan_find(strv(buf + r->pos, len - r->pos), '>');
+                if (end == STR_NONE) {
+                    r->pos = len;
+                    if (r->is_last) {
+                        return xml__reader_error(r);
+                    }
+                    return XML_EVENT_NEED_INPUT;
+                }
+                r->pos += end + 1;
+                r->state = XML__READ_CONTENT;
+                r->pending_ends = 1;
+                continue;
+            }
+
+            case XML__READ_DONE:
+                return XML_EVENT_DONE;
+
+            default:
+                return XML_EVENT_ERROR;
         }
     }
-
-    return false;
 }
 
-htmltag_t *html__parse_tag(arena_t *arena, instream_t *in) {
-    istr_skip_whitespace(in);
+bool xml_reader_next_attribute(xml_reader_t *r, xmlattr_t *attr) {
+    strview_t attrs = r->attributes;
+    usize i = r->attr_cursor;
 
-    // we're either parsing the body, or we have finished the object
-    if (istr_peek(in) != '<' || istr_peek_next(in) == '/') {
-        return NULL;
+    while (i < attrs.len && char_is_space(attrs.buf[i])) {
+        i++;
     }
-
-    istr_skip(in, 1); // skip <
-
-    // meta tag, we don't care about these
-    if (istr_peek(in) == '?') {
-        istr_ignore_and_skip(in, '\n');
-        return NULL;
+    if (i >= attrs.len) {
+        r->attr_cursor = i;
+        return false;
     }
 
-    htmltag_t *tag = alloc(arena, htmltag_t);
-
-    tag->key = strv_to_upper(
-        arena, 
-        strv_trim(istr_get_view_either(in, strv(" >")))
-    );
-
-    xmlattr_t *attr = xml__parse_attr(arena, in);
-    while (attr) {
-        attr->next = tag->attributes;
-        tag->attributes = attr;
-        attr = xml__parse_attr(arena, in);
+    usize key_start = i;
+    while (i < attrs.len && attrs.buf[i] != '=' && !char_is_space(attrs.buf[i])) {
+        i++;
     }
+    strview_t key = strv_sub(attrs, key_start, i);
 
-    // this tag does not have children, return
-    if (istr_peek(in) == '/') {
-        istr_skip(in, 2); // skip / and >
-        return tag;
+    while (i < attrs.len && char_is_space(attrs.buf[i])) {
+        i++;
     }
 
-    istr_skip(in, 1); // skip >
-
-    bool is_p_tag = strv_equals(strv(tag->key), strv("P"));
-    while (!istr_is_finished(in)) {
-        istr_skip_whitespace(in);
-        strview_t content = strv_trim(istr_get_view(in, '<'));
-    
-        // skip <
-        istr_skip(in, 1);
-    
-        bool is_closing = istr_peek(in) == '/';
-        if (is_closing) {
-            istr_skip(in, 1);
+    strview_t value = STRV_EMPTY;
+    if (i < attrs.len && attrs.buf[i] == '=') {
+        i++;
+        while (i < attrs.len && char_is_space(attrs.buf[i])) {
+            i++;
         }
 
- 
-        arena_t scratch = *arena;
-        instream_t scratch_in = *in;
-        str_t next_tag = strv_to_upper(&scratch, strv_trim(istr_get_view_either(&scratch_in, strv(" >"))));
-        
-        // rewind <
-        istr_rewind_n(in, 1);
-
-        // if we don't have children, it means this is the only content
-        // otherwise, it means this is content in-between other tags,
-        // if so: create an empty tag with the content and add it as a child
-        if (!strv_is_empty(content)) {
-            if (tag->children == NULL) {
-                tag->content = content;
+        if (i < attrs.len && (attrs.buf[i] == '"' || attrs.buf[i] == '\'')) {
+            char quote = attrs.buf[i++];
+            usize value_start = i;
+            while (i < attrs.len && attrs.buf[i] != quote) {
+                i++;
             }
-            else {
-                htmltag_t *empty = alloc(arena, htmltag_t);
-                empty->content = content;
-                olist_push(tag->children, tag->tail, empty);
+            value = strv_sub(attrs, value_start, i);
+            // skip closing quote
+            i += i < attrs.len;
+        }
+        else {
+            usize value_start = i;
+            while (i < attrs.len && !char_is_space(attrs.buf[i])) {
+                i++;
             }
+            value = strv_sub(attrs, value_start, i);
         }
+    }
 
-        bool close_tag = 
-            (is_closing && str_equals(tag->key, next_tag)) ||
-            (is_p_tag   && html__closes_p_tag(strv(next_tag)));
+    r->attr_cursor = i;
+    *attr = (xmlattr_t){
+        .key = key,
+        .value = value,
+    };
+    return true;
+}
 
-        if (close_tag) {
-            if (is_closing) {
-                istr_skip(in, 2 + next_tag.len);
-            }
+strview_t xml_reader_get_attribute(xml_reader_t *r, strview_t key) {
+    usize cursor = r->attr_cursor;
+    r->attr_cursor = 0;
+
+    strview_t out = STRV_EMPTY;
+    xmlattr_t attr;
+    while (xml_reader_next_attribute(r, &attr)) {
+        if (xml__name_equals(attr.key, key, r->flags & XML_HTML)) {
+            out = attr.value;
             break;
         }
+    }
 
-        htmltag_t *child = html__parse_tag(arena, in);
-        if (tag->tail) {
-            (tag->tail)->next = (child);
-            (tag->tail) = (child);
-        } 
-        else {
-            (tag->children) = (tag->tail) = (child);
+    r->attr_cursor = cursor;
+    return out;
+}
+
+xml_path_t xml_path_init(arena_t *arena, strview_t path) {
+    // there can't be more segments than half the chars, plus one
+    xml_path_t out = {
+        .segments = alloc(arena, strview_t, path.len / 2 + 1),
+    };
+
+    instream_t in = istr_init(path);
+    while (!istr_is_finished(&in)) {
+        strview_t segment = istr_get_view(&in, '/');
+        istr_skip(&in, 1);
+        if (!strv_is_empty(segment)) {
+            out.segments[out.count++] = segment;
         }
     }
 
-    return tag;
+    return out;
+}
+
+bool xml_reader_at(xml_reader_t *r, xml_path_t *path) {
+    if (r->depth != path->count) {
+        return false;
+    }
+    for (u32 i = 0; i < path->count; ++i) {
+        strview_t segment = path->segments[i];
+        if (strv_equals(segment, strv("*"))) {
+            continue;
+        }
+        if (!xml__name_equals(xml__reader_name_at(r, i), segment, r->flags & XML_HTML)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+xml_event_e xml_reader_select(xml_reader_t *r, xml_path_t *paths, int count, int *match) {
+    while (true) {
+        xml_event_e event = xml_reader_next(r);
+        switch (event) {
+            case XML_EVENT_NEED_INPUT:
+            case XML_EVENT_DONE:
+            case XML_EVENT_ERROR:
+                return event;
+            case XML_EVENT_TAG_BEGIN:
+                break;
+            default:
+                continue;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (xml_reader_at(r, &paths[i])) {
+                *match = i;
+                return event;
+            }
+        }
+    }
 }
 
 const char *http_get_method_string(http_method_e method) {
@@ -3175,6 +9192,351 @@ http_res_t http_parse_res(arena_t *arena, strview_t response) {
     return res;
 }
 
+typedef enum {
+    HTTP__PARSE_HEAD,       // looking for the empty line after the headers
+    HTTP__PARSE_BODY,       // waiting for Content-Length bytes
+    HTTP__PARSE_CHUNK_SIZE,
+    HTTP__PARSE_CHUNK_DATA,
+    HTTP__PARSE_CHUNK_END,  // line ending after the chunk data
+    HTTP__PARSE_TRAILER,
+    HTTP__PARSE_FINISHED,   // result is either done or error
+} http__parse_state_e;
+
+http_parser_t http_parser_init(arena_t *arena) {
+    return (http_parser_t){ .arena = arena };
+}
+
+static http_parse_e http__parser_finish(http_parser_t *p, http_parse_e result) {
+    p->state = HTTP__PARSE_FINISHED;
+    p->result = result;
+    return result;
+}
+
+// header names are case insensitive
+static bool http__header_is(strview_t key, strview_t name) {
+    if (key.len != name.len) {
+        return false;
+    }
+    for (usize i = 0; i < key.len; ++i) {
+        if (char_lower(key.buf[i]) != name.buf[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the views in req still point in the old buffer
+static void http__parser_rebase(http_parser_t *p, const char *base) {
+    if (p->base && p->base != base) {
+#define HTTP__REBASE(v) if ((v).buf) (v).buf = base + ((v).buf - p->base)
+        HTTP__REBASE(p->req.url);
+        for_each (h, p->req.headers) {
+            HTTP__REBASE(h->key);
+            HTTP__REBASE(h->value);
+        }
+#undef HTTP__REBASE
+    }
+    p->base = base;
+}
+
+// gets the line at pos without the line ending and moves pos after it
+static bool http__parser_line(http_parser_t *p, strview_t buf, strview_t *line) {
+    const char *nl = memchr(buf.buf + p->pos, '\n', buf.len - p->pos);
+    if (!nl) {
+        return false;
+    }
+    usize end = nl - buf.buf;
+    *line = strv(buf.buf + p->pos, end - p->pos);
+    if (strv_ends_with(*line, '\r')) {
+        *line = strv_remove_suffix(*line, 1);
+    }
+    p->pos = end + 1;
+    return true;
+}
+
+// clients can send an empty line after a body, it's not part of the next request
+static usize http__skip_empty_lines(strview_t buf) {
+    usize pos = 0;
+    while (pos < buf.len && (buf.buf[pos] == '\r' || buf.buf[pos] == '\n')) {
+        pos++;
+    }
+    return pos;
+}
+
+// looks for an empty line, starting from the last line ending that could be part of it
+static bool http__parser_find_head(http_parser_t *p, strview_t buf) {
+    while (p->pos < buf.len) {
+        const char *nl = memchr(buf.buf + p->pos, '\n', buf.len - p->pos);
+        if (!nl) {
+            p->pos = buf.len;
+            break;
+        }
+
+        usize i = nl - buf.buf;
+        if (i + 1 == buf.len || (buf.buf[i + 1] == '\r' && i + 2 == buf.len)) {
+            p->pos = i;
+            break;
+        }
+        if (buf.buf[i + 1] == '\n') {
+            p->header_len = i + 2;
+            return true;
+        }
+        if (buf.buf[i + 1] == '\r' && buf.buf[i + 2] == '\n') {
+            p->header_len = i + 3;
+            return true;
+        }
+        p->pos = i + 1;
+    }
+    return false;
+}
+
+static bool http__parse_length(strview_t value, usize *length) {
+    if (value.len == 0 || value.len > 18) {
+        return false;
+    }
+    usize out = 0;
+    for (usize i = 0; i < value.len; ++i) {
+        if (!char_is_num(value.buf[i])) {
+            return false;
+        }
+        out = out * 10 + (value.buf[i] - '0');
+    }
+    *length = out;
+    return true;
+}
+
+// hex size, optionally followed by extensions that are ignored
+static bool http__parse_chunk_size(strview_t line, usize *size) {
+    usize out = 0;
+    usize i = 0;
+    for (; i < line.len && char_is_hex(line.buf[i]); ++i) {
+        if (i == 15) {
+            return false;
+        }
+        char c = char_lower(line.buf[i]);
+        out = out * 16 + (c <= '9' ? c - '0' : c - 'a' + 10);
+    }
+    if (i == 0) {
+        return false;
+    }
+    strview_t rest = strv_trim(strv_sub(line, i, SIZE_MAX));
+    if (rest.len > 0 && rest.buf[0] != ';') {
+        return false;
+    }
+    *size = out;
+    return true;
+}
+
+// pos is on the request line
+static bool http__parser_parse_head(http_parser_t *p, strview_t head) {
+    strview_t request_line = STRV_EMPTY;
+    http__parser_line(p, head, &request_line);
+
+    instream_t line = istr_init(request_line);
+    strview_t method  = istr_get_view(&line, ' ');
+    istr_skip(&line, 1);
+    strview_t url     = istr_get_view(&line, ' ');
+    istr_skip(&line, 1);
+    strview_t version = istr_get_view_len(&line, SIZE_MAX);
+
+    strview_t methods[5] = { strv("GET"), strv("POST"), strv("HEAD"), strv("PUT"), strv("DELETE") };
+    usize method_index = 0;
+    while (method_index < arrlen(methods) && !strv_equals(method, methods[method_index])) {
+        method_index++;
+    }
+    if (method_index == arrlen(methods)) {
+        return false;
+    }
+    p->req.method = (http_method_e)method_index;
+
+    if (!strv_starts_with(url, '/')) {
+        return false;
+    }
+    p->req.url = strv_remove_prefix(url, 1);
+
+    if (version.len != 8 ||
+        !strv_starts_with_view(version, strv("HTTP/")) ||
+        !char_is_num(version.buf[5]) ||
+        version.buf[6] != '.' ||
+        !char_is_num(version.buf[7])
+    ) {
+        return false;
+    }
+    p->req.version.major = version.buf[5] - '0';
+    p->req.version.minor = version.buf[7] - '0';
+
+    bool has_length = false;
+    bool has_encoding = false;
+
+    strview_t header = STRV_EMPTY;
+    while (http__parser_line(p, head, &header) && !strv_is_empty(header)) {
+
+        // folded lines are obsolete, and so are spaces before the colon
+        usize colon = strv_find(header, ':', 0);
+        if (colon == STR_NONE || colon == 0 || char_is_space(header.buf[0]) || char_is_space(header.buf[colon - 1])) {
+            return false;
+        }
+
+        http_header_t *h = alloc(p->arena, http_header_t);
+        h->key = strv_sub(header, 0, colon);
+        h->value = strv_trim(strv_sub(header, colon + 1, SIZE_MAX));
+        list_push(p->req.headers, h);
+
+        if (http__header_is(h->key, strv("content-length"))) {
+            usize length = 0;
+            // different lengths are how requests get smuggled
+            if (!http__parse_length(h->value, &length) || (has_length && length != p->content_length)) {
+                return false;
+            }
+            p->content_length = length;
+            has_length = true;
+        }
+        else if (http__header_is(h->key, strv("transfer-encoding"))) {
+            // chunked has to be the last encoding, otherwise there is no way to know where the body ends
+            strview_t encoding = h->value;
+            usize comma = strv_rfind(encoding, ',', 0);
+            if (comma != STR_NONE) {
+                encoding = strv_trim(strv_sub(encoding, comma + 1, SIZE_MAX));
+            }
+            if (has_encoding || !http__header_is(encoding, strv("chunked"))) {
+                return false;
+            }
+            has_encoding = true;
+        }
+    }
+
+    if (has_length && has_encoding) {
+        return false;
+    }
+
+    p->is_chunked = has_encoding;
+    return true;
+}
+
+// second pass over the chunks, they were all checked already
+static strview_t http__parser_join_chunks(http_parser_t *p, strview_t buf) {
+    char *body = alloc(p->arena, char, p->content_length + 1, ALLOC_NOZERO);
+    usize len = 0;
+
+    p->pos = p->header_len;
+    while (true) {
+        strview_t line = STRV_EMPTY;
+        usize size = 0;
+        http__parser_line(p, buf, &line);
+        http__parse_chunk_size(line, &size);
+        if (size == 0) {
+            break;
+        }
+        memcpy(body + len, buf.buf + p->pos, size);
+        len += size;
+        p->pos += size;
+        http__parser_line(p, buf, &line);
+    }
+
+    body[len] = '\0';
+    p->pos = p->end;
+    return strv(body, len);
+}
+
+http_parse_e http_parser_feed(http_parser_t *p, strview_t buf) {
+    if (p->state == HTTP__PARSE_FINISHED) {
+        return p->result;
+    }
+
+    http__parser_rebase(p, buf.buf);
+
+    if (p->state == HTTP__PARSE_HEAD) {
+        // the empty lines before the request line can also come in more than one read
+        usize start = http__skip_empty_lines(buf);
+        if (p->pos < start) {
+            p->pos = start;
+        }
+        if (!http__parser_find_head(p, buf)) {
+            if (p->pos > COLLA_HTTP_MAX_HEADER_SIZE) {
+                return http__parser_finish(p, HTTP_PARSE_ERROR);
+            }
+            return HTTP_PARSE_NEED_MORE;
+        }
+        p->pos = http__skip_empty_lines(buf);
+        if (p->header_len > COLLA_HTTP_MAX_HEADER_SIZE || !http__parser_parse_head(p, strv(buf.buf, p->header_len))) {
+            return http__parser_finish(p, HTTP_PARSE_ERROR);
+        }
+
+        p->pos = p->header_len;
+        if (p->is_chunked) {
+            // the decoded length goes in content_length
+            p->content_length = 0;
+            p->state = HTTP__PARSE_CHUNK_SIZE;
+        }
+        else {
+            p->state = HTTP__PARSE_BODY;
+        }
+    }
+
+    if (p->state == HTTP__PARSE_BODY) {
+        if (buf.len - p->header_len < p->content_length) {
+            return HTTP_PARSE_HEADERS_DONE;
+        }
+        p->end = p->header_len + p->content_length;
+        if (p->content_length > 0) {
+            p->req.body = strv(buf.buf + p->header_len, p->content_length);
+        }
+        return http__parser_finish(p, HTTP_PARSE_DONE);
+    }
+
+    while (true) {
+        strview_t line = STRV_EMPTY;
+
+        if (p->state == HTTP__PARSE_CHUNK_DATA) {
+            usize available = MIN(buf.len - p->pos, p->chunk_left);
+            p->pos += available;
+            p->chunk_left -= available;
+            if (p->chunk_left > 0) {
+                return HTTP_PARSE_HEADERS_DONE;
+            }
+            p->state = HTTP__PARSE_CHUNK_END;
+        }
+
+        if (!http__parser_line(p, buf, &line)) {
+            // a size or a trailer line can't be this long
+            if (buf.len - p->pos > KB(8)) {
+                return http__parser_finish(p, HTTP_PARSE_ERROR);
+            }
+            return HTTP_PARSE_HEADERS_DONE;
+        }
+
+        switch (p->state) {
+            case HTTP__PARSE_CHUNK_SIZE:
+            {
+                usize size = 0;
+                if (!http__parse_chunk_size(line, &size) || size > SIZE_MAX - p->content_length) {
+                    return http__parser_finish(p, HTTP_PARSE_ERROR);
+                }
+                p->content_length += size;
+                p->chunk_left = size;
+                p->state = size ? HTTP__PARSE_CHUNK_DATA : HTTP__PARSE_TRAILER;
+                break;
+            }
+            case HTTP__PARSE_CHUNK_END:
+                if (!strv_is_empty(line)) {
+                    return http__parser_finish(p, HTTP_PARSE_ERROR);
+                }
+                p->state = HTTP__PARSE_CHUNK_SIZE;
+                break;
+            case HTTP__PARSE_TRAILER:
+                // trailer fields are read but not kept
+                if (strv_is_empty(line)) {
+                    p->end = p->pos;
+                    p->req.body = http__parser_join_chunks(p, buf);
+                    return http__parser_finish(p, HTTP_PARSE_DONE);
+                }
+                break;
+            default:
+                break;
+        }
+    }
+}
+
 str_t http_req_to_str(arena_t *arena, http_req_t *req) {
     outstream_t out = ostr_init(arena);
 
@@ -3217,6 +9579,11 @@ str_t http_res_to_str(arena_t *arena, http_res_t *res) {
         res->status_code, 
         http_get_status_string(res->status_code)
     );
+
+    for_each (h, res->headers) {
+        ostr_print(&out, "%v: %v\r\n", h->key, h->value);
+    }
+
     ostr_puts(&out, strv("\r\n"));
     ostr_puts(&out, res->body);
 
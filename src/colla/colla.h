@@ -29,10 +29,35 @@ extern void *memmove(void *dst, const void *src, size_t size);
 
 typedef enum {
     COLLA_DARRAY_BLOCK_SIZE       = 64,
-    COLLA_RG_MAX_MATCHES          = 16,
+    COLLA_RG_MAX_INSTS            = 1 << 16,
+    COLLA_RG_MAX_REPEAT           = 1000,
+    COLLA_RG_DFA_MAX_STATES       = 1024,
     COLLA_OS_ARENA_SIZE           = 1 << 20, // MB(1)
     COLLA_OS_MAX_WAITABLE_HANDLES = 256,
     COLLA_LOG_MAX_CALLBACKS       = 22,
+    COLLA_FMT_BUFFER_SIZE         = 1 << 16, // KB(64)
+    COLLA_JQ_DEQUE_SIZE           = 256,
+    COLLA_BARRIER_SPIN_COUNT      = 1 << 12,
+    COLLA_CHUNK_BLOCK_SIZE        = 1 << 16, // KB(64)
+    COLLA_SEARCH_SKIP_TABLE_LEN   = 32,
+    COLLA_SEARCH_SKIP_TABLE_MIN_TEXT = 1 << 12, // KB(4)
+    COLLA_DIR_BUFFER_SIZE         = 1 << 15, // KB(32)
+    COLLA_SCRATCH_COUNT           = 2,
+    COLLA_SCRATCH_MAX_CONFLICTS   = 4,
+    COLLA_SCRATCH_SIZE            = 1 << 28, // MB(256)
+    COLLA_SCRATCH_DECOMMIT_THRESHOLD = 1 << 24, // MB(16)
+    COLLA_POOL_BLOCK_SIZE         = 1 << 12, // KB(4)
+    COLLA_SLAB_MIN_SIZE           = 16,
+    COLLA_SLAB_CLASS_COUNT        = 9, // 16B to 4KB
+    COLLA_ARENA_STATS_MAX_ARENAS  = 256,
+    COLLA_ARENA_STATS_MAX_SITES   = 64,
+    COLLA_HUGE_PAGE_SIZE          = 1 << 21, // MB(2)
+    COLLA_JSON_INDEX_MIN          = 16,
+    COLLA_JSON_TAPE_BATCH         = 1 << 14,
+    COLLA_JSON_MAX_DEPTH          = 1024,
+    COLLA_INI_INDEX_MIN           = 16,
+    COLLA_XML_MAX_DEPTH           = 1024,
+    COLLA_HTTP_MAX_HEADER_SIZE    = 1 << 16, // KB(64)
 } colla_constants_e;
 
 // CORE MODULES /////////////////////////////////
@@ -241,8 +266,24 @@ typedef struct arena_t arena_t;
 
 // FORMATTING ///////////////////////////////////
 
+// stdout is buffered per thread, the buffer is written when it fills up,
+// on fmt_flush or when the thread exits. if stdout is a terminal it is also
+// written on every newline. os_file_write on os_stdout() goes in the same buffer.
+// on exit and os_abort the buffers of every thread still running are written too
 int fmt_print(const char *fmt, ...);
 int fmt_printv(const char *fmt, va_list args);
+// same as fmt_print, but the formatted text is guaranteed to reach stdout 
+// in one piece, without output from other threads in the middle
+int fmt_record(const char *fmt, ...);
+int fmt_recordv(const char *fmt, va_list args);
+void fmt_write(const void *buf, usize len);
+void fmt_flush(void);
+// writes the buffers of every live thread, not only the calling one
+void fmt_flush_all(void);
+// flushes and forgets the calling thread's buffer, os_thread_launch
+// calls this when the thread returns. threads started some other way
+// have to call it themselves before they exit
+void fmt_release(void);
 int fmt_buffer(char *buf, usize len, const char *fmt, ...);
 int fmt_bufferv(char *buf, usize len, const char *fmt, va_list args);
 
@@ -482,6 +523,68 @@ usize strv_find_either(strview_t ctx, strview_t chars, usize from);
 usize strv_rfind(strview_t ctx, char c, usize from_right);
 usize strv_rfind_view(strview_t ctx, strview_t view, usize from_right);
 
+// SCAN /////////////////////////////////////////
+
+// byte scanning kernels, on x64 they use SSE2 and switch to AVX2
+// at runtime if the cpu supports it, everywhere else they are scalar.
+// the find functions return STR_NONE when there is no match
+
+usize scan_find(strview_t ctx, char c);
+usize scan_rfind(strview_t ctx, char c);
+usize scan_count(strview_t ctx, char c);
+// n starts from 1, scan_find_nth(ctx, c, 1) == scan_find(ctx, c)
+usize scan_find_nth(strview_t ctx, char c, usize n);
+usize scan_rfind_nth(strview_t ctx, char c, usize n);
+
+// goes through the position of every c in order, e.g. 
+// to get the line offsets:
+//     scan_iter_t it = scan_iter_init(data, '\n');
+//     usize pos = 0;
+//     while (scan_iter_next(&it, &pos)) { ... }
+typedef struct scan_iter_t scan_iter_t;
+struct scan_iter_t {
+    strview_t data;
+    usize next;
+    usize base;
+    u64 mask;
+    char c;
+};
+
+scan_iter_t scan_iter_init(strview_t ctx, char c);
+bool scan_iter_next(scan_iter_t *it, usize *pos);
+
+// which kernel set is used, mostly useful to benchmark 
+// and check the scalar versions
+typedef enum {
+    SCAN_ISA_SCALAR,
+    SCAN_ISA_SSE2,
+    SCAN_ISA_AVX2,
+} scan_isa_e;
+
+scan_isa_e scan_get_isa(void);
+// returns false if the cpu doesn't support it
+bool scan_set_isa(scan_isa_e isa);
+
+// SEARCH ///////////////////////////////////////
+
+// substring search, the strategy is picked from the needle: short needles
+// are found by looking for their first and last byte with the scan kernels,
+// long ones (COLLA_SEARCH_SKIP_TABLE_LEN and up) use Boyer-Moore-Horspool.
+// init it once to search the same needle many times, the needle 
+// has to stay valid while the searcher is used
+typedef struct searcher_t searcher_t;
+struct searcher_t {
+    strview_t needle;
+    bool use_skip_table;
+    u16 skip[256];
+    u16 rskip[256];
+};
+
+searcher_t searcher_init(strview_t needle);
+// same as strv_find_view and strv_rfind_view
+usize searcher_find(const searcher_t *s, strview_t ctx, usize from);
+usize searcher_rfind(const searcher_t *s, strview_t ctx, usize from_right);
+
 // CTYPE ////////////////////////////////////////
 
 bool char_is_space(char c);
@@ -532,6 +635,8 @@ usize istr_remaining(instream_t *ctx);
 bool istr_is_finished(instream_t *ctx);
 
 bool istr_get_bool(instream_t *ctx, bool *val);
+// numbers are read only up to the end of the stream, integers are decimal or
+// start with 0x. they return false and leave val alone if the number doesn't fit
 bool istr_get_u8(instream_t *ctx, u8 *val);
 bool istr_get_u16(instream_t *ctx, u16 *val);
 bool istr_get_u32(instream_t *ctx, u32 *val);
@@ -606,20 +711,50 @@ bool ibstr_get_i64(ibstream_t *ib, i64 *out);
 
 // REGEX ////////////////////////////////////////
 
-// typedef struct rg_result_t rg_result_t;
-// struct rg_result_t {
-//     strview_t text;
-//     i64 offset;
-// };
-//
-// typedef struct rg_match_t rg_match_t;
-// struct rg_match_t {
-//     rg_result_t matches[COLLA_RG_MAX_MATCHES];
-//     int count;
-//     bool found_match;
-// };
+// regular expressions compiled to a nfa and matched with a dfa that is 
+// built lazily, so matching is always linear in the length of the text.
+// supports literals, ., [a-z] and [^a-z] classes, \d \w \s \D \W \S, 
+// escapes, (groups), | alternation, ^ $ anchors, * + ? and {n} {n,} {n,m}.
+// without ^ the pattern can match anywhere in the text.
+// an rg_t is read only once compiled and can be shared between threads,
+// each thread needs its own rg_cache_t
+
+typedef enum {
+    RG_DEFAULT     = 0,
+    RG_IGNORE_CASE = 1 << 0,
+} rg_flags_e;
+
+typedef struct rg_t rg_t;
+typedef struct rg_cache_t rg_cache_t;
 
+// returns NULL and logs an error if the pattern is not valid
+rg_t *rg_compile(arena_t *arena, strview_t pattern, rg_flags_e flags);
+rg_cache_t *rg_cache_init(arena_t *arena, const rg_t *rg);
+bool rg_match(rg_cache_t *cache, strview_t text);
+
+// compiles rg every time, only use it for one off matches
 bool rg_matches(strview_t rg, strview_t text);
+
+// GLOB /////////////////////////////////////////
+
+// * matches any string, ? any character, [a-z] and [!a-z] match a group 
+// and [a-z]+ matches it one or more times. the whole text has to match.
+// glob_compile once and reuse it to match many texts, it's read only
+// so it can be shared between threads. glob_match only uses scratch for
+// texts of 256 bytes or more with [..]+ in the pattern, nothing is kept in it
+
+typedef enum {
+    GLOB_DEFAULT     = 0,
+    // doesn't need to allocate or convert the text
+    GLOB_IGNORE_CASE = 1 << 0,
+} glob_flags_e;
+
+typedef struct glob_prog_t glob_prog_t;
+
+glob_prog_t *glob_compile(arena_t *arena, strview_t glob, glob_flags_e flags);
+bool glob_match(arena_t scratch, const glob_prog_t *glob, strview_t text);
+
+// compiles glob every time, only use it for one off matches
 bool glob_matches(strview_t glob, strview_t text);
 
 /////////////////////////////////////////////////
@@ -644,12 +779,33 @@ typedef enum alloc_flags_e {
     ALLOC_SOFT_FAIL  = 1 << 1,
 } alloc_flags_e;
 
+// only used by virtual arenas
+typedef enum arena_flags_e {
+    ARENA_FLAGS_NONE = 0,
+    // transparent huge pages, memory is reserved and committed in COLLA_HUGE_PAGE_SIZE blocks
+    ARENA_HUGE_PAGES = 1 << 0,
+    // like ARENA_HUGE_PAGES, but first try the preallocated huge pages pool (linux only)
+    ARENA_HUGETLB    = 1 << 1,
+    // fault in the memory when it's committed instead of on first touch
+    ARENA_PREFAULT   = 1 << 2,
+    // decommitted memory is only taken back when the os needs it (MADV_FREE/MEM_RESET)
+    ARENA_LAZY_DECOMMIT = 1 << 3,
+} arena_flags_e;
+
+typedef struct arena_stats_t arena_stats_t;
+
 typedef struct arena_t arena_t;
 struct arena_t {
     u8 *beg;
     u8 *cur;
     u8 *end;
     arena_type_e type;
+    arena_flags_e flags;
+    // virtual arenas commit memory in blocks of this size
+    usize commit_size;
+    // NULL unless arena stats were enabled when the arena was made,
+    // copies of the arena share it
+    arena_stats_t *stats;
 };
 
 typedef struct arena_desc_t arena_desc_t;
@@ -657,6 +813,19 @@ struct arena_desc_t {
     arena_type_e type;
     usize size;
     u8 *static_buffer;
+    arena_flags_e flags;
+    // rounded up to a power of two, defaults to the page size
+    usize commit_size;
+    // when arena_trim finds more than this committed past the position,
+    // the memory is given back to the os, keeping half of it (0 = never)
+    usize decommit_threshold;
+    // arena_trim also gives back the memory past the position if it has been
+    // this long since the last time (0 = never)
+    u32 decommit_interval_ms;
+    // only used by the arena stats
+    const char *name;
+    const char *file;
+    int line;
 };
 
 typedef struct arena_alloc_desc_t arena_alloc_desc_t;
@@ -666,13 +835,15 @@ struct arena_alloc_desc_t {
     alloc_flags_e flags;
     usize align;
     usize size;
+    const char *file;
+    int line;
 };
 
-// arena_type_e type, usize allocation, [ byte *static_buffer ]
-#define arena_make(...) arena_init(&(arena_desc_t){ __VA_ARGS__ })
+// arena_type_e type, usize allocation, [ byte *static_buffer, arena_flags_e flags, usize commit_size, usize decommit_threshold, u32 decommit_interval_ms, const char *name ]
+#define arena_make(...) arena_init(&(arena_desc_t){ __VA_ARGS__, .file = __FILE__, .line = __LINE__ })
 
 // arena_t *arena, T type, [ usize count, alloc_flags_e flags, usize align, usize size ]
-#define alloc(arenaptr, type, ...) arena_alloc(&(arena_alloc_desc_t){ .size = sizeof(type), .count = 1, .align = alignof(type), .arena = arenaptr, __VA_ARGS__ })
+#define alloc(arenaptr, type, ...) arena_alloc(&(arena_alloc_desc_t){ .file = __FILE__, .line = __LINE__, .size = sizeof(type), .count = 1, .align = alignof(type), .arena = arenaptr, __VA_ARGS__ })
 
 // simple arena that always calls malloc internally, this is useful if you need
 // malloc for some reason but want to still use the arena interface
@@ -692,6 +863,187 @@ usize arena_remaining(arena_t *arena);
 usize arena_capacity(arena_t *arena);
 void arena_rewind(arena_t *arena, usize from_start);
 void arena_pop(arena_t *arena, usize amount);
+// applies the decommit policy of a virtual arena, rewinds don't do it on their own
+// because a copy of the arena could still be using memory past the position.
+// call it once nothing past the position is in use anymore
+void arena_trim(arena_t *arena);
+// total memory given back to the os by the decommit policy
+usize arena_decommitted_bytes(arena_t *arena);
+
+// remembers the position of an arena, arena_temp_end rewinds it back there
+typedef struct arena_temp_t arena_temp_t;
+struct arena_temp_t {
+    arena_t *arena;
+    usize pos;
+};
+
+arena_temp_t arena_temp_begin(arena_t *arena);
+void arena_temp_end(arena_temp_t *temp);
+
+// ARENA STATS //////////////////////////////////
+
+// compiled in unless COLLA_NO_ARENA_STATS is set, but only arenas made
+// after arena_stats_enable(true) are tracked, the rest cost a NULL check
+
+typedef struct arena_site_t arena_site_t;
+struct arena_site_t {
+    const char *file;
+    int line;
+    usize count;
+    usize bytes;
+};
+
+struct arena_stats_t {
+    const char *name;
+    const char *file;
+    int line;
+    arena_type_e type;
+    usize capacity;
+    usize alloc_count;
+    // total bytes handed out, rewinding doesn't subtract from it
+    usize allocated;
+    // highest position the arena ever reached
+    usize peak;
+    // only for virtual arenas, committed is the highest it ever was
+    usize committed;
+    usize commit_count;
+    usize decommitted;
+    usize rewind_count;
+    bool released;
+    arena_site_t sites[COLLA_ARENA_STATS_MAX_SITES];
+    // allocations that didn't fit in the sites table
+    usize other_sites_count;
+    usize other_sites_bytes;
+};
+
+void arena_stats_enable(bool enable);
+bool arena_stats_is_enabled(void);
+arena_stats_t *arena_stats_get(int *out_count);
+// prints a table with every tracked arena and their biggest call sites
+void arena_stats_print(void);
+
+// SCRATCH //////////////////////////////////////
+
+// every thread has a pool of COLLA_SCRATCH_COUNT arenas, reserved the first time
+// they're needed. scratch_begin returns one that doesn't use the same memory as
+// any of the arenas passed in (copies of an arena count as the same arena), so
+// pass in every arena that the result could be allocated in.
+// they give memory back past COLLA_SCRATCH_DECOMMIT_THRESHOLD, long running loops
+// should call arena_trim on the arena after scratch_end
+// [ arena_t *conflicts... ]
+#define scratch_begin(...) scratch__begin((arena_t *[COLLA_SCRATCH_MAX_CONFLICTS + 1]){ NULL, __VA_ARGS__ })
+#define scratch_end(temp) arena_temp_end(temp)
+
+// the scratch arena is rewound at the end of the block, don't break or return out of it
+// arena_temp_t name, [ arena_t *conflicts... ]
+#define scratch_scope(name, ...) for (arena_temp_t name = scratch_begin(__VA_ARGS__); name.arena; scratch_end(&name))
+
+arena_temp_t scratch__begin(arena_t **conflicts);
+// frees the scratch arenas of the calling thread, threads started with
+// os_thread_launch and colla_cleanup call this automatically
+void scratch_release(void);
+
+// POOL /////////////////////////////////////////
+
+// fixed size objects carved from an arena COLLA_POOL_BLOCK_SIZE bytes at a time,
+// freed objects go in a free list and are reused first.
+// a pool belongs to one thread, other threads can give objects back with
+// pool_free_remote, the owner takes them back when its free list is empty
+typedef struct pool_t pool_t;
+struct pool_t {
+    arena_t *arena;
+    usize size;
+    usize align;
+    void *free;
+    i64 remote_free; // void *
+    u8 *block_cur;
+    u8 *block_end;
+};
+
+pool_t pool_init(arena_t *arena, usize size, usize align);
+// arena_t *arena, T type
+#define pool_make(arenaptr, type) pool_init(arenaptr, sizeof(type), alignof(type))
+
+typedef struct pool_alloc_desc_t pool_alloc_desc_t;
+struct pool_alloc_desc_t {
+    pool_t *pool;
+    alloc_flags_e flags;
+};
+
+// the object is zeroed unless ALLOC_NOZERO is passed
+void *pool_alloc_desc(pool_alloc_desc_t *desc);
+// pool_t *pool, [ alloc_flags_e flags ]
+#define pool_alloc(poolptr, ...) pool_alloc_desc(&(pool_alloc_desc_t){ .pool = poolptr, __VA_ARGS__ })
+void pool_free(pool_t *pool, void *ptr);
+// safe to call from any thread
+void pool_free_remote(pool_t *pool, void *ptr);
+
+// SLAB /////////////////////////////////////////
+
+// a pool for every power of two size from COLLA_SLAB_MIN_SIZE, bigger
+// allocations go straight in the arena and are never reused
+typedef struct slab_t slab_t;
+struct slab_t {
+    arena_t *arena;
+    pool_t classes[COLLA_SLAB_CLASS_COUNT];
+};
+
+slab_t slab_init(arena_t *arena);
+void *slab_alloc(slab_t *slab, usize size);
+// size has to be the same that was passed to slab_alloc
+void slab_free(slab_t *slab, void *ptr, usize size);
+void slab_free_remote(slab_t *slab, void *ptr, usize size);
+
+// HASH MAP /////////////////////////////////////
+
+// open addressing hash map with a control byte for every slot, probing checks
+// 16 slots at a time (swiss table style). keys are not copied, a map uses either
+// strview_t or integer keys, never both.
+// the table grows at 7/8 load and the old one is left in the arena, so entry
+// pointers are only valid until the next hmap_set
+typedef struct hmap_entry_t hmap_entry_t;
+struct hmap_entry_t {
+    strview_t key; // integer keys have a NULL buf and the key in len
+    u64 hash;
+    void *value;
+};
+
+typedef struct hmap_t hmap_t;
+struct hmap_t {
+    arena_t *arena;
+    u8 *ctrl;
+    hmap_entry_t *entries;
+    usize cap;
+    usize count;
+    usize deleted;
+};
+
+// count is how many entries to make room for, the map can still grow past it
+hmap_t hmap_init(arena_t *arena, usize count);
+
+u64 hmap_hash(strview_t key);
+u64 hmap_hash_u64(u64 key);
+
+// returns NULL if the key is not in the map
+hmap_entry_t *hmap_get(hmap_t *map, strview_t key);
+// adds the key or replaces its value
+hmap_entry_t *hmap_set(hmap_t *map, strview_t key, void *value);
+bool hmap_remove(hmap_t *map, strview_t key);
+
+// same as above with the hash already computed by hmap_hash
+hmap_entry_t *hmap_get_hashed(hmap_t *map, strview_t key, u64 hash);
+hmap_entry_t *hmap_set_hashed(hmap_t *map, strview_t key, u64 hash, void *value);
+bool hmap_remove_hashed(hmap_t *map, strview_t key, u64 hash);
+
+hmap_entry_t *hmap_get_u64(hmap_t *map, u64 key);
+hmap_entry_t *hmap_set_u64(hmap_t *map, u64 key, void *value);
+bool hmap_remove_u64(hmap_t *map, u64 key);
+
+// pass NULL to get the first entry, returns NULL after the last one.
+// removing the current entry while iterating is fine
+hmap_entry_t *hmap_next(hmap_t *map, hmap_entry_t *prev);
+
+#define hmap_for_each(it, map) for (hmap_entry_t *it = hmap_next(map, NULL); it; it = hmap_next(map, it))
 
 // OS LAYER /////////////////////////////////////
 
@@ -721,6 +1073,8 @@ struct os_system_info_t {
 void os_init(void);
 void os_cleanup(void);
 os_system_info_t os_get_system_info(void);
+// monotonic clock in milliseconds
+u64 os_time_ms(void);
 void os_abort(int code);
 
 iptr os_get_last_error(void);
@@ -879,12 +1233,60 @@ buffer_t os_file_read_all_fp(arena_t *arena, oshandle_t handle);
 str_t os_file_read_all_str(arena_t *arena, strview_t path);
 str_t os_file_read_all_str_fp(arena_t *arena, oshandle_t handle);
 
+// read only view of a file from the current position to the end, regular
+// files are memory mapped, anything else (pipes, consoles) is read in the arena
+typedef struct os_file_view_t os_file_view_t;
+struct os_file_view_t {
+    strview_t data;
+    // only set if the file was mapped
+    void *base;
+    usize size;
+    uptr mapping;
+};
+
+os_file_view_t os_file_map(arena_t *arena, oshandle_t handle);
+void os_file_unmap(os_file_view_t *view);
+
+// reads a file one block at a time, whatever wasn't consumed is carried
+// over to the start of the buffer before reading the next block so records 
+// that span two blocks come out whole. the buffer grows if a single record
+// doesn't fit. regular files are mapped and come out as a single block.
+// the records returned are only valid until the next call
+typedef struct chunkstream_t chunkstream_t;
+struct chunkstream_t {
+    oshandle_t handle;
+    arena_t *arena;
+    os_file_view_t view;
+    char *buf;
+    usize cap;
+    usize beg;
+    usize end;
+    // number of bytes consumed so far
+    usize offset;
+    bool is_finished;
+    // false if the last record was cut short by the end of the file
+    bool terminated;
+};
+
+// pass 0 to block_size to use COLLA_CHUNK_BLOCK_SIZE
+chunkstream_t chunk_init(arena_t *arena, oshandle_t handle, usize block_size);
+void chunk_cleanup(chunkstream_t *cs);
+bool chunk_is_mapped(chunkstream_t *cs);
+// strips the '\n' and, if there is one, the '\r' before it
+bool chunk_get_line(chunkstream_t *cs, strview_t *line);
+bool chunk_get_delim(chunkstream_t *cs, char delim, strview_t *record);
+// the last record can be shorter than size
+bool chunk_get_fixed(chunkstream_t *cs, usize size, strview_t *record);
+// everything that is buffered, or what a single read returns if nothing is
+bool chunk_get_any(chunkstream_t *cs, strview_t *record);
+
 bool os_file_write_all(strview_t name, buffer_t buffer);
 bool os_file_write_all_fp(oshandle_t handle, buffer_t buffer);
 
 bool os_file_write_all_str(strview_t name, strview_t data);
 bool os_file_write_all_str_fp(oshandle_t handle, strview_t data);
 
+// last write time in 100ns ticks since 1601 (FILETIME) on every platform
 u64 os_file_time(strview_t path);
 u64 os_file_time_fp(oshandle_t handle);
 bool os_file_has_changed(strview_t path, u64 last_change);
@@ -900,7 +1302,11 @@ typedef struct dir_entry_t dir_entry_t;
 struct dir_entry_t {
     str_t name;
     dir_type_e type;
+    // only valid after os_dir_entry_size/os_dir_entry_time, which may need
+    // an extra syscall on some platforms
     usize file_size;
+    u64 last_write; // same unit as os_file_time
+    bool has_info;
 };
 
 #define dir_foreach(arena, it, dir) for (dir_entry_t *it = os_dir_next(arena, dir); it; it = os_dir_next(arena, dir))
@@ -912,6 +1318,9 @@ bool os_dir_is_valid(dir_t *dir);
 void os_dir_close(dir_t *dir);
 
 dir_entry_t *os_dir_next(arena_t *arena, dir_t *dir);
+// lazily query the size/last write time of the entry just returned by os_dir_next
+usize os_dir_entry_size(dir_t *dir, dir_entry_t *entry);
+u64 os_dir_entry_time(dir_t *dir, dir_entry_t *entry);
 
 // == PROCESS ===================================
 
@@ -941,7 +1350,16 @@ void *os_alloc(usize size);
 void os_free(void *ptr);
 
 void *os_reserve(usize size, usize *out_padded_size);
+// reserves memory that can be backed by huge pages, the size is padded to COLLA_HUGE_PAGE_SIZE
+// and it should be committed in blocks of COLLA_HUGE_PAGE_SIZE. with use_hugetlb it first
+// tries to use the preallocated huge pages pool (linux only)
+void *os_reserve_huge(usize size, usize *out_padded_size, bool use_hugetlb);
 bool os_commit(void *ptr, usize num_of_pages);
+// gives the memory back to the os, its content is lost. with lazy
+// the os only takes it back when it needs it
+bool os_decommit(void *ptr, usize size, bool lazy);
+// faults in committed memory right away instead of on first touch
+void os_prefault(void *ptr, usize size);
 bool os_release(void *ptr, usize size);
 usize os_pad_to_page(usize byte_count);
 
@@ -955,7 +1373,9 @@ typedef struct os_barrier_t os_barrier_t;
 struct os_barrier_t {
     i64 thread_count;
     i64 thread_value;
-    i64 has_completed;
+    // bumped every time all the threads arrive, so a thread that is
+    // already in the next barrier can't be confused with a late one
+    i64 generation;
 };
 
 extern thread_local i64 os_thread_id;
@@ -1002,40 +1422,77 @@ void os_cond_wait(oshandle_t cond, oshandle_t mutex, int milliseconds);
 
 typedef void (job_func_f)(void *userdata);
 
+typedef struct job_queue_t job_queue_t;
+typedef struct jq_group_t jq_group_t;
+typedef struct jq_worker_t jq_worker_t;
+
 typedef struct job_t job_t;
 struct job_t {
     job_t *next;
     job_func_f *func;
     void *userdata;
+    jq_group_t *group;
 };
 
-typedef struct job_queue_t job_queue_t;
+// a set of jobs that can be waited on without stopping the queue,
+// jobs can push more jobs in the group they're running in
+struct jq_group_t {
+    job_queue_t *queue;
+    i64 pending;
+};
+
+// every worker has its own deque, jobs pushed from a worker go in its 
+// deque and are popped LIFO by the owner, idle workers steal from the 
+// other end (FIFO). jobs pushed from outside the pool go in a shared list
 struct job_queue_t {
     job_t *jobs;
     job_t *freelist;
-    bool should_stop;
-    bool stop_when_finished;
-    int reader;
-    int writer;
+    i64 injected_count;
+    i64 pending;
+    i64 sleeping;
+    i64 should_stop;
+    i64 stop_when_finished;
+    // set while a thread outside the pool is helping in jq_group_wait
+    i64 helper_busy;
+    // threads in jq_group_wait that can't help, they only care about their group
+    i64 waiting;
+    // thread_count + 1, the last one is for the helping thread
+    jq_worker_t *workers;
     oshandle_t mutex;
     oshandle_t condvar;
     oshandle_t *threads;
-    i64 *thread_ids;
     int thread_count;
 };
 
 // pass 0 to worker count to use max workers (os_get_system_info().processor_count)
 job_queue_t *jq_init(arena_t *arena, int worker_count);
 void jq_stop(job_queue_t *queue);
+// waits for all the jobs to finish, including the ones pushed by other jobs
 // no need to call this if you call jq_stop
 void jq_cleanup(job_queue_t *queue);
+// when called from a job, arena must belong to the calling thread
 void jq_push(arena_t *arena, job_queue_t *queue, job_func_f *func, void *userdata);
 job_t *jq_pop_job(job_queue_t *queue);
 
+jq_group_t *jq_group_create(arena_t *arena, job_queue_t *queue);
+void jq_group_push(arena_t *arena, jq_group_t *group, job_func_f *func, void *userdata);
+// runs jobs from the queue on the calling thread until all the jobs in
+// the group (and the ones they pushed in it) have finished. only one thread
+// outside the pool can help at a time, any other one just waits
+void jq_group_wait(jq_group_t *group);
+// group of the job running on the calling thread, NULL if there is none
+jq_group_t *jq_current_group(void);
+// jobs that keep state per thread should index it with jq_worker_index and
+// not with os_thread_id: a thread waiting on a group also runs jobs, from
+// a slot of its own. the index is -1 outside of a job
+int jq_slot_count(job_queue_t *queue);
+int jq_worker_index(void);
+
 #endif
 
 // == ATOMICS ========================================
 
+i64 atomic_get_i64(i64 *src);
 i64 atomic_set_i64(i64 *dest, i64 val);
 i64 atomic_add_i64(i64 *dest, i64 val);
 i64 atomic_and_i64(i64 *dest, i64 val);
@@ -1063,23 +1520,31 @@ struct initable_t {
     inivalue_t *values;
     inivalue_t *tail;
     initable_t *next;
-};
-
-typedef struct ini_t ini_t;
-struct ini_t {
-    strview_t text;
-    initable_t *tables;
-    initable_t *tail;
+    usize count;
+    // first value of every key, only for tables with at least COLLA_INI_INDEX_MIN
+    // values. it is filled in the first time they are queried with an arena
+    hmap_t keys;
+    strview_t lazy_body; // lines of the table that haven't been parsed yet
 };
 
 typedef struct iniopt_t iniopt_t;
 struct iniopt_t {
     bool merge_duplicate_tables; // default false
     bool merge_duplicate_keys;   // default false
+    bool lazy_tables;            // default false
     char key_value_divider;      // default =
     strview_t comment_vals;      // default ;#
 };
 
+typedef struct ini_t ini_t;
+struct ini_t {
+    strview_t text;
+    initable_t *tables;
+    initable_t *tail;
+    hmap_t index; // first table with every name
+    iniopt_t opts;
+};
+
 typedef struct iniarray_t iniarray_t;
 struct iniarray_t {
     strview_t *values;
@@ -1094,8 +1559,20 @@ ini_t ini_parse_str(arena_t *arena, strview_t str, iniopt_t *opt);
 
 bool ini_is_valid(ini_t *ini);
 
-initable_t *ini_get_table(ini_t *ini, strview_t name);
-inivalue_t *ini_get(initable_t *table, strview_t key);
+// with lazy_tables the values of a table are only parsed the first time it's returned
+// by ini_get_table or ini_load_table, in arena, which has to outlive the ini (usually
+// the one passed to ini_parse). the root table is always parsed. walking ini->tables
+// by hand skips this, the lazy tables look empty: use ini_for_each_table instead
+initable_t *ini_get_table(arena_t *arena, ini_t *ini, strview_t name);
+// parses the table if it's lazy, arena can only be NULL if it isn't
+initable_t *ini_load_table(arena_t *arena, ini_t *ini, initable_t *table);
+// big tables get an index of their keys the first time they are queried, allocated
+// in arena. with a NULL arena no index is built and the values are walked instead
+inivalue_t *ini_get(arena_t *arena, initable_t *table, strview_t key);
+
+// every table in file order, the lazy ones are parsed in arena on the way
+#define ini_for_each_table(name, arena, ini) \
+    for (initable_t *name = ini_load_table(arena, ini, (ini)->tables); name; name = ini_load_table(arena, ini, name->next))
 
 iniarray_t ini_as_arr(arena_t *arena, inivalue_t *value, char delim);
 u64 ini_as_uint(inivalue_t *value);
@@ -1129,6 +1606,7 @@ typedef enum jsontype_e {
     JSON_NUMBER,
     JSON_BOOL,
     JSON_OBJECT,
+    JSON_KEY, // only used in json_tape_t
 } jsontype_e;
 
 typedef enum jsonflags_e {
@@ -1138,6 +1616,8 @@ typedef enum jsonflags_e {
     JSON_ONLY_OBJECT_START  = 1 << 2,
 } jsonflags_e;
 
+typedef struct json_index_t json_index_t;
+
 typedef struct json_t json_t;
 struct json_t {
     json_t *next;
@@ -1146,11 +1626,18 @@ struct json_t {
     strview_t key;
 
     union {
-        json_t *array;
+        struct {
+            union {
+                json_t *array;
+                json_t *object;
+            };
+            // only objects and arrays with at least COLLA_JSON_INDEX_MIN children
+            // have one, it is filled in the first time they are queried
+            json_index_t *index;
+        };
         strview_t string;
         double number;
         bool boolean;
-        json_t *object;
     };
     jsontype_e type;
 };
@@ -1158,7 +1645,16 @@ struct json_t {
 json_t *json_parse(arena_t *arena, strview_t filename, jsonflags_e flags);
 json_t *json_parse_str(arena_t *arena, strview_t str, jsonflags_e flags);
 
-json_t *json_get(json_t *node, strview_t key);
+// big objects and arrays get their index the first time they are queried, it is
+// allocated in arena, which has to outlive the json (usually the one passed to json_parse).
+// with a NULL arena no index is built and the children are walked instead.
+// children added after the index was built are found, the index is built again.
+// the first query on a big object is not thread safe
+json_t *json_get(arena_t *arena, json_t *node, strview_t key);
+// index-th child of an array or object, NULL if out of bounds
+json_t *json_at(arena_t *arena, json_t *node, usize index);
+// number of children of an array or object
+usize json_len(json_t *node);
 
 #define json_check(val, js_type) ((val) && (val)->type == js_type)
 #define json_for(it, arr) for (json_t *it = json_check(arr, JSON_ARRAY) ? arr->array : NULL; it; it = it->next)
@@ -1182,6 +1678,119 @@ struct json_pretty_opts_t {
 
 void json_pretty_print(json_t *root, const json_pretty_opts_t *options);
 
+// JSON TAPE ////////////////////////////////////
+
+// flat alternative to json_t for big documents, the structural characters are
+// found 64 bytes at a time and every value becomes a 16 byte element.
+// the elements of an object alternate JSON_KEY and value, strings and keys
+// point in the source, which has to outlive the tape
+typedef struct json_elem_t json_elem_t;
+struct json_elem_t {
+    u32 type; // jsontype_e
+    union {
+        u32 len; // strings and keys
+        u32 end; // objects and arrays, index of the first element after them
+    };
+    union {
+        u64 offset; // strings and keys, offset in the source
+        u64 count;  // objects and arrays, number of values
+        double number;
+        bool boolean;
+    };
+};
+
+typedef struct json_tape_t json_tape_t;
+struct json_tape_t {
+    strview_t src;
+    json_elem_t *elems;
+    usize count;
+};
+
+// count is zero if the json is not valid
+json_tape_t json_tape_parse(arena_t *arena, strview_t str, jsonflags_e flags);
+strview_t json_tape_str(json_tape_t *tape, usize index);
+// index of the element after the value at index, skipping all of its children
+usize json_tape_next(json_tape_t *tape, usize index);
+// builds the json_t tree for code that uses the old interface
+json_t *json_from_tape(arena_t *arena, json_tape_t *tape);
+void json_tape_pretty_print(json_tape_t *tape, const json_pretty_opts_t *options);
+
+// JSON READER //////////////////////////////////
+
+// pull parser for json that comes in chunks of any size. strings and keys are
+// views in the current chunk, or in a buffer of the reader if they were split
+// between chunks, so they are only valid until the next json_reader_next.
+// memory depends only on the nesting depth and on the longest split string
+typedef enum json_event_e {
+    JSON_EVENT_NEED_INPUT, // call json_reader_feed with the next chunk
+    JSON_EVENT_OBJECT_BEGIN,
+    JSON_EVENT_OBJECT_END,
+    JSON_EVENT_ARRAY_BEGIN,
+    JSON_EVENT_ARRAY_END,
+    JSON_EVENT_KEY,
+    JSON_EVENT_STRING,
+    JSON_EVENT_NUMBER,
+    JSON_EVENT_BOOL,
+    JSON_EVENT_NULL,
+    JSON_EVENT_DONE,
+    JSON_EVENT_ERROR,
+} json_event_e;
+
+typedef struct json_reader_t json_reader_t;
+struct json_reader_t {
+    arena_t *arena;
+    jsonflags_e flags;
+    strview_t chunk;
+    usize pos;
+    bool is_last;
+
+    u32 state;
+    bool escaped;
+    bool in_partial;
+    usize token_start;
+    u8 *partial;
+    usize partial_len;
+    usize partial_cap;
+
+    u32 depth;
+    u32 value_depth;
+    u32 stack_cap;
+    u8 *kinds;       // JSON_OBJECT or JSON_ARRAY for every depth
+    u64 *key_hashes; // last key of every object
+    usize *key_ends; // the last keys are one after the other in key_text, up to these
+    u32 *indices;    // index of the current value in every array
+    u8 *key_text;
+    usize key_text_cap;
+
+    // value of the last event
+    strview_t str;
+    double number;
+    bool boolean;
+};
+
+json_reader_t json_reader_init(arena_t *arena, jsonflags_e flags);
+// the chunk has to stay valid until json_reader_next asks for more input.
+// is_last means that there is nothing after this chunk
+void json_reader_feed(json_reader_t *r, strview_t chunk, bool is_last);
+json_event_e json_reader_next(json_reader_t *r);
+
+// paths look like "choices[0].delta.content", keys are compared by hash, then
+// by text, without unescaping them
+typedef struct json_path_t json_path_t;
+struct json_path_t {
+    u32 count;
+    u64 *segments; // key hash or array index
+    bool *is_index;
+    strview_t *keys;
+};
+
+json_path_t json_path_init(arena_t *arena, strview_t path);
+// true if the last value or begin event is at path
+bool json_reader_at(json_reader_t *r, json_path_t *path);
+// reads until a value at one of the paths, which is put in match. returns the event of
+// that value, or JSON_EVENT_NEED_INPUT, JSON_EVENT_DONE or JSON_EVENT_ERROR
+json_event_e json_reader_select(json_reader_t *r, json_path_t *paths, int count, int *match);
+
 // == XML ============================================
 
 typedef struct xmlattr_t xmlattr_t;
@@ -1239,6 +1848,98 @@ html_t html_parse_str(arena_t *arena, strview_t str);
 htmltag_t *html_get_tag(htmltag_t *parent, strview_t key, bool recursive);
 strview_t html_get_attribute(htmltag_t *tag, strview_t key);
 
+// XML READER ///////////////////////////////////
+
+// pull parser for xml and html that comes in chunks of any size, without building
+// the tree. names, text and attributes are views in the current chunk, or in a
+// buffer of the reader if they were split between chunks, so they are only valid
+// until the next xml_reader_next. entities are not decoded.
+// memory depends only on the nesting depth and on the longest split tag or text
+typedef enum xml_event_e {
+    XML_EVENT_NEED_INPUT, // call xml_reader_feed with the next chunk
+    XML_EVENT_TAG_BEGIN,  // name and attributes are set
+    XML_EVENT_TAG_END,    // name is set, self closing tags get one too
+    XML_EVENT_TEXT,       // trimmed text between tags, or the content of a CDATA section
+    XML_EVENT_DONE,
+    XML_EVENT_ERROR,
+} xml_event_e;
+
+typedef enum xmlflags_e {
+    XML_DEFAULT = 0,
+    // names are compared ignoring case, void elements (br, img, ...) and <p> don't
+    // need to be closed, unclosed tags are closed by their parent, script and style
+    // contents are returned as text
+    XML_HTML    = 1 << 0,
+} xmlflags_e;
+
+typedef struct xml_reader_t xml_reader_t;
+struct xml_reader_t {
+    arena_t *arena;
+    xmlflags_e flags;
+    strview_t chunk;
+    usize pos;
+    bool is_last;
+
+    u32 state;
+    u32 markup;     // kind of the tag being read
+    u32 seen;       // bytes of the tag read so far
+    u32 match;      // how much of the closing sequence was found
+    char quote;
+    bool in_partial;
+    bool split_lt;  // html text ended the last chunk with a < that could start a tag
+    usize token_start;
+    u8 *partial;
+    usize partial_len;
+    usize partial_cap;
+
+    // names of the open tags, one after the other
+    u32 depth;
+    u32 stack_cap;
+    u32 *name_offsets;
+    u8 *names;
+    usize names_len;
+    usize names_cap;
+
+    // a tag can close others before it begins
+    u32 pending_ends;
+    bool pending_begin;
+    bool self_closing;
+    strview_t pending_name;
+    strview_t pending_attributes;
+    usize attr_cursor;
+
+    // value of the last event
+    strview_t name;
+    strview_t text;
+    strview_t attributes; // everything between the name and the >
+};
+
+xml_reader_t xml_reader_init(arena_t *arena, xmlflags_e flags);
+// the chunk has to stay valid until xml_reader_next asks for more input.
+// is_last means that there is nothing after this chunk
+void xml_reader_feed(xml_reader_t *r, strview_t chunk, bool is_last);
+xml_event_e xml_reader_next(xml_reader_t *r);
+
+// attributes of the last XML_EVENT_TAG_BEGIN, values don't have quotes and
+// attributes without a value (html) have an empty one
+strview_t xml_reader_get_attribute(xml_reader_t *r, strview_t key);
+// returns false after the last one
+bool xml_reader_next_attribute(xml_reader_t *r, xmlattr_t *attr);
+
+// paths look like "rss/channel/item/title", a * matches any name
+typedef struct xml_path_t xml_path_t;
+struct xml_path_t {
+    u32 count;
+    strview_t *segments;
+};
+
+xml_path_t xml_path_init(arena_t *arena, strview_t path);
+// true if the open tags are exactly path
+bool xml_reader_at(xml_reader_t *r, xml_path_t *path);
+// reads until a tag at one of the paths begins, which is put in match. returns
+// XML_EVENT_TAG_BEGIN, or XML_EVENT_NEED_INPUT, XML_EVENT_DONE or XML_EVENT_ERROR
+xml_event_e xml_reader_select(xml_reader_t *r, xml_path_t *paths, int count, int *match);
+
 // NETWORKING ///////////////////////////////////
 
 void net_init(void);
@@ -1292,6 +1993,37 @@ http_header_t *http_parse_headers(arena_t *arena, strview_t header_string);
 http_req_t http_parse_req(arena_t *arena, strview_t request);
 http_res_t http_parse_res(arena_t *arena, strview_t response);
 
+// incremental request parser, for requests that come in over many reads and
+// for pipelined requests that share a read
+typedef enum http_parse_e {
+    HTTP_PARSE_NEED_MORE,    // the request line and headers are not all there yet
+    HTTP_PARSE_HEADERS_DONE, // req has everything but the body
+    HTTP_PARSE_DONE,         // req is complete, the next request starts at end
+    HTTP_PARSE_ERROR,
+} http_parse_e;
+
+typedef struct http_parser_t http_parser_t;
+struct http_parser_t {
+    arena_t *arena;
+    http_parse_e result;
+    u32 state;
+    const char *base; // where the buffer was in the last call
+    usize pos;
+    usize header_len; // offset of the body
+    usize end;        // length of the whole request
+    usize content_length;
+    usize chunk_left;
+    bool is_chunked;
+    http_req_t req;
+};
+
+http_parser_t http_parser_init(arena_t *arena);
+// buf has every byte received so far, starting from the request line. it can move
+// between calls (to grow it), but it has to stay where it is while req is used.
+// url, headers and body are views in buf, except for chunked bodies which are
+// put together in the arena
+http_parse_e http_parser_feed(http_parser_t *p, strview_t buf);
+
 str_t http_req_to_str(arena_t *arena, http_req_t *req);
 str_t http_res_to_str(arena_t *arena, http_res_t *res);
 
@@ -18,6 +18,8 @@
 #include <dirent.h>
 #include <pthread.h>
 #include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <sys/stat.h>
 #include <sys/utsname.h>
 #if !COLLA_NO_NET
@@ -139,6 +141,7 @@ void os_cleanup(void) {
 }
 
 void os_abort(int code) {
+    fmt_flush_all();
 #if COLLA_DEBUG
     if (code == 1) {
         abort();
@@ -165,22 +168,48 @@ os_system_info_t os_get_system_info(void) {
     return lin_data.info;
 }
 
+u64 os_time_ms(void) {
+    struct timespec ts = {0};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (u64)ts.tv_sec * 1000 + (u64)ts.tv_nsec / 1000000;
+}
+
 void os_log_set_colour(os_log_colour_e colour) {
     strview_t view = os__fg_colours[colour];
-    os_file_write(os_stdout(), view.buf, view.len);
+    fmt_write(view.buf, view.len);
 }
 
 void os_log_set_colour_bg(os_log_colour_e foreground, os_log_colour_e background) {
     strview_t fg = os__fg_colours[foreground];
     strview_t bg = os__bg_colours[background];
-    os_file_write(os_stdout(), fg.buf, fg.len);
-    os_file_write(os_stdout(), bg.buf, bg.len);
+    fmt_write(fg.buf, fg.len);
+    fmt_write(bg.buf, bg.len);
 }
 
 oshandle_t os_stdout(void) {
     return (oshandle_t){ (uptr)(stdout) };
 }
 
+pthread_mutex_t os__stdout_mtx = PTHREAD_MUTEX_INITIALIZER;
+
+bool os__stdout_is_tty(void) {
+    return isatty(STDOUT_FILENO);
+}
+
+void os__stdout_lock(void) {
+    pthread_mutex_lock(&os__stdout_mtx);
+}
+
+void os__stdout_unlock(void) {
+    pthread_mutex_unlock(&os__stdout_mtx);
+}
+
+void os__stdout_write(const void *buf, usize len) {
+    // go through stdio so that we stay in order with anything using printf
+    fwrite(buf, 1, len, stdout);
+    fflush(stdout);
+}
+
 oshandle_t os_stdin(void) {
     return (oshandle_t){ (uptr)(stdin)};
 }
@@ -274,6 +303,11 @@ usize os_file_read(oshandle_t handle, void *buf, usize len) {
 
 usize os_file_write(oshandle_t handle, const void *buf, usize len) {
     if (!os_handle_valid(handle)) return 0;
+    // stdout is buffered by fmt, writing around it would print out of order
+    if (os_handle_match(handle, os_stdout())) {
+        fmt_write(buf, len);
+        return len;
+    }
     return fwrite(buf, 1, len, (FILE*)handle.data);
 }
 
@@ -317,65 +351,191 @@ bool os_file_is_finished(oshandle_t handle) {
     return fread(&c, 1, 1, (FILE*)handle.data) == 0;
 }
 
+// returns after one read, fread keeps going until len bytes or the end of the file.
+// anything already in the FILE buffer would be skipped, so the handle should
+// only be read through this
+usize os__file_read_some(oshandle_t handle, void *buf, usize len) {
+    if (!os_handle_valid(handle)) return 0;
+    int fd = fileno((FILE *)handle.data);
+    while (true) {
+        ssize_t res = read(fd, buf, len);
+        if (res >= 0) return (usize)res;
+        if (errno != EINTR) return 0;
+    }
+}
+
+bool os__file_map(oshandle_t handle, os_file_view_t *view) {
+    FILE *fp = (FILE *)handle.data;
+    int fd = fileno(fp);
+
+    struct stat st = {0};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return false;
+    }
+
+    off_t offset = ftello(fp);
+    if (offset < 0 || offset > st.st_size) {
+        return false;
+    }
+
+    usize size = (usize)st.st_size;
+    void *base = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (base == MAP_FAILED) {
+        return false;
+    }
+
+    // we almost always go through the file front to back
+    madvise(base, size, MADV_SEQUENTIAL);
+    madvise(base, size, MADV_WILLNEED);
+
+    view->base = base;
+    view->size = size;
+    view->data = strv((char *)base + offset, size - offset);
+
+    // leave the handle where a full read would have
+    fseeko(fp, 0, SEEK_END);
+
+    return true;
+}
+
+void os__file_unmap(os_file_view_t *view) {
+    munmap(view->base, view->size);
+}
+
+// same unit as windows' FILETIME: 100ns ticks since 1601
+static u64 os__file_time_from_timespec(struct timespec ts) {
+    u64 unix_to_1601 = 11644473600ull;
+    return ((u64)ts.tv_sec + unix_to_1601) * 10000000ull + (u64)ts.tv_nsec / 100;
+}
+
 u64 os_file_time_fp(oshandle_t handle) {
     if (!os_handle_valid(handle)) return 0;
     struct stat st = {0};
     int fd = fileno((FILE*)handle.data);
     if (fstat(fd, &st) == 0) {
-        return st.st_mtim.tv_nsec;
+        return os__file_time_from_timespec(st.st_mtim);
     }
     return 0;
 }
 
 // == DIR WALKER ================================
 
+// raw record returned by getdents64, glibc only exposes it under _GNU_SOURCE
+typedef struct os__dirent64_t os__dirent64_t;
+struct os__dirent64_t {
+    u64 d_ino;
+    i64 d_off;
+    unsigned short d_reclen;
+    unsigned char d_type;
+    char d_name[];
+};
+
 struct dir_t {
-    DIR *ctx;
+    int fd;
+    int buf_len;
+    int buf_pos;
     dir_entry_t next;
+    // getdents64 buffer, from the heap so os_dir_close can give it back:
+    // a walk that recurses on one arena would otherwise keep one per directory
+    u8 *buf;
 };
 
 dir_t *os_dir_open(arena_t *arena, strview_t path) {
     arena_t scratch = *arena;
     str_t folder = str(&scratch, path);
     
-    DIR *ctx = opendir(folder.buf);
-    if (!ctx) {
+    int fd = open(folder.buf, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
         return NULL;
     }
 
-    dir_t *dir = alloc(arena, dir_t);
-    dir->ctx = ctx;
+    dir_t *dir = alloc(arena, dir_t, 1, ALLOC_NOZERO);
+    dir->fd = fd;
+    dir->buf_len = 0;
+    dir->buf_pos = 0;
+    dir->next = (dir_entry_t){0};
+    // overwritten by getdents64, no need to clear it
+    dir->buf = malloc(COLLA_DIR_BUFFER_SIZE);
+    if (!dir->buf) {
+        close(fd);
+        return NULL;
+    }
 
     return dir;
 }
 
 void os_dir_close(dir_t *dir) {
-    if (!dir || !dir->ctx) return;
-    closedir(dir->ctx);
-    dir->ctx = NULL;
+    if (!dir || dir->fd < 0) return;
+    close(dir->fd);
+    dir->fd = -1;
+    free(dir->buf);
+    dir->buf = NULL;
 }
 
 bool os_dir_is_valid(dir_t *dir) {
-    return dir && dir->ctx;
+    return dir && dir->fd >= 0;
+}
+
+bool os__dir_entry_stat(dir_t *dir, dir_entry_t *entry) {
+    if (!entry) return false;
+    if (entry->has_info) return true;
+    if (!os_dir_is_valid(dir)) return false;
+
+    struct stat st = {0};
+    if (fstatat(dir->fd, entry->name.buf, &st, 0) != 0) {
+        return false;
+    }
+
+    entry->type = S_ISDIR(st.st_mode) ? DIRTYPE_DIR : DIRTYPE_FILE;
+    entry->file_size = entry->type == DIRTYPE_FILE ? (usize)st.st_size : 0;
+    entry->last_write = os__file_time_from_timespec(st.st_mtim);
+    entry->has_info = true;
+
+    return true;
 }
 
 dir_entry_t *os_dir_next(arena_t *arena, dir_t *dir) {
-    struct dirent *data = readdir(dir->ctx);
-    if (!data) {
-        os_dir_close(dir);
+    if (!os_dir_is_valid(dir)) {
         return NULL;
     }
 
-    struct stat st = {0};
-    stat(data->d_name, &st);
+    if (dir->buf_pos >= dir->buf_len) {
+        long read = syscall(SYS_getdents64, dir->fd, dir->buf, COLLA_DIR_BUFFER_SIZE);
+        if (read <= 0) {
+            os_dir_close(dir);
+            return NULL;
+        }
+        dir->buf_len = (int)read;
+        dir->buf_pos = 0;
+    }
 
-    dir->next.name = (str_t){ data->d_name, strlen(data->d_name) };
-    dir->next.type = S_ISDIR(st.st_mode) ? DIRTYPE_DIR : DIRTYPE_FILE;
-    dir->next.file_size = st.st_size;
+    os__dirent64_t *data = (os__dirent64_t *)(dir->buf + dir->buf_pos);
+    dir->buf_pos += data->d_reclen;
+
+    dir->next = (dir_entry_t){
+        .name = str(arena, data->d_name),
+        .type = data->d_type == DT_DIR ? DIRTYPE_DIR : DIRTYPE_FILE,
+    };
+
+    // symlinks are followed and some filesystems don't fill d_type,
+    // only these need a stat to know what they are
+    if (data->d_type == DT_LNK || data->d_type == DT_UNKNOWN) {
+        os__dir_entry_stat(dir, &dir->next);
+    }
 
     return &dir->next;
 }
 
+usize os_dir_entry_size(dir_t *dir, dir_entry_t *entry) {
+    os__dir_entry_stat(dir, entry);
+    return entry ? entry->file_size : 0;
+}
+
+u64 os_dir_entry_time(dir_t *dir, dir_entry_t *entry) {
+    os__dir_entry_stat(dir, entry);
+    return entry ? entry->last_write : 0;
+}
+
 // == PROCESS ===================================
 
 void os_set_env_var(arena_t scratch, strview_t key, strview_t value) {
@@ -427,6 +587,53 @@ void *os_reserve(usize size, usize *out_padded_size) {
         0
     );
 
+    if (ptr == MAP_FAILED) {
+        return NULL;
+    }
+
+    if (out_padded_size) {
+        *out_padded_size = alloc_size;
+    }
+
+    return ptr;
+}
+
+void *os_reserve_huge(usize size, usize *out_padded_size, bool use_hugetlb) {
+    usize huge_size = COLLA_HUGE_PAGE_SIZE;
+    usize alloc_size = (size + huge_size - 1) & ~(huge_size - 1);
+    void *ptr = MAP_FAILED;
+
+#ifdef MAP_HUGETLB
+    // without MAP_NORESERVE the pages are reserved from the pool right away,
+    // so this fails here instead of with a SIGBUS when the pool runs out
+    if (use_hugetlb) {
+        ptr = mmap(NULL, alloc_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    }
+#else
+    COLLA_UNUSED(use_hugetlb);
+#endif
+
+    if (ptr == MAP_FAILED) {
+        // transparent huge pages only back aligned blocks, so reserve a bit
+        // more than needed and trim it down to an aligned range
+        u8 *raw = mmap(NULL, alloc_size + huge_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return NULL;
+        }
+
+        u8 *aligned = (u8 *)(((uptr)raw + huge_size - 1) & ~(uptr)(huge_size - 1));
+        usize head = aligned - raw;
+        usize tail = huge_size - head;
+        if (head) munmap(raw, head);
+        if (tail) munmap(aligned + alloc_size, tail);
+
+        if (madvise(aligned, alloc_size, MADV_HUGEPAGE)) {
+            warn("transparent huge pages are not available: %s", strerror(errno));
+        }
+
+        ptr = aligned;
+    }
+
     if (out_padded_size) {
         *out_padded_size = alloc_size;
     }
@@ -443,6 +650,34 @@ bool os_commit(void *ptr, usize num_of_pages) {
     return res != -1;
 }
 
+bool os_decommit(void *ptr, usize size, bool lazy) {
+#ifdef MADV_FREE
+    if (lazy && madvise(ptr, size, MADV_FREE) == 0) {
+        return true;
+    }
+#else
+    COLLA_UNUSED(lazy);
+#endif
+    // the pages stay readable/writable, the next touch gets a zeroed page
+    return madvise(ptr, size, MADV_DONTNEED) == 0;
+}
+
+void os_prefault(void *ptr, usize size) {
+#ifndef MADV_POPULATE_WRITE
+    #define MADV_POPULATE_WRITE 23
+#endif
+    if (madvise(ptr, size, MADV_POPULATE_WRITE) == 0) {
+        return;
+    }
+
+    // kernels older than 5.14, touch every page ourselves
+    usize page_size = lin_data.info.page_size;
+    volatile u8 *bytes = ptr;
+    for (usize i = 0; i < size; i += page_size) {
+        bytes[i] = bytes[i];
+    }
+}
+
 bool os_release(void *ptr, usize size) {
     if (!ptr) return false;
 
@@ -453,12 +688,20 @@ bool os_release(void *ptr, usize size) {
 
 // == THREAD ====================================
 
+thread_local i64 os_thread_id = 0;
+i64 os_thread_count = 0;
+
 void *os__lin_thread_entry_point(void *ptr) {
     os_entity_t *entity = (os_entity_t *)ptr;
     colla_assert(entity);
     thread_func_t *func = entity->thread.func;
     void *userdata = entity->thread.userdata;
+
+    os_thread_id = atomic_inc_i64(&os_thread_count) - 1;
+
     int result = func(entity->thread.handle, userdata);
+    fmt_release();
+    scratch_release();
     return (void*)((iptr)result);
 }
 
@@ -504,6 +747,23 @@ bool os_thread_join(oshandle_t thread, int *code) {
     return success;
 }   
 
+void os__cpu_pause(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    __asm__ volatile("yield");
+#endif
+}
+
+// futexes work on 32 bit values, on little endian that's the low half
+void os__wait_on_address(i64 *address, i64 value) {
+    syscall(SYS_futex, (u32 *)address, FUTEX_WAIT_PRIVATE, (u32)value, NULL, NULL, 0);
+}
+
+void os__wake_all_on_address(i64 *address) {
+    syscall(SYS_futex, (u32 *)address, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
 u64 os_thread_get_id(oshandle_t thread) {
     os_entity_t *entity = os__handle_to_entity(thread, OS_KIND_THREAD);
     if (!entity) return 0;
@@ -592,7 +852,7 @@ void os_cond_broadcast(oshandle_t cond) {
 
 void os_cond_wait(oshandle_t cond, oshandle_t mutex, int milliseconds) {
     os_entity_t *cond_entity  = os__handle_to_entity(cond, OS_KIND_CONDITION_VARIABLE);
-    os_entity_t *mutex_entity = os__handle_to_entity(cond, OS_KIND_MUTEX);
+    os_entity_t *mutex_entity = os__handle_to_entity(mutex, OS_KIND_MUTEX);
     if (!cond_entity)  return;
     if (!mutex_entity) return;
 
@@ -601,6 +861,45 @@ void os_cond_wait(oshandle_t cond, oshandle_t mutex, int milliseconds) {
 
 #endif
 
+// == ATOMICS ========================================
+
+i64 atomic_get_i64(i64 *src) {
+    return __atomic_load_n(src, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_set_i64(i64 *dest, i64 val) {
+    return __atomic_exchange_n(dest, val, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_add_i64(i64 *dest, i64 val) {
+    return __atomic_fetch_add(dest, val, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_and_i64(i64 *dest, i64 val) {
+    return __atomic_fetch_and(dest, val, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_cmp_i64(i64 *dest, i64 val, i64 cmp) {
+    __atomic_compare_exchange_n(dest, &cmp, val, false, __ATOMIC_SEQ_CST, __ATOMIC_SEQ_CST);
+    return cmp;
+}
+
+i64 atomic_inc_i64(i64 *dest) {
+    return __atomic_add_fetch(dest, 1, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_dec_i64(i64 *dest) {
+    return __atomic_sub_fetch(dest, 1, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_or_i64(i64 *dest, i64 val) {
+    return __atomic_fetch_or(dest, val, __ATOMIC_SEQ_CST);
+}
+
+i64 atomic_xor_i64(i64 *dest, i64 val) {
+    return __atomic_fetch_xor(dest, val, __ATOMIC_SEQ_CST);
+}
+
 str_t str_os_from_str16(arena_t *arena, str16_t src) {
     mbstate_t state = {0};
 
@@ -15,6 +15,10 @@
     #endif
 #endif
 
+#if COLLA_CMT_LIB && !COLLA_TCC
+    #pragma comment(lib, "Synchronization")
+#endif
+
 #ifndef PROCESSOR_ARCHITECTURE_ARM64
 #define PROCESSOR_ARCHITECTURE_ARM64            12
 #endif
@@ -165,6 +169,8 @@ struct {
     oshandle_t hconout;
     WORD default_fg;
     WORD default_bg;
+    CRITICAL_SECTION stdout_lock;
+    bool stdout_lock_ready;
 } w32_data = {0};
 
 os_entity_t *os__win_alloc_entity(os_entity_kind_e kind) {
@@ -197,6 +203,9 @@ HANDLE os__win_get_handle(oshandle_t handle) {
 void os_init(void) {
     SetConsoleOutputCP(CP_UTF8);
 
+    InitializeCriticalSection(&w32_data.stdout_lock);
+    w32_data.stdout_lock_ready = true;
+
     SYSTEM_INFO sysinfo = {0};
     GetSystemInfo(&sysinfo);
 
@@ -260,6 +269,7 @@ void os_cleanup(void) {
 }
 
 void os_abort(int code) {
+    fmt_flush_all();
 #if COLLA_DEBUG
     if (code != 0) {
         __debugbreak();
@@ -327,19 +337,61 @@ os_system_info_t os_get_system_info(void) {
 	return w32_data.info;
 }
 
+u64 os_time_ms(void) {
+    return GetTickCount64();
+}
+
 void os_log_set_colour(os_log_colour_e colour) {
-    WriteFile((HANDLE)w32_data.hstdout.data, win32__fg_colours[colour], arrlen(win32__fg_colours[colour]), NULL, NULL);
+    fmt_write(win32__fg_colours[colour], strlen(win32__fg_colours[colour]));
 }
 
 void os_log_set_colour_bg(os_log_colour_e foreground, os_log_colour_e background) {
-    WriteFile((HANDLE)w32_data.hstdout.data, win32__fg_colours[foreground], arrlen(win32__fg_colours[foreground]), NULL, NULL);
-    WriteFile((HANDLE)w32_data.hstdout.data, win32__bg_colours[background], arrlen(win32__bg_colours[background]), NULL, NULL);
+    fmt_write(win32__fg_colours[foreground], strlen(win32__fg_colours[foreground]));
+    fmt_write(win32__bg_colours[background], strlen(win32__bg_colours[background]));
 }
 
 oshandle_t os_stdout(void) {
     return w32_data.hstdout;
 }
 
+bool os__stdout_is_tty(void) {
+    HANDLE hstdout = (HANDLE)w32_data.hstdout.data;
+    return hstdout && GetFileType(hstdout) == FILE_TYPE_CHAR;
+}
+
+void os__stdout_lock(void) {
+    if (w32_data.stdout_lock_ready) {
+        EnterCriticalSection(&w32_data.stdout_lock);
+    }
+}
+
+void os__stdout_unlock(void) {
+    if (w32_data.stdout_lock_ready) {
+        LeaveCriticalSection(&w32_data.stdout_lock);
+    }
+}
+
+void os__stdout_write(const void *buf, usize len) {
+    HANDLE hstdout = (HANDLE)w32_data.hstdout.data;
+    // os_init hasn't been called yet
+    if (!hstdout) {
+        fwrite(buf, 1, len, stdout);
+        fflush(stdout);
+        return;
+    }
+
+    const u8 *data = buf;
+    while (len > 0) {
+        DWORD written = 0;
+        DWORD to_write = (DWORD)MIN(len, 0x7FFFFFFF);
+        if (!WriteFile(hstdout, data, to_write, &written, NULL) || written == 0) {
+            break;
+        }
+        data += written;
+        len  -= written;
+    }
+}
+
 oshandle_t os_stdin(void) {
     return w32_data.hstdin;
 }
@@ -487,6 +539,11 @@ usize os_file_read(oshandle_t handle, void *buf, usize len) {
 
 usize os_file_write(oshandle_t handle, const void *buf, usize len) {
     if (!os_handle_valid(handle)) return 0;
+    // stdout is buffered by fmt, writing around it would print out of order
+    if (os_handle_match(handle, os_stdout())) {
+        fmt_write(buf, len);
+        return len;
+    }
     DWORD written = 0;
     WriteFile((HANDLE)handle.data, buf, (DWORD)len, &written, NULL);
     return (usize)written;
@@ -541,6 +598,59 @@ bool os_file_is_finished(oshandle_t handle) {
     return is_finished;
 }
 
+// ReadFile already returns what a pipe has instead of waiting for len bytes
+usize os__file_read_some(oshandle_t handle, void *buf, usize len) {
+    return os_file_read(handle, buf, len);
+}
+
+bool os__file_map(oshandle_t handle, os_file_view_t *view) {
+    HANDLE hfile = (HANDLE)handle.data;
+    if (GetFileType(hfile) != FILE_TYPE_DISK) {
+        return false;
+    }
+
+    LARGE_INTEGER size = {0};
+    LARGE_INTEGER offset = {0};
+    if (!GetFileSizeEx(hfile, &size) || size.QuadPart == 0) {
+        return false;
+    }
+    if (!SetFilePointerEx(hfile, (LARGE_INTEGER){0}, &offset, FILE_CURRENT) || offset.QuadPart > size.QuadPart) {
+        return false;
+    }
+
+    HANDLE mapping = CreateFileMapping(hfile, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!mapping) {
+        return false;
+    }
+
+    void *base = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!base) {
+        CloseHandle(mapping);
+        return false;
+    }
+
+#if !COLLA_TCC
+    // start paging the file in, same idea as MADV_WILLNEED
+    WIN32_MEMORY_RANGE_ENTRY range = { base, (SIZE_T)size.QuadPart };
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+
+    view->base = base;
+    view->size = (usize)size.QuadPart;
+    view->mapping = (uptr)mapping;
+    view->data = strv((char *)base + offset.QuadPart, (usize)(size.QuadPart - offset.QuadPart));
+
+    // leave the handle where a full read would have
+    SetFilePointerEx(hfile, (LARGE_INTEGER){0}, NULL, FILE_END);
+
+    return true;
+}
+
+void os__file_unmap(os_file_view_t *view) {
+    UnmapViewOfFile(view->base);
+    CloseHandle((HANDLE)view->mapping);
+}
+
 u64 os_file_time_fp(oshandle_t handle) {
     if (!os_handle_valid(handle)) return 0;
     FILETIME time = {0};
@@ -581,6 +691,14 @@ dir_entry_t os__dir_entry_from_find_data(arena_t *arena, WIN32_FIND_DATAW *fd) {
         out.file_size = filesize.QuadPart;
     }
 
+    // FindNextFile already gives us everything, no need to query it later
+    ULARGE_INTEGER time = {
+        .HighPart = fd->ftLastWriteTime.dwHighDateTime,
+        .LowPart  = fd->ftLastWriteTime.dwLowDateTime,
+    };
+    out.last_write = (u64)time.QuadPart;
+    out.has_info = true;
+
     return out;
 }
 
@@ -647,6 +765,16 @@ dir_entry_t *os_dir_next(arena_t *arena, dir_t *dir) {
     return &dir->cur_entry;
 }
 
+usize os_dir_entry_size(dir_t *dir, dir_entry_t *entry) {
+    COLLA_UNUSED(dir);
+    return entry ? entry->file_size : 0;
+}
+
+u64 os_dir_entry_time(dir_t *dir, dir_entry_t *entry) {
+    COLLA_UNUSED(dir);
+    return entry ? entry->last_write : 0;
+}
+
 // == PROCESS ===================================
 
 struct os_env_t {
@@ -840,12 +968,36 @@ void *os_reserve(usize size, usize *out_padded_size) {
     return ptr;
 }
 
+// large pages need SeLockMemoryPrivilege and have to be committed when they're
+// reserved, which doesn't work with arenas, so we only pad the size here
+void *os_reserve_huge(usize size, usize *out_padded_size, bool use_hugetlb) {
+    COLLA_UNUSED(use_hugetlb);
+    usize huge_size = COLLA_HUGE_PAGE_SIZE;
+    usize alloc_size = (size + huge_size - 1) & ~(huge_size - 1);
+    return os_reserve(alloc_size, out_padded_size);
+}
+
 bool os_commit(void *ptr, usize num_of_pages) {
     usize page_size = os_get_system_info().page_size;
     void *new_ptr = VirtualAlloc(ptr, num_of_pages * page_size, MEM_COMMIT, PAGE_READWRITE);
     return new_ptr != NULL;
 }
 
+bool os_decommit(void *ptr, usize size, bool lazy) {
+    if (lazy) {
+        return VirtualAlloc(ptr, size, MEM_RESET, PAGE_READWRITE) != NULL;
+    }
+    return VirtualFree(ptr, size, MEM_DECOMMIT);
+}
+
+void os_prefault(void *ptr, usize size) {
+    usize page_size = os_get_system_info().page_size;
+    volatile u8 *bytes = ptr;
+    for (usize i = 0; i < size; i += page_size) {
+        bytes[i] = bytes[i];
+    }
+}
+
 bool os_release(void *ptr, usize size) {
     COLLA_UNUSED(size);
     return VirtualFree(ptr, 0, MEM_RELEASE);
@@ -864,7 +1016,31 @@ DWORD WINAPI os__win_thread_entry_point(void *ptr) {
 
     os_thread_id = atomic_inc_i64(&os_thread_count) - 1;
 
-    return func(id, userdata);
+    int result = func(id, userdata);
+    fmt_release();
+    scratch_release();
+    return result;
+}
+
+void os__cpu_pause(void) {
+    YieldProcessor();
+}
+
+void os__wait_on_address(i64 *address, i64 value) {
+#if COLLA_TCC
+    COLLA_UNUSED(address); COLLA_UNUSED(value);
+    SwitchToThread();
+#else
+    WaitOnAddress(address, &value, sizeof(value), INFINITE);
+#endif
+}
+
+void os__wake_all_on_address(i64 *address) {
+#if COLLA_TCC
+    COLLA_UNUSED(address);
+#else
+    WakeByAddressAll(address);
+#endif
 }
 
 oshandle_t os_thread_launch(thread_func_t func, void *userdata) {
@@ -986,6 +1162,10 @@ void os_cond_wait(oshandle_t cond, oshandle_t mutex, int milliseconds) {
 #define InterlockedExchangeAdd64(dst, val) *dst += val 
 #endif
 
+i64 atomic_get_i64(i64 *src) {
+    return InterlockedCompareExchange64(src, 0, 0);
+}
+
 i64 atomic_set_i64(i64 *dest, i64 val) {
     return InterlockedExchange64(dest, val);
 }
@@ -95,7 +95,7 @@ bool load_cache(arena_t *arena) {
         arena_t scratch = *arena;
 
         ini_t ini = ini_parse(&scratch, strv("build/cache.ini"), &(iniopt_t){ .comment_vals = strv("#") });
-        initable_t *root = ini_get_table(&ini, INI_ROOT);
+        initable_t *root = ini_get_table(&scratch, &ini, INI_ROOT);
         if (!root) fatal("fail");
     
         for_each (val, root->values) {
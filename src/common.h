@@ -215,7 +215,8 @@ ini_t common_get_config(arena_t *arena, str_t *out_conf_fname) {
 
     str_t local_dir = common_get_local_folder(&scratch);
     str_t conf_fname = str_fmt(&scratch, "%v/conf.ini", local_dir);
-    ini_t conf = ini_parse(arena, strv(conf_fname), NULL);
+    // tools only look at their own table
+    ini_t conf = ini_parse(arena, strv(conf_fname), &(iniopt_t){ .lazy_tables = true });
 
     if (out_conf_fname) {
         *out_conf_fname = str_dup(arena, conf_fname);
@@ -250,6 +251,7 @@ int common_strv_to_int(strview_t v) {
 bool common_prompt(strview_t question) {
     while (true) {
         print("%v? (y/n): ", question);
+        fmt_flush();
         int c = _getch();
         println("");
         if (c == 'y') return true;
@@ -261,7 +263,7 @@ bool common_prompt(strview_t question) {
     return false;
 }
 
-void fd__iter_dir(arena_t scratch, strview_t path, const fd_desc_t *desc) {
+void fd__iter_dir(arena_t scratch, strview_t path, const fd_desc_t *desc, const glob_prog_t *glob) {
     dir_t *dir = NULL;
     if (path.len == 0) {
         dir = os_dir_open(&scratch, strv("./"));
@@ -282,7 +284,7 @@ void fd__iter_dir(arena_t scratch, strview_t path, const fd_desc_t *desc) {
         str_t fullpath = str_fmt(&scratch, "%v%v/", path, entry->name);
         strview_t fname_only = str_sub(fullpath, 0, fullpath.len - 1);
 
-        if (glob_matches(desc->rg, fname_only)) {
+        if (glob_match(scratch, glob, fname_only)) {
             desc->cb(scratch, str(&scratch, fname_only), desc->udata);
         }
 
@@ -291,13 +293,14 @@ void fd__iter_dir(arena_t scratch, strview_t path, const fd_desc_t *desc) {
                 continue;
             }
             
-            fd__iter_dir(scratch, strv(fullpath), desc);
+            fd__iter_dir(scratch, strv(fullpath), desc, glob);
         }
     }
 }
 
 void fd_search(arena_t scratch, const fd_desc_t *desc) {
-    fd__iter_dir(scratch, desc->path, desc);
+    glob_prog_t *glob = glob_compile(&scratch, desc->rg, GLOB_DEFAULT);
+    fd__iter_dir(scratch, desc->path, desc, glob);
 }
 
 typedef struct {
@@ -306,29 +309,76 @@ typedef struct {
     str_list_t *list;
 } common_glob_t;
 
-void common__glob_iter(arena_t scratch, strview_t path, glob_t *desc) {
-    dir_t *dir = os_dir_open(&scratch, path);
-    dir_foreach (&scratch, it, dir) {
-        if (!desc->add_hidden && it->name.buf[0] == '.') {
-            continue;
+typedef struct common__glob_seg_t common__glob_seg_t;
+struct common__glob_seg_t {
+    strview_t text;
+    glob_prog_t *prog;
+    bool is_deep;
+};
+
+void common__glob_walk(arena_t scratch, strview_t base, glob_t *desc, common__glob_seg_t *segs, int index, int count) {
+    common__glob_seg_t *seg = &segs[index];
+    bool is_last = index == (count - 1);
+
+    // literal segment, no need to list the directory
+    if (!seg->prog && !seg->is_deep) {
+        str_t path = os_path_join(&scratch, base, seg->text);
+        if (is_last) {
+            if (os_file_or_dir_exists(strv(path))) {
+                desc->cb(scratch, strv(path), desc->udata);
+            }
         }
+        else if (os_dir_exists(strv(path))) {
+            common__glob_walk(scratch, strv(path), desc, segs, index + 1, count);
+        }
+        return;
+    }
+
+    // ** matches zero directories too
+    if (seg->is_deep && !is_last) {
+        common__glob_walk(scratch, base, desc, segs, index + 1, count);
+    }
+
+    bool allow_hidden = desc->add_hidden || (seg->prog && seg->text.buf[0] == '.');
+
+    dir_t *dir = os_dir_open(&scratch, base.len ? base : strv("./"));
+    dir_foreach (&scratch, it, dir) {
         strview_t name = strv(it->name);
         if (strv_equals(name, strv(".")) || strv_equals(name, strv(".."))) {
             continue;
         }
+        if (!allow_hidden && name.buf[0] == '.') {
+            continue;
+        }
 
-        str_t newpath = os_path_join(&scratch, path, name);
-        name = strv(newpath);
-        if (strv_starts_with_view(name, strv("./"))) {
-            name = strv_remove_prefix(name, 2);
+        bool is_dir = it->type == DIRTYPE_DIR;
+
+        if (seg->is_deep) {
+            if (is_last) {
+                str_t path = os_path_join(&scratch, base, name);
+                desc->cb(scratch, strv(path), desc->udata);
+                if (is_dir) {
+                    common__glob_walk(scratch, strv(path), desc, segs, index, count);
+                }
+            }
+            else if (is_dir) {
+                str_t path = os_path_join(&scratch, base, name);
+                common__glob_walk(scratch, strv(path), desc, segs, index, count);
+            }
+            continue;
         }
 
-        if (glob_matches(desc->exp, name)) {
-            desc->cb(scratch, name, desc->udata);
+        // prune anything that can't match this level
+        if (!glob_match(scratch, seg->prog, name) || (!is_last && !is_dir)) {
+            continue;
         }
 
-        if (it->type == DIRTYPE_DIR && desc->recursive) {
-            common__glob_iter(scratch, strv(newpath), desc);
+        str_t path = os_path_join(&scratch, base, name);
+        if (is_last) {
+            desc->cb(scratch, strv(path), desc->udata);
+        }
+        else {
+            common__glob_walk(scratch, strv(path), desc, segs, index + 1, count);
         }
     }
 }
@@ -336,12 +386,71 @@ void common__glob_iter(arena_t scratch, strview_t path, glob_t *desc) {
 void common_glob(arena_t scratch, glob_t *desc) {
     if (!desc || !desc->cb) return;
 
-    strview_t dir;
-    os_file_split_path(desc->exp, &dir, NULL, NULL);
-    if (dir.len == 0) {
-        dir = strv("./");
+    strview_t exp = desc->exp;
+    strview_t base = STRV_EMPTY;
+
+    // keep the root of absolute paths (/foo or C:/foo) as the base
+    if (exp.len && (exp.buf[0] == '/' || exp.buf[0] == '\\')) {
+        base = strv_sub(exp, 0, 1);
     }
-    common__glob_iter(scratch, dir, desc);
+    else if (exp.len >= 3 && exp.buf[1] == ':' && (exp.buf[2] == '/' || exp.buf[2] == '\\')) {
+        base = strv_sub(exp, 0, 3);
+    }
+    exp = strv_remove_prefix(exp, base.len);
+
+    int max_segs = 2;
+    for (usize i = 0; i < exp.len; ++i) {
+        if (exp.buf[i] == '/' || exp.buf[i] == '\\') {
+            max_segs++;
+        }
+    }
+
+    common__glob_seg_t *segs = alloc(&scratch, common__glob_seg_t, max_segs);
+    int count = 0;
+    bool has_deep = false;
+
+    usize beg = 0;
+    for (usize i = 0; i <= exp.len; ++i) {
+        if (i < exp.len && exp.buf[i] != '/' && exp.buf[i] != '\\') {
+            continue;
+        }
+        strview_t text = strv_sub(exp, beg, i);
+        beg = i + 1;
+
+        if (text.len == 0 || strv_equals(text, strv("."))) {
+            continue;
+        }
+
+        common__glob_seg_t *seg = &segs[count++];
+        seg->text = text;
+        if (strv_equals(text, strv("**"))) {
+            // a/**/**/b is the same as a/**/b
+            if (count > 1 && segs[count - 2].is_deep) {
+                count--;
+                continue;
+            }
+            seg->is_deep = true;
+            has_deep = true;
+        }
+        else if (common_is_glob(text)) {
+            seg->prog = glob_compile(&scratch, text, GLOB_DEFAULT);
+            if (!seg->prog) return;
+        }
+    }
+
+    if (count == 0) {
+        return;
+    }
+
+    // recursive globs used to match the last segment at any depth,
+    // which is the same as an implicit ** right before it
+    if (desc->recursive && !has_deep) {
+        segs[count] = segs[count - 1];
+        segs[count - 1] = (common__glob_seg_t){ .text = strv("**"), .is_deep = true };
+        count++;
+    }
+
+    common__glob_walk(scratch, base, desc, segs, 0, count);
 }
 
 bool common_is_glob(strview_t exp) {
@@ -37,8 +37,12 @@ struct {
     strview_t prevdir;
 
     arena_t *worker_arenas;
-    arena_t *scratch_arenas;
-    oshandle_t print_mtx;
+    slab_t *dir_slabs;
+
+    // compiled once and shared, each thread has its own dfa cache
+    rg_t *regex;
+    rg_cache_t **regex_caches;
+    glob_prog_t *glob;
 
     fd_opt_t opt;
 } fd_data = {
@@ -48,6 +52,15 @@ struct {
 
 // == globals =============
 
+// a directory waiting to be walked, it comes from the slab of the thread
+// that found it and it's given back by the thread that walks it
+typedef struct fd_dir_t fd_dir_t;
+struct fd_dir_t {
+    i64 owner;
+    usize alloc_size;
+    str_t path;
+};
+
 void fd_job(void *);
 
 void fd_parse_opts(int argc, char **argv, fd_opt_t *opt) {
@@ -120,7 +133,9 @@ void fd_check_name(arena_t scratch, strview_t name, bool is_dir) {
     atomic_inc_i64(&fd_data.checked);
 
     strview_t current = name;
-    if (!fd_data.opt.case_sensitive) {
+    // both the regex and the glob already ignore case, 
+    // only the exact match needs the name converted
+    if (!fd_data.opt.case_sensitive && fd_data.opt.exact_name) {
         str_t filename = str(&scratch, current);
         str_upper(&filename);
         current = strv(filename);
@@ -133,12 +148,12 @@ void fd_check_name(arena_t scratch, strview_t name, bool is_dir) {
     }
     else {
         if (fd_data.opt.extended) {
-            if (!rg_matches(fd_data.opt.tofind, current)) {
+            if (!rg_match(fd_data.regex_caches[jq_worker_index()], current)) {
                 return;
             }
         }
         else {
-            if (!glob_matches(fd_data.opt.tofind, current)) {
+            if (!glob_match(scratch, fd_data.glob, current)) {
                 return;
             }
         }
@@ -172,18 +187,43 @@ void fd_check_name(arena_t scratch, strview_t name, bool is_dir) {
         filename = strv_remove_prefix(name, dir.len);
     }
 
-    os_mutex_lock(fd_data.print_mtx);
-        if (fd_data.opt.is_piped) {
-            println("%v%v", dir, filename);
-        }
-        else {
-            println(
-                TERM_FG_DARK_GREY "%v" TERM_RESET
-                TERM_FG_GREEN "%v" TERM_RESET,
-                dir, filename
-            );
-        }
-    os_mutex_unlock(fd_data.print_mtx);
+    if (fd_data.opt.is_piped) {
+        fmt_record("%v%v\n", dir, filename);
+    }
+    else {
+        fmt_record(
+            TERM_FG_DARK_GREY "%v" TERM_RESET
+            TERM_FG_GREEN "%v" TERM_RESET "\n",
+            dir, filename
+        );
+    }
+}
+
+fd_dir_t *fd_dir_make(strview_t path) {
+    usize alloc_size = sizeof(fd_dir_t) + path.len + 1;
+    int slot = jq_worker_index();
+    fd_dir_t *dir = slab_alloc(&fd_data.dir_slabs[slot], alloc_size);
+    dir->owner = slot;
+    dir->alloc_size = alloc_size;
+    dir->path.buf = (char *)(dir + 1);
+    dir->path.len = path.len;
+    memcpy(dir->path.buf, path.buf, path.len);
+    return dir;
+}
+
+void fd_dir_free(fd_dir_t *dir) {
+    // the starting directory doesn't come from a slab
+    if (dir->owner < 0) {
+        return;
+    }
+
+    slab_t *slab = &fd_data.dir_slabs[dir->owner];
+    if (dir->owner == jq_worker_index()) {
+        slab_free(slab, dir, dir->alloc_size);
+    }
+    else {
+        slab_free_remote(slab, dir, dir->alloc_size);
+    }
 }
 
 void iter_dir(arena_t scratch, strview_t path) {
@@ -198,11 +238,9 @@ void iter_dir(arena_t scratch, strview_t path) {
             continue;
         }
 
-        arena_t *arena = &fd_data.worker_arenas[os_thread_id];
-        str_t *fullpath = alloc(arena, str_t);
-        *fullpath = os_path_join(arena, path, strv(entry->name));
+        str_t fullpath = os_path_join(&scratch, path, strv(entry->name));
 
-        strview_t fullname = strv(*fullpath);
+        strview_t fullname = strv(fullpath);
         if (strv_starts_with_view(fullname, strv("./"))) {
             fullname = strv_remove_prefix(fullname, 2);
         }
@@ -214,15 +252,18 @@ void iter_dir(arena_t scratch, strview_t path) {
                 continue;
             }
 
-            jq_push(arena, fd_data.jq, fd_job, fullpath);
+            arena_t *arena = &fd_data.worker_arenas[jq_worker_index()];
+            jq_group_push(arena, jq_current_group(), fd_job, fd_dir_make(strv(fullpath)));
         }
     }
 }
 
 void fd_job(void *userdata) {
-    arena_t scratch = fd_data.scratch_arenas[os_thread_id];
-    str_t *dir = userdata;
-    iter_dir(scratch, strv(*dir));
+    fd_dir_t *dir = userdata;
+    scratch_scope (scratch, &fd_data.worker_arenas[jq_worker_index()]) {
+        iter_dir(*scratch.arena, strv(dir->path));
+    }
+    fd_dir_free(dir);
 }
 
 void TOY(fd)(int argc, char **argv) {
@@ -230,7 +271,7 @@ void TOY(fd)(int argc, char **argv) {
 
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
 
-    icons_init(ICON_STYLE_NERD);
+    icons_init(&arena, ICON_STYLE_NERD);
 
     if (strv_is_empty(fd_data.opt.dir)) {
         fd_data.opt.dir = strv(".");
@@ -250,17 +291,39 @@ void TOY(fd)(int argc, char **argv) {
         fd_data.opt.is_regex = true;
     }
 
-    fd_data.print_mtx = os_mutex_create();
+    fd_data.jq = jq_init(&arena, (int)fd_data.opt.thread_count);
+    // the main thread runs jobs too while it waits, so it needs a slot
+    int slot_count = jq_slot_count(fd_data.jq);
+
+    if (fd_data.opt.extended) {
+        rg_flags_e flags = fd_data.opt.case_sensitive ? RG_DEFAULT : RG_IGNORE_CASE;
+        fd_data.regex = rg_compile(&arena, strv(fd_data.opt.tofind_original), flags);
+        if (!fd_data.regex) {
+            os_abort(1);
+        }
+        fd_data.regex_caches = alloc(&arena, rg_cache_t *, slot_count);
+    }
+    else {
+        glob_flags_e flags = fd_data.opt.case_sensitive ? GLOB_DEFAULT : GLOB_IGNORE_CASE;
+        fd_data.glob = glob_compile(&arena, strv(fd_data.opt.tofind_original), flags);
+    }
 
-    fd_data.worker_arenas = alloc(&arena, arena_t, fd_data.opt.thread_count);
-    fd_data.scratch_arenas = alloc(&arena, arena_t, fd_data.opt.thread_count);
-    for (int i = 0; i < fd_data.opt.thread_count; ++i) {
+    fd_data.worker_arenas = alloc(&arena, arena_t, slot_count);
+    fd_data.dir_slabs = alloc(&arena, slab_t, slot_count);
+    for (int i = 0; i < slot_count; ++i) {
         fd_data.worker_arenas[i] = arena_make(ARENA_VIRTUAL, GB(1));
-        fd_data.scratch_arenas[i] = arena_make(ARENA_VIRTUAL, GB(1));
+        fd_data.dir_slabs[i] = slab_init(&fd_data.worker_arenas[i]);
+        if (fd_data.regex) {
+            fd_data.regex_caches[i] = rg_cache_init(&fd_data.worker_arenas[i], fd_data.regex);
+        }
     }
 
-    fd_data.jq = jq_init(&arena, (int)fd_data.opt.thread_count);
-    jq_push(&arena, fd_data.jq, fd_job, &fd_data.opt.dir);
+    fd_dir_t *start = alloc(&arena, fd_dir_t);
+    start->owner = -1;
+    start->path = str(&arena, fd_data.opt.dir);
+    jq_group_t *group = jq_group_create(&arena, fd_data.jq);
+    jq_group_push(&arena, group, fd_job, start);
+    jq_group_wait(group);
     jq_cleanup(fd_data.jq);
 
     if (!fd_data.opt.is_piped) {
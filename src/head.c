@@ -77,39 +77,35 @@ void head_tail(arena_t scratch, oshandle_t fp, head_opt_t *opt) {
     i64 lines = -opt->lines;
     i64 bytes = -opt->bytes;
 
-    // read file buffered as fp could be stdin
-    outstream_t ostr = ostr_init(&scratch);
-    char buf[KB(10)] = {0};
-    while (true) {
-        usize read = os_file_read(fp, buf, sizeof(buf));
-        ostr_puts(&ostr, strv(buf, read));
-        if (read < sizeof(buf)) {
-            break;
-        }
-    }
-    str_t data = ostr_to_str(&ostr);
+    // mapped if it's a file, read buffered otherwise as fp could be stdin
+    os_file_view_t view = os_file_map(&scratch, fp);
+    strview_t data = view.data;
 
     if (lines > 0) {
-        i64 line_count = 0;
-        for (usize i = 0; i < data.len; ++i) {
-            if (data.buf[i] == opt->line_delim) {
-                line_count++;
-            }
-        }; 
-        if (line_count < lines) {
-            return;
-        }
-        instream_t in = istr_init(strv(data));
-        i64 to_print = line_count - lines;
-        for (i64 i = 0; i < to_print; ++i) {
-            strview_t line = istr_get_view(&in, opt->line_delim);
-            istr_skip(&in, 1);
-            println("%v", line);
+        usize line_count = scan_count(data, opt->line_delim);
+        if (line_count > (usize)lines) {
+            usize end = scan_find_nth(data, opt->line_delim, line_count - lines);
+            fmt_write(data.buf, end + 1);
         }
     }
     else {
-        strview_t view = str_sub(data, 0, data.len - bytes);
-        println("%v", view);
+        strview_t head = strv_sub(data, 0, data.len - MIN((usize)bytes, data.len));
+        println("%v", head);
+    }
+
+    os_file_unmap(&view);
+}
+
+// writes data skipping any '\r'
+void head__write(strview_t data) {
+    while (data.len) {
+        usize pos = scan_find(data, '\r');
+        if (pos == STR_NONE) {
+            fmt_write(data.buf, data.len);
+            break;
+        }
+        fmt_write(data.buf, pos);
+        data = strv_remove_prefix(data, pos + 1);
     }
 }
 
@@ -127,23 +123,29 @@ void head_impl(arena_t scratch, oshandle_t fp, head_opt_t *opt) {
     u8 buffer[KB(10)] = {0};
     while (lines_rem > 0 || bytes_rem > 0) {
         usize read = os_file_read(fp, buffer, sizeof(buffer));
+        strview_t data = strv((char *)buffer, read);
         if (lines) {
-            for (usize i = 0; i < read && lines_rem > 0; ++i) {
-                if (opt->line_delim == '\n' && buffer[i] == '\r') continue;
-                if (buffer[i] == opt->line_delim) {
-                    lines_rem--;
-                    if (lines_rem <= 0) break;
-                }
-                print("%c", buffer[i]);
+            usize end = scan_find_nth(data, opt->line_delim, (usize)lines_rem);
+            if (end != STR_NONE) {
+                // the last delimiter is not printed
+                data.len = end;
+                lines_rem = 0;
+            }
+            else {
+                lines_rem -= scan_count(data, opt->line_delim);
+            }
+
+            if (opt->line_delim == '\n') {
+                head__write(data);
+            }
+            else {
+                fmt_write(data.buf, data.len);
             }
         }
         else {
-            i64 todo = MIN((i64)read, bytes_rem);
-            bytes_rem -= todo;
-            for (i64 i = 0; i < todo; ++i) {
-                if (buffer[i] == '\r') continue;
-                print("%c", buffer[i]);
-            }
+            data.len = MIN((i64)read, bytes_rem);
+            bytes_rem -= data.len;
+            head__write(data);
         }
 
         if (read == 0) {
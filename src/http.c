@@ -148,9 +148,14 @@ void TOY(http)(int argc, char **argv) {
                 req.body = strv(full);
             }
 
-            json_t *json = json_parse_str(&arena, req.body, JSON_DEFAULT);
+            json_tape_t json = json_tape_parse(&arena, req.body, JSON_DEFAULT);
 
-            json_pretty_print(json, &(json_pretty_opts_t){0}); 
+            if (json.count) {
+                json_tape_pretty_print(&json, &(json_pretty_opts_t){0}); 
+            }
+            else {
+                print("%v\n", req.body);
+            }
         }
         else {
             print("%v\n", req.body);
@@ -208,9 +213,14 @@ void TOY(http)(int argc, char **argv) {
             response.body = strv(full);
         }
 
-        json_t *json = json_parse_str(&arena, response.body, JSON_DEFAULT);
+        json_tape_t json = json_tape_parse(&arena, response.body, JSON_DEFAULT);
 
-        json_pretty_print(json, &(json_pretty_opts_t){0}); 
+        if (json.count) {
+            json_tape_pretty_print(&json, &(json_pretty_opts_t){0}); 
+        }
+        else {
+            println("%v", response.body);
+        }
     }
     else {
         println("%v", response.body);
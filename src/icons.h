@@ -2,8 +2,6 @@
 
 #include "colla/colla.h"
 
-#define ICONMAP_SIZE 128 
-
 typedef enum {
     ICON_NONE,
 
@@ -77,100 +75,28 @@ strview_t icons[ICON_STYLE__COUNT][ICON__COUNT] = {
 typedef struct icons_map_t icons_map_t;
 struct icons_map_t {
     icon_style_e style;
-    strview_t keys[ICONMAP_SIZE];
-    strview_t values[ICONMAP_SIZE];
-    u64 hashes[ICONMAP_SIZE];
+    hmap_t map;
 };
 
 icons_map_t icon__map = {0};
 
-void icons_init(icon_style_e style);
-void iconsmap__add(strview_t key, strview_t ico);
-strview_t iconsmap__get(strview_t key);
-u64 iconsmap__hash(strview_t key);
+void icons_init(arena_t *arena, icon_style_e style);
 
 strview_t ext_to_ico(strview_t ext) {
-    return iconsmap__get(ext); 
-}
-
-// ICONS HASHMAP IMPLEMENTATION //////////////////////////////
-
-void iconsmap__add(strview_t key, strview_t ico) {
-    u64 hash = iconsmap__hash(key);
-    usize index = hash & (ICONMAP_SIZE - 1);
-
-    for (usize i = index; i < ICONMAP_SIZE; ++i) {
-        if (icon__map.hashes[i] == 0) {
-            icon__map.hashes[i] = hash;
-            icon__map.keys[i] = key;
-            icon__map.values[i] = ico;
-            return;
-        }
-    }
-
-    for (usize i = 0; i < index; ++i) {
-        if (icon__map.hashes[i] == 0) {
-            icon__map.hashes[i] = hash;
-            icon__map.keys[i] = key;
-            icon__map.values[i] = ico;
-            return;
-        }
-    }
-
-    fatal("could not find an empty slot in icons hashmap, increase ICONMAP_SIZE");
-}
-
-strview_t iconsmap__get(strview_t key) {
-    if (strv_is_empty(key)) {
+    hmap_entry_t *entry = hmap_get(&icon__map.map, ext);
+    if (!entry) {
+        // return a default icon for unrecognized files
         return icons[icon__map.style][ICON_FILE];
     }
-
-    u64 hash = iconsmap__hash(key);
-    usize index = hash & (ICONMAP_SIZE - 1);
-    for (usize i = index; i < ICONMAP_SIZE; ++i) {
-        if (icon__map.hashes[i] == hash && 
-            strv_equals(icon__map.keys[i], key))
-        {
-            return icon__map.values[i];
-        }
-
-        if (icon__map.hashes[i] == 0) {
-            return icons[icon__map.style][ICON_FILE];
-        }
-    }
-
-    for (usize i = 0; i < index; ++i) {
-        if (icon__map.hashes[i] == hash && 
-            strv_equals(icon__map.keys[i], key))
-        {
-            return icon__map.values[i];
-        }
-
-        if (icon__map.hashes[i] == 0) {
-            return icons[icon__map.style][ICON_FILE];
-        }
-    }
-
-    // return a default icon for unrecognized files
-    return icons[icon__map.style][ICON_FILE];
-}
-
-u64 iconsmap__hash(strview_t key) {
-    const u8 *data = (const u8 *)key.buf;
-    u64 hash = 0;
-
-    for (usize i = 0; i < key.len; ++i) {
-		hash = data[i] + (hash << 6) + (hash << 16) - hash;
-    }
-
-    return hash;
+    return *(strview_t *)entry->value;
 }
 
-void icons_init(icon_style_e style) {
+void icons_init(arena_t *arena, icon_style_e style) {
     icon__map.style = style;
+    icon__map.map = hmap_init(arena, 128);
 
     // add all the known icons here!
-#define add_ico(ext, ico) iconsmap__add((strview_t)cstrv(ext), icons[style][ICON_##ico])
+#define add_ico(ext, ico) hmap_set(&icon__map.map, strv(ext), &icons[style][ICON_##ico])
 
     // CODE ICONS
 
@@ -12,7 +12,7 @@ typedef struct {
     bool no_border;
     bool no_linenum;
 
-    str_t data;
+    strview_t data;
     i64 offset;
     i64 line_count;
 } less_options_t;
@@ -63,7 +63,7 @@ bool less_update(arena_t *arena, float dt, void *userdata) {
             p->list_type = TUI_LIST_LINE;
             if (!opt->no_linenum) p->list_type |= TUI_LIST_DISPLAY_NUMBER;
             tui_set_max_elements(p, (int)opt->line_count);
-            instream_t in = istr_init(strv(opt->data));
+            instream_t in = istr_init(opt->data);
             for (i64 i = 0; i < opt->line_count; ++i) {
                 strview_t line = istr_get_line(&in);
                 if (strv_back(line) == '\r') {
@@ -128,7 +128,8 @@ void TOY(less)(int argc, char **argv) {
     less_options_t opt = {0};
     less_parse_options(argc, argv, &opt);
 
-    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    // pipes are read whole into the arena, huge pages make that a lot cheaper
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1), .flags = ARENA_HUGE_PAGES);
 
     oshandle_t fp = os_stdin();
     if (!opt.in_piped) {
@@ -137,7 +138,10 @@ void TOY(less)(int argc, char **argv) {
             fatal("could not open %v for reading: %v", opt.file, os_get_error_string(os_get_last_error()));
         }
     }
-    opt.data = common_read_buffered(&arena, fp);
+    // the view stays valid after closing the file, we never unmap it
+    // as we need it until we exit
+    os_file_view_t view = os_file_map(&arena, fp);
+    opt.data = view.data;
     if (!opt.in_piped) {
         os_file_close(fp);
     }
@@ -145,9 +149,7 @@ void TOY(less)(int argc, char **argv) {
     print("%v", opt.data);
     // return;
 
-    for (usize i = 0; i < opt.data.len; ++i) {
-        opt.line_count += opt.data.buf[i] == '\n';
-    }
+    opt.line_count = scan_count(opt.data, '\n');
 
     opt.offset = (tui_height() - (2 * !opt.no_border) - 1) / 2;
 
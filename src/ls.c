@@ -33,6 +33,8 @@ typedef struct {
     strview_t dir;
     icon_style_e style;
     bool is_out_piped;
+    // keeps the entries next to each other instead of between their names
+    pool_t entry_pool;
 } ls_opt_t;
 
 typedef struct ls_entry_t ls_entry_t;
@@ -164,12 +166,12 @@ ls_entry_t *ls_add_dir(arena_t *arena, strview_t path, int depth, ls_opt_t *opt)
             continue;
         }
 
-        ls_entry_t *new_entry = alloc(arena, ls_entry_t);
+        ls_entry_t *new_entry = pool_alloc(&opt->entry_pool);
         new_entry->type = entry->type;
         new_entry->path = entry->name;
 
         if (opt->list_extra) {
-            new_entry->size = entry->file_size;
+            new_entry->size = os_dir_entry_size(dir, entry);
             new_entry->filetype = ls_get_file_info(arena, strv(entry->name));
         }
  
@@ -298,13 +300,14 @@ void TOY(ls)(int argc, char **argv) {
     ls_parse_opts(argc, argv, &opt);
 
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    opt.entry_pool = pool_make(&arena, ls_entry_t);
 
     if (strv_is_empty(opt.dir)) {
         opt.dir = strv(".");
     }
 
     if (!opt.is_out_piped && opt.style) {
-        icons_init(opt.style);
+        icons_init(&arena, opt.style);
     }
 
     ls_entry_t *entries = ls_add_dir(&arena, opt.dir, 1, &opt);
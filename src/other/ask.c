@@ -105,16 +105,16 @@ void load_options(arena_t *arena, int argc, char **argv) {
         info("saved configuration to %v", conf_fname);
     }
 
-    initable_t *ini_ask = ini_get_table(&conf, strv("ask"));
+    initable_t *ini_ask = ini_get_table(arena, &conf, strv("ask"));
     if (!ini_ask) {
         warn("a configuration file was found at %v, but there is no [ask] category", conf_fname);
         os_abort(1);
     }
     
-    inivalue_t *model  = ini_get(ini_ask, strv("model"));
-    inivalue_t *key    = ini_get(ini_ask, strv("key"));
-    inivalue_t *prompt = ini_get(ini_ask, strv("prompt"));
-    inivalue_t *cache  = ini_get(ini_ask, strv("cache"));
+    inivalue_t *model  = ini_get(arena, ini_ask, strv("model"));
+    inivalue_t *key    = ini_get(arena, ini_ask, strv("key"));
+    inivalue_t *prompt = ini_get(arena, ini_ask, strv("prompt"));
+    inivalue_t *cache  = ini_get(arena, ini_ask, strv("cache"));
 
     if (!model) {
         warn("invalid configuration found in %v, model is missing", conf_fname);
@@ -476,6 +476,7 @@ void ask_grab_chunk(strview_t chunk, void *userdata) {
     }
     
     instream_t in = istr_init(chunk);
+    json_path_t content_path = json_path_init(&scratch, strv("choices[0].delta.content"));
 
     while (!istr_is_finished(&in)) {
         strview_t line = istr_get_line(&in);
@@ -500,24 +501,20 @@ void ask_grab_chunk(strview_t chunk, void *userdata) {
             break;
         }
 
-        json_t *json = json_parse_str(&scratch, line, JSON_DEFAULT);
-        if (!json) fatal("1 failed to parse json: %v", line);
-        json_t *choices = json_get(json, strv("choices"));
-        if (!choices) fatal("2 failed to get choices: %v", line);
-        json_t *item = choices->array;
-        if (!item)  fatal("3 failed to get item: %v", line);
+        // only the content is needed, so read it in place instead of building the whole tree
+        json_reader_t reader = json_reader_init(&scratch, JSON_DEFAULT);
+        json_reader_feed(&reader, line, true);
 
-        json_t *delta = json_get(item, strv("delta"));
-        if (!delta) fatal("4 failed to get delta: %v", line);
-        json_t *content = json_get(delta, strv("content"));
-        if (!content) fatal("5 failed to get content: %v", line);
+        int match = 0;
+        json_event_e event = json_reader_select(&reader, &content_path, 1, &match);
+        if (event == JSON_EVENT_ERROR) fatal("failed to parse json: %v", line);
 
-        if (strv_is_empty(content->string)) {
+        if (event != JSON_EVENT_STRING || strv_is_empty(reader.str)) {
             continue;
         }
 
         os_mutex_lock(ask.mtx);
-            ostr_puts(&ask.data, content->string);
+            ostr_puts(&ask.data, reader.str);
         os_mutex_unlock(ask.mtx);
     }
 }
@@ -364,7 +364,7 @@ void worker_load_pipeline_job(worker_data_t *data, void *userdata) {
         }
     );
     json_t *doc = json_parse_str(&data->scratch, strv(res), JSON_DEFAULT);
-    json_t *title = json_get(doc, strv("title"));
+    json_t *title = json_get(&data->scratch, doc, strv("title"));
     pip->title = str(&data->arena, title->string);
     ATOMIC_SET(pip->loading_status, LOADING_JOBS);
     ATOMIC_INC(data->state->pipeline_fetched);
@@ -383,10 +383,10 @@ void worker_load_pipeline_job(worker_data_t *data, void *userdata) {
     pip->cur_stage = JOB_STAGE__COUNT;
 
     for_each (json_job, doc->array) {
-        json_t *json_id     = json_get(json_job, strv("id"));
-        json_t *json_name   = json_get(json_job, strv("name"));
-        json_t *json_status = json_get(json_job, strv("status"));
-        json_t *json_stage  = json_get(json_job, strv("stage"));
+        json_t *json_id     = json_get(&data->scratch, json_job, strv("id"));
+        json_t *json_name   = json_get(&data->scratch, json_job, strv("name"));
+        json_t *json_status = json_get(&data->scratch, json_job, strv("status"));
+        json_t *json_stage  = json_get(&data->scratch, json_job, strv("stage"));
 
         job_stage_e stage   = JOB_STAGE_NONE;
         gb_status_e status = 0;
@@ -657,9 +657,9 @@ str_t gb__get_token(arena_t *arena, str_t *refresh_token, bool force) {
 
     if (!force && os_file_exists(strv(cache_path))) {
         ini_t ini = ini_parse(&scratch, strv(cache_path), NULL);
-        initable_t *root = ini_get_table(&ini, INI_ROOT);
-        inivalue_t *ini_token = ini_get(root, strv("token"));
-        inivalue_t *ini_refresh = ini_get(root, strv("refresh"));
+        initable_t *root = ini_get_table(&scratch, &ini, INI_ROOT);
+        inivalue_t *ini_token = ini_get(&scratch, root, strv("token"));
+        inivalue_t *ini_refresh = ini_get(&scratch, root, strv("refresh"));
         token = ini_token->value;
         new_refresh = ini_refresh->value;
         goto finish;
@@ -751,9 +751,9 @@ str_t gb__get_token(arena_t *arena, str_t *refresh_token, bool force) {
         }
 
         json_t *doc = json_parse_str(&scratch, res.body, JSON_DEFAULT);
-        json_t *js_token   = json_get(doc, strv("access_token"));
-        json_t *js_expiry  = json_get(doc, strv("expires_in"));
-        json_t *js_refresh = json_get(doc, strv("refresh_token"));
+        json_t *js_token   = json_get(&scratch, doc, strv("access_token"));
+        json_t *js_expiry  = json_get(&scratch, doc, strv("expires_in"));
+        json_t *js_refresh = json_get(&scratch, doc, strv("refresh_token"));
 
         if (!(
             json_check(js_token, JSON_STRING) &&
@@ -863,8 +863,8 @@ void gb__refresh_token(gitlab_t *ctx) {
         os_mutex_unlock(ctx->token_mtx);
         goto finish;
     }
-    json_t *token   = json_get(doc, strv("access_token"));
-    json_t *refresh = json_get(doc, strv("refresh_token"));
+    json_t *token   = json_get(&scratch, doc, strv("access_token"));
+    json_t *refresh = json_get(&scratch, doc, strv("refresh_token"));
 
     os_mutex_lock(ctx->token_mtx);
         ctx->token         = str(&ctx->arena, token->string);
@@ -907,8 +907,8 @@ str_t gb_make_request(gitlab_t *ctx, gbreq_t *req) {
     if (res.status_code != 200) {
         json_t *doc = json_parse_str(&req->scratch, res.body, JSON_DEFAULT);
 
-        json_t *error = json_get(doc, strv("error"));
-        json_t *desc  = json_get(doc, strv("error_description"));
+        json_t *error = json_get(&req->scratch, doc, strv("error"));
+        json_t *desc  = json_get(&req->scratch, doc, strv("error_description"));
         if (strv_equals(error->string, strv("invalid_token")) && 
             strv_equals(desc->string, strv("Token is expired. You can either do re-authorization or token refresh."))
         ) {
@@ -938,7 +938,7 @@ str_t gb_current_username(gitlab_t *ctx, arena_t *arena) {
     }
 
     json_t *doc = json_parse_str(&scratch, strv(res), JSON_DEFAULT);
-    json_t *js_username = json_get(doc, strv("username"));
+    json_t *js_username = json_get(&scratch, doc, strv("username"));
     if (!json_check(js_username, JSON_STRING)) {
         goto finish;
     }
@@ -1348,9 +1348,9 @@ int main(int argc, char **argv) {
     json_t *root = json_parse_str(&state->arena, strv(res), JSON_DEFAULT);
     
     json_for(p, root) {
-        json_t *json_id     = json_get(p, strv("id"));
-        json_t *json_sha    = json_get(p, strv("sha"));
-        json_t *json_status = json_get(p, strv("status"));
+        json_t *json_id     = json_get(&state->arena, p, strv("id"));
+        json_t *json_sha    = json_get(&state->arena, p, strv("sha"));
+        json_t *json_status = json_get(&state->arena, p, strv("status"));
 
      
         gb_status_e status = GB_STATUS_NONE;
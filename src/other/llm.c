@@ -34,13 +34,13 @@ llm_models_t *llm_get_free_models(arena_t *arena, arena_t scratch) {
     http_res_t res = http_get(&scratch, strv("https://openrouter.ai/api/v1/models"));
     json_t *json = json_parse_str(&scratch, res.body, JSON_DEFAULT);
 
-    json_t *data = json_get(json, strv("data"));
+    json_t *data = json_get(&scratch, json, strv("data"));
     json_for(model, data) {
         // .pricing.prompt
-        json_t *name    = json_get(model, strv("name"));
-        json_t *id      = json_get(model, strv("id"));
-        json_t *pricing = json_get(model, strv("pricing"));
-        json_t *prompt  = json_get(pricing, strv("prompt"));
+        json_t *name    = json_get(&scratch, model, strv("name"));
+        json_t *id      = json_get(&scratch, model, strv("id"));
+        json_t *pricing = json_get(&scratch, model, strv("pricing"));
+        json_t *prompt  = json_get(&scratch, pricing, strv("prompt"));
 
         if (json_check(prompt, JSON_STRING)) {
             double cost = strv_to_num(prompt->string);
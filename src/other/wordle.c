@@ -13,14 +13,6 @@ struct word_t {
 
 darr_define(word_arr_t, word_t);
 
-typedef struct hset_t hset_t;
-struct hset_t {
-    word_t *words;
-    u32 *hashes;
-    int size;
-    int collisions_count;
-};
-
 struct {
     bool quit;
     bool valid;
@@ -32,90 +24,17 @@ struct {
     char guesses[5][5];
     int tries;
     int count;
-    hset_t words;
+    hmap_t words;
     word_arr_t *valid_guesses;
     int total_count;
 } app = {0};
 
-hset_t hset_init(arena_t *arena, usize pow2_size) {
-    usize count = 1ull << pow2_size;
-    return (hset_t) {
-        .words = alloc(arena, word_t, count),
-        .hashes = alloc(arena, u32, count),
-        .size = (int)count,
-    };
-}
-
 word_t word_from_strv(strview_t v) {
     word_t w = {0};
     memmove(w.str, v.buf, 5);
     return w;
 }
 
-u32 hset_hash(const char buf[5]) {
-    return (buf[0] - 'a') * 456976 +  // 26^4
-           (buf[1] - 'a') * 17576 +   // 26^3
-           (buf[2] - 'a') * 676 +     // 26^2
-           (buf[3] - 'a') * 26 +      // 26^1
-           (buf[4] - 'a');            // 26^0
-}
-
-void hset_add(hset_t *set, strview_t word) {
-    colla_assert(word.len == 5);
-    u32 hash = hset_hash(word.buf);
-    usize index = hash & (set->size - 1);
-
-    for (usize i = index; i < set->size; ++i) {
-        if (set->hashes[i] == 0) {
-            set->hashes[i] = hash;
-            set->words[i] = word_from_strv(word);
-            return;
-        }
-        else {
-            // debug
-            set->collisions_count++;
-        }
-    }
-
-    for (usize i = 0; i < index; ++i) {
-        if (set->hashes[i] == 0) {
-            set->hashes[i] = hash;
-            set->words[i] = word_from_strv(word);
-            return;
-        }
-        else {
-            // debug
-            set->collisions_count++;
-        }
-
-    }
-
-    fatal("could not fit word in set");
-}
-
-word_t *hset_get(hset_t *set, strview_t word) {
-    u32 hash = hset_hash(word.buf);
-    usize index = hash & (set->size - 1);
-
-    for (usize i = index; i < set->size; ++i) {
-        if (set->hashes[i] == hash) {
-            if (memcmp(set->words[i].str, word.buf, 5) == 0) {
-                return &set->words[i];
-            }
-        }
-    }
-
-    for (usize i = 0; i < index; ++i) {
-        if (set->hashes[i] == hash) {
-            if (memcmp(set->words[i].str, word.buf, 5) == 0) {
-                return &set->words[i];
-            }
-        }
-    }
-
-    return NULL;
-}
-
 int wordle_load(strview_t data, arena_t *arena) {
     int count = 0;
 
@@ -131,7 +50,8 @@ int wordle_load(strview_t data, arena_t *arena) {
             darr_push(arena, app.valid_guesses, word_from_strv(line));
         }
 
-        hset_add(&app.words, line);
+        // the words point in the embedded lists, so they don't need to be copied
+        hmap_set(&app.words, line, NULL);
         count++;
     }
 
@@ -218,7 +138,7 @@ bool app_update(arena_t *arena, float dt, void *udata) {
     COLLA_UNUSED(udata); COLLA_UNUSED(dt); COLLA_UNUSED(arena);
     strview_t guess = strv(app.guess, app.count);
 
-    app.valid = app.count == 5 && hset_get(&app.words, guess);
+    app.valid = app.count == 5 && hmap_get(&app.words, guess);
 
     return app.quit;
 }
@@ -336,7 +256,7 @@ int main() {
 
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
 
-    app.words = hset_init(&arena, 18);
+    app.words = hmap_init(&arena, 1 << 14);
 
     app.total_count = wordle_load(strv((char*)debug_wordle_la_txt, debug_wordle_la_txt_len), &arena);
     wordle_load(strv((char*)debug_wordle_ta_txt, debug_wordle_ta_txt_len), NULL);
@@ -15,6 +15,7 @@ typedef struct {
     bool verbose;
     os_barrier_t thread_barrier;
     socket_t server_socket;
+    hmap_t mime_types;
 } serve_opt_t;
 
 void serve_parse_opts(arena_t scratch, int argc, char **argv, serve_opt_t *opt) {
@@ -99,55 +100,59 @@ void serve_parse_opts(arena_t scratch, int argc, char **argv, serve_opt_t *opt)
     }
 }
 
-strview_t mime(strview_t filename) {
-    struct {
-        strview_t ext;
-        strview_t val;
-    } types[] = {
-        { cstrv(".asc"),  cstrv("text/plain"), },
-        { cstrv(".bin"),  cstrv("application/octet-stream"), },
-        { cstrv(".bmp"),  cstrv("image/bmp"), },
-        { cstrv(".cpio"), cstrv("application/x-cpio"), },
-        { cstrv(".css"),  cstrv("text/css"), },
-        { cstrv(".doc"),  cstrv("application/msword"), },
-        { cstrv(".dtd"),  cstrv("text/xml"), },
-        { cstrv(".dvi"),  cstrv("application/x-dvi"), },
-        { cstrv(".gif"),  cstrv("image/gif"), },
-        { cstrv(".htm"),  cstrv("text/html"), },
-        { cstrv(".html"), cstrv("text/html"), },
-        { cstrv(".jar"),  cstrv("application/x-java-archive"), },
-        { cstrv(".jpeg"), cstrv("image/jpeg"), },
-        { cstrv(".jpg"),  cstrv("image/jpeg"), },
-        { cstrv(".js"),   cstrv("application/x-javascript"), },
-        { cstrv(".mp3"),  cstrv("audio/mpeg"), },
-        { cstrv(".mp4"),  cstrv("video/mp4"), },
-        { cstrv(".mpg"),  cstrv("video/mpeg"), },
-        { cstrv(".ogg"),  cstrv("application/ogg"), },
-        { cstrv(".pbm"),  cstrv("image/x-portable-bitmap"), },
-        { cstrv(".pdf"),  cstrv("application/pdf"), },
-        { cstrv(".png"),  cstrv("image/png"), },
-        { cstrv(".ppt"),  cstrv("application/vnd.ms-powerpoint"), },
-        { cstrv(".ps"),   cstrv("application/postscript"), },
-        { cstrv(".rtf"),  cstrv("text/rtf"), },
-        { cstrv(".sgml"), cstrv("text/sgml"), },
-        { cstrv(".svg"),  cstrv("image/svg+xml"), },
-        { cstrv(".tar"),  cstrv("application/x-tar"), },
-        { cstrv(".tex"),  cstrv("application/x-tex"), },
-        { cstrv(".tiff"), cstrv("image/tiff"), },
-        { cstrv(".txt"),  cstrv("text/plain"), },
-        { cstrv(".wav"),  cstrv("audio/x-wav"), },
-        { cstrv(".xls"),  cstrv("application/vnd.ms-excel"), },
-        { cstrv(".xml"),  cstrv("text/xml"), },
-        { cstrv(".zip"),  cstrv("application/zip") },
-    };
+struct {
     strview_t ext;
-    os_file_split_path(filename, NULL, NULL, &ext);
-    for (int i = 0; i < arrlen(types); ++i) {
-        if (strv_equals(types[i].ext, ext)) {
-            return types[i].val;
-        }
+    strview_t val;
+} mime__types[] = {
+    { cstrv(".asc"),  cstrv("text/plain"), },
+    { cstrv(".bin"),  cstrv("application/octet-stream"), },
+    { cstrv(".bmp"),  cstrv("image/bmp"), },
+    { cstrv(".cpio"), cstrv("application/x-cpio"), },
+    { cstrv(".css"),  cstrv("text/css"), },
+    { cstrv(".doc"),  cstrv("application/msword"), },
+    { cstrv(".dtd"),  cstrv("text/xml"), },
+    { cstrv(".dvi"),  cstrv("application/x-dvi"), },
+    { cstrv(".gif"),  cstrv("image/gif"), },
+    { cstrv(".htm"),  cstrv("text/html"), },
+    { cstrv(".html"), cstrv("text/html"), },
+    { cstrv(".jar"),  cstrv("application/x-java-archive"), },
+    { cstrv(".jpeg"), cstrv("image/jpeg"), },
+    { cstrv(".jpg"),  cstrv("image/jpeg"), },
+    { cstrv(".js"),   cstrv("application/x-javascript"), },
+    { cstrv(".mp3"),  cstrv("audio/mpeg"), },
+    { cstrv(".mp4"),  cstrv("video/mp4"), },
+    { cstrv(".mpg"),  cstrv("video/mpeg"), },
+    { cstrv(".ogg"),  cstrv("application/ogg"), },
+    { cstrv(".pbm"),  cstrv("image/x-portable-bitmap"), },
+    { cstrv(".pdf"),  cstrv("application/pdf"), },
+    { cstrv(".png"),  cstrv("image/png"), },
+    { cstrv(".ppt"),  cstrv("application/vnd.ms-powerpoint"), },
+    { cstrv(".ps"),   cstrv("application/postscript"), },
+    { cstrv(".rtf"),  cstrv("text/rtf"), },
+    { cstrv(".sgml"), cstrv("text/sgml"), },
+    { cstrv(".svg"),  cstrv("image/svg+xml"), },
+    { cstrv(".tar"),  cstrv("application/x-tar"), },
+    { cstrv(".tex"),  cstrv("application/x-tex"), },
+    { cstrv(".tiff"), cstrv("image/tiff"), },
+    { cstrv(".txt"),  cstrv("text/plain"), },
+    { cstrv(".wav"),  cstrv("audio/x-wav"), },
+    { cstrv(".xls"),  cstrv("application/vnd.ms-excel"), },
+    { cstrv(".xml"),  cstrv("text/xml"), },
+    { cstrv(".zip"),  cstrv("application/zip") },
+};
+
+void mime_init(arena_t *arena, hmap_t *map) {
+    *map = hmap_init(arena, arrlen(mime__types));
+    for (int i = 0; i < arrlen(mime__types); ++i) {
+        hmap_set(map, mime__types[i].ext, &mime__types[i].val);
     }
-    return STRV_EMPTY;
+}
+
+strview_t mime(hmap_t *map, strview_t filename) {
+    strview_t ext;
+    os_file_split_path(filename, NULL, NULL, &ext);
+    hmap_entry_t *entry = hmap_get(map, ext);
+    return entry ? *(strview_t *)entry->value : STRV_EMPTY;
 }
 
 void send_file(arena_t scratch, oshandle_t fp, usize size, socket_t client) {
@@ -168,8 +173,72 @@ void send_file(arena_t scratch, oshandle_t fp, usize size, socket_t client) {
     }
 }
 
+// req is NULL if the request couldn't be parsed
+void serve_respond(arena_t scratch, serve_opt_t *opt, socket_t client, http_req_t *req, bool keep_open) {
+    int code = 200;
+    strview_t filename = STRV_EMPTY;
+
+    if (!req) {
+        if (opt->verbose) warn("400: malformed request");
+        code = 400;
+        goto close;
+    }
+
+    if (req->method != HTTP_GET) {
+        if (opt->verbose) warn("501: method %s is not supported", http_get_method_string(req->method));
+        code = 501;
+        goto close;
+    }
+
+    str_t path = os_path_join(&scratch, opt->dir, req->url);
+    if (os_file_exists(strv(path))) {
+        filename = strv(path);
+    }
+    else {
+        str_t index = os_path_join(&scratch, strv(path), strv("index.html"));
+        if (!os_file_exists(strv(index))) {
+            if (opt->verbose) warn("404: file %v not found", path);
+            code = 404;
+            goto close;
+        }
+        filename = strv(index);
+    }
+
+close:
+    http_res_t res = {
+        .version = { 1, 1 },
+        .status_code = code,
+        .headers = NULL,
+    };
+    res.headers = http_add_header(&scratch, res.headers, strv("Connection"), keep_open ? strv("keep-alive") : strv("close"));
+    if (filename.len > 0) {
+        oshandle_t fp = os_file_open(filename, OS_FILE_READ);
+        usize file_size = os_file_size(fp);
+        str_t content_length = str_fmt(&scratch, "%zu", file_size);
+        res.headers = http_add_header(&scratch, res.headers, strv("Content-Length"), strv(content_length));
+        strview_t mime_type = mime(&opt->mime_types, filename);
+        if (mime_type.len > 0) {
+            res.headers = http_add_header(&scratch, res.headers, strv("Content-Type"), mime_type);
+        }
+        str_t response = http_res_to_str(&scratch, &res);
+        sk_send(client, response.buf, (int)response.len);
+
+        if (opt->verbose) info("200: requesting %v", filename);
+        send_file(scratch, fp, file_size, client);
+        os_file_close(fp);
+    }
+    else {
+        // the client can only tell where the response ends if there's a length
+        res.headers = http_add_header(&scratch, res.headers, strv("Content-Length"), strv("0"));
+        str_t response = http_res_to_str(&scratch, &res);
+        sk_send(client, response.buf, (int)response.len);
+    }
+}
+
 void serve_entry_point(void *udata) {
-    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    // the loop below never ends, so the scratch arena is held for the whole thread
+    arena_temp_t thread_scratch = scratch_begin();
+    arena_t *arena = thread_scratch.arena;
     serve_opt_t *opt = udata;
 
     if (os_thread_id == 0) {
@@ -199,74 +268,61 @@ void serve_entry_point(void *udata) {
             continue;
         }
 
-        arena_t scratch = arena;
-        outstream_t out = ostr_init(&scratch);
-        u8 buf[KB(5)] = {0};
+        arena_temp_t request = arena_temp_begin(arena);
+        usize cap = KB(8);
+        char *buf = alloc(arena, char, cap, ALLOC_NOZERO);
+        usize len = 0;
+        // where the request being parsed starts in buf
+        usize start = 0;
+        http_parser_t parser = http_parser_init(arena);
+
         while (true) {
-            int read = sk_recv(client, buf, sizeof(buf));
-            if (read < 0) {
+            http_parse_e result = http_parser_feed(&parser, strv(buf + start, len - start));
+
+            if (result == HTTP_PARSE_ERROR) {
+                serve_respond(*arena, opt, client, NULL, false);
                 break;
             }
-            ostr_puts(&out, strv((char*)buf, read));
-            if (read < sizeof(buf)) {
+
+            // we don't need the body of any request we support, so answer and close
+            if (result == HTTP_PARSE_HEADERS_DONE) {
+                serve_respond(*arena, opt, client, &parser.req, false);
                 break;
             }
-        }
 
-        str_t req_str = ostr_to_str(&out);
-        http_req_t req = http_parse_req(&scratch, strv(req_str));
-        int code = 200;
-        strview_t mime_type = STRV_EMPTY;
-        strview_t filename = STRV_EMPTY;
-
-        if (req.method != HTTP_GET) {
-            if (opt->verbose) warn("501: method %s is not supported", http_get_method_string(req.method));
-            code = 501;
-            goto close;
-        }
-
-        str_t path = os_path_join(&scratch, opt->dir, req.url);
-        if (os_file_exists(strv(path))) {
-            filename = strv(path);
-        }
-        else {
-            str_t index = os_path_join(&scratch, strv(path), strv("index.html"));
-            if (!os_file_exists(strv(index))) {
-                if (opt->verbose) warn("404: file %v not found", path);
-                code = 404;
-                goto close;
+            if (result == HTTP_PARSE_DONE) {
+                start += parser.end;
+                // each thread is stuck on one client, so the connection is only kept
+                // open if the client already sent the next request
+                http_parser_t next = http_parser_init(arena);
+                bool keep_open = http_parser_feed(&next, strv(buf + start, len - start)) == HTTP_PARSE_DONE;
+                serve_respond(*arena, opt, client, &parser.req, keep_open);
+                if (!keep_open) {
+                    break;
+                }
+                parser = next;
+                continue;
             }
-            filename = strv(index);
-        }
 
-close:
-        http_res_t res = {
-            .version = { 1, 1 },
-            .status_code = code,
-            .headers = NULL,
-        };
-        http_add_header(&scratch, res.headers, strv("Connection"), strv("close"));
-        if (filename.len > 0) {
-            oshandle_t fp = os_file_open(filename, OS_FILE_READ);
-            usize file_size = os_file_size(fp);
-            str_t content_length = str_fmt(&scratch, "%zu", file_size);
-            http_add_header(&scratch, res.headers, strv("Content-Length"), strv(content_length));
-            mime_type = mime(filename);
-            if (mime_type.len > 0) {
-                http_add_header(&scratch, res.headers, strv("Content-Type"), mime_type);
+            if (len == cap) {
+                char *new_buf = alloc(arena, char, cap * 2, ALLOC_NOZERO);
+                memcpy(new_buf, buf, len);
+                buf = new_buf;
+                cap *= 2;
             }
-            str_t response = http_res_to_str(&scratch, &res);
-            sk_send(client, response.buf, (int)response.len);
 
-            if (opt->verbose) info("200: requesting %v", filename);
-            send_file(scratch, fp, file_size, client);
-            os_file_close(fp);
-        }
-        else {
-            str_t response = http_res_to_str(&scratch, &res);
-            sk_send(client, response.buf, (int)response.len);
+            int read = sk_recv(client, buf + len, (int)(cap - len));
+            if (read <= 0) {
+                break;
+            }
+            len += read;
         }
+
         sk_close(client);
+
+        arena_temp_end(&request);
+        // a big response can leave a lot of memory committed, give it back
+        arena_trim(arena);
     }
 }
 
@@ -295,6 +351,8 @@ void TOY(serve)(int argc, char **argv) {
         os_log_set_options(OS_LOG_NOFILE);
     }
 
+    mime_init(&arena, &opt.mime_types);
+
     opt.thread_barrier.thread_count = opt.threads;
     oshandle_t *threads = alloc(&arena, oshandle_t, opt.threads);
 
@@ -159,35 +159,32 @@ void TOY(strings)(int argc, char **argv) {
             ss_state.digits = ss_get_digits(file_size, &opt);
         }
 
-        char buf[KB(10)] = {0};
-
-        while (true) {
-            usize read = os_file_read(fp, buf, sizeof(buf));
-            if (read == 0) {
-                break;
-            }
-
-            for (usize k = 0; k < read; ++k, ++ss_state.offset) {
-                if (buf[k] >= 32 && buf[k] <= 126) {
-                    ss_state.printbuf[ss_state.count++] = buf[k];
-                    ss_state.total_count++;
-                    if (ss_state.count >= sizeof(ss_state.printbuf)) {
-                        ss_print_buf(opt.files[k], &opt);
-                        ss_state.count = 0;
-                    }
-                }
-                else if (ss_state.total_count >= opt.min_len) {
-                    ss_print_buf(opt.files[k], &opt);
-                    println("");
-                    ss_state.total_count = ss_state.count = 0;
-                    ss_state.start_of_line = true;
-                }
-                else {
-                    ss_state.total_count = ss_state.count = 0;
-                    ss_state.start_of_line = true;
+        arena_t scratch = ss_state.arena;
+        os_file_view_t view = os_file_map(&scratch, fp);
+        strview_t buf = view.data;
+
+        for (usize k = 0; k < buf.len; ++k, ++ss_state.offset) {
+            if (buf.buf[k] >= 32 && buf.buf[k] <= 126) {
+                ss_state.printbuf[ss_state.count++] = buf.buf[k];
+                ss_state.total_count++;
+                if (ss_state.count >= sizeof(ss_state.printbuf)) {
+                    ss_print_buf(opt.files[i], &opt);
+                    ss_state.count = 0;
                 }
             }
-
+            else if (ss_state.total_count >= opt.min_len) {
+                ss_print_buf(opt.files[i], &opt);
+                println("");
+                ss_state.total_count = ss_state.count = 0;
+                ss_state.start_of_line = true;
+            }
+            else {
+                ss_state.total_count = ss_state.count = 0;
+                ss_state.start_of_line = true;
+            }
         }
+
+        os_file_unmap(&view);
+        os_file_close(fp);
     }
 }
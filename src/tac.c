@@ -17,9 +17,11 @@ void TOY(tac)(int argc, char **argv) {
         return;
     }
 
-    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
-    str_t data = common_read_buffered(&arena, os_stdin());
-    strview_t lines = strv(data);
+    // pipes are read whole into the arena, huge pages make that a lot cheaper
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1), .flags = ARENA_HUGE_PAGES);
+    // needs all of the input anyway, at least avoid the copy when it is a file
+    os_file_view_t view = os_file_map(&arena, os_stdin());
+    strview_t lines = view.data;
 
     if (strv_back(lines) == '\r') {
         lines.len--;
@@ -37,4 +39,6 @@ void TOY(tac)(int argc, char **argv) {
         }
         println("%v", line);
     }
+
+    os_file_unmap(&view);
 }
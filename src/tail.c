@@ -85,34 +85,111 @@ void tail_parse_opts(int argc, char **argv, tail_opt_t *opt) {
     }
 }
 
-str_t tail_impl(arena_t *arena, oshandle_t fp, tail_opt_t *opt) {
-    i64 lines = opt->lines;
-    i64 bytes = opt->bytes;
+typedef struct tail__line_t tail__line_t;
+struct tail__line_t {
+    char *buf;
+    usize len;
+    usize cap;
+};
 
-    // read file buffered as fp could be stdin
-    str_t file_data = common_read_buffered(arena, fp);
+// the whole file is available, walk back from the end
+void tail__print_view(strview_t data, tail_opt_t *opt) {
+    if (opt->lines > 0) {
+        strview_t body = data;
+        // a trailing delimiter doesn't start a new line
+        if (strv_ends_with(body, opt->line_delim)) {
+            body.len--;
+        }
+        usize pos = scan_rfind_nth(body, opt->line_delim, (usize)opt->lines);
+        pos = pos != STR_NONE ? pos + 1 : 0;
+        fmt_write(data.buf + pos, data.len - pos);
+    }
+    else {
+        usize bytes = MIN((usize)opt->bytes, data.len);
+        fmt_write(data.buf + data.len - bytes, bytes);
+        print("\n");
+    }
+}
 
-    if (lines > 0) {
-        strview_t data = strv(file_data);
-        i64 line_count = 1;
-        for (usize i = 0; i < data.len; ++i) {
-            if (data.buf[i] == opt->line_delim) {
-                line_count++;
-            }
-        }; 
+// only keep the last lines around, reusing their buffers
+void tail__stream_lines(arena_t *arena, chunkstream_t *cs, tail_opt_t *opt) {
+    i64 lines = opt->lines;
+    tail__line_t *ring = alloc(arena, tail__line_t, lines);
+    i64 head = 0;
+    i64 count = 0;
+
+    strview_t line = STRV_EMPTY;
+    while (chunk_get_delim(cs, opt->line_delim, &line)) {
+        tail__line_t *slot = &ring[head];
+        head = (head + 1) % lines;
+        count = MIN(count + 1, lines);
+
+        if (slot->cap < line.len) {
+            slot->cap = MAX(line.len, slot->cap * 2);
+            slot->buf = alloc(arena, char, slot->cap, ALLOC_NOZERO);
+        }
+        memcpy(slot->buf, line.buf, line.len);
+        slot->len = line.len;
+    }
 
-        for (i64 to_skip = line_count - lines; to_skip > 0; --to_skip) {
-            usize pos = strv_find(data, opt->line_delim, 0);
-            if (pos == STR_NONE) break;
-            data = strv_sub(data, pos + 1, STR_END);
+    for (i64 i = 0; i < count; ++i) {
+        tail__line_t *slot = &ring[(head - count + i + lines) % lines];
+        fmt_write(slot->buf, slot->len);
+        if ((i + 1) < count || cs->terminated) {
+            fmt_write(&opt->line_delim, 1);
         }
+    }
+}
 
-        return str(arena, data);
+// only keep the last bytes around in a ring buffer
+void tail__stream_bytes(arena_t *arena, chunkstream_t *cs, tail_opt_t *opt) {
+    usize bytes = (usize)opt->bytes;
+    char *ring = alloc(arena, char, bytes, ALLOC_NOZERO);
+    usize pos = 0;
+    usize filled = 0;
+
+    strview_t block = STRV_EMPTY;
+    while (chunk_get_fixed(cs, COLLA_CHUNK_BLOCK_SIZE, &block)) {
+        if (block.len >= bytes) {
+            memcpy(ring, block.buf + block.len - bytes, bytes);
+            pos = 0;
+            filled = bytes;
+            continue;
+        }
+
+        usize first = MIN(block.len, bytes - pos);
+        memcpy(ring + pos, block.buf, first);
+        memcpy(ring, block.buf + first, block.len - first);
+        pos = (pos + block.len) % bytes;
+        filled = MIN(filled + block.len, bytes);
+    }
+
+    if (filled < bytes) {
+        fmt_write(ring, filled);
     }
     else {
-        strview_t data = str_sub(file_data, file_data.len - bytes, STR_END);
-        return str_fmt(arena, "%v\n", data);
+        fmt_write(ring + pos, bytes - pos);
+        fmt_write(ring, pos);
+    }
+    print("\n");
+}
+
+void tail_impl(arena_t scratch, oshandle_t fp, tail_opt_t *opt) {
+    // files are mapped, anything else (e.g. stdin) is streamed
+    // so only the tail is ever kept in memory
+    chunkstream_t cs = chunk_init(&scratch, fp, 0);
+
+    if (chunk_is_mapped(&cs)) {
+        tail__print_view(strv(cs.buf, cs.end), opt);
+    }
+    else if (opt->lines > 0) {
+        tail__stream_lines(&scratch, &cs, opt);
     }
+    else if (opt->bytes > 0) {
+        tail__stream_bytes(&scratch, &cs, opt);
+    }
+
+    chunk_cleanup(&cs);
 }
 
 #define FW_MAX_FILES 1024
@@ -259,8 +336,7 @@ void tail__glob(arena_t scratch, strview_t fname, void *udata) {
         println(TERM_FG_ORANGE "==> %v <==" TERM_FG_DEFAULT, fname);
     }
 
-    str_t data = tail_impl(&scratch, fp, opt);
-    print("%v", data);
+    tail_impl(scratch, fp, opt);
     os_file_close(fp);
 }
 
@@ -272,17 +348,18 @@ void TOY(tail)(int argc, char **argv) {
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
 
     if (opt.follow) {
-        arena_t scratch = arena_make(ARENA_VIRTUAL, GB(1));
+        arena_temp_t scratch = scratch_begin(&arena);
         file_watcher_t fw = fw_init(&arena, opt.files[0], opt.poll_time);
         oshandle_t fp = os_file_open(opt.files[0], OS_FILE_READ);
         usize old_size = os_file_size(fp);
-        str_t data = tail_impl(&arena, fp, &opt);
+        tail_impl(arena, fp, &opt);
         os_file_close(fp);
-        print("%v", data);
+        fmt_flush();
 
         while (true) {
-            arena_rewind(&scratch, 0);
-            if (fw_has_changed(scratch, &fw)) {
+            arena_rewind(scratch.arena, scratch.pos);
+            arena_trim(scratch.arena);
+            if (fw_has_changed(*scratch.arena, &fw)) {
                 fp = os_handle_zero();
                 do {
                     fp = os_file_open(opt.files[0], OS_FILE_READ);
@@ -298,12 +375,17 @@ void TOY(tail)(int argc, char **argv) {
                 }
 
                 os_file_seek(fp, old_size);
-                str_t new_data = common_read_buffered(&scratch, fp);
+                chunkstream_t cs = chunk_init(scratch.arena, fp, 0);
+                strview_t block = STRV_EMPTY;
+                while (chunk_get_fixed(&cs, COLLA_CHUNK_BLOCK_SIZE, &block)) {
+                    fmt_write(block.buf, block.len);
+                }
+                chunk_cleanup(&cs);
                 os_file_close(fp);
 
                 old_size = new_size;
 
-                print("%v", new_data);
+                fmt_flush();
             }
             if (opt.poll_time) {
                 // sleep so we don't use 100% cpu, this means
@@ -333,7 +415,6 @@ void TOY(tail)(int argc, char **argv) {
         }
     }
     else {
-        str_t data = tail_impl(&arena, os_stdin(), &opt);
-        print("%v", data);
+        tail_impl(arena, os_stdin(), &opt);
     }
 }
@@ -33,20 +33,38 @@ void TOY(tee)(int argc, char **argv) {
     tee_parse_opts(argc, argv, &opt);
 
     arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
-    str_t input = common_read_buffered(&arena, os_stdin());
 
-    bool out_printed = false;
+    oshandle_t outputs[TEE_MAX_FILES] = {0};
+    i64 output_count = 0;
+
+    // stdout is always written to, "-" only makes sure of it
     for (i64 i = 0; i < opt.file_count; ++i) {
-        if (!out_printed && strv_equals(opt.files[i], strv("-"))) {
-            out_printed = true;
-            os_file_write_all_str_fp(os_stdout(), strv(input));
+        if (strv_equals(opt.files[i], strv("-"))) {
+            continue;
+        }
+
+        oshandle_t fp = os_file_open(opt.files[i], OS_FILE_WRITE);
+        if (!os_handle_valid(fp)) {
+            err("can't open %v: %v", opt.files[i], os_get_error_string(os_get_last_error()));
+            continue;
         }
-        else {
-            os_file_write_all_str(opt.files[i], strv(input));
+        outputs[output_count++] = fp;
+    }
+
+    // copy whatever each read returns instead of waiting for a full block,
+    // this way the output keeps up with an interactive or slow input
+    chunkstream_t cs = chunk_init(&arena, os_stdin(), 0);
+    strview_t block = STRV_EMPTY;
+    while (chunk_get_any(&cs, &block)) {
+        for (i64 i = 0; i < output_count; ++i) {
+            os_file_write(outputs[i], block.buf, block.len);
         }
+        fmt_write(block.buf, block.len);
+        fmt_flush();
     }
+    chunk_cleanup(&cs);
 
-    if (!out_printed) {
-        os_file_write_all_str_fp(os_stdout(), strv(input));
+    for (i64 i = 0; i < output_count; ++i) {
+        os_file_close(outputs[i]);
     }
 }
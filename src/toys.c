@@ -47,9 +47,23 @@ struct toy_t {
     void (*main_fn)(int argc, char **argv);
 };
 
+void toys__print_arena_report(void) {
+    print("\n");
+    arena_stats_print();
+}
+
 int main(int argc, char **argv) {
     colla_init(COLLA_OS);
 
+    // TOYS_ARENA_REPORT=1 prints how much every arena was used when the toy exits
+    arena_t env_arena = arena_make(ARENA_VIRTUAL, MB(1));
+    str_t arena_report = os_get_env_var(&env_arena, strv("TOYS_ARENA_REPORT"));
+    if (strv_equals(strv(arena_report), strv("1"))) {
+        arena_stats_enable(true);
+        atexit(toys__print_arena_report);
+    }
+    arena_cleanup(&env_arena);
+
     toy_t toys[] = {
         TOY_DEFINE(acpi),
         TOY_DEFINE(base64),
@@ -373,6 +373,8 @@ void tui__end_frame(void) {
     tui__render_elem(&out, tui.root, 1, 1, tui_width(), tui_height());
     str_t screen = ostr_to_str(&out);
     pretty_print(tui.frame_arena, "%v", screen);
+    // the frame doesn't end with a newline, make sure it gets on screen
+    fmt_flush();
 }
 
 bool tui__has_input(void) {
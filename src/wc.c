@@ -106,26 +106,57 @@ i64 wc_words(strview_t line) {
     return count;
 }
 
+// when only lines and bytes are needed there is no reason to look at each line
+void wc_count_lines(arena_t scratch, oshandle_t fp, wc_info_t *out) {
+    chunkstream_t cs = chunk_init(&scratch, fp, 0);
+
+    i64 line_count = 0;
+    strview_t block = STRV_EMPTY;
+    while (chunk_get_fixed(&cs, COLLA_CHUNK_BLOCK_SIZE, &block)) {
+        line_count += scan_count(block, '\n');
+    }
+
+    // same as counting lines one by one, the last one doesn't need a newline
+    if (cs.offset > 0 && !strv_ends_with(block, '\n')) {
+        line_count++;
+    }
+
+    out->bytes = cs.offset;
+    out->lines = line_count;
+
+    chunk_cleanup(&cs);
+}
+
 void wc_count(arena_t scratch, oshandle_t fp, wc_info_t *out, wc_opt_t *opt) {
-    str_t data = common_read_buffered(&scratch, fp);
-    out->bytes = data.len;
+    if (!(opt->print_words || opt->print_chars || opt->print_max_len)) {
+        wc_count_lines(scratch, fp, out);
+        return;
+    }
+
+    chunkstream_t cs = chunk_init(&scratch, fp, 0);
 
     i64 max_len = 0;
     i64 word_count = 0;
     i64 line_count = 0;
     i64 chars_count = 0;
 
-    instream_t in = istr_init(strv(data));
-    while (!istr_is_finished(&in)) {
-        strview_t line = istr_get_line(&in);
+    strview_t line = STRV_EMPTY;
+    usize line_start = cs.offset;
+    while (chunk_get_line(&cs, &line)) {
         line_count++;
         word_count += wc_words(line);
         max_len = MAX(max_len, (i64)line.len);
+        if (opt->print_chars) {
+            // the line ending is not part of the line but still counts
+            usize line_ending = cs.offset - line_start - line.len;
+            chars_count += strv_get_utf8_len(line) + line_ending;
+        }
+        line_start = cs.offset;
     }
 
-    if (opt->print_chars) {
-        out->chars = strv_get_utf8_len(strv(data));
-    }
+    out->bytes = cs.offset;
+
+    chunk_cleanup(&cs);
 
     out->chars = chars_count;
     out->words = word_count;
@@ -12,6 +12,7 @@ typedef struct {
     char delimiter;
     bool use_delim;
     strview_t replace;
+    searcher_t replace_searcher;
     i64 thread_count;
     i64 max_args;
     bool exit;
@@ -22,7 +23,6 @@ typedef struct {
     strview_t initial_args[XARGS_MAX_INITIAL_ARGS];
     i64 initial_args_count;
 
-    oshandle_t print_mtx;
     strv_list_t *args;
     strview_t *args_shared;
     i64 total_args_shared;
@@ -123,6 +123,10 @@ void xargs_parse_opts(int argc, char **argv, xargs_opt_t *opt) {
 
     opt->command = opt->initial_args[0];
 
+    if (opt->replace.len) {
+        opt->replace_searcher = searcher_init(opt->replace);
+    }
+
     if (opt->thread_count && opt->interactive) {
         fatal("option -j and -p are mutually exculsive");
     }
@@ -227,7 +231,7 @@ void xargs_run(arena_t scratch, strv_list_t *args, xargs_opt_t *opt) {
             outstream_t ostr = ostr_init(&scratch);
             usize from = 0;
             while (from < arg.len) {
-                usize pos = strv_find_view(arg, opt->replace, from);
+                usize pos = searcher_find(&opt->replace_searcher, arg, from);
                 ostr_puts(&ostr, strv_sub(arg, from, pos));
                 from = pos + opt->replace.len;
                 if (pos == STR_END) {
@@ -294,18 +298,17 @@ void xargs_run(arena_t scratch, strv_list_t *args, xargs_opt_t *opt) {
 
     str_t out = common_read_buffered(&scratch, hout);
 
-    os_mutex_lock(opt->print_mtx);
-        if (opt->verbose) {
-            print("running \"%v\"\n", command);
-        }
-        if (out.len) {
-            print("%v", out);
-        }
-    os_mutex_unlock(opt->print_mtx);
+    if (opt->verbose) {
+        fmt_record("running \"%v\"\n%v", command, out);
+    }
+    else if (out.len) {
+        fmt_record("%v", out);
+    }
 }
 
 void xargs_entry_point(void *udata) {
-    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    arena_temp_t thread_scratch = scratch_begin();
+    arena_t *arena = thread_scratch.arena;
     xargs_opt_t *opt = udata;
 
     strview_t *args = NULL;
@@ -324,7 +327,7 @@ void xargs_entry_point(void *udata) {
             );
         }
 
-        args = alloc(&arena, strview_t, args_count);
+        args = alloc(arena, strview_t, args_count);
 
         i64 cur = 0;
         for_each (a, opt->args) {
@@ -361,13 +364,19 @@ void xargs_entry_point(void *udata) {
         }
         i64 end = base + count;
 
-        arena_t scratch = arena;
+        arena_temp_t job = arena_temp_begin(arena);
         strv_list_t *cur_args = NULL;
         for (i64 i = base; i < end; ++i) {
-            darr_push(&scratch, cur_args, args[i]);
+            darr_push(arena, cur_args, args[i]);
         }
-        xargs_run(scratch, cur_args, opt);
+        xargs_run(*arena, cur_args, opt);
+        arena_temp_end(&job);
     }
+
+    // the shared arguments live in the scratch arena of thread 0,
+    // which is released as soon as the thread returns
+    os_barrier_sync(&opt->thread_barrier);
+    scratch_end(&thread_scratch);
 }
 
 int xargs_thread_entry_point(u64 id, void *udata) {
@@ -392,7 +401,6 @@ void TOY(xargs)(int argc, char **argv) {
     }
 
     opt.thread_barrier.thread_count = opt.thread_count;
-    opt.print_mtx = os_mutex_create();
     oshandle_t *threads = alloc(&arena, oshandle_t, opt.thread_count);
 
     for (int i = 0; i < opt.thread_count; ++i) {
@@ -54,6 +54,8 @@ struct {
 
     char search_buf[64];
     usize search_buf_pos;
+    // rebuilt every time a new search is started
+    searcher_t searcher;
     i64 search_cursor;
     bool is_last_search;
     bool is_first_search;
@@ -133,8 +135,7 @@ void xxd_parse_opts(int argc, char **argv, xxd_opt_t *opt) {
 void xxd_search_next(void) {
     strview_t haystack = strv((char*)xxd_state.data.data, xxd_state.data.len);
     usize from = xxd_state.search_cursor > 0 ? xxd_state.search_cursor + 1 : 0;
-    strview_t needle = strv(xxd_state.search_buf, xxd_state.search_buf_pos);
-    usize new_cursor = strv_find_view(haystack, needle, from);
+    usize new_cursor = searcher_find(&xxd_state.searcher, haystack, from);
     if (new_cursor != STR_NONE) {
         xxd_state.search_cursor = new_cursor;
         xxd_state.cursor = xxd_state.search_cursor;
@@ -154,8 +155,7 @@ void xxd_search_prev(void) {
     }
 
     haystack = strv_sub(haystack, 0, xxd_state.search_cursor);
-    strview_t needle = strv(xxd_state.search_buf, xxd_state.search_buf_pos);
-    usize new_cursor = strv_rfind_view(haystack, needle, 0);
+    usize new_cursor = searcher_rfind(&xxd_state.searcher, haystack, 0);
     if (new_cursor != STR_NONE) {
         xxd_state.search_cursor = new_cursor;
         xxd_state.cursor = xxd_state.search_cursor;
@@ -510,6 +510,7 @@ bool xxd_search_event(strview_t key) {
     }
     else if (IS("enter")) {
         xxd_state.mode = XXD_MODE_HEX;
+        xxd_state.searcher = searcher_init(strv(xxd_state.search_buf, xxd_state.search_buf_pos));
         xxd_search_next();
     }
 
@@ -640,13 +641,20 @@ void TOY(xxd)(int argc, char **argv) {
         fatal("file %v does not exist", xxd_state.filename);
     }
 
-    xxd_state.data = os_file_read_all(&arena, xxd_state.filename);
-
     if (opt.dump || opt.nocolors) {
+        // we only read the data when dumping, no need to copy it
+        oshandle_t fp = os_file_open(xxd_state.filename, OS_FILE_READ);
+        os_file_view_t view = os_file_map(&arena, fp);
+        xxd_state.data = (buffer_t){ (u8 *)view.data.buf, view.data.len };
         xxd_dump(&opt);
+        os_file_unmap(&view);
+        os_file_close(fp);
         return;
     }
 
+    // the editor writes to the buffer, so this needs its own copy
+    xxd_state.data = os_file_read_all(&arena, xxd_state.filename);
+
     tui_init(&(tui_desc_t){
         .update = xxd_update,
         .event = xxd_event,
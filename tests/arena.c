@@ -0,0 +1,153 @@
+#include "tests.h"
+
+#if COLLA_LIN
+#include <sys/resource.h>
+#endif
+
+// checks that virtual arenas keep their data with every commit option and that
+// trimming gives memory back, then times filling them
+
+static usize page_faults(void) {
+#if COLLA_LIN
+    struct rusage usage = {0};
+    getrusage(RUSAGE_SELF, &usage);
+    return (usize)usage.ru_minflt + (usize)usage.ru_majflt;
+#else
+    return 0;
+#endif
+}
+
+// the free pages in the preallocated huge pages pool, without them
+// ARENA_HUGETLB is the same as ARENA_HUGE_PAGES
+static usize hugetlb_free_pages(void) {
+    usize pages = 0;
+#if COLLA_LIN
+    FILE *fp = fopen("/proc/meminfo", "r");
+    if (!fp) return 0;
+    char line[128];
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "HugePages_Free: %zu", &pages) == 1) break;
+    }
+    fclose(fp);
+#endif
+    return pages;
+}
+
+static bool config_available(arena_flags_e flags) {
+    return !(flags & ARENA_HUGETLB) || hugetlb_free_pages() > 0;
+}
+
+typedef struct arena_config_t arena_config_t;
+struct arena_config_t {
+    const char *name;
+    arena_flags_e flags;
+    usize commit_size;
+};
+
+static arena_config_t arena_configs[] = {
+    { "default",       ARENA_FLAGS_NONE,                  0 },
+    { "commit 1MB",    ARENA_FLAGS_NONE,                  MB(1) },
+    { "huge pages",    ARENA_HUGE_PAGES,                  0 },
+    { "huge+prefault", ARENA_HUGE_PAGES | ARENA_PREFAULT, 0 },
+    { "hugetlb",       ARENA_HUGETLB,                     0 },
+    { "lazy decommit", ARENA_LAZY_DECOMMIT,               0 },
+};
+
+// allocates in 1MB blocks, fills them and reads them back
+static bool fill_arena(arena_t *arena, usize total) {
+    usize block = MB(1);
+    u8 **blocks = alloc(arena, u8 *, total / block);
+    for (usize b = 0; b < total / block; ++b) {
+        blocks[b] = alloc(arena, u8, block, ALLOC_NOZERO);
+        memset(blocks[b], (int)b, block);
+    }
+    for (usize b = 0; b < total / block; ++b) {
+        if (blocks[b][0] != (u8)b || blocks[b][block - 1] != (u8)b) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_arenas(void) {
+    usize total = test_quick() ? MB(32) : MB(256);
+
+    for (usize c = 0; c < arrlen(arena_configs); ++c) {
+        arena_config_t *config = &arena_configs[c];
+        if (!config_available(config->flags)) {
+            print("%s: no free pages in the huge pages pool, skipped\n", config->name);
+            continue;
+        }
+        arena_t arena = arena_make(
+            ARENA_VIRTUAL, GB(1),
+            .flags = config->flags,
+            .commit_size = config->commit_size,
+            .decommit_threshold = MB(8)
+        );
+        check(arena.beg != NULL, "%s: could not make the arena", config->name);
+        if (!arena.beg) continue;
+
+        // alignment and zeroing across commit blocks
+        u64 *first = alloc(&arena, u64, 3);
+        u8 *odd = alloc(&arena, u8, 7);
+        void *aligned = alloc(&arena, u8, 100, .align = 256);
+        check(first[0] == 0 && first[2] == 0 && odd[6] == 0, "%s: memory was not zeroed", config->name);
+        check(((uptr)aligned & 255) == 0, "%s: alignment of 256 not respected", config->name);
+
+        usize start = arena_tell(&arena);
+        check(fill_arena(&arena, total), "%s: blocks were overwritten", config->name);
+
+        // a copy keeps using the memory after a rewind, until the trim
+        arena_t copy = arena;
+        arena_rewind(&arena, start);
+        u8 *kept = alloc(&copy, u8, MB(1), ALLOC_NOZERO);
+        memset(kept, 0xAB, MB(1));
+        check(kept[MB(1) - 1] == 0xAB, "%s: the copy lost its memory", config->name);
+
+        usize before = arena_decommitted_bytes(&arena);
+        arena_trim(&arena);
+        check(arena_decommitted_bytes(&arena) > before, "%s: trim gave nothing back", config->name);
+
+        // memory that was given back comes back zeroed
+        u8 *again = alloc(&arena, u8, MB(16));
+        check(again[0] == 0 && again[MB(16) - 1] == 0, "%s: memory was not zeroed after a trim", config->name);
+
+        arena_cleanup(&arena);
+    }
+}
+
+static void bench_arenas(void) {
+    usize total = GB(1);
+    print("allocating and filling 1GB in 1MB blocks\n");
+    for (usize c = 0; c < arrlen(arena_configs); ++c) {
+        arena_config_t *config = &arena_configs[c];
+        if (!config_available(config->flags)) {
+            print("    %-32s skipped, no free pages in the huge pages pool\n", config->name);
+            continue;
+        }
+        usize faults = 0;
+        u64 start = os_time_ms();
+        {
+            usize faults_before = page_faults();
+            arena_t arena = arena_make(ARENA_VIRTUAL, GB(2), .flags = config->flags, .commit_size = config->commit_size);
+            fill_arena(&arena, total);
+            faults = page_faults() - faults_before;
+            arena_cleanup(&arena);
+        }
+        u64 ms = os_time_ms() - start;
+        double mb_per_sec = ms ? (double)(total / MB(1)) * 1000.0 / (double)ms : 0.0;
+        print("    %-32s %6llu ms %8.0f MB/s %8zu faults\n", config->name, ms, mb_per_sec, faults);
+    }
+}
+
+int main(void) {
+    test_init();
+
+    test_arenas();
+
+    if (!test_quick()) {
+        bench_arenas();
+    }
+
+    return test_end();
+}
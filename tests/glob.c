@@ -0,0 +1,448 @@
+#include "tests.h"
+
+#if COLLA_WIN
+#include "../src/common.h"
+#endif
+
+// checks glob_match against a plain recursive matcher on random patterns and texts,
+// short ones and ones long enough to need scratch, with and without ignore case.
+// then on windows walks a random tree with common_glob and checks the paths it
+// finds against the same matcher applied to every path in the tree
+
+// one element of a pattern for the reference matcher
+typedef struct ref_elem_t ref_elem_t;
+struct ref_elem_t {
+    char c;        // 0 for *, ? and classes
+    bool star;
+    bool any;
+    bool multi;    // [..]+
+    bool set[256]; // the class
+};
+
+typedef struct ref_glob_t ref_glob_t;
+struct ref_glob_t {
+    ref_elem_t *elems;
+    usize count;
+};
+
+static ref_glob_t ref_compile(arena_t *arena, strview_t glob, bool ignore_case) {
+    ref_glob_t out = { .elems = alloc(arena, ref_elem_t, glob.len + 1) };
+    for (usize i = 0; i < glob.len; ++i) {
+        ref_elem_t *e = &out.elems[out.count++];
+        char c = glob.buf[i];
+        if (c == '*') {
+            e->star = true;
+            continue;
+        }
+        if (c == '?') {
+            e->any = true;
+            continue;
+        }
+        if (c == '[') {
+            // a ] right after [ or [! is part of the class, no closing ] means [ is a character
+            usize k = i + 1;
+            bool negate = k < glob.len && glob.buf[k] == '!';
+            k += negate;
+            usize first = k;
+            while (k < glob.len && (glob.buf[k] != ']' || k == first)) {
+                k++;
+            }
+            if (k < glob.len) {
+                for (usize j = first; j < k; ++j) {
+                    u8 from = (u8)glob.buf[j], to = from;
+                    if (j + 2 < k && glob.buf[j + 1] == '-') {
+                        to = (u8)glob.buf[j + 2];
+                        j += 2;
+                    }
+                    for (u32 x = from; x <= to; ++x) {
+                        e->set[x] = true;
+                        if (ignore_case) {
+                            e->set[(u8)char_lower((char)x)] = true;
+                            e->set[(u8)char_upper((char)x)] = true;
+                        }
+                    }
+                }
+                if (negate) {
+                    for (int x = 0; x < 256; ++x) e->set[x] = !e->set[x];
+                }
+                i = k;
+                if (i + 1 < glob.len && glob.buf[i + 1] == '+') {
+                    e->multi = true;
+                    i++;
+                }
+                continue;
+            }
+        }
+        e->c = ignore_case ? char_lower(c) : c;
+    }
+    return out;
+}
+
+// memo has (count + 1) * (text.len + 1) entries: 0 not known yet, 1 no, 2 yes
+static bool ref_match_at(ref_glob_t *g, strview_t text, bool ignore_case, usize e, usize t, u8 *memo) {
+    u8 *known = &memo[e * (text.len + 1) + t];
+    if (*known) {
+        return *known == 2;
+    }
+
+    bool result = false;
+    if (e == g->count) {
+        result = t == text.len;
+    }
+    else {
+        ref_elem_t *elem = &g->elems[e];
+        if (elem->star) {
+            for (usize k = t; k <= text.len && !result; ++k) {
+                result = ref_match_at(g, text, ignore_case, e + 1, k, memo);
+            }
+        }
+        else if (t < text.len) {
+            u8 c = (u8)text.buf[t];
+            bool ok = elem->any ? true :
+                      elem->c   ? (ignore_case ? char_lower((char)c) : (char)c) == elem->c :
+                                  elem->set[c];
+            if (ok) {
+                result = ref_match_at(g, text, ignore_case, e + 1, t + 1, memo);
+                // a run goes on with the same element
+                if (!result && elem->multi) {
+                    result = ref_match_at(g, text, ignore_case, e, t + 1, memo);
+                }
+            }
+        }
+    }
+
+    *known = result ? 2 : 1;
+    return result;
+}
+
+static bool ref_match(arena_t scratch, strview_t glob, strview_t text, bool ignore_case) {
+    ref_glob_t g = ref_compile(&scratch, glob, ignore_case);
+    u8 *memo = alloc(&scratch, u8, (g.count + 1) * (text.len + 1));
+    return ref_match_at(&g, text, ignore_case, 0, 0, memo);
+}
+
+static const char *glob_pieces[] = {
+    "a", "b", "ab", "ba", "A", "*", "*", "?", "[ab]", "[!a]", "[a-c]", "[ab]+", "[b]+", "[!b]+",
+    "[]a]", "[!]]", "[", "]", "-", "[a-]", "x",
+};
+
+static str_t random_glob(arena_t *arena) {
+    outstream_t out = ostr_init(arena);
+    usize pieces = test_rand_range(0, 7);
+    for (usize i = 0; i < pieces; ++i) {
+        ostr_puts(&out, strv(glob_pieces[test_rand_range(0, arrlen(glob_pieces))]));
+    }
+    return ostr_to_str(&out);
+}
+
+// few different characters, so the patterns match often
+static strview_t random_text(arena_t *arena, usize len) {
+    static const char alphabet[] = "aabbbcAB]-x";
+    char *buf = alloc(arena, char, len + 1);
+    for (usize i = 0; i < len; ++i) {
+        buf[i] = alphabet[test_rand_range(0, sizeof(alphabet) - 1)];
+    }
+    return strv(buf, len);
+}
+
+static void test_random_globs(arena_t *arena) {
+    int count = test_quick() ? 20000 : 300000;
+    int matched = 0;
+    for (int i = 0; i < count; ++i) {
+        arena_t scratch = *arena;
+        str_t glob = random_glob(&scratch);
+        bool ignore_case = test_chance(4);
+        glob_prog_t *prog = glob_compile(&scratch, strv(glob), ignore_case ? GLOB_IGNORE_CASE : GLOB_DEFAULT);
+
+        for (int t = 0; t < 8; ++t) {
+            // some past the 256 bytes that fit on the stack of glob_match
+            usize len = test_chance(16) ? test_rand_range(250, 700) : test_rand_range(0, 12);
+            strview_t text = random_text(&scratch, len);
+            // sometimes the glob itself, so literals with [ and ] match
+            if (t == 0) text = strv(glob);
+
+            bool expected = ref_match(scratch, strv(glob), text, ignore_case);
+            bool got = glob_match(scratch, prog, text);
+            check(got == expected, "%v%s on %v: got %d", glob, ignore_case ? " (ignore case)" : "", text, got);
+            if (!ignore_case) {
+                check(glob_matches(strv(glob), text) == expected, "glob_matches %v on %v", glob, text);
+            }
+            matched += expected;
+        }
+        if (test__state.failed) break;
+    }
+    print("%d random globs on %d texts, %d matched\n", count, count * 8, matched);
+}
+
+static void test_samples(arena_t *arena) {
+    struct {
+        const char *glob;
+        const char *text;
+        bool expected;
+    } samples[] = {
+        { "*.c", "colla.c", true },
+        { "*.c", "colla.h", false },
+        { "*", "", true },
+        { "?", "", false },
+        { "a*b*c", "aXbYc", true },
+        { "a*b*c", "aXbYcZ", false },
+        { "[a-z]+.txt", "notes.txt", true },
+        { "[a-z]+.txt", "Notes.txt", false },
+        { "[!0-9]*", "9lives", false },
+        { "file[0-9]+[a-z]+.log", "file123abc.log", true },
+        { "file[0-9]+[a-z]+.log", "file123.log", false },
+        { "*[ab]+c", "xxababbc", true },
+        { "[]]", "]", true },
+        { "[abc", "[abc", true },
+        { "a[", "a[", true },
+    };
+    for (usize i = 0; i < arrlen(samples); ++i) {
+        strview_t glob = strv(samples[i].glob), text = strv(samples[i].text);
+        check(glob_matches(glob, text) == samples[i].expected, "%v on %v", glob, text);
+        check(ref_match(*arena, glob, text, false) == samples[i].expected, "the reference matcher: %v on %v", glob, text);
+    }
+
+    // a long text that goes through the runs, with a small arena that has to be enough every time
+    u8 buffer[KB(4)];
+    arena_t small = arena_make(ARENA_STATIC, sizeof(buffer), buffer);
+    glob_prog_t *prog = glob_compile(&small, strv("*[ab]+c*"), GLOB_DEFAULT);
+    char *text = alloc(arena, char, 1000);
+    for (usize i = 0; i < 1000; ++i) text[i] = i == 900 ? 'c' : 'a';
+    usize matches = 0;
+    for (int i = 0; i < 1000; ++i) {
+        matches += glob_match(small, prog, strv(text, 1000));
+    }
+    check(matches == 1000, "matched %zu of 1000 times with the same scratch", matches);
+    arena_cleanup(&small);
+}
+
+#if COLLA_WIN
+
+// a random tree of directories and files, the paths are kept to check the walk
+typedef struct tree_t tree_t;
+struct tree_t {
+    strview_t root;
+    str_t *paths; // relative to root, with /
+    bool *is_dir;
+    usize count;
+    usize cap;
+};
+
+static const char *tree_names[] = { "a", "b", "ab", "ba", "abc", "x.c", "y.c", "ab.c", "bb.txt", "a1", "c" };
+
+static void tree_fill(arena_t *arena, tree_t *tree, strview_t dir, int depth) {
+    usize children = test_rand_range(0, 6);
+    for (usize i = 0; i < children && tree->count < tree->cap; ++i) {
+        strview_t name = strv(tree_names[test_rand_range(0, arrlen(tree_names))]);
+        str_t rel = dir.len ? str_fmt(arena, "%v/%v", dir, name) : str(arena, name);
+        str_t full = str_fmt(arena, "%v/%v", tree->root, rel);
+        if (os_file_or_dir_exists(strv(full))) {
+            continue;
+        }
+        bool is_dir = depth < 3 && test_chance(2);
+        if (is_dir) {
+            os_dir_create(strv(full));
+        }
+        else {
+            oshandle_t fp = os_file_open(strv(full), OS_FILE_WRITE);
+            os_file_close(fp);
+        }
+        tree->paths[tree->count] = rel;
+        tree->is_dir[tree->count] = is_dir;
+        tree->count++;
+        if (is_dir) {
+            tree_fill(arena, tree, strv(rel), depth + 1);
+        }
+    }
+}
+
+// ** matches any number of directories, the last one at least one
+static bool ref_path_match(arena_t scratch, strview_t *segs, usize seg_count, strview_t *names, usize name_count) {
+    if (seg_count == 0) {
+        return name_count == 0;
+    }
+    if (strv_equals(segs[0], strv("**"))) {
+        usize min = seg_count == 1 ? 1 : 0;
+        for (usize skip = min; skip <= name_count; ++skip) {
+            if (ref_path_match(scratch, segs + 1, seg_count - 1, names + skip, name_count - skip)) {
+                return true;
+            }
+        }
+        return false;
+    }
+    return name_count > 0 &&
+        ref_match(scratch, segs[0], names[0], false) &&
+        ref_path_match(scratch, segs + 1, seg_count - 1, names + 1, name_count - 1);
+}
+
+static usize split_path(arena_t *arena, strview_t path, strview_t **out) {
+    usize count = 1;
+    for (usize i = 0; i < path.len; ++i) count += path.buf[i] == '/';
+    *out = alloc(arena, strview_t, count);
+    usize n = 0, beg = 0;
+    for (usize i = 0; i <= path.len; ++i) {
+        if (i == path.len || path.buf[i] == '/') {
+            (*out)[n++] = strv_sub(path, beg, i);
+            beg = i + 1;
+        }
+    }
+    return n;
+}
+
+typedef struct found_t found_t;
+struct found_t {
+    arena_t *arena;
+    strview_t root;
+    hmap_t paths;
+};
+
+static void found_path(arena_t scratch, strview_t path, void *udata) {
+    COLLA_UNUSED(scratch);
+    found_t *found = udata;
+    str_t copy = str(found->arena, path);
+    for (usize i = 0; i < copy.len; ++i) {
+        if (copy.buf[i] == '\\') copy.buf[i] = '/';
+    }
+    // relative to the root, the walk can find the same path more than once through **
+    strview_t rel = strv_remove_prefix(strv(copy), found->root.len + 1);
+    hmap_set(&found->paths, rel, NULL);
+}
+
+static const char *walk_pieces[] = { "*", "a", "ab", "?", "a*", "*.c", "[ab]*", "[ab]+", "[!a]*", "**", "?.c", "[a-b]+.c", "ab.c", "b" };
+
+static void test_common_glob(arena_t *arena) {
+    arena_t scratch = *arena;
+    tree_t tree = { .root = strv("glob_test_tree"), .cap = 400 };
+    tree.paths = alloc(&scratch, str_t, tree.cap);
+    tree.is_dir = alloc(&scratch, bool, tree.cap);
+    if (os_dir_exists(tree.root)) {
+        print("%v is already there, skipping the walks\n", tree.root);
+        return;
+    }
+    os_dir_create(tree.root);
+    // names repeat, so it takes a few goes to get a tree that's big enough
+    for (int i = 0; i < 100 && tree.count < 80; ++i) {
+        tree_fill(&scratch, &tree, STRV_EMPTY, 0);
+    }
+
+    // the paths that were found go in an arena of their own, common_glob
+    // is still using the memory after the scratch it was given
+    arena_t results = arena_make(ARENA_VIRTUAL, GB(1));
+
+    int count = test_quick() ? 300 : 3000;
+    for (int i = 0; i < count; ++i) {
+        arena_t temp = scratch;
+        outstream_t out = ostr_init(&temp);
+        usize seg_count = test_rand_range(1, 4);
+        for (usize s = 0; s < seg_count; ++s) {
+            ostr_print(&out, s ? "/%s" : "%s", walk_pieces[test_rand_range(0, arrlen(walk_pieces))]);
+        }
+        str_t pattern = ostr_to_str(&out);
+        bool recursive = test_chance(4);
+
+        arena_t found_arena = results;
+        found_t found = { .arena = &found_arena, .root = tree.root, .paths = hmap_init(&found_arena, 0) };
+        common_glob(temp, &(glob_t){
+            .exp = strv(str_fmt(&temp, "%v/%v", tree.root, pattern)),
+            .recursive = recursive,
+            .cb = found_path,
+            .udata = &found,
+        });
+
+        // what the walk does with recursive: an implicit ** before the last segment
+        strview_t *segs = NULL;
+        usize segs_len = split_path(&temp, strv(pattern), &segs);
+        bool has_deep = false;
+        for (usize s = 0; s < segs_len; ++s) has_deep |= strv_equals(segs[s], strv("**"));
+        if (recursive && !has_deep) {
+            strview_t *more = alloc(&temp, strview_t, segs_len + 1);
+            memcpy(more, segs, sizeof(strview_t) * (segs_len - 1));
+            more[segs_len - 1] = strv("**");
+            more[segs_len] = segs[segs_len - 1];
+            segs = more;
+            segs_len++;
+        }
+
+        usize expected = 0;
+        for (usize p = 0; p < tree.count; ++p) {
+            strview_t *names = NULL;
+            usize names_len = split_path(&temp, strv(tree.paths[p]), &names);
+            bool should_match = ref_path_match(temp, segs, segs_len, names, names_len);
+            bool matched = hmap_get(&found.paths, strv(tree.paths[p])) != NULL;
+            check(matched == should_match, "%v%s on %v: got %d", pattern, recursive ? " (recursive)" : "", tree.paths[p], matched);
+            expected += should_match;
+        }
+        check(found.paths.count == expected, "%v found %zu paths, expected %zu", pattern, found.paths.count, expected);
+        if (test__state.failed) break;
+    }
+    print("%d globs on a tree of %zu paths\n", count, tree.count);
+
+    for (usize p = tree.count; p > 0; --p) {
+        str_t full = str_fmt(&scratch, "%v/%v", tree.root, tree.paths[p - 1]);
+        if (tree.is_dir[p - 1]) os_dir_delete(strv(full));
+        else                    os_file_delete(strv(full));
+    }
+    os_dir_delete(tree.root);
+    arena_cleanup(&results);
+}
+
+#endif
+
+static void bench_globs(arena_t *arena) {
+    usize count = 2000000;
+    strview_t names[] = {
+        strv("colla.c"), strv("colla_win32.c"), strv("README.md"), strv("build.bat"),
+        strv("file123abc.log"), strv("notes.txt"), strv("a_much_longer_file_name_with_numbers_2024.tar.gz"),
+    };
+    const char *globs[] = { "*.c", "*_win32*", "file[0-9]+[a-z]+.log", "[a-z]+_*[0-9]+.tar.gz" };
+
+    for (usize g = 0; g < arrlen(globs); ++g) {
+        glob_prog_t *prog = glob_compile(arena, strv(globs[g]), GLOB_DEFAULT);
+        usize matched = 0;
+        char name[64];
+        fmt_buffer(name, sizeof(name), "%s", globs[g]);
+        bench(name, 0, {
+            matched = 0;
+            for (usize i = 0; i < count; ++i) {
+                matched += glob_match(*arena, prog, names[i % arrlen(names)]);
+            }
+        });
+        check(matched > 0, "%s matched nothing", globs[g]);
+    }
+
+    // long enough that the runs don't fit on the stack and go in scratch
+    usize long_count = 100000;
+    char *text = alloc(arena, char, KB(1));
+    for (usize i = 0; i < KB(1); ++i) text[i] = "ab"[i % 2];
+    glob_prog_t *prog = glob_compile(arena, strv("*[ab]+[cd]*"), GLOB_DEFAULT);
+    usize matched = 0;
+    print("%zu texts of 1KB\n", long_count);
+    bench("*[ab]+[cd]*", KB(1) * long_count, {
+        matched = 0;
+        for (usize i = 0; i < long_count; ++i) {
+            matched += glob_match(*arena, prog, strv(text, KB(1)));
+        }
+    });
+    check(matched == 0, "*[ab]+[cd]* matched a text without c or d");
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_samples(&arena);
+    test_random_globs(&arena);
+#if COLLA_WIN
+    test_common_glob(&arena);
+#else
+    print("common_glob is only built on windows, the walks are skipped\n");
+#endif
+
+    if (!test_quick()) {
+        print("2000000 names\n");
+        bench_globs(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,183 @@
+#include "tests.h"
+
+// runs random sets, removes and gets on a map and on a plain array that knows
+// the right answer, then times lookups against a linear scan and bulk inserts
+
+static void test_u64_keys(arena_t *arena) {
+    usize key_count = 5000;
+    int ops = test_quick() ? 200000 : 4000000;
+
+    // values[key] is what the map should have, 0 when the key is not there
+    usize *values = alloc(arena, usize, key_count);
+    usize expected_count = 0;
+    hmap_t map = hmap_init(arena, 0);
+
+    for (int i = 0; i < ops; ++i) {
+        // the keys are spread out so they don't hash next to each other
+        u64 index = test_rand_range(0, key_count);
+        u64 key = index * 0x9E3779B97F4A7C15ull;
+        switch (test_rand_range(0, 3)) {
+            case 0:
+            {
+                usize value = (usize)i + 1;
+                hmap_entry_t *e = hmap_set_u64(&map, key, (void *)value);
+                expected_count += values[index] == 0;
+                values[index] = value;
+                check(e && e->value == (void *)value, "set %llu", key);
+                break;
+            }
+            case 1:
+            {
+                bool removed = hmap_remove_u64(&map, key);
+                check(removed == (values[index] != 0), "remove %llu returned %d", key, removed);
+                expected_count -= values[index] != 0;
+                values[index] = 0;
+                break;
+            }
+            default:
+            {
+                hmap_entry_t *e = hmap_get_u64(&map, key);
+                usize got = e ? (usize)e->value : 0;
+                check(got == values[index], "get %llu: %zu, expected %zu", key, got, values[index]);
+                break;
+            }
+        }
+        if (test__state.failed) {
+            break;
+        }
+    }
+
+    check(map.count == expected_count, "count %zu, expected %zu", map.count, expected_count);
+
+    usize seen = 0;
+    hmap_for_each(e, &map) {
+        u64 index = e->key.len * 0xF1DE83E19937733Dull; // inverse of the multiplier
+        check(index < key_count && values[index] == (usize)e->value, "iterated over %llu", (u64)e->key.len);
+        seen++;
+    }
+    check(seen == expected_count, "iterated over %zu entries, expected %zu", seen, expected_count);
+    print("%d operations on u64 keys, %zu entries at the end\n", ops, expected_count);
+}
+
+static void test_string_keys(arena_t *arena) {
+    usize count = test_quick() ? 10000 : 100000;
+    strview_t *keys = alloc(arena, strview_t, count);
+    hmap_t map = hmap_init(arena, 16);
+
+    for (usize i = 0; i < count; ++i) {
+        keys[i] = strv(str_fmt(arena, "key %zu", i));
+        hmap_set(&map, keys[i], (void *)(i + 1));
+    }
+    check(map.count == count, "count %zu after %zu sets", map.count, count);
+
+    // removes the odd ones while iterating
+    hmap_for_each(e, &map) {
+        usize i = (usize)e->value - 1;
+        if (i & 1) {
+            check(hmap_remove(&map, e->key), "remove %v while iterating", e->key);
+        }
+    }
+
+    usize found = 0;
+    for (usize i = 0; i < count; ++i) {
+        // a different copy of the key, so it is compared and not just the pointer
+        str_t copy = str(arena, keys[i]);
+        hmap_entry_t *e = hmap_get(&map, strv(copy));
+        bool should_be_there = (i & 1) == 0;
+        check((e != NULL) == should_be_there && (!e || e->value == (void *)(i + 1)), "get %v", keys[i]);
+        found += e != NULL;
+
+        u64 hash = hmap_hash(keys[i]);
+        check(hmap_get_hashed(&map, keys[i], hash) == e, "get hashed %v", keys[i]);
+    }
+    check(map.count == found, "count %zu, found %zu", map.count, found);
+    check(!hmap_get(&map, strv("not a key")), "found a key that was never set");
+    print("%zu string keys\n", count);
+}
+
+static void bench_lookups(arena_t *arena) {
+    struct {
+        const char *ext;
+        const char *mime;
+    } table[] = {
+        { "html", "text/html" },            { "htm", "text/html" },            { "css", "text/css" },
+        { "js", "text/javascript" },        { "mjs", "text/javascript" },      { "json", "application/json" },
+        { "txt", "text/plain" },            { "md", "text/markdown" },         { "xml", "application/xml" },
+        { "csv", "text/csv" },              { "png", "image/png" },            { "jpg", "image/jpeg" },
+        { "jpeg", "image/jpeg" },           { "gif", "image/gif" },            { "svg", "image/svg+xml" },
+        { "ico", "image/x-icon" },          { "webp", "image/webp" },          { "bmp", "image/bmp" },
+        { "mp3", "audio/mpeg" },            { "wav", "audio/wav" },            { "ogg", "audio/ogg" },
+        { "mp4", "video/mp4" },             { "webm", "video/webm" },          { "pdf", "application/pdf" },
+        { "zip", "application/zip" },       { "gz", "application/gzip" },      { "wasm", "application/wasm" },
+        { "ttf", "font/ttf" },              { "woff", "font/woff" },           { "woff2", "font/woff2" },
+    };
+    const char *lookups[] = { "html", "css", "js", "png", "woff2", "svg", "json", "unknown" };
+
+    hmap_t map = hmap_init(arena, arrlen(table));
+    for (usize i = 0; i < arrlen(table); ++i) {
+        hmap_set(&map, strv(table[i].ext), (void *)table[i].mime);
+    }
+
+    usize count = 20000000;
+    usize scan_len = 0, map_len = 0;
+    print("%zu mime lookups on %zu extensions\n", count, arrlen(table));
+
+    bench("linear scan", 0, {
+        scan_len = 0;
+        for (usize i = 0; i < count; ++i) {
+            strview_t ext = strv(lookups[i % arrlen(lookups)]);
+            for (usize t = 0; t < arrlen(table); ++t) {
+                if (strv_equals(ext, strv(table[t].ext))) {
+                    scan_len += strlen(table[t].mime);
+                    break;
+                }
+            }
+        }
+    });
+    bench("hmap_get", 0, {
+        map_len = 0;
+        for (usize i = 0; i < count; ++i) {
+            hmap_entry_t *e = hmap_get(&map, strv(lookups[i % arrlen(lookups)]));
+            if (e) map_len += strlen(e->value);
+        }
+    });
+    check(scan_len == map_len, "the lookups found different types");
+
+    usize inserts = 1000000;
+    usize hits = 0;
+    print("%zu random u64 keys\n", inserts);
+    bench("hmap_set_u64 (growing)", 0, {
+        arena_t scratch = *arena;
+        hmap_t big = hmap_init(&scratch, 0);
+        for (usize i = 0; i < inserts; ++i) {
+            hmap_set_u64(&big, hmap_hash_u64(i), NULL);
+        }
+    });
+    bench("hmap_set_u64 + hmap_get_u64", 0, {
+        arena_t scratch = *arena;
+        hmap_t big = hmap_init(&scratch, inserts);
+        for (usize i = 0; i < inserts; ++i) {
+            hmap_set_u64(&big, hmap_hash_u64(i), NULL);
+        }
+        hits = 0;
+        for (usize i = 0; i < inserts; ++i) {
+            hits += hmap_get_u64(&big, hmap_hash_u64(i)) != NULL;
+        }
+    });
+    check(hits == inserts, "found %zu of %zu keys", hits, inserts);
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_u64_keys(&arena);
+    test_string_keys(&arena);
+
+    if (!test_quick()) {
+        bench_lookups(&arena);
+    }
+
+    return test_end();
+}
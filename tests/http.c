@@ -0,0 +1,235 @@
+#include "tests.h"
+
+// checks that http_parser_feed gives the same request however the bytes come in,
+// that it rejects the requests it should, and times it against http_parse_req
+
+static const char *browser_get =
+    "GET /index.html?page=2 HTTP/1.1\r\n"
+    "Host: localhost:8080\r\n"
+    "User-Agent: Mozilla/5.0 (Windows NT 10.0; Win64; x64) Gecko/20100101 Firefox/120.0\r\n"
+    "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,*/*;q=0.8\r\n"
+    "Accept-Language: en-GB,en;q=0.5\r\n"
+    "Accept-Encoding: gzip, deflate, br\r\n"
+    "Connection: keep-alive\r\n"
+    "Upgrade-Insecure-Requests: 1\r\n"
+    "\r\n";
+
+// everything the parser found, in one string that can be compared.
+// the headers are listed last to first, like the parser keeps them
+static str_t parse_result(arena_t *arena, http_parser_t *p, http_parse_e result) {
+    if (result == HTTP_PARSE_ERROR) {
+        return str(arena, "ERROR");
+    }
+    if (result != HTTP_PARSE_DONE) {
+        return str_fmt(arena, "INCOMPLETE %d", result);
+    }
+
+    outstream_t out = ostr_init(arena);
+    http_req_t *req = &p->req;
+    ostr_print(&out, "%d %hhu.%hhu [%v] end %zu\n", req->method, req->version.major, req->version.minor, req->url, p->end);
+    for (http_header_t *h = req->headers; h; h = h->next) {
+        ostr_print(&out, "[%v]=[%v]\n", h->key, h->value);
+    }
+    ostr_print(&out, "body [%v]", req->body);
+    return ostr_to_str(&out);
+}
+
+static str_t parse_whole(arena_t *arena, strview_t request) {
+    http_parser_t p = http_parser_init(arena);
+    return parse_result(arena, &p, http_parser_feed(&p, request));
+}
+
+// feeds longer and longer prefixes, each one copied somewhere else like a buffer that grows
+static str_t parse_growing(arena_t *arena, strview_t request, usize step) {
+    http_parser_t p = http_parser_init(arena);
+    http_parse_e result = HTTP_PARSE_NEED_MORE;
+    usize len = 0;
+    while (true) {
+        len = MIN(len + step, request.len);
+        char *copy = alloc(arena, char, len + 1, ALLOC_NOZERO);
+        memcpy(copy, request.buf, len);
+        result = http_parser_feed(&p, strv(copy, len));
+        if (result == HTTP_PARSE_DONE || result == HTTP_PARSE_ERROR || len == request.len) {
+            break;
+        }
+    }
+    return parse_result(arena, &p, result);
+}
+
+static void check_every_feed(arena_t *arena, strview_t request, strview_t expected) {
+    str_t whole = parse_whole(arena, request);
+    check(strv_equals(strv(whole), expected), "%v\nwhole: %v\nexpected: %v", request, whole, expected);
+
+    for (usize step = 1; step <= request.len; ++step) {
+        arena_t scratch = *arena;
+        str_t got = parse_growing(&scratch, request, step);
+        if (!strv_equals(strv(got), strv(whole))) {
+            check(false, "%v\nin steps of %zu: %v\nwhole: %v", request, step, got, whole);
+            break;
+        }
+    }
+}
+
+static void test_samples(arena_t *arena) {
+    struct {
+        const char *request;
+        const char *expected;
+    } samples[] = {
+        {
+            "GET / HTTP/1.1\r\n\r\n",
+            "0 1.1 [] end 18\nbody []",
+        },
+        {
+            "POST /api/items HTTP/1.0\r\nContent-Type: text/plain\r\nContent-Length: 5\r\n\r\nhello",
+            "1 1.0 [api/items] end 78\n[Content-Length]=[5]\n[Content-Type]=[text/plain]\nbody [hello]",
+        },
+        {
+            "PUT /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\n7;ext=1\r\n, world\r\n0\r\nX-Sum: 1\r\n\r\n",
+            "3 1.1 [a] end 90\n[Transfer-Encoding]=[chunked]\nbody [hello, world]",
+        },
+        {
+            // only the first request is parsed, the second starts at end
+            "GET /1 HTTP/1.1\r\n\r\nGET /2 HTTP/1.1\r\n\r\n",
+            "0 1.1 [1] end 19\nbody []",
+        },
+        {
+            // empty lines before the request line are skipped
+            "\r\n\r\nDELETE /x HTTP/1.1\r\nHost:  spaced  \r\n\r\n",
+            "4 1.1 [x] end 43\n[Host]=[spaced]\nbody []",
+        },
+        {
+            "HEAD /h HTTP/1.1\r\nContent-Length: 2\r\ncontent-length: 2\r\n\r\nokGET",
+            "2 1.1 [h] end 60\n[content-length]=[2]\n[Content-Length]=[2]\nbody [ok]",
+        },
+        { "BREW /pot HTTP/1.1\r\n\r\n", "ERROR" },
+        { "GET pot HTTP/1.1\r\n\r\n", "ERROR" },
+        { "GET / HTTP/x.1\r\n\r\n", "ERROR" },
+        { "GET / HTTP/1.1\r\nHost: a\r\n folded\r\n\r\n", "ERROR" },
+        { "GET / HTTP/1.1\r\nHost : a\r\n\r\n", "ERROR" },
+        { "GET / HTTP/1.1\r\n: a\r\n\r\n", "ERROR" },
+        { "POST / HTTP/1.1\r\nContent-Length: 1\r\nContent-Length: 2\r\n\r\nab", "ERROR" },
+        { "POST / HTTP/1.1\r\nContent-Length: x\r\n\r\n", "ERROR" },
+        { "POST / HTTP/1.1\r\nContent-Length: 3\r\nTransfer-Encoding: chunked\r\n\r\n0\r\n\r\n", "ERROR" },
+        { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked, gzip\r\n\r\n0\r\n\r\n", "ERROR" },
+        { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\nzz\r\n\r\n", "ERROR" },
+        { "POST / HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n2\r\nabc\r\n0\r\n\r\n", "ERROR" },
+    };
+
+    for (usize i = 0; i < arrlen(samples); ++i) {
+        arena_t scratch = *arena;
+        check_every_feed(&scratch, strv(samples[i].request), strv(samples[i].expected));
+    }
+
+    arena_t scratch = *arena;
+    str_t get = parse_whole(&scratch, strv(browser_get));
+    check(strv_starts_with_view(strv(get), strv("0 1.1 [index.html?page=2]")), "browser get: %v", get);
+    check_every_feed(&scratch, strv(browser_get), strv(get));
+
+    // headers that never end
+    scratch = *arena;
+    usize big = COLLA_HTTP_MAX_HEADER_SIZE + KB(1);
+    char *endless = alloc(&scratch, char, big);
+    memcpy(endless, "GET / HTTP/1.1\r\nX: ", 19);
+    memset(endless + 19, 'a', big - 19);
+    check(strv_equals(strv(parse_whole(&scratch, strv(endless, big))), strv("ERROR")), "endless headers were not rejected");
+}
+
+// changes, removes or repeats a few bytes of a valid request
+static strview_t mutate(arena_t *arena, strview_t request) {
+    static const char interesting[] = "\r\n: 0;aF-/ \t";
+    char *buf = alloc(arena, char, request.len * 2 + 1, ALLOC_NOZERO);
+    memcpy(buf, request.buf, request.len);
+    usize len = request.len;
+
+    int edits = (int)test_rand_range(1, 4);
+    for (int i = 0; i < edits && len > 0; ++i) {
+        usize at = test_rand_range(0, len);
+        switch (test_rand_range(0, 3)) {
+            case 0:
+                buf[at] = test_chance(2) ? interesting[test_rand_range(0, sizeof(interesting) - 1)] : (char)test_rand();
+                break;
+            case 1:
+                memmove(buf + at, buf + at + 1, len - at - 1);
+                len--;
+                break;
+            default:
+            {
+                usize count = MIN(test_rand_range(1, 16), len - at);
+                if (len + count <= request.len * 2) {
+                    memmove(buf + at + count, buf + at, len - at);
+                    len += count;
+                }
+                break;
+            }
+        }
+    }
+    return strv(buf, len);
+}
+
+static void test_mutations(arena_t *arena) {
+    strview_t requests[] = {
+        strv(browser_get),
+        strv("POST /api/items HTTP/1.1\r\nContent-Length: 11\r\n\r\nhello world"),
+        strv("PUT /a HTTP/1.1\r\nTransfer-Encoding: chunked\r\n\r\n5\r\nhello\r\nA\r\n, world!!!\r\n0\r\nX: 1\r\n\r\n"),
+        strv("\r\n\nGET /next HTTP/1.1\r\nHost: a\r\n\r\nGET"),
+    };
+
+    int count = test_quick() ? 20000 : 300000;
+    int mismatches = 0, errors = 0;
+    for (int i = 0; i < count; ++i) {
+        arena_t scratch = *arena;
+        strview_t request = mutate(&scratch, requests[test_rand_range(0, arrlen(requests))]);
+        str_t whole = parse_whole(&scratch, request);
+        str_t split = parse_growing(&scratch, request, test_chance(2) ? 1 : test_rand_range(2, 64));
+        if (!strv_equals(strv(whole), strv(split))) {
+            if (mismatches++ == 0) {
+                print("first mismatch on %v\nwhole: %v\nsplit: %v\n", request, whole, split);
+            }
+        }
+        errors += strv_equals(strv(whole), strv("ERROR"));
+    }
+    check(mismatches == 0, "%d of %d mutated requests parsed differently when split", mismatches, count);
+    print("%d mutated requests, %d rejected, %d mismatches\n", count, errors, mismatches);
+}
+
+static void bench_parsers(arena_t *arena) {
+    strview_t request = strv(browser_get);
+    usize count = 1000000;
+    usize headers = 0, expected = 0;
+
+    bench("http_parser_feed", request.len * count, {
+        headers = 0;
+        for (usize i = 0; i < count; ++i) {
+            arena_t scratch = *arena;
+            http_parser_t p = http_parser_init(&scratch);
+            http_parser_feed(&p, request);
+            for (http_header_t *h = p.req.headers; h; h = h->next) headers++;
+        }
+    });
+    bench("http_parse_req", request.len * count, {
+        expected = 0;
+        for (usize i = 0; i < count; ++i) {
+            arena_t scratch = *arena;
+            http_req_t req = http_parse_req(&scratch, request);
+            for (http_header_t *h = req.headers; h; h = h->next) expected++;
+        }
+    });
+
+    check(headers == expected, "the parsers found %zu and %zu headers", headers, expected);
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_samples(&arena);
+    test_mutations(&arena);
+
+    if (!test_quick()) {
+        print("%zu byte request, 1000000 times\n", strlen(browser_get));
+        bench_parsers(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,349 @@
+#include "tests.h"
+
+// writes random ini files with repeated tables and keys, and checks the tables and
+// values the parser finds against the ones the file was written from, with every
+// mix of options, lazy or not, with and without the key index. then times lookups
+// in a big table and getting one table out of a big config
+
+typedef struct gen_value_t gen_value_t;
+struct gen_value_t {
+    u32 key;
+    u32 value; // every value is different, so it tells which one was found
+};
+
+// tables[0] is the root, the values before the first [table]
+typedef struct gen_table_t gen_table_t;
+struct gen_table_t {
+    u32 name;
+    gen_value_t *values;
+    usize count;
+};
+
+typedef struct gen_ini_t gen_ini_t;
+struct gen_ini_t {
+    gen_table_t *tables;
+    usize count;
+    u32 names; // table names and keys are picked in [0, names) and [0, keys)
+    u32 keys;
+    str_t text;
+};
+
+static gen_ini_t make_ini(arena_t *arena, usize table_count, u32 names, u32 keys, usize max_values) {
+    gen_ini_t gen = { .tables = alloc(arena, gen_table_t, table_count + 1), .count = table_count + 1, .names = names, .keys = keys };
+    u32 next_value = 0;
+    for (usize t = 0; t < gen.count; ++t) {
+        gen_table_t *table = &gen.tables[t];
+        table->name = (u32)test_rand_range(0, names);
+        // on both sides of COLLA_INI_INDEX_MIN
+        table->count = test_rand_range(0, test_chance(3) ? max_values : COLLA_INI_INDEX_MIN);
+        table->values = alloc(arena, gen_value_t, table->count);
+        for (usize v = 0; v < table->count; ++v) {
+            table->values[v] = (gen_value_t){ (u32)test_rand_range(0, keys), next_value++ };
+        }
+    }
+
+    outstream_t out = ostr_init(arena);
+    for (usize t = 0; t < gen.count; ++t) {
+        gen_table_t *table = &gen.tables[t];
+        if (t > 0) {
+            ostr_print(&out, "\n[table %u]\n", table->name);
+        }
+        for (usize v = 0; v < table->count; ++v) {
+            if (test_chance(10)) {
+                ostr_print(&out, test_chance(2) ? "; comment\n" : "# key 1 = no\n");
+            }
+            ostr_print(&out, test_chance(4) ? "key%u=v%u\n" : "key%u = v%u\n", table->values[v].key, table->values[v].value);
+        }
+    }
+    gen.text = ostr_to_str(&out);
+    return gen;
+}
+
+// the values a table should end up with: the ones of the table at first, and those
+// of the later tables with the same name when they are merged
+static gen_value_t *expected_values(arena_t *arena, gen_ini_t *gen, usize first, iniopt_t *opts, usize *count) {
+    usize total = 0;
+    for (usize t = first; t < gen->count; ++t) {
+        if (t == first || (opts->merge_duplicate_tables && t > 0 && gen->tables[t].name == gen->tables[first].name)) {
+            total += gen->tables[t].count;
+        }
+        if (first == 0) break;
+    }
+
+    gen_value_t *out = alloc(arena, gen_value_t, total);
+    *count = 0;
+    for (usize t = first; t < gen->count; ++t) {
+        if (t != first && (!opts->merge_duplicate_tables || gen->tables[t].name != gen->tables[first].name)) {
+            continue;
+        }
+        for (usize v = 0; v < gen->tables[t].count; ++v) {
+            gen_value_t value = gen->tables[t].values[v];
+            bool merged = false;
+            // a merged key keeps its place and takes the new value
+            for (usize i = 0; opts->merge_duplicate_keys && i < *count; ++i) {
+                if (out[i].key == value.key) {
+                    out[i].value = value.value;
+                    merged = true;
+                    break;
+                }
+            }
+            if (!merged) {
+                out[(*count)++] = value;
+            }
+        }
+        if (first == 0) break;
+    }
+    return out;
+}
+
+static bool same_values(initable_t *table, gen_value_t *values, usize count) {
+    if (table->count != count) {
+        return false;
+    }
+    char buf[64];
+    usize i = 0;
+    for_each (v, table->values) {
+        if (i == count) return false;
+        usize len = fmt_buffer(buf, sizeof(buf), "key%u", values[i].key);
+        if (!strv_equals(v->key, strv(buf, len))) return false;
+        len = fmt_buffer(buf, sizeof(buf), "v%u", values[i].value);
+        if (!strv_equals(v->value, strv(buf, len))) return false;
+        i++;
+    }
+    return i == count;
+}
+
+// the first table with that name, or -1
+static i64 first_table(gen_ini_t *gen, u32 name) {
+    for (usize t = 1; t < gen->count; ++t) {
+        if (gen->tables[t].name == name) return (i64)t;
+    }
+    return -1;
+}
+
+static bool name_seen_before(gen_ini_t *gen, usize t) {
+    for (usize i = 1; i < t; ++i) {
+        if (gen->tables[i].name == gen->tables[t].name) return true;
+    }
+    return false;
+}
+
+// the ini used to keep a pointer to the arena it was parsed in, this one is gone by the time it's used
+static ini_t parse_with_copy(arena_t *arena, strview_t text, iniopt_t *opts) {
+    arena_t copy = *arena;
+    ini_t ini = ini_parse_str(&copy, text, opts);
+    *arena = copy;
+    return ini;
+}
+
+static void check_ini(arena_t *arena, gen_ini_t *gen, iniopt_t *opts) {
+    ini_t ini = parse_with_copy(arena, strv(gen->text), opts);
+    char name[64];
+
+    // merged tables are parsed when the next one with the same name is found
+    if (opts->lazy_tables && !opts->merge_duplicate_tables) {
+        usize parsed = 0;
+        for_each (t, ini.tables) {
+            parsed += t != ini.tables && t->values != NULL;
+        }
+        check(parsed == 0, "%zu lazy tables were parsed before they were asked for", parsed);
+    }
+
+    // half the lookups go first, so some lazy tables are parsed by ini_get_table
+    // and some by ini_for_each_table
+    int lookups = (int)gen->count * 4;
+    for (int pass = 0; pass < 2; ++pass) {
+        for (int i = 0; i < lookups / 2; ++i) {
+            // some names and keys that aren't there
+            u32 name_id = (u32)test_rand_range(0, gen->names + 2);
+            u32 key_id = (u32)test_rand_range(0, gen->keys + 2);
+            bool is_root = test_chance(8);
+            i64 expected_table = is_root ? 0 : first_table(gen, name_id);
+            usize len = fmt_buffer(name, sizeof(name), "table %u", name_id);
+            initable_t *table = ini_get_table(arena, &ini, is_root ? INI_ROOT : strv(name, len));
+
+            check((table != NULL) == (expected_table >= 0), "[%.*s] found %d", (int)len, name, table != NULL);
+            if (!table || expected_table < 0) {
+                continue;
+            }
+
+            usize count = 0;
+            gen_value_t *values = expected_values(arena, gen, (usize)expected_table, opts, &count);
+            gen_value_t *expected = NULL;
+            for (usize v = 0; v < count && !expected; ++v) {
+                if (values[v].key == key_id) expected = &values[v];
+            }
+
+            char key[64];
+            len = fmt_buffer(key, sizeof(key), "key%u", key_id);
+            // with and without the index
+            inivalue_t *got = ini_get(test_chance(2) ? arena : NULL, table, strv(key, len));
+            char value[64];
+            usize value_len = expected ? fmt_buffer(value, sizeof(value), "v%u", expected->value) : 0;
+            check((got != NULL) == (expected != NULL) && (!got || strv_equals(got->value, strv(value, value_len))),
+                "[%v] %.*s: got %v, expected %.*s", table->name, (int)len, key, got ? got->value : strv("nothing"), (int)value_len, value);
+        }
+
+        if (pass == 1) {
+            break;
+        }
+
+        // every table in order, with all its values
+        usize t = 0;
+        bool same = true;
+        ini_for_each_table(table, arena, &ini) {
+            while (t < gen->count && opts->merge_duplicate_tables && t > 0 && name_seen_before(gen, t)) {
+                t++;
+            }
+            if (t == gen->count) {
+                same = false;
+                break;
+            }
+            usize count = 0;
+            gen_value_t *values = expected_values(arena, gen, t, opts, &count);
+            usize len = fmt_buffer(name, sizeof(name), "table %u", gen->tables[t].name);
+            strview_t expected_name = t == 0 ? INI_ROOT : strv(name, len);
+            if (!strv_equals(table->name, expected_name) || !same_values(table, values, count)) {
+                check(false, "table %zu [%v] isn't what was written, expected [%v] with %zu values", t, table->name, expected_name, count);
+                same = false;
+                break;
+            }
+            t++;
+        }
+        while (t < gen->count && opts->merge_duplicate_tables && t > 0 && name_seen_before(gen, t)) {
+            t++;
+        }
+        check(same && t == gen->count, "went through %zu of %zu tables", t, gen->count);
+    }
+}
+
+static void test_random_files(arena_t *arena) {
+    int count = test_quick() ? 300 : 3000;
+    for (int i = 0; i < count; ++i) {
+        arena_t scratch = *arena;
+        gen_ini_t gen = make_ini(&scratch, test_rand_range(0, 20), (u32)test_rand_range(1, 12), (u32)test_rand_range(1, 60), 100);
+        for (int o = 0; o < 8; ++o) {
+            iniopt_t opts = {
+                .merge_duplicate_tables = o & 1,
+                .merge_duplicate_keys = (o >> 1) & 1,
+                .lazy_tables = (o >> 2) & 1,
+            };
+            arena_t parse = scratch;
+            check_ini(&parse, &gen, &opts);
+        }
+        if (test__state.failed) {
+            print("failed on:\n%v\n", gen.text);
+            break;
+        }
+    }
+    print("%d random files, with every mix of options\n", count);
+}
+
+static void test_samples(arena_t *arena) {
+    strview_t text = strv(
+        "name = root\n"
+        "[a]\n"
+        "x = 1\n"
+        "; a comment\n"
+        "y=2\n"
+        "\n"
+        "[b]\n"
+        "x = 3\n"
+        "\n"
+        "[a]\n"
+        "x = 4\n"
+        "z = 5\n"
+    );
+
+    ini_t ini = ini_parse_str(arena, text, NULL);
+    initable_t *a = ini_get_table(arena, &ini, strv("a"));
+    check(a && a->count == 2 && strv_equals(ini_get(arena, a, strv("x"))->value, strv("1")), "the first [a] wins");
+    check(!ini_get(arena, a, strv("z")), "the second [a] isn't merged");
+    check(strv_equals(ini_get(NULL, ini_get_table(arena, &ini, INI_ROOT), strv("name"))->value, strv("root")), "root value");
+    check(!ini_get_table(arena, &ini, strv("c")), "found a table that isn't there");
+
+    ini = ini_parse_str(arena, text, &(iniopt_t){ .merge_duplicate_tables = true, .merge_duplicate_keys = true, .lazy_tables = true });
+    a = ini_get_table(arena, &ini, strv("a"));
+    check(a && a->count == 3 && strv_equals(ini_get(arena, a, strv("x"))->value, strv("4")), "merged [a] has the last x");
+    check(a && strv_equals(a->values->key, strv("x")) && strv_equals(a->tail->key, strv("z")), "merged [a] keeps the order");
+
+    // an empty line ends a table, what comes after goes to the root
+    ini = ini_parse_str(arena, strv("[a]\nx = 1\n\ny = 2\n"), &(iniopt_t){ .lazy_tables = true });
+    check(ini_get(NULL, ini_get_table(arena, &ini, INI_ROOT), strv("y")), "the value after the empty line isn't in the root");
+    check(!ini_get(NULL, ini_get_table(arena, &ini, strv("a")), strv("y")), "the value after the empty line is in [a]");
+}
+
+static void bench_ini(arena_t *arena) {
+    usize keys = 2000;
+    // the text has an arena of its own, the outstream keeps growing in it
+    arena_t text_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    outstream_t out = ostr_init(&text_arena);
+    ostr_print(&out, "[big]\n");
+    for (usize i = 0; i < keys; ++i) {
+        ostr_print(&out, "key%zu = %zu\n", i, i);
+    }
+    strview_t big_text = ostr_as_view(&out);
+
+    usize count = 100000;
+    usize found = 0, expected = 0;
+    print("%zu lookups in a table with %zu keys\n", count, keys);
+
+    ini_t ini = ini_parse_str(arena, big_text, NULL);
+    initable_t *big = ini_get_table(arena, &ini, strv("big"));
+    char key[64];
+    bench("ini_get, walking the values", 0, {
+        expected = 0;
+        for (usize i = 0; i < count; ++i) {
+            usize len = fmt_buffer(key, sizeof(key), "key%zu", (i * 7919) % keys);
+            expected += ini_get(NULL, big, strv(key, len)) != NULL;
+        }
+    });
+    bench("ini_get, with the index", 0, {
+        found = 0;
+        for (usize i = 0; i < count; ++i) {
+            usize len = fmt_buffer(key, sizeof(key), "key%zu", (i * 7919) % keys);
+            found += ini_get(arena, big, strv(key, len)) != NULL;
+        }
+    });
+    check(found == expected && found == count, "found %zu and %zu keys", found, expected);
+
+    // a config with a table for every tool, and one tool that reads its own
+    ostr_clear(&out);
+    for (usize t = 0; t < 2000; ++t) {
+        ostr_print(&out, "[tool%zu]\n", t);
+        for (usize i = 0; i < 20; ++i) {
+            ostr_print(&out, "option%zu = some value for tool %zu\n", i, t);
+        }
+        ostr_putc(&out, '\n');
+    }
+    strview_t config = ostr_as_view(&out);
+    print("getting one table out of %zu bytes\n", config.len);
+    usize values = 0, lazy_values = 0;
+    bench("ini_parse_str", config.len, {
+        arena_t scratch = *arena;
+        ini_t conf = ini_parse_str(&scratch, config, NULL);
+        values = ini_get_table(&scratch, &conf, strv("tool1000"))->count;
+    });
+    bench("ini_parse_str, lazy_tables", config.len, {
+        arena_t scratch = *arena;
+        ini_t conf = ini_parse_str(&scratch, config, &(iniopt_t){ .lazy_tables = true });
+        lazy_values = ini_get_table(&scratch, &conf, strv("tool1000"))->count;
+    });
+    check(values == 20 && lazy_values == 20, "the tables have %zu and %zu values", values, lazy_values);
+    arena_cleanup(&text_arena);
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_samples(&arena);
+    test_random_files(&arena);
+
+    if (!test_quick()) {
+        bench_ini(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,339 @@
+#include "tests.h"
+
+// checks that every job pushed to the job queue runs exactly once, from outside
+// the pool and from inside jobs, that an uneven tree of jobs is walked whole, and
+// that threads never get past a barrier before the others arrive. then times them
+// with more and more threads
+
+typedef struct jobs_t jobs_t;
+struct jobs_t {
+    job_queue_t *queue;
+    arena_t *arenas; // one for each slot, for the jobs that push jobs
+    i64 *runs;       // how many times each job ran
+    i64 sum;
+    i64 leaves;
+    i64 dirs;
+};
+
+static jobs_t jobs = {0};
+
+static void flat_job(void *userdata) {
+    usize index = (usize)userdata;
+    atomic_inc_i64(&jobs.runs[index]);
+    atomic_add_i64(&jobs.sum, (i64)index);
+}
+
+// splits its range in two jobs until it is one item long
+static void split_job(void *userdata) {
+    u64 range = (u64)(uptr)userdata;
+    u32 lo = (u32)(range >> 32), hi = (u32)range;
+    if (hi - lo == 1) {
+        atomic_inc_i64(&jobs.runs[lo]);
+        atomic_inc_i64(&jobs.leaves);
+        return;
+    }
+    u32 mid = lo + (hi - lo) / 2;
+    arena_t *arena = &jobs.arenas[jq_worker_index()];
+    jq_group_push(arena, jq_current_group(), split_job, (void *)(uptr)(((u64)lo << 32) | mid));
+    jq_group_push(arena, jq_current_group(), split_job, (void *)(uptr)(((u64)mid << 32) | hi));
+}
+
+// fills more scratch than the decommit threshold, the next job on the
+// same worker should find it given back
+static void scratch_job(void *userdata) {
+    i64 *decommitted = userdata;
+    i64 run = atomic_inc_i64(&jobs.sum) - 1;
+    arena_temp_t scratch = scratch_begin();
+    decommitted[run] = (i64)arena_decommitted_bytes(scratch.arena);
+    u8 *big = alloc(scratch.arena, u8, COLLA_SCRATCH_DECOMMIT_THRESHOLD * 2, ALLOC_NOZERO);
+    memset(big, 1, COLLA_SCRATCH_DECOMMIT_THRESHOLD * 2);
+    scratch_end(&scratch);
+}
+
+// a made up directory tree, walked like fd does: one job for each directory, which
+// looks at its files and pushes a job for each subdirectory. most directories have
+// a few subdirectories and some have dozens, so the work is uneven and only shows
+// up while the walk goes on
+static u32 fanout_subdirs(u64 dir, u32 depth, u32 max_depth) {
+    if (depth >= max_depth) {
+        return 0;
+    }
+    u64 h = hmap_hash_u64(dir);
+    return (h % 16) == 0 ? 10 + (u32)((h >> 8) % 30) : (u32)((h >> 8) % 4);
+}
+
+static u64 fanout_child(u64 dir, u32 i) {
+    return hmap_hash_u64(dir * 64 + i + 1) >> 8;
+}
+
+// what a directory job does with its files, instead of a stat for each one
+static i64 fanout_files(u64 dir) {
+    u32 files = (u32)((hmap_hash_u64(dir) >> 16) % 40);
+    u64 sum = 0;
+    for (u32 f = 0; f < files; ++f) {
+        u64 h = dir + f;
+        for (int i = 0; i < 8; ++i) h = hmap_hash_u64(h);
+        sum += h & 0xFFFF;
+    }
+    return (i64)sum;
+}
+
+static u32 fanout_depth = 0;
+
+// the directory is in the top 56 bits of userdata, the depth in the bottom 8
+static void fanout_job(void *userdata) {
+    u64 packed = (u64)(uptr)userdata;
+    u64 dir = packed >> 8;
+    u32 depth = (u32)(packed & 0xFF);
+
+    atomic_inc_i64(&jobs.dirs);
+    atomic_add_i64(&jobs.sum, fanout_files(dir));
+
+    arena_t *arena = &jobs.arenas[jq_worker_index()];
+    u32 subdirs = fanout_subdirs(dir, depth, fanout_depth);
+    for (u32 i = 0; i < subdirs; ++i) {
+        u64 child = (fanout_child(dir, i) << 8) | (depth + 1);
+        jq_group_push(arena, jq_current_group(), fanout_job, (void *)(uptr)child);
+    }
+}
+
+// the same walk on one thread, for the expected counts
+static void fanout_expected(u64 dir, u32 depth, i64 *dirs, i64 *sum) {
+    *dirs += 1;
+    *sum += fanout_files(dir);
+    u32 subdirs = fanout_subdirs(dir, depth, fanout_depth);
+    for (u32 i = 0; i < subdirs; ++i) {
+        fanout_expected(fanout_child(dir, i), depth + 1, dirs, sum);
+    }
+}
+
+static void jobs_begin(arena_t *arena, int workers, usize count) {
+    jobs.queue = jq_init(arena, workers);
+    int slots = jq_slot_count(jobs.queue);
+    jobs.arenas = alloc(arena, arena_t, slots);
+    for (int i = 0; i < slots; ++i) {
+        jobs.arenas[i] = arena_make(ARENA_VIRTUAL, GB(1));
+    }
+    jobs.runs = alloc(arena, i64, count);
+    jobs.sum = 0;
+    jobs.leaves = 0;
+    jobs.dirs = 0;
+}
+
+static void jobs_end(void) {
+    jq_cleanup(jobs.queue);
+    for (int i = 0; i < jq_slot_count(jobs.queue); ++i) {
+        arena_cleanup(&jobs.arenas[i]);
+    }
+}
+
+static bool ran_once(usize count) {
+    for (usize i = 0; i < count; ++i) {
+        if (jobs.runs[i] != 1) {
+            check(false, "job %zu ran %lld times", i, jobs.runs[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void run_flat(arena_t *arena, usize count) {
+    for (usize i = 0; i < count; ++i) {
+        jq_push(arena, jobs.queue, flat_job, (void *)i);
+    }
+}
+
+static void run_split(arena_t *arena, usize count) {
+    jq_group_t *group = jq_group_create(arena, jobs.queue);
+    jq_group_push(arena, group, split_job, (void *)(uptr)count);
+    jq_group_wait(group);
+}
+
+// the root has lots of subdirectories, like a home folder
+static void run_fanout(arena_t *arena, u32 max_depth) {
+    fanout_depth = max_depth;
+    jq_group_t *group = jq_group_create(arena, jobs.queue);
+    for (u32 i = 0; i < 32; ++i) {
+        jq_group_push(arena, group, fanout_job, (void *)(uptr)((fanout_child(0, i) << 8) | 1));
+    }
+    jq_group_wait(group);
+}
+
+static void fanout_check(u32 max_depth, int workers) {
+    i64 dirs = 0, sum = 0;
+    fanout_depth = max_depth;
+    for (u32 i = 0; i < 32; ++i) {
+        fanout_expected(fanout_child(0, i), 1, &dirs, &sum);
+    }
+    check(jobs.dirs == dirs && jobs.sum == sum, "fanout with %d workers walked %lld directories, expected %lld", workers, jobs.dirs, dirs);
+}
+
+static void test_jobs(arena_t *arena) {
+    usize count = test_quick() ? 20000 : 500000;
+    int worker_counts[] = { 1, 2, 4, 0 };
+
+    for (usize w = 0; w < arrlen(worker_counts); ++w) {
+        arena_t scratch = *arena;
+        jobs_begin(&scratch, worker_counts[w], count);
+        run_flat(&scratch, count);
+        jobs_end();
+        check(ran_once(count) && jobs.sum == (i64)(count * (count - 1) / 2), "flat jobs with %d workers", worker_counts[w]);
+
+        // the same queue runs more than one group, and stays up between them
+        scratch = *arena;
+        jobs_begin(&scratch, worker_counts[w], count);
+        run_split(&scratch, count / 2);
+        check(jobs.leaves == (i64)(count / 2), "first group: %lld leaves", jobs.leaves);
+        jobs.leaves = 0;
+        for (usize i = 0; i < count / 2; ++i) jobs.runs[i] = 0;
+        run_split(&scratch, count);
+        check(jobs.leaves == (i64)count, "second group: %lld leaves", jobs.leaves);
+        jobs_end();
+        check(ran_once(count), "split jobs with %d workers", worker_counts[w]);
+
+        scratch = *arena;
+        jobs_begin(&scratch, worker_counts[w], 0);
+        run_fanout(&scratch, test_quick() ? 8 : 11);
+        jobs_end();
+        fanout_check(test_quick() ? 8 : 11, worker_counts[w]);
+    }
+    print("%zu jobs, pushed from outside and from inside jobs\n", count);
+
+    // one worker, so the jobs run one after the other on the same thread
+    arena_t scratch = *arena;
+    jobs_begin(&scratch, 1, 0);
+    i64 decommitted[3] = {0};
+    for (usize i = 0; i < arrlen(decommitted); ++i) {
+        jq_push(&scratch, jobs.queue, scratch_job, decommitted);
+    }
+    jobs_end();
+    check(decommitted[0] == 0 && decommitted[2] > decommitted[1] && decommitted[1] > 0, "the scratch of the worker was not trimmed between jobs: %lld %lld %lld", decommitted[0], decommitted[1], decommitted[2]);
+}
+
+typedef struct barrier_test_t barrier_test_t;
+struct barrier_test_t {
+    os_barrier_t barrier;
+    i64 *arrived; // for each round
+    i64 early;
+    int rounds;
+    int threads;
+};
+
+static int barrier_thread(u64 thread_id, void *userdata) {
+    COLLA_UNUSED(thread_id);
+    barrier_test_t *t = userdata;
+    for (int r = 0; r < t->rounds; ++r) {
+        atomic_inc_i64(&t->arrived[r]);
+        os_barrier_sync(&t->barrier);
+        if (atomic_get_i64(&t->arrived[r]) != t->threads) {
+            atomic_inc_i64(&t->early);
+        }
+    }
+    return 0;
+}
+
+static void run_barrier(arena_t *arena, int threads, int rounds, barrier_test_t *t) {
+    *t = (barrier_test_t){
+        .barrier.thread_count = threads,
+        .arrived = alloc(arena, i64, rounds),
+        .rounds = rounds,
+        .threads = threads,
+    };
+    oshandle_t *handles = alloc(arena, oshandle_t, threads);
+    for (int i = 0; i < threads; ++i) {
+        handles[i] = os_thread_launch(barrier_thread, t);
+    }
+    for (int i = 0; i < threads; ++i) {
+        os_thread_join(handles[i], NULL);
+    }
+}
+
+static void test_barrier(arena_t *arena) {
+    int cores = (int)os_get_system_info().processor_count;
+    int rounds = test_quick() ? 2000 : 20000;
+    // more threads than cores too, where spinning alone would stall
+    int thread_counts[] = { 2, MAX(cores, 4), cores * 2 + 5 };
+
+    for (usize i = 0; i < arrlen(thread_counts); ++i) {
+        arena_t scratch = *arena;
+        barrier_test_t t = {0};
+        run_barrier(&scratch, thread_counts[i], rounds, &t);
+        check(t.early == 0, "%lld threads got past the barrier early with %d threads", t.early, thread_counts[i]);
+    }
+    print("%d barrier rounds with up to %d threads\n", rounds, thread_counts[2]);
+}
+
+#define FANOUT_BENCH_DEPTH 11
+
+static void bench_queue(arena_t *arena, int workers, usize count) {
+    char name[64];
+    fmt_buffer(name, sizeof(name), "flat, %d workers", workers);
+    bench(name, 0, {
+        arena_t scratch = *arena;
+        jobs_begin(&scratch, workers, count);
+        run_flat(&scratch, count);
+        jobs_end();
+    });
+    fmt_buffer(name, sizeof(name), "split, %d workers", workers);
+    bench(name, 0, {
+        arena_t scratch = *arena;
+        jobs_begin(&scratch, workers, count);
+        run_split(&scratch, count);
+        jobs_end();
+    });
+    fmt_buffer(name, sizeof(name), "fanout, %d workers", workers);
+    bench(name, 0, {
+        arena_t scratch = *arena;
+        jobs_begin(&scratch, workers, 0);
+        run_fanout(&scratch, FANOUT_BENCH_DEPTH);
+        jobs_end();
+    });
+    fanout_check(FANOUT_BENCH_DEPTH, workers);
+}
+
+static void bench_jobs(arena_t *arena) {
+    int cores = (int)os_get_system_info().processor_count;
+    usize count = 2000000;
+    print("%zu jobs\n", count);
+
+    i64 dirs = 0, sum = 0;
+    fanout_depth = FANOUT_BENCH_DEPTH;
+    for (u32 i = 0; i < 32; ++i) {
+        fanout_expected(fanout_child(0, i), 1, &dirs, &sum);
+    }
+    print("fanout over %lld directories, %d deep\n", dirs, FANOUT_BENCH_DEPTH);
+
+    for (int workers = 1; workers < cores; workers *= 2) {
+        bench_queue(arena, workers, count);
+    }
+    bench_queue(arena, cores, count);
+
+    int rounds = 10000;
+    print("%d barrier rounds on %d cores\n", rounds, cores);
+    int thread_counts[] = { 2, 8, 64 };
+    for (usize i = 0; i < arrlen(thread_counts); ++i) {
+        char name[64];
+        fmt_buffer(name, sizeof(name), "%d threads", thread_counts[i]);
+        barrier_test_t t = {0};
+        bench(name, 0, {
+            arena_t scratch = *arena;
+            run_barrier(&scratch, thread_counts[i], rounds, &t);
+        });
+        check(t.early == 0, "threads got past the barrier early");
+    }
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(4));
+
+    test_jobs(&arena);
+    test_barrier(&arena);
+
+    if (!test_quick()) {
+        bench_jobs(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,645 @@
+#include "tests.h"
+
+// checks that json_parse_str, json_tape_parse and json_reader_t agree on random
+// documents, that the reader gives the same events for every chunk size, and that
+// truncated documents are rejected by all three. checks json_get, json_at and
+// json_len against walking the children, also on big objects that get an index
+// and after children are added, and json_reader_select against the paths of the
+// tree. then times them on a big array
+
+// == GENERATOR =======================================
+
+static void gen_space(outstream_t *out) {
+    while (test_chance(4)) {
+        ostr_putc(out, " \t\n\r"[test_rand_range(0, 4)]);
+    }
+}
+
+static void gen_string(outstream_t *out) {
+    static const char *pieces[] = {
+        "a", "b", "hello", " ", "\\\"", "\\\\", "\\/", "\\n", "\\t", "\\u00e9", "\\ud83d\\ude00", "\xc3\xa9", "\xe2\x82\xac", "{", "]", ":", ",",
+    };
+    ostr_putc(out, '"');
+    usize count = test_rand_range(0, 8);
+    for (usize i = 0; i < count; ++i) {
+        ostr_puts(out, strv(pieces[test_rand_range(0, arrlen(pieces))]));
+    }
+    ostr_putc(out, '"');
+}
+
+static void gen_number(outstream_t *out) {
+    switch (test_rand_range(0, 6)) {
+        case 0: ostr_print(out, "%lld", (long long)test_rand_range(0, 1000)); break;
+        case 1: ostr_print(out, "-%llu", test_rand()); break;
+        case 2: ostr_print(out, "%llu.%03llu", test_rand_range(0, 100000), test_rand_range(0, 1000)); break;
+        case 3: ostr_print(out, "%llue%d", test_rand_range(1, 10), (int)test_rand_range(0, 40) - 20); break;
+        case 4: ostr_print(out, "-0.%lluE+%d", test_rand_range(0, 1000000), (int)test_rand_range(0, 300)); break;
+        default:
+        {
+            u64 bits = test_rand();
+            double value = 0;
+            memcpy(&value, &bits, sizeof(value));
+            if (isnan(value) || isinf(value)) value = 0.5;
+            ostr_print(out, "%.17g", value);
+            break;
+        }
+    }
+}
+
+static void gen_value(outstream_t *out, int depth) {
+    u64 kind = test_rand_range(0, depth < 6 ? 8 : 5);
+    switch (kind) {
+        case 0: gen_string(out); break;
+        case 1: gen_number(out); break;
+        case 2: ostr_puts(out, strv("true")); break;
+        case 3: ostr_puts(out, strv("false")); break;
+        case 4: ostr_puts(out, strv("null")); break;
+        default:
+        {
+            bool is_object = kind == 5 || kind == 7;
+            ostr_putc(out, is_object ? '{' : '[');
+            // sometimes past COLLA_JSON_INDEX_MIN, only near the top so documents stay small
+            usize count = depth < 2 && test_chance(4) ? test_rand_range(COLLA_JSON_INDEX_MIN - 2, COLLA_JSON_INDEX_MIN * 3) : test_rand_range(0, 6);
+            for (usize i = 0; i < count; ++i) {
+                if (i) ostr_putc(out, ',');
+                gen_space(out);
+                if (is_object) {
+                    gen_string(out);
+                    gen_space(out);
+                    ostr_putc(out, ':');
+                    gen_space(out);
+                }
+                gen_value(out, depth + 1);
+                gen_space(out);
+            }
+            ostr_putc(out, is_object ? '}' : ']');
+            break;
+        }
+    }
+}
+
+// a document always starts with an object or an array, so no prefix of it is valid
+static strview_t gen_document(outstream_t *out) {
+    do {
+        ostr_clear(out);
+        gen_space(out);
+        gen_value(out, 0);
+    } while (ostr_back(out) != '}' && ostr_back(out) != ']');
+    gen_space(out);
+    return ostr_as_view(out);
+}
+
+static strview_t gen_api_array(outstream_t *out, usize size) {
+    ostr_clear(out);
+    ostr_putc(out, '[');
+    for (u64 id = 0; ostr_tell(out) < size; ++id) {
+        if (id) ostr_puts(out, strv(",\n"));
+        ostr_print(
+            out,
+            "{\"id\": %llu, \"name\": \"user %llu\", \"email\": \"user%llu@example.com\", \"active\": %s, "
+            "\"score\": %llu.%02llu, \"tags\": [\"a\", \"b\\u00e9\", \"c\"], \"address\": {\"city\": \"city %llu\", \"zip\": \"%05llu\"}, \"parent\": null}",
+            id, id, id, id % 3 ? "true" : "false", id % 1000, id % 100, id % 97, id % 100000
+        );
+    }
+    ostr_putc(out, ']');
+    return ostr_as_view(out);
+}
+
+// == EVENTS ==========================================
+
+// events are folded in a hash, the same document has to give the same hash
+typedef struct events_t events_t;
+struct events_t {
+    u64 hash;
+    usize count;
+    bool is_valid;
+};
+
+static void events_add(events_t *ev, char kind, strview_t str, double number) {
+    u64 h = ev->hash ? ev->hash : 0xcbf29ce484222325ull;
+    h = (h ^ (u8)kind) * 0x100000001b3ull;
+    for (usize i = 0; i < str.len; ++i) {
+        h = (h ^ (u8)str.buf[i]) * 0x100000001b3ull;
+    }
+    u64 bits = 0;
+    memcpy(&bits, &number, sizeof(bits));
+    ev->hash = (h ^ bits) * 0x100000001b3ull;
+    ev->count++;
+}
+
+static void events_from_tape(events_t *ev, json_tape_t *tape, usize index) {
+    json_elem_t *elem = &tape->elems[index];
+    switch (elem->type) {
+        case JSON_STRING: events_add(ev, 's', json_tape_str(tape, index), 0); break;
+        case JSON_NUMBER: events_add(ev, 'n', STRV_EMPTY, elem->number);     break;
+        case JSON_BOOL:   events_add(ev, 'b', STRV_EMPTY, elem->boolean);    break;
+        case JSON_NULL:   events_add(ev, 'z', STRV_EMPTY, 0);                break;
+        case JSON_OBJECT:
+        case JSON_ARRAY:
+        {
+            bool is_object = elem->type == JSON_OBJECT;
+            events_add(ev, is_object ? '{' : '[', STRV_EMPTY, 0);
+            usize i = index + 1;
+            while (i < elem->end) {
+                if (is_object) {
+                    events_add(ev, 'k', json_tape_str(tape, i++), 0);
+                }
+                events_from_tape(ev, tape, i);
+                i = json_tape_next(tape, i);
+            }
+            events_add(ev, is_object ? '}' : ']', STRV_EMPTY, 0);
+            break;
+        }
+    }
+}
+
+static events_t events_from_reader(arena_t scratch, strview_t doc, usize chunk_size) {
+    events_t ev = {0};
+    json_reader_t r = json_reader_init(&scratch, JSON_DEFAULT);
+    usize fed = MIN(chunk_size, doc.len);
+    json_reader_feed(&r, strv(doc.buf, fed), fed == doc.len);
+
+    while (true) {
+        json_event_e event = json_reader_next(&r);
+        switch (event) {
+            case JSON_EVENT_NEED_INPUT:
+            {
+                usize len = MIN(chunk_size, doc.len - fed);
+                json_reader_feed(&r, strv(doc.buf + fed, len), fed + len == doc.len);
+                fed += len;
+                break;
+            }
+            case JSON_EVENT_OBJECT_BEGIN: events_add(&ev, '{', STRV_EMPTY, 0);       break;
+            case JSON_EVENT_OBJECT_END:   events_add(&ev, '}', STRV_EMPTY, 0);       break;
+            case JSON_EVENT_ARRAY_BEGIN:  events_add(&ev, '[', STRV_EMPTY, 0);       break;
+            case JSON_EVENT_ARRAY_END:    events_add(&ev, ']', STRV_EMPTY, 0);       break;
+            case JSON_EVENT_KEY:          events_add(&ev, 'k', r.str, 0);            break;
+            case JSON_EVENT_STRING:       events_add(&ev, 's', r.str, 0);            break;
+            case JSON_EVENT_NUMBER:       events_add(&ev, 'n', STRV_EMPTY, r.number);  break;
+            case JSON_EVENT_BOOL:         events_add(&ev, 'b', STRV_EMPTY, r.boolean); break;
+            case JSON_EVENT_NULL:         events_add(&ev, 'z', STRV_EMPTY, 0);       break;
+            case JSON_EVENT_DONE:
+                ev.is_valid = true;
+                return ev;
+            case JSON_EVENT_ERROR:
+                return ev;
+        }
+    }
+}
+
+static bool same_value(json_t *node, json_tape_t *tape, usize index) {
+    json_elem_t *elem = &tape->elems[index];
+    if (!node || node->type != elem->type) {
+        return false;
+    }
+
+    switch (elem->type) {
+        case JSON_STRING: return strv_equals(node->string, json_tape_str(tape, index));
+        case JSON_NUMBER: return memcmp(&node->number, &elem->number, sizeof(double)) == 0;
+        case JSON_BOOL:   return node->boolean == elem->boolean;
+        case JSON_OBJECT:
+        case JSON_ARRAY:
+        {
+            bool is_object = elem->type == JSON_OBJECT;
+            json_t *child = node->array;
+            usize i = index + 1;
+            while (i < elem->end) {
+                if (!child) {
+                    return false;
+                }
+                if (is_object && !strv_equals(child->key, json_tape_str(tape, i++))) {
+                    return false;
+                }
+                if (!same_value(child, tape, i)) {
+                    return false;
+                }
+                i = json_tape_next(tape, i);
+                child = child->next;
+            }
+            return child == NULL;
+        }
+        default: return true;
+    }
+}
+
+// == LOOKUPS =========================================
+
+static json_t *walk_get(json_t *node, strview_t key) {
+    for_each (child, node->object) {
+        if (strv_equals(child->key, key)) return child;
+    }
+    return NULL;
+}
+
+static json_t *walk_at(json_t *node, usize index) {
+    for_each (child, node->array) {
+        if (index-- == 0) return child;
+    }
+    return NULL;
+}
+
+static usize walk_len(json_t *node) {
+    usize count = 0;
+    for_each (child, node->array) count++;
+    return count;
+}
+
+// every key and index of every object and array, with and without an arena
+static bool same_lookups(arena_t *arena, json_t *node) {
+    if (!node || (node->type != JSON_OBJECT && node->type != JSON_ARRAY)) {
+        return true;
+    }
+
+    usize len = walk_len(node);
+    if (json_len(node) != len) {
+        return false;
+    }
+
+    for (int pass = 0; pass < 2; ++pass) {
+        arena_t *index_arena = pass ? arena : NULL;
+        usize i = 0;
+        for_each (child, node->array) {
+            if (json_at(index_arena, node, i++) != child) {
+                return false;
+            }
+            if (node->type == JSON_OBJECT && json_get(index_arena, node, child->key) != walk_get(node, child->key)) {
+                return false;
+            }
+        }
+        if (json_at(index_arena, node, len) || json_get(index_arena, node, strv("not a key")) || json_get(index_arena, node, strv("\x01"))) {
+            return false;
+        }
+    }
+
+    for_each (child, node->array) {
+        if (!same_lookups(arena, child)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static json_t *new_number(arena_t *arena, strview_t key, double number) {
+    json_t *node = alloc(arena, json_t);
+    node->type = JSON_NUMBER;
+    node->key = key;
+    node->number = number;
+    return node;
+}
+
+static void append(json_t *parent, json_t *node) {
+    json_t *last = parent->object;
+    while (last && last->next) last = last->next;
+    node->prev = last;
+    if (last) last->next = node;
+    else      parent->object = node;
+}
+
+static void prepend(json_t *parent, json_t *node) {
+    node->next = parent->object;
+    if (parent->object) parent->object->prev = node;
+    parent->object = node;
+}
+
+static void test_big_objects(arena_t *arena) {
+    usize sizes[] = { COLLA_JSON_INDEX_MIN - 1, COLLA_JSON_INDEX_MIN, 100, 1000, 5000 };
+
+    for (usize s = 0; s < arrlen(sizes); ++s) {
+        arena_temp_t temp = arena_temp_begin(arena);
+        usize size = sizes[s];
+
+        // every third key is used again later in the object, the first one has to win
+        outstream_t out = ostr_init(arena);
+        ostr_puts(&out, strv("{\"object\": {"));
+        for (usize i = 0; i < size; ++i) {
+            ostr_print(&out, "%s\"key %zu\": %zu", i ? ", " : "", i % 3 == 2 ? i / 3 : i, i);
+        }
+        ostr_puts(&out, strv("}, \"array\": ["));
+        for (usize i = 0; i < size; ++i) {
+            ostr_print(&out, "%s%zu", i ? ", " : "", i);
+        }
+        ostr_puts(&out, strv("]}"));
+        strview_t doc = strv(ostr_to_str(&out));
+
+        json_t *root = json_parse_str(arena, doc, JSON_DEFAULT);
+        json_t *object = json_get(arena, root, strv("object"));
+        json_t *array = json_get(arena, root, strv("array"));
+        check(json_check(object, JSON_OBJECT) && json_check(array, JSON_ARRAY), "%zu members: missing object or array", size);
+        if (!object || !array) {
+            arena_temp_end(&temp);
+            continue;
+        }
+
+        check(json_len(object) == size && json_len(array) == size, "%zu members: json_len %zu and %zu", size, json_len(object), json_len(array));
+        bool same = true;
+        for (usize i = 0; i < size; ++i) {
+            json_t *value = json_at(arena, array, i);
+            same = same && value && value->number == (double)i;
+            str_t key = str_fmt(arena, "key %zu", i);
+            json_t *member = json_get(arena, object, strv(key));
+            // member i has its own key unless i % 3 == 2, member 3i+2 has it again
+            usize first = i % 3 != 2 ? i : i * 3 + 2 < size ? i * 3 + 2 : STR_NONE;
+            same = same && (first == STR_NONE ? member == NULL : member && member->number == (double)first);
+        }
+        check(same, "%zu members: json_get or json_at gave the wrong child", size);
+        check(same_lookups(arena, root), "%zu members: lookups differ from walking the children", size);
+
+        // added after the index was built, at the end and at the start
+        json_t *added = new_number(arena, strv("added"), -1);
+        append(object, added);
+        check(json_get(arena, object, strv("added")) == added, "%zu members: appended key not found", size);
+        check(json_len(object) == size + 1, "%zu members: json_len %zu after an append", size, json_len(object));
+        check(json_at(arena, object, size) == added, "%zu members: json_at missed the appended child", size);
+
+        json_t *first_key = new_number(arena, strv("key 0"), -2);
+        prepend(object, first_key);
+        check(json_get(arena, object, strv("key 0")) == first_key, "%zu members: prepended duplicate key doesn't win", size);
+        check(json_get(NULL, object, strv("added")) == added, "%zu members: appended key not found without an arena", size);
+
+        json_t *number = new_number(arena, STRV_EMPTY, -3);
+        append(array, number);
+        check(json_at(NULL, array, size) == number && json_at(arena, array, size) == number, "%zu members: json_at missed the appended item", size);
+        check(same_lookups(arena, root), "%zu members: lookups differ from walking the children after appends", size);
+
+        arena_temp_end(&temp);
+    }
+    print("objects and arrays from %zu to %zu members\n", sizes[0], sizes[arrlen(sizes) - 1]);
+}
+
+// == PATHS ===========================================
+
+typedef struct path_list_t path_list_t;
+struct path_list_t {
+    str_t *paths; // of every node but the root, in the order they are in the document
+    json_t **nodes;
+    usize count;
+    usize cap;
+};
+
+static usize count_nodes(json_t *node) {
+    usize count = 1;
+    if (node->type == JSON_OBJECT || node->type == JSON_ARRAY) {
+        for_each (child, node->array) count += count_nodes(child);
+    }
+    return count;
+}
+
+// keys that can't be written in a path give NULL paths to their node and everything in it
+static void collect_paths(arena_t *arena, path_list_t *list, json_t *node, str_t prefix, bool writable) {
+    if (node->type != JSON_OBJECT && node->type != JSON_ARRAY) {
+        return;
+    }
+    usize i = 0;
+    for_each (child, node->array) {
+        str_t path = STR_EMPTY;
+        if (writable && node->type == JSON_ARRAY) {
+            path = str_fmt(arena, "%v[%zu]", prefix, i);
+        }
+        else if (writable && child->key.len && strv_find_either(child->key, strv(".["), 0) == STR_NONE) {
+            path = prefix.len ? str_fmt(arena, "%v.%v", prefix, child->key) : str(arena, child->key);
+        }
+        list->paths[list->count] = path;
+        list->nodes[list->count++] = child;
+        collect_paths(arena, list, child, path, path.buf != NULL);
+        i++;
+    }
+}
+
+static json_event_e event_of(json_t *node) {
+    switch (node->type) {
+        case JSON_OBJECT: return JSON_EVENT_OBJECT_BEGIN;
+        case JSON_ARRAY:  return JSON_EVENT_ARRAY_BEGIN;
+        case JSON_STRING: return JSON_EVENT_STRING;
+        case JSON_NUMBER: return JSON_EVENT_NUMBER;
+        case JSON_BOOL:   return JSON_EVENT_BOOL;
+        default:          return JSON_EVENT_NULL;
+    }
+}
+
+// runs json_reader_select with paths over doc, in chunks, and checks that it stops
+// on every node of wanted in order, wanted[i] is the path that node is at
+static bool same_selection(arena_t scratch, strview_t doc, usize chunk_size, json_path_t *paths, int count, json_t **wanted, int *wanted_path, usize wanted_count) {
+    json_reader_t r = json_reader_init(&scratch, JSON_DEFAULT);
+    usize fed = MIN(chunk_size, doc.len);
+    json_reader_feed(&r, strv(doc.buf, fed), fed == doc.len);
+    usize found = 0;
+
+    while (true) {
+        int match = -1;
+        json_event_e event = json_reader_select(&r, paths, count, &match);
+        switch (event) {
+            case JSON_EVENT_NEED_INPUT:
+            {
+                usize len = MIN(chunk_size, doc.len - fed);
+                json_reader_feed(&r, strv(doc.buf + fed, len), fed + len == doc.len);
+                fed += len;
+                break;
+            }
+            case JSON_EVENT_DONE:
+                return found == wanted_count;
+            case JSON_EVENT_ERROR:
+                return false;
+            default:
+                if (found == wanted_count || match != wanted_path[found] || event != event_of(wanted[found])) {
+                    return false;
+                }
+                found++;
+                break;
+        }
+    }
+}
+
+static void test_paths(arena_t *arena, outstream_t *out) {
+    // the second delta is skipped over, and keys that start the same are different keys
+    strview_t doc = strv(
+        "{\"choices\": [{\"delta\": {\"content\": \"x\", \"contents\": 1}}, {\"delta\": {\"other\": {\"content\": \"no\"}, \"content\": \"y\"}}],"
+        " \"content\": \"top\", \"cont\": [[0, 1], [2, [3, {\"k\\\"ey\": true}]]]}"
+    );
+    const char *path_strs[] = { "choices[1].delta.content", "content", "cont[1][1][1].k\\\"ey", "choices[0].delta.contents", "cont[0]" };
+    json_path_t paths[arrlen(path_strs)];
+    for (usize i = 0; i < arrlen(path_strs); ++i) {
+        paths[i] = json_path_init(arena, strv(path_strs[i]));
+    }
+    json_t *tree = json_parse_str(arena, doc, JSON_DEFAULT);
+    json_t *choices = json_get(arena, tree, strv("choices"));
+    json_t *cont = json_get(arena, tree, strv("cont"));
+    json_t *wanted[] = {
+        json_get(arena, json_get(arena, json_at(arena, choices, 0), strv("delta")), strv("contents")),
+        json_get(arena, json_get(arena, json_at(arena, choices, 1), strv("delta")), strv("content")),
+        json_get(arena, tree, strv("content")),
+        json_at(arena, cont, 0),
+        json_at(arena, json_at(arena, json_at(arena, cont, 1), 1), 1)->object,
+    };
+    int wanted_path[] = { 3, 0, 1, 4, 2 };
+    for (usize size = 1; size <= doc.len; ++size) {
+        if (!same_selection(*arena, doc, size, paths, arrlen(paths), wanted, wanted_path, arrlen(wanted))) {
+            check(false, "json_reader_select with %zu byte chunks", size);
+            break;
+        }
+    }
+
+    // paths of random nodes of random documents
+    int count = test_quick() ? 300 : 3000;
+    usize selected = 0;
+    for (int n = 0; n < count; ++n) {
+        doc = gen_document(out);
+        arena_temp_t temp = arena_temp_begin(arena);
+
+        tree = json_parse_str(arena, doc, JSON_DEFAULT);
+        usize nodes = count_nodes(tree);
+        path_list_t list = {
+            .paths = alloc(arena, str_t, nodes),
+            .nodes = alloc(arena, json_t *, nodes),
+        };
+        collect_paths(arena, &list, tree, STR_EMPTY, true);
+
+        json_path_t random_paths[4];
+        str_t path_text[4];
+        int path_count = 0;
+        for (int tries = 0; tries < 8 && path_count < (int)arrlen(random_paths) && list.count; ++tries) {
+            str_t path = list.paths[test_rand_range(0, list.count)];
+            bool is_new = path.buf != NULL;
+            for (int p = 0; p < path_count && is_new; ++p) {
+                is_new = !strv_equals(strv(path), strv(path_text[p]));
+            }
+            if (is_new) {
+                path_text[path_count] = path;
+                random_paths[path_count++] = json_path_init(arena, strv(path));
+            }
+        }
+
+        json_t **wanted_nodes = alloc(arena, json_t *, list.count + 1);
+        int *wanted_paths = alloc(arena, int, list.count + 1);
+        usize wanted_count = 0;
+        for (usize i = 0; i < list.count; ++i) {
+            for (int p = 0; p < path_count; ++p) {
+                if (list.paths[i].buf && strv_equals(strv(list.paths[i]), strv(path_text[p]))) {
+                    wanted_nodes[wanted_count] = list.nodes[i];
+                    wanted_paths[wanted_count++] = p;
+                    break;
+                }
+            }
+        }
+        selected += wanted_count;
+
+        usize size = test_chance(2) ? doc.len : test_rand_range(1, 16);
+        check(
+            same_selection(*arena, doc, size, random_paths, path_count, wanted_nodes, wanted_paths, wanted_count),
+            "json_reader_select with %zu byte chunks on %v", size, doc
+        );
+
+        arena_temp_end(&temp);
+    }
+    print("%d documents, %zu values selected by path\n", count, selected);
+}
+
+// == TESTS ===========================================
+
+static void test_random_documents(arena_t *arena, outstream_t *out) {
+    int count = test_quick() ? 500 : 5000;
+    for (int n = 0; n < count; ++n) {
+        strview_t doc = gen_document(out);
+        arena_temp_t temp = arena_temp_begin(arena);
+
+        json_t *tree = json_parse_str(arena, doc, JSON_DEFAULT);
+        json_tape_t tape = json_tape_parse(arena, doc, JSON_DEFAULT);
+        check(tree && tape.count, "valid document rejected: %v", doc);
+        if (!tree || !tape.count) {
+            arena_temp_end(&temp);
+            continue;
+        }
+
+        check(same_value(tree, &tape, 0), "tree and tape differ: %v", doc);
+        json_t *from_tape = json_from_tape(arena, &tape);
+        check(same_value(from_tape, &tape, 0), "json_from_tape differs: %v", doc);
+        check(same_lookups(arena, tree) && same_lookups(arena, from_tape), "lookups differ from walking the children: %v", doc);
+
+        events_t expected = {0};
+        events_from_tape(&expected, &tape, 0);
+        // every chunk size for small documents, a few for the others
+        usize step = doc.len < 256 ? 1 : doc.len / 16;
+        for (usize size = 1; size <= doc.len; size += step) {
+            events_t got = events_from_reader(*arena, doc, size);
+            check(
+                got.is_valid && got.hash == expected.hash && got.count == expected.count,
+                "reader with %zu byte chunks differs: %v", size, doc
+            );
+        }
+
+        // anything cut from the end takes the closing bracket with it
+        strview_t cut = strv_trim_right(doc);
+        cut.len -= 1 + test_rand_range(0, cut.len);
+        check(!json_parse_str(arena, cut, JSON_DEFAULT), "tree accepted a truncated document: %v", cut);
+        check(!json_tape_parse(arena, cut, JSON_DEFAULT).count, "tape accepted a truncated document: %v", cut);
+        check(!events_from_reader(*arena, cut, 7).is_valid, "reader accepted a truncated document: %v", cut);
+
+        arena_temp_end(&temp);
+    }
+    print("%d random documents\n", count);
+}
+
+static void bench_big_array(arena_t *arena, outstream_t *out) {
+    strview_t doc = gen_api_array(out, MB(64));
+    print("benchmark on a %_$$$dB array of objects\n", doc.len);
+
+    usize tree_mem = 0, tape_mem = 0, reader_mem = 0;
+    usize events = 0;
+
+    bench("json_parse_str", doc.len, {
+        arena_temp_t temp = arena_temp_begin(arena);
+        check(json_parse_str(arena, doc, JSON_DEFAULT), "big array rejected by json_parse_str");
+        tree_mem = arena_tell(arena) - temp.pos;
+        arena_temp_end(&temp);
+    });
+
+    bench("json_tape_parse", doc.len, {
+        arena_temp_t temp = arena_temp_begin(arena);
+        check(json_tape_parse(arena, doc, JSON_DEFAULT).count, "big array rejected by json_tape_parse");
+        tape_mem = arena_tell(arena) - temp.pos;
+        arena_temp_end(&temp);
+    });
+
+    bench("json_reader_t, 4KB chunks", doc.len, {
+        arena_temp_t temp = arena_temp_begin(arena);
+        events_t ev = events_from_reader(*arena, doc, KB(4));
+        check(ev.is_valid, "big array rejected by json_reader_t");
+        events = ev.count;
+        arena_temp_end(&temp);
+    });
+
+    bench("json_reader_t, one chunk", doc.len, {
+        arena_temp_t temp = arena_temp_begin(arena);
+        check(events_from_reader(*arena, doc, doc.len).is_valid, "big array rejected by json_reader_t");
+        arena_temp_end(&temp);
+    });
+
+    // the reader is passed a copy of the arena, so measure it separately
+    {
+        json_reader_t r = json_reader_init(arena, JSON_DEFAULT);
+        usize start = arena_tell(arena);
+        json_reader_feed(&r, doc, true);
+        while (json_reader_next(&r) < JSON_EVENT_DONE);
+        reader_mem = arena_tell(arena) - start;
+        arena_rewind(arena, start);
+    }
+
+    print("    %zu events, memory: tree %_$$$dB, tape %_$$$dB, reader %_$$$dB\n", events, tree_mem, tape_mem, reader_mem);
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(4));
+    arena_t gen_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    outstream_t out = ostr_init(&gen_arena);
+
+    test_random_documents(&arena, &out);
+    test_big_objects(&arena);
+    test_paths(&arena, &out);
+
+    if (!test_quick()) {
+        bench_big_array(&arena, &out);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,271 @@
+#include "tests.h"
+
+// checks that istr_get_num gives the same double as strtod, bit for bit and with
+// the same length read, and that the integer getters round trip and respect their
+// limits. then compares their speed with the c runtime
+
+// numbers are written in this buffer one after the other, separated by a space
+typedef struct numbers_t numbers_t;
+struct numbers_t {
+    strview_t text;
+    usize count;
+};
+
+typedef enum {
+    NUM_FIXED,   // 12345.678
+    NUM_INT,     // 10 digits
+    NUM_SHORT,   // %.6g
+    NUM_ROUND,   // %.17g, too many digits for the exact path
+    NUM__COUNT,
+} num_style_e;
+
+static double random_double(void) {
+    while (true) {
+        u64 bits = test_rand();
+        double value = 0;
+        memcpy(&value, &bits, sizeof(value));
+        if (!isnan(value) && !isinf(value)) {
+            return value;
+        }
+    }
+}
+
+static void write_number(outstream_t *out, num_style_e style) {
+    switch (style) {
+        case NUM_FIXED: ostr_print(out, "%llu.%03llu", test_rand_range(0, 100000), test_rand_range(0, 1000)); break;
+        case NUM_INT:   ostr_print(out, "%llu", test_rand_range(1000000000ull, 10000000000ull));        break;
+        case NUM_SHORT: ostr_print(out, "%.6g", random_double());                                        break;
+        default:        ostr_print(out, "%.17g", random_double());                                       break;
+    }
+}
+
+static numbers_t make_numbers(outstream_t *out, num_style_e style, usize count) {
+    ostr_clear(out);
+    for (usize i = 0; i < count; ++i) {
+        write_number(out, style);
+        ostr_putc(out, ' ');
+    }
+    return (numbers_t){ ostr_as_view(out), count };
+}
+
+// the text is null terminated by the space after it
+static void check_same_as_strtod(const char *text, usize len) {
+    instream_t in = istr_init(strv(text, len));
+    double got = 0;
+    bool ok = istr_get_num(&in, &got);
+
+    char *end = NULL;
+    double expected = strtod(text, &end);
+
+    check(ok, "istr_get_num rejected %.*s", (int)len, text);
+    check(memcmp(&got, &expected, sizeof(double)) == 0, "%.*s: got %.17g, strtod %.17g", (int)len, text, got, expected);
+    check(in.cur == end, "%.*s: read %zu bytes, strtod %zu", (int)len, text, in.cur - text, end - text);
+}
+
+static void test_random_doubles(outstream_t *out) {
+    int count = test_quick() ? 20000 : 500000;
+    for (int style = 0; style < NUM__COUNT; ++style) {
+        for (int i = 0; i < count; ++i) {
+            ostr_clear(out);
+            // random doubles already have a sign, the others get one sometimes
+            if (style < NUM_SHORT && test_chance(4)) ostr_putc(out, '-');
+            write_number(out, style);
+            if (test_chance(8)) ostr_print(out, "e%d", (int)test_rand_range(0, 60) - 30);
+            ostr_putc(out, '\0');
+            strview_t text = ostr_as_view(out);
+            check_same_as_strtod(text.buf, text.len - 1);
+        }
+    }
+    print("%d random doubles\n", count * NUM__COUNT);
+}
+
+// 19 digit mantissas with any exponent that doesn't overflow, and the digits of the point halfway between
+// two doubles, cut to 19 digits and nudged by one. those are the ones eisel-lemire
+// can't always decide
+static void test_long_mantissas(outstream_t *out) {
+    int count = test_quick() ? 20000 : 1000000;
+    for (int i = 0; i < count; ++i) {
+        ostr_clear(out);
+        if (test_chance(2)) {
+            u64 mantissa = test_rand_range(1000000000000000000ull, 10000000000000000000ull);
+            ostr_print(out, "%llue%d", mantissa, (int)test_rand_range(0, 650) - 360);
+        }
+        else {
+            double value = fabs(random_double());
+            double next = nextafter(value, INFINITY);
+            long double half = ((long double)value + (long double)next) / 2;
+            char digits[64];
+            fmt_buffer(digits, sizeof(digits), "%.18Le", half);
+            // d.dddddddddddddddddde[+-]x, without the point it's a 19 digit integer
+            char *e = strchr(digits, 'e');
+            u64 mantissa = (u64)(digits[0] - '0');
+            for (char *c = digits + 2; c < e; ++c) mantissa = mantissa * 10 + (u64)(*c - '0');
+            mantissa += (u64)test_rand_range(0, 3) - 1;
+            ostr_print(out, "%llue%d", mantissa, atoi(e + 1) - 18);
+        }
+        ostr_putc(out, '\0');
+        strview_t text = ostr_as_view(out);
+        check_same_as_strtod(text.buf, text.len - 1);
+    }
+    print("%d numbers with 19 digits\n", count);
+}
+
+static void test_edge_doubles(arena_t *arena) {
+    const char *cases[] = {
+        "0", "-0", "0.0", "1", "-1", ".5", "5.", "+7", "  12", "1e", "1e+", "2e-", "3.e2", "0x1p-2", "0X10",
+        "0.1", "0.3", "1e22", "1e23", "-1e-22", "9007199254740992", "9007199254740993", "18446744073709551615",
+        "123456789012345678901234567890", "4.9e-324", "2.4703282292062328e-324", "1e-400",
+        "2.2250738585072011e-308", "2.2250738585072014e-308", "1.7976931348623157e308",
+        "0.000000000000000000000000000000000000000000001", "100000000000000000000000", "nan", "-nan(123)",
+        "1.5,", "2]", "3}", "4 5",
+    };
+    for (usize i = 0; i < arrlen(cases); ++i) {
+        check_same_as_strtod(cases[i], strlen(cases[i]));
+    }
+
+    // longer than the stack buffer of the strtod fallback
+    strview_t longest = STRV_EMPTY;
+    for (usize len = 500; len <= 5000; len += 500) {
+        char *text = alloc(arena, char, len + 8);
+        memset(text, '1', len);
+        memcpy(text + len / 2, ".25", 3);
+        memcpy(text + len, "e-4990", 7);
+        check_same_as_strtod(text, len + 6);
+        longest = strv(text, len + 6);
+    }
+
+    // the fallback takes a scratch arena for those, not the one the json is going in
+    arena_temp_t scratch = scratch_begin();
+    arena_t copy = *scratch.arena;
+    str_t doc = str_fmt(arena, "[\"first\", %v, \"last\"]", longest);
+    json_t *root = json_parse_str(&copy, strv(doc), 0);
+    json_t *first = root ? json_at(NULL, root, 0) : NULL;
+    check(first && first->type == JSON_STRING && strv_equals(first->string, strv("first")), "a long number overwrote the json before it");
+    scratch_end(&scratch);
+}
+
+static void test_integers(void) {
+    int count = test_quick() ? 20000 : 1000000;
+    char buf[64];
+    for (int i = 0; i < count; ++i) {
+        i64 value = (i64)test_rand() >> test_rand_range(0, 63);
+        usize len = fmt_buffer(buf, sizeof(buf), "%lld", value);
+        instream_t in = istr_init(strv(buf, len));
+        i64 got = 0;
+        check(istr_get_i64(&in, &got) && got == value && istr_is_finished(&in), "i64 %lld came back as %lld", value, got);
+
+        u64 uvalue = test_rand() >> test_rand_range(0, 63);
+        len = fmt_buffer(buf, sizeof(buf), "%llu", uvalue);
+        in = istr_init(strv(buf, len));
+        u64 ugot = 0;
+        check(istr_get_u64(&in, &ugot) && ugot == uvalue && istr_is_finished(&in), "u64 %llu came back as %llu", uvalue, ugot);
+    }
+    print("%d random integers\n", count * 2);
+
+    #define check_int(type, text, expect_ok, expected) do { \
+            instream_t in = istr_init(strv(text)); \
+            type got = 0; \
+            bool ok = istr_get_##type(&in, &got); \
+            check(ok == (expect_ok) && (!ok || got == (type)(expected)), #type " " text ": ok %d, got %lld", ok, (long long)got); \
+        } while (0)
+
+    check_int(u8, "0", true, 0);
+    check_int(u8, "255", true, 255);
+    check_int(u8, "256", false, 0);
+    check_int(u16, "65535", true, 65535);
+    check_int(u16, "65536", false, 0);
+    check_int(u32, "4294967295", true, 4294967295u);
+    check_int(u32, "4294967296", false, 0);
+    check_int(u64, "18446744073709551615", true, UINT64_MAX);
+    check_int(u64, "18446744073709551616", false, 0);
+    check_int(u64, "-5", false, 0);
+    check_int(i32, "-2147483648", true, INT32_MIN);
+    check_int(i32, "2147483648", false, 0);
+    check_int(i64, "9223372036854775807", true, INT64_MAX);
+    check_int(i64, "-9223372036854775808", true, INT64_MIN);
+    check_int(i64, "9223372036854775808", false, 0);
+    check_int(i64, "0x7f", true, 127);
+    check_int(i64, "010", true, 10);
+
+    #undef check_int
+}
+
+static void bench_numbers(outstream_t *out) {
+    usize count = 1000000;
+    const char *names[] = { "12345.678", "10 digit ints", "%.6g", "%.17g" };
+
+    for (int style = 0; style < NUM__COUNT; ++style) {
+        numbers_t numbers = make_numbers(out, style, count);
+        print("%zu numbers like %s\n", count, names[style]);
+
+        // the sum keeps the compiler from dropping the loops
+        double sum = 0, expected = 0;
+
+        bench("istr_get_num", numbers.text.len, {
+            instream_t in = istr_init(numbers.text);
+            sum = 0;
+            for (usize i = 0; i < numbers.count; ++i) {
+                double value = 0;
+                istr_get_num(&in, &value);
+                sum += value;
+            }
+        });
+
+        bench("strtod", numbers.text.len, {
+            const char *cur = numbers.text.buf;
+            expected = 0;
+            for (usize i = 0; i < numbers.count; ++i) {
+                char *end = NULL;
+                expected += strtod(cur, &end);
+                cur = end;
+            }
+        });
+
+        check(memcmp(&sum, &expected, sizeof(double)) == 0, "the sums of the %s numbers differ", names[style]);
+
+        if (style == NUM_INT) {
+            u64 usum = 0, uexpected = 0;
+            bench("istr_get_u64", numbers.text.len, {
+                instream_t in = istr_init(numbers.text);
+                usum = 0;
+                for (usize i = 0; i < numbers.count; ++i) {
+                    u64 value = 0;
+                    istr_get_u64(&in, &value);
+                    istr_skip_whitespace(&in);
+                    usum += value;
+                }
+            });
+
+            bench("strtoull", numbers.text.len, {
+                const char *cur = numbers.text.buf;
+                uexpected = 0;
+                for (usize i = 0; i < numbers.count; ++i) {
+                    char *end = NULL;
+                    uexpected += strtoull(cur, &end, 10);
+                    cur = end;
+                }
+            });
+
+            check(usum == uexpected, "the sums of the integers differ");
+        }
+    }
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    arena_t gen_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    outstream_t out = ostr_init(&gen_arena);
+
+    test_random_doubles(&out);
+    test_long_mantissas(&out);
+    test_edge_doubles(&arena);
+    test_integers();
+
+    if (!test_quick()) {
+        bench_numbers(&out);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,229 @@
+#include "tests.h"
+
+// checks that pools and slabs never hand out the same memory twice, also when
+// objects are freed from another thread, then times them against malloc and
+// against a free list written by hand on top of an arena
+
+typedef struct object_t object_t;
+struct object_t {
+    u64 id;
+    u8 data[40];
+};
+
+static void test_pool(arena_t *arena) {
+    pool_t pool = pool_make(arena, object_t);
+    usize slots = 4096;
+    object_t **live = alloc(arena, object_t *, slots);
+    int ops = test_quick() ? 200000 : 2000000;
+    usize live_count = 0, peak = 0;
+    usize arena_start = arena_tell(arena);
+
+    for (int i = 0; i < ops; ++i) {
+        usize s = test_rand_range(0, slots);
+        if (live[s]) {
+            object_t *obj = live[s];
+            bool intact = obj->id == s + 1;
+            for (usize b = 0; b < sizeof(obj->data); ++b) intact = intact && obj->data[b] == (u8)(s + b);
+            check(intact, "object %zu was overwritten", s);
+            pool_free(&pool, obj);
+            live[s] = NULL;
+            live_count--;
+        }
+        else {
+            bool zeroed = test_chance(2);
+            object_t *obj = zeroed ? pool_alloc(&pool) : pool_alloc(&pool, ALLOC_NOZERO);
+            check(!zeroed || (obj->id == 0 && obj->data[39] == 0), "object %zu was not zeroed", s);
+            check(((uptr)obj % alignof(object_t)) == 0, "object %zu is not aligned", s);
+            obj->id = s + 1;
+            for (usize b = 0; b < sizeof(obj->data); ++b) obj->data[b] = (u8)(s + b);
+            live[s] = obj;
+            live_count++;
+            peak = MAX(peak, live_count);
+        }
+        if (test__state.failed) break;
+    }
+
+    // freed objects are reused, so the pool never needs more than the peak
+    usize used = arena_tell(arena) - arena_start;
+    usize bound = (peak + COLLA_POOL_BLOCK_SIZE / sizeof(object_t)) * sizeof(object_t) + COLLA_POOL_BLOCK_SIZE;
+    check(used <= bound, "the pool used %zu bytes for %zu objects", used, peak);
+    print("pool: %d operations, at most %zu objects, %zu bytes used\n", ops, peak, used);
+}
+
+static void test_slab(arena_t *arena) {
+    slab_t slab = slab_init(arena);
+    usize slots = 2048;
+    u8 **live = alloc(arena, u8 *, slots);
+    usize *sizes = alloc(arena, usize, slots);
+    int ops = test_quick() ? 100000 : 1000000;
+
+    for (int i = 0; i < ops; ++i) {
+        usize s = test_rand_range(0, slots);
+        if (live[s]) {
+            bool intact = true;
+            for (usize b = 0; b < sizes[s]; ++b) intact = intact && live[s][b] == (u8)(s ^ b);
+            check(intact, "slab object %zu of %zu bytes was overwritten", s, sizes[s]);
+            slab_free(&slab, live[s], sizes[s]);
+            live[s] = NULL;
+        }
+        else {
+            // mostly small, sometimes bigger than the biggest class
+            usize size = test_chance(50) ? test_rand_range(4097, 9000) : test_rand_range(1, 4097);
+            u8 *ptr = slab_alloc(&slab, size);
+            bool zeroed = true;
+            for (usize b = 0; b < size; ++b) zeroed = zeroed && ptr[b] == 0;
+            check(zeroed, "slab object of %zu bytes was not zeroed", size);
+            for (usize b = 0; b < size; ++b) ptr[b] = (u8)(s ^ b);
+            live[s] = ptr;
+            sizes[s] = size;
+        }
+        if (test__state.failed) break;
+    }
+    print("slab: %d operations\n", ops);
+}
+
+// single producer, single consumer ring of objects to free
+#define RING_SIZE 1024
+
+typedef struct remote_t remote_t;
+struct remote_t {
+    slab_t *slab;
+    void *ring[RING_SIZE];
+    usize sizes[RING_SIZE];
+    i64 head; // written by the owner
+    i64 tail; // written by the other thread
+    i64 bad;
+    usize count;
+};
+
+static int remote_free_thread(u64 thread_id, void *userdata) {
+    COLLA_UNUSED(thread_id);
+    remote_t *r = userdata;
+    for (usize i = 0; i < r->count; ++i) {
+        while (atomic_get_i64(&r->tail) == atomic_get_i64(&r->head)) {}
+        usize slot = (usize)atomic_get_i64(&r->tail) % RING_SIZE;
+        u8 *ptr = r->ring[slot];
+        usize size = r->sizes[slot];
+        for (usize b = 0; b < size; ++b) {
+            if (ptr[b] != (u8)(size + b)) {
+                atomic_inc_i64(&r->bad);
+                break;
+            }
+        }
+        slab_free_remote(r->slab, ptr, size);
+        atomic_inc_i64(&r->tail);
+    }
+    return 0;
+}
+
+static void test_remote_free(arena_t *arena) {
+    slab_t slab = slab_init(arena);
+    remote_t *r = alloc(arena, remote_t);
+    r->slab = &slab;
+    r->count = test_quick() ? 50000 : 200000;
+    usize arena_start = arena_tell(arena);
+
+    oshandle_t thread = os_thread_launch(remote_free_thread, r);
+    for (usize i = 0; i < r->count; ++i) {
+        while (atomic_get_i64(&r->head) - atomic_get_i64(&r->tail) == RING_SIZE) {}
+        usize size = (usize)16 << test_rand_range(0, 5);
+        u8 *ptr = slab_alloc(&slab, size);
+        for (usize b = 0; b < size; ++b) ptr[b] = (u8)(size + b);
+        usize slot = (usize)atomic_get_i64(&r->head) % RING_SIZE;
+        r->ring[slot] = ptr;
+        r->sizes[slot] = size;
+        atomic_inc_i64(&r->head);
+    }
+    os_thread_join(thread, NULL);
+
+    usize used = arena_tell(arena) - arena_start;
+    check(atomic_get_i64(&r->bad) == 0, "%lld objects were changed before they were freed", atomic_get_i64(&r->bad));
+    // without the remote frees this would be around 60MB
+    check(used < MB(4), "the slab used %zu bytes with remote frees", used);
+    print("remote frees: %zu objects from 16 to 256 bytes, %zu bytes used\n", r->count, used);
+}
+
+typedef struct free_node_t free_node_t;
+struct free_node_t {
+    free_node_t *next;
+};
+
+static void bench_pool(arena_t *arena) {
+    usize count = 20000000;
+    usize batch = 64;
+    usize total = 0, expected = 0;
+    object_t *objects[64];
+    print("%zu allocs and frees of %zu bytes, %zu at a time\n", count, sizeof(object_t), batch);
+
+    bench("pool_alloc/pool_free", 0, {
+        arena_t scratch = *arena;
+        pool_t pool = pool_make(&scratch, object_t);
+        total = 0;
+        for (usize i = 0; i < count; i += batch) {
+            for (usize b = 0; b < batch; ++b) objects[b] = pool_alloc(&pool);
+            for (usize b = 0; b < batch; ++b) total += (uptr)objects[b] & 0xFF;
+            for (usize b = 0; b < batch; ++b) pool_free(&pool, objects[b]);
+        }
+    });
+
+    bench("pool_alloc(ALLOC_NOZERO)/pool_free", 0, {
+        arena_t scratch = *arena;
+        pool_t pool = pool_make(&scratch, object_t);
+        total = 0;
+        for (usize i = 0; i < count; i += batch) {
+            for (usize b = 0; b < batch; ++b) objects[b] = pool_alloc(&pool, ALLOC_NOZERO);
+            for (usize b = 0; b < batch; ++b) total += (uptr)objects[b] & 0xFF;
+            for (usize b = 0; b < batch; ++b) pool_free(&pool, objects[b]);
+        }
+    });
+
+    // what a caller would write without a pool: one object at a time from the arena
+    bench("arena + free list", 0, {
+        arena_t scratch = *arena;
+        free_node_t *free_list = NULL;
+        expected = 0;
+        for (usize i = 0; i < count; i += batch) {
+            for (usize b = 0; b < batch; ++b) {
+                if (free_list) {
+                    objects[b] = (object_t *)free_list;
+                    free_list = free_list->next;
+                }
+                else {
+                    objects[b] = alloc(&scratch, object_t, 1, ALLOC_NOZERO);
+                }
+            }
+            for (usize b = 0; b < batch; ++b) expected += (uptr)objects[b] & 0xFF;
+            for (usize b = 0; b < batch; ++b) {
+                free_node_t *node = (free_node_t *)objects[b];
+                node->next = free_list;
+                free_list = node;
+            }
+        }
+    });
+
+    bench("malloc/free", 0, {
+        for (usize i = 0; i < count; i += batch) {
+            for (usize b = 0; b < batch; ++b) objects[b] = malloc(sizeof(object_t));
+            for (usize b = 0; b < batch; ++b) expected += (uptr)objects[b] & 0xFF;
+            for (usize b = 0; b < batch; ++b) free(objects[b]);
+        }
+    });
+    COLLA_UNUSED(expected);
+    check(total > 0, "the pool benchmark did nothing");
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_pool(&arena);
+    test_slab(&arena);
+    test_remote_free(&arena);
+
+    if (!test_quick()) {
+        bench_pool(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,372 @@
+#include "tests.h"
+
+// checks rg_match against a backtracking matcher on random patterns and texts,
+// then the literal prefilter, patterns that need more dfa states than the cache
+// has and patterns that are too big. then times a few searches over lines of text
+
+typedef enum {
+    PAT_CHAR,   // c
+    PAT_ANY,    // .
+    PAT_CLASS,  // set of a b c, maybe negated
+    PAT_BOL,
+    PAT_EOL,
+    PAT_CAT,
+    PAT_ALT,
+    PAT_REPEAT,
+} pat_type_e;
+
+typedef struct pat_t pat_t;
+struct pat_t {
+    pat_type_e type;
+    char c;
+    u8 set;      // bit 0 = a, 1 = b, 2 = c
+    bool negate;
+    int min, max; // max -1 is unbounded
+    pat_t *left, *right;
+};
+
+static pat_t *pat_new(arena_t *arena, pat_type_e type) {
+    pat_t *p = alloc(arena, pat_t);
+    p->type = type;
+    return p;
+}
+
+static pat_t *pat_random(arena_t *arena, int depth) {
+    u64 r = test_rand_range(0, depth > 0 ? 10 : 5);
+    pat_t *p = NULL;
+    switch (r) {
+        case 0: case 1:
+            p = pat_new(arena, PAT_CHAR);
+            p->c = (char)('a' + test_rand_range(0, 3));
+            break;
+        case 2:
+            p = pat_new(arena, PAT_ANY);
+            break;
+        case 3:
+            p = pat_new(arena, PAT_CLASS);
+            p->set = (u8)test_rand_range(1, 8);
+            p->negate = test_chance(3);
+            break;
+        case 4:
+            p = pat_new(arena, test_chance(2) ? PAT_BOL : PAT_EOL);
+            break;
+        case 5: case 6:
+            p = pat_new(arena, PAT_CAT);
+            p->left = pat_random(arena, depth - 1);
+            p->right = pat_random(arena, depth - 1);
+            break;
+        case 7:
+            p = pat_new(arena, PAT_ALT);
+            p->left = pat_random(arena, depth - 1);
+            p->right = pat_random(arena, depth - 1);
+            break;
+        default:
+        {
+            p = pat_new(arena, PAT_REPEAT);
+            do {
+                p->left = pat_random(arena, depth - 1);
+            } while (p->left->type == PAT_BOL || p->left->type == PAT_EOL);
+            switch (test_rand_range(0, 6)) {
+                case 0: p->min = 0; p->max = -1; break;
+                case 1: p->min = 1; p->max = -1; break;
+                case 2: p->min = 0; p->max = 1;  break;
+                case 3: p->min = p->max = (int)test_rand_range(0, 4); break;
+                case 4: p->min = (int)test_rand_range(0, 3); p->max = -1; break;
+                default:
+                    p->min = (int)test_rand_range(0, 3);
+                    p->max = p->min + (int)test_rand_range(0, 3);
+                    break;
+            }
+            break;
+        }
+    }
+    return p;
+}
+
+static void pat_print(outstream_t *out, pat_t *p) {
+    switch (p->type) {
+        case PAT_CHAR:  ostr_putc(out, p->c); break;
+        case PAT_ANY:   ostr_putc(out, '.'); break;
+        case PAT_BOL:   ostr_putc(out, '^'); break;
+        case PAT_EOL:   ostr_putc(out, '$'); break;
+        case PAT_CLASS:
+            ostr_puts(out, strv(p->negate ? "[^" : "["));
+            for (int i = 0; i < 3; ++i) {
+                if (p->set & (1 << i)) ostr_putc(out, (char)('a' + i));
+            }
+            ostr_putc(out, ']');
+            break;
+        case PAT_CAT:
+            pat_print(out, p->left);
+            pat_print(out, p->right);
+            break;
+        case PAT_ALT:
+            ostr_putc(out, '(');
+            pat_print(out, p->left);
+            ostr_putc(out, '|');
+            pat_print(out, p->right);
+            ostr_putc(out, ')');
+            break;
+        case PAT_REPEAT:
+        {
+            bool atom = p->left->type == PAT_CHAR || p->left->type == PAT_ANY || p->left->type == PAT_CLASS;
+            if (!atom) ostr_putc(out, '(');
+            pat_print(out, p->left);
+            if (!atom) ostr_putc(out, ')');
+            if (p->min == 0 && p->max == -1)     ostr_putc(out, '*');
+            else if (p->min == 1 && p->max == -1) ostr_putc(out, '+');
+            else if (p->min == 0 && p->max == 1)  ostr_putc(out, '?');
+            else if (p->max == -1)                ostr_print(out, "{%d,}", p->min);
+            else if (p->min == p->max)            ostr_print(out, "{%d}", p->min);
+            else                                  ostr_print(out, "{%d,%d}", p->min, p->max);
+            // lazy quantifiers match the same texts
+            if (test_chance(6)) ostr_putc(out, '?');
+            break;
+        }
+    }
+}
+
+// backtracking reference, cont is called with every position where p can end
+typedef struct ref_cont_t ref_cont_t;
+struct ref_cont_t {
+    bool (*fn)(ref_cont_t *k, usize pos);
+    pat_t *p;
+    int count;
+    usize start;
+    ref_cont_t *next;
+};
+
+static strview_t ref_text = {0};
+
+static bool ref_match(pat_t *p, usize pos, ref_cont_t *k);
+
+static bool ref_accept(ref_cont_t *k, usize pos) {
+    COLLA_UNUSED(k); COLLA_UNUSED(pos);
+    return true;
+}
+
+static bool ref_cat_right(ref_cont_t *k, usize pos) {
+    return ref_match(k->p->right, pos, k->next);
+}
+
+static bool ref_repeat(pat_t *p, int count, usize pos, ref_cont_t *k);
+
+static bool ref_repeat_next(ref_cont_t *k, usize pos) {
+    // an iteration that matched nothing can't make progress
+    if (pos == k->start && k->count > k->p->min) {
+        return false;
+    }
+    return ref_repeat(k->p, k->count, pos, k->next);
+}
+
+static bool ref_repeat(pat_t *p, int count, usize pos, ref_cont_t *k) {
+    if (p->max < 0 || count < p->max) {
+        ref_cont_t again = { ref_repeat_next, p, count + 1, pos, k };
+        if (ref_match(p->left, pos, &again)) {
+            return true;
+        }
+    }
+    return count >= p->min && k->fn(k, pos);
+}
+
+static bool ref_match(pat_t *p, usize pos, ref_cont_t *k) {
+    switch (p->type) {
+        case PAT_CHAR:
+            return pos < ref_text.len && ref_text.buf[pos] == p->c && k->fn(k, pos + 1);
+        case PAT_ANY:
+            return pos < ref_text.len && ref_text.buf[pos] != '\n' && k->fn(k, pos + 1);
+        case PAT_CLASS:
+        {
+            if (pos >= ref_text.len) return false;
+            char c = ref_text.buf[pos];
+            bool in = c >= 'a' && c <= 'c' && (p->set & (1 << (c - 'a')));
+            return in != p->negate && k->fn(k, pos + 1);
+        }
+        case PAT_BOL:
+            return pos == 0 && k->fn(k, pos);
+        case PAT_EOL:
+            return pos == ref_text.len && k->fn(k, pos);
+        case PAT_CAT:
+        {
+            ref_cont_t right = { ref_cat_right, p, 0, 0, k };
+            return ref_match(p->left, pos, &right);
+        }
+        case PAT_ALT:
+            return ref_match(p->left, pos, k) || ref_match(p->right, pos, k);
+        case PAT_REPEAT:
+            return ref_repeat(p, 0, pos, k);
+    }
+    return false;
+}
+
+static bool ref_search(pat_t *p, strview_t text) {
+    ref_text = text;
+    ref_cont_t accept = { ref_accept };
+    for (usize start = 0; start <= text.len; ++start) {
+        if (ref_match(p, start, &accept)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static void test_random_patterns(arena_t *arena) {
+    int patterns = test_quick() ? 2000 : 20000;
+    int texts = 20;
+    char text_buf[24];
+
+    for (int i = 0; i < patterns; ++i) {
+        arena_t scratch = *arena;
+        pat_t *pat = pat_random(&scratch, 4);
+        outstream_t out = ostr_init(&scratch);
+        pat_print(&out, pat);
+        strview_t source = ostr_as_view(&out);
+
+        rg_t *rg = rg_compile(&scratch, source, RG_DEFAULT);
+        check(rg != NULL, "%v did not compile", source);
+        if (!rg) continue;
+        rg_cache_t *cache = rg_cache_init(&scratch, rg);
+
+        for (int t = 0; t < texts; ++t) {
+            usize len = test_rand_range(0, sizeof(text_buf));
+            for (usize j = 0; j < len; ++j) {
+                text_buf[j] = test_chance(12) ? '\n' : (char)('a' + test_rand_range(0, test_chance(4) ? 4 : 3));
+            }
+            strview_t text = strv(text_buf, len);
+            bool expected = ref_search(pat, text);
+            bool got = rg_match(cache, text);
+            if (got != expected) {
+                check(false, "%v on \"%v\": got %d, expected %d", source, text, got, expected);
+                break;
+            }
+        }
+    }
+    print("%d random patterns, %d texts each\n", patterns, texts);
+}
+
+static void test_samples(arena_t *arena) {
+    struct {
+        const char *pattern;
+        rg_flags_e flags;
+        const char *text;
+        bool expected;
+    } samples[] = {
+        // the prefilter looks for "needle" first
+        { "ne+dle\\d+",        RG_DEFAULT,     "a needle42 in a haystack", true },
+        { "ne+dle\\d+",        RG_DEFAULT,     "a needle in a haystack",   false },
+        { "(foo|bar)baz",      RG_DEFAULT,     "xxbarbaz",                 true },
+        { "(foo|bar)baz",      RG_DEFAULT,     "xxbazbar",                 false },
+        { "(?:foo|bar)+$",     RG_DEFAULT,     "foobarfoo",                true },
+        { "^\\w+@\\w+\\.com$", RG_DEFAULT,     "me@example.com",           true },
+        { "^\\w+@\\w+\\.com$", RG_DEFAULT,     "me@example.com.au",        false },
+        { "HELLO world",       RG_IGNORE_CASE, "say Hello World!",         true },
+        { "[A-F]{2}",          RG_IGNORE_CASE, "0xbe",                     true },
+        { "a{3}",              RG_DEFAULT,     "aab",                      false },
+        { "a{2,3}b",           RG_DEFAULT,     "caaab",                    true },
+        { "x{0}y",             RG_DEFAULT,     "y",                        true },
+        { "a.c",               RG_DEFAULT,     "a\nc",                     false },
+        { "\\s\\S\\s",         RG_DEFAULT,     "a b c",                    true },
+        { "[^\\d]+",           RG_DEFAULT,     "123",                      false },
+        { "a{",                RG_DEFAULT,     "a{",                       true },
+        { "^$",                RG_DEFAULT,     "",                         true },
+    };
+
+    for (usize i = 0; i < arrlen(samples); ++i) {
+        arena_t scratch = *arena;
+        rg_t *rg = rg_compile(&scratch, strv(samples[i].pattern), samples[i].flags);
+        bool got = rg_match(rg_cache_init(&scratch, rg), strv(samples[i].text));
+        check(got == samples[i].expected, "%s on \"%s\": got %d", samples[i].pattern, samples[i].text, got);
+    }
+
+    const char *invalid[] = {
+        "(a", "a)", "[ab", "*a", "a{5,2}", "a{1001}", "\\",
+        // these used to overflow the size count
+        "((a{1000}){1000}){1000}",
+        "(((((a{100}){100}){100}){100}){100}){100}",
+        "((a{1000,}){1000,}){1000,}",
+    };
+    for (usize i = 0; i < arrlen(invalid); ++i) {
+        arena_t scratch = *arena;
+        check(rg_compile(&scratch, strv(invalid[i]), RG_DEFAULT) == NULL, "%s compiled", invalid[i]);
+    }
+}
+
+// a[ab]{11}c needs about 2^12 dfa states, more than the cache keeps
+static void test_cache_flush(arena_t *arena) {
+    rg_t *rg = rg_compile(arena, strv("a[ab]{11}c"), RG_DEFAULT);
+    rg_cache_t *cache = rg_cache_init(arena, rg);
+
+    int count = test_quick() ? 50 : 500;
+    usize len = 3000;
+    char *text = alloc(arena, char, len);
+    int matches = 0;
+
+    for (int i = 0; i < count; ++i) {
+        for (usize j = 0; j < len; ++j) {
+            text[j] = test_chance(2000) ? 'c' : (char)('a' + test_rand_range(0, 2));
+        }
+        // the match is near the end half of the times
+        usize cut = test_chance(2) ? len : test_rand_range(len / 2, len);
+        strview_t view = strv(text, cut);
+
+        bool expected = false;
+        for (usize j = 0; j + 12 < view.len && !expected; ++j) {
+            if (view.buf[j] != 'a' || view.buf[j + 12] != 'c') continue;
+            expected = true;
+            for (usize k = 1; k < 12; ++k) {
+                expected = expected && view.buf[j + k] != 'c';
+            }
+        }
+
+        bool got = rg_match(cache, view);
+        check(got == expected, "a[ab]{11}c on text %d: got %d, expected %d", i, got, expected);
+        matches += expected;
+    }
+    print("%d texts that fill the dfa cache, %d matches\n", count, matches);
+}
+
+static void bench_regex(arena_t *arena) {
+    usize len = MB(64);
+    char *text = alloc(arena, char, len, ALLOC_NOZERO);
+    for (usize i = 0; i < len; ++i) {
+        u64 r = test_rand_range(0, 60);
+        text[i] = r == 0 ? '\n' : r < 10 ? ' ' : (char)('a' + r % 26);
+    }
+
+    const char *patterns[] = {
+        "needle",          // only the prefilter
+        "ab[cd]+e",        // short literal, the dfa runs on most lines
+        "^[a-z]+ [a-z]+$", // no literal
+    };
+
+    print("64MB of text, matched line by line\n");
+    for (usize p = 0; p < arrlen(patterns); ++p) {
+        rg_cache_t *cache = rg_cache_init(arena, rg_compile(arena, strv(patterns[p]), RG_DEFAULT));
+        usize matches = 0;
+        bench(patterns[p], len, {
+            instream_t in = istr_init(strv(text, len));
+            matches = 0;
+            while (!istr_is_finished(&in)) {
+                strview_t line = istr_get_line(&in);
+                matches += rg_match(cache, line);
+            }
+        });
+        print("    %zu matching lines\n", matches);
+    }
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+
+    test_samples(&arena);
+    test_random_patterns(&arena);
+    test_cache_flush(&arena);
+
+    if (!test_quick()) {
+        bench_regex(&arena);
+    }
+
+    return test_end();
+}
@@ -0,0 +1,245 @@
+#include "tests.h"
+
+// checks the scan kernels and the searcher against plain loops, with every
+// kernel set the cpu supports, then times them on a big text
+
+static const char *isa_names[] = { "scalar", "sse2", "avx2" };
+
+static usize ref_find(strview_t ctx, char c) {
+    for (usize i = 0; i < ctx.len; ++i) {
+        if (ctx.buf[i] == c) return i;
+    }
+    return STR_NONE;
+}
+
+static usize ref_rfind(strview_t ctx, char c) {
+    for (usize i = ctx.len; i > 0; --i) {
+        if (ctx.buf[i - 1] == c) return i - 1;
+    }
+    return STR_NONE;
+}
+
+static usize ref_count(strview_t ctx, char c) {
+    usize count = 0;
+    for (usize i = 0; i < ctx.len; ++i) {
+        count += ctx.buf[i] == c;
+    }
+    return count;
+}
+
+static usize ref_find_nth(strview_t ctx, char c, usize n) {
+    for (usize i = 0; i < ctx.len && n; ++i) {
+        if (ctx.buf[i] == c && --n == 0) return i;
+    }
+    return STR_NONE;
+}
+
+static usize ref_rfind_nth(strview_t ctx, char c, usize n) {
+    for (usize i = ctx.len; i > 0 && n; --i) {
+        if (ctx.buf[i - 1] == c && --n == 0) return i - 1;
+    }
+    return STR_NONE;
+}
+
+static usize ref_find_view(strview_t ctx, strview_t view, usize from) {
+    if (from > ctx.len) return STR_NONE;
+    for (usize i = from; i + view.len <= ctx.len; ++i) {
+        if (memcmp(ctx.buf + i, view.buf, view.len) == 0) return i;
+    }
+    return STR_NONE;
+}
+
+static usize ref_rfind_view(strview_t ctx, strview_t view, usize from_right) {
+    if (ctx.len == 0) return STR_NONE;
+    usize end = ctx.len - MIN(from_right, ctx.len);
+    if (end < view.len) return STR_NONE;
+    for (usize i = end - view.len + 1; i > 0; --i) {
+        if (memcmp(ctx.buf + i - 1, view.buf, view.len) == 0) return i - 1;
+    }
+    return STR_NONE;
+}
+
+// few different bytes, so there are lots of matches and near matches
+static void fill_random(char *buf, usize len, usize alphabet) {
+    for (usize i = 0; i < len; ++i) {
+        buf[i] = (char)('a' + test_rand_range(0, alphabet));
+    }
+}
+
+static void test_bytes(arena_t *arena, scan_isa_e isa) {
+    usize max_len = test_quick() ? 200 : 600;
+    char *buf = alloc(arena, char, max_len + 64);
+
+    for (usize len = 0; len <= max_len; ++len) {
+        // every alignment in a cache line
+        usize offset = len % 64;
+        fill_random(buf + offset, len, test_chance(2) ? 4 : 40);
+        strview_t ctx = strv(buf + offset, len);
+        char c = (char)('a' + test_rand_range(0, 4));
+
+        check(scan_find(ctx, c) == ref_find(ctx, c), "%s find len %zu", isa_names[isa], len);
+        check(scan_rfind(ctx, c) == ref_rfind(ctx, c), "%s rfind len %zu", isa_names[isa], len);
+        check(scan_count(ctx, c) == ref_count(ctx, c), "%s count len %zu", isa_names[isa], len);
+
+        usize n = test_rand_range(0, len / 2 + 2);
+        check(scan_find_nth(ctx, c, n) == ref_find_nth(ctx, c, n), "%s find_nth %zu len %zu", isa_names[isa], n, len);
+        check(scan_rfind_nth(ctx, c, n) == ref_rfind_nth(ctx, c, n), "%s rfind_nth %zu len %zu", isa_names[isa], n, len);
+
+        scan_iter_t it = scan_iter_init(ctx, c);
+        usize pos = 0, expected = 0, matches = 0;
+        bool same = true;
+        while (scan_iter_next(&it, &pos)) {
+            expected = ref_find_view(ctx, strv(&c, 1), matches ? expected + 1 : 0);
+            same = same && pos == expected;
+            matches++;
+        }
+        check(same && matches == ref_count(ctx, c), "%s iter len %zu", isa_names[isa], len);
+    }
+}
+
+static void test_search(arena_t *arena, scan_isa_e isa) {
+    int count = test_quick() ? 5000 : 100000;
+    // some longer than COLLA_SEARCH_SKIP_TABLE_MIN_TEXT, where strv_find_view can build a searcher
+    usize max_len = COLLA_SEARCH_SKIP_TABLE_MIN_TEXT * 2;
+    char *hay = alloc(arena, char, max_len);
+    char needle_buf[100];
+
+    for (int i = 0; i < count; ++i) {
+        usize len = test_rand_range(0, test_chance(8) ? max_len : 1000);
+        usize alphabet = test_chance(2) ? 2 : 26;
+        fill_random(hay, len, alphabet);
+        strview_t ctx = strv(hay, len);
+
+        // on both sides of COLLA_SEARCH_SKIP_TABLE_LEN
+        usize nlen = test_rand_range(0, arrlen(needle_buf));
+        if (len > nlen && test_chance(2)) {
+            memcpy(needle_buf, hay + test_rand_range(0, len - nlen), nlen);
+        }
+        else {
+            fill_random(needle_buf, nlen, alphabet);
+        }
+        strview_t needle = strv(needle_buf, nlen);
+        searcher_t searcher = searcher_init(needle);
+
+        usize from = test_rand_range(0, len + 2);
+        usize got = searcher_find(&searcher, ctx, from);
+        usize expected = ref_find_view(ctx, needle, from);
+        check(got == expected, "%s find %zu byte needle in %zu bytes from %zu: got %zu, expected %zu", isa_names[isa], nlen, len, from, got, expected);
+
+        got = strv_find_view(ctx, needle, from);
+        check(got == expected, "%s strv_find_view %zu byte needle in %zu bytes from %zu: got %zu, expected %zu", isa_names[isa], nlen, len, from, got, expected);
+
+        got = searcher_rfind(&searcher, ctx, from);
+        expected = ref_rfind_view(ctx, needle, from);
+        check(got == expected, "%s rfind %zu byte needle in %zu bytes from %zu: got %zu, expected %zu", isa_names[isa], nlen, len, from, got, expected);
+
+        got = strv_rfind_view(ctx, needle, from);
+        check(got == expected, "%s strv_rfind_view %zu byte needle in %zu bytes from %zu: got %zu, expected %zu", isa_names[isa], nlen, len, from, got, expected);
+    }
+}
+
+// searches the whole text with one searcher, then piece by piece with strv_find_view,
+// like a caller that looks for the needle in every line
+static void bench_search(strview_t ctx, strview_t needle, usize piece) {
+    usize expected = ref_find_view(ctx, needle, 0);
+    usize found = 0, pieces = 0;
+    char name[64];
+
+    searcher_t searcher = searcher_init(needle);
+    fmt_buffer(name, sizeof(name), "searcher_find (%zu bytes)", needle.len);
+    bench(name, ctx.len, found = searcher_find(&searcher, ctx, 0));
+    check(found == expected, "searcher_find found the needle at %zu, expected %zu", found, expected);
+
+    fmt_buffer(name, sizeof(name), "strv_find_view (%zu bytes, %zu byte pieces)", needle.len, piece);
+    bench(name, ctx.len, {
+        pieces = 0;
+        for (usize i = 0; i < ctx.len; i += piece) {
+            pieces += strv_find_view(strv_sub(ctx, i, i + piece), needle, 0) != STR_NONE;
+        }
+    });
+    check(pieces == (expected != STR_NONE), "strv_find_view found the needle in %zu pieces", pieces);
+}
+
+static void bench_scan(arena_t *arena) {
+    usize len = MB(64);
+    char *text = alloc(arena, char, len, ALLOC_NOZERO);
+    // lines of words, about 60 bytes each
+    for (usize i = 0; i < len; ++i) {
+        u64 r = test_rand_range(0, 60);
+        text[i] = r == 0 ? '\n' : r < 10 ? ' ' : (char)('a' + r % 26);
+    }
+    strview_t ctx = strv(text, len);
+
+    // mostly zeros, like an object file, and only two letters. the first and
+    // last bytes of the needles are everywhere, so the pair kernels hit all the time
+    usize small_len = MB(16);
+    char *binary = alloc(arena, char, small_len, ALLOC_NOZERO);
+    char *two_letters = alloc(arena, char, small_len, ALLOC_NOZERO);
+    for (usize i = 0; i < small_len; ++i) {
+        binary[i] = test_chance(4) ? (char)test_rand() : '\0';
+        two_letters[i] = (char)('a' + test_rand_range(0, 2));
+    }
+    const char binary_needle[] = "\x7f" "ELF\x02\x01\x01\0\0\0\0\0\0\0\0\0\x03\0>\0\x01\0\0\0\0\0\0\0\0\0\0\0@\0\0\0\0\0\0";
+
+    const char *short_needle = "the quick brown";
+    const char *long_needle = "a needle longer than the skip table length";
+    const char *two_letter_needle = "abababababaabbbabababbbbaaabababaabababbbabababa";
+    usize expected_lines = ref_count(ctx, '\n');
+    usize lines = 0, found = 0;
+
+    // called through a volatile pointer, or the compiler runs them only once
+    usize (*volatile plain_count)(strview_t, char) = ref_count;
+    usize (*volatile plain_find)(strview_t, strview_t, usize) = ref_find_view;
+
+    print("64MB of text, %zu lines\n", expected_lines);
+    bench("plain loop count", len, lines = plain_count(ctx, '\n'));
+    bench("plain loop search", len, found = plain_find(ctx, strv(short_needle), 0));
+    check(found == STR_NONE, "the needle is in the text");
+
+    for (scan_isa_e isa = SCAN_ISA_SCALAR; isa <= SCAN_ISA_AVX2; ++isa) {
+        if (!scan_set_isa(isa)) {
+            continue;
+        }
+        print("%s\n", isa_names[isa]);
+        bench("scan_count", len, lines = scan_count(ctx, '\n'));
+        check(lines == expected_lines, "%s counted %zu lines", isa_names[isa], lines);
+        bench("scan_find (no match)", len, found = scan_find(ctx, '#'));
+        bench("scan_rfind (no match)", len, found = scan_rfind(ctx, '#'));
+
+        bench_search(ctx, strv(short_needle), 64);
+        bench_search(ctx, strv(long_needle), 64);
+        bench_search(ctx, strv(long_needle), KB(64));
+
+        print("%s, 16MB of mostly zeros\n", isa_names[isa]);
+        bench_search(strv(binary, small_len), strv(binary_needle, sizeof(binary_needle) - 1), 256);
+        bench_search(strv(binary, small_len), strv(binary_needle, sizeof(binary_needle) - 1), KB(64));
+
+        print("%s, 16MB of 'a' and 'b'\n", isa_names[isa]);
+        bench_search(strv(two_letters, small_len), strv(two_letter_needle), 256);
+        bench_search(strv(two_letters, small_len), strv(two_letter_needle), KB(64));
+    }
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(1));
+    scan_isa_e default_isa = scan_get_isa();
+    print("default kernels: %s\n", isa_names[default_isa]);
+
+    for (scan_isa_e isa = SCAN_ISA_SCALAR; isa <= SCAN_ISA_AVX2; ++isa) {
+        if (!scan_set_isa(isa)) {
+            print("%s is not supported\n", isa_names[isa]);
+            continue;
+        }
+        test_bytes(&arena, isa);
+        test_search(&arena, isa);
+    }
+
+    if (!test_quick()) {
+        bench_scan(&arena);
+    }
+
+    scan_set_isa(default_isa);
+    return test_end();
+}
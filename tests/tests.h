@@ -0,0 +1,95 @@
+#pragma once
+
+// every test is one program that includes colla, from the root of the repo:
+//     nob -O fast -r tests\json.c
+// they print their timings and the checks that failed, the exit code is the
+// number of failed checks. TEST_QUICK=1 skips the benchmarks
+
+#define COLLA_NO_NET 1
+#include "../src/colla/colla.c"
+
+typedef struct test_state_t test_state_t;
+struct test_state_t {
+    int checks;
+    int failed;
+    bool quick;
+    u64 rng;
+};
+
+static test_state_t test__state = {
+    // the same inputs on every run, so a failure can be reproduced
+    .rng = 0x9E3779B97F4A7C15ull,
+};
+
+#define check(cond, ...) do { \
+        test__state.checks++; \
+        if (!(cond)) { \
+            test__state.failed++; \
+            print("%s:%d: ", __FILE__, __LINE__); \
+            print(__VA_ARGS__); \
+            print("\n"); \
+        } \
+    } while (0)
+
+static void test_init(void) {
+    colla_init(COLLA_OS);
+    arena_t scratch = arena_make(ARENA_VIRTUAL, KB(4));
+    str_t quick = os_get_env_var(&scratch, strv("TEST_QUICK"));
+    test__state.quick = quick.len && quick.buf[0] != '0';
+    arena_cleanup(&scratch);
+}
+
+static int test_end(void) {
+    if (test__state.failed) {
+        print("%d of %d checks failed\n", test__state.failed, test__state.checks);
+    }
+    else {
+        print("%d checks passed\n", test__state.checks);
+    }
+    colla_cleanup();
+    return test__state.failed;
+}
+
+static inline bool test_quick(void) {
+    return test__state.quick;
+}
+
+// xorshift64*
+static inline u64 test_rand(void) {
+    u64 x = test__state.rng;
+    x ^= x >> 12;
+    x ^= x << 25;
+    x ^= x >> 27;
+    test__state.rng = x;
+    return x * 0x2545F4914F6CDD1Dull;
+}
+
+// in [lo, hi)
+static inline u64 test_rand_range(u64 lo, u64 hi) {
+    return lo + test_rand() % (hi - lo);
+}
+
+static inline bool test_chance(u64 one_in) {
+    return test_rand() % one_in == 0;
+}
+
+// best of a few runs of the code, bytes is how much one run reads (0 to skip the throughput)
+#define bench(name, bytes, ...) do { \
+        u64 bench__best = UINT64_MAX; \
+        for (int bench__run = 0; bench__run < 5; ++bench__run) { \
+            u64 bench__start = os_time_ms(); \
+            __VA_ARGS__; \
+            bench__best = MIN(bench__best, os_time_ms() - bench__start); \
+        } \
+        test__report(name, bytes, bench__best); \
+    } while (0)
+
+static inline void test__report(const char *name, usize bytes, u64 ms) {
+    if (bytes) {
+        double mb_per_sec = (double)bytes / (1024.0 * 1024.0) / ((double)MAX(ms, 1) / 1000.0);
+        print("    %-32s %6llu ms %8.1f MB/s\n", name, ms, mb_per_sec);
+    }
+    else {
+        print("    %-32s %6llu ms\n", name, ms);
+    }
+}
@@ -0,0 +1,320 @@
+#include "tests.h"
+
+// checks the events of xml_reader_t on hand written xml and html, that random
+// documents give the same events for every chunk size and split, and that truncated
+// xml is an error. then times it against xml_parse_str on a big catalog
+
+// == EVENTS ==========================================
+
+typedef struct feed_t feed_t;
+struct feed_t {
+    usize first; // size of the first chunk
+    usize chunk; // size of the others
+};
+
+// the events as text, like B[p class=x]T[hi]E[p]
+static strview_t read_events(arena_t scratch, outstream_t *out, strview_t doc, xmlflags_e flags, feed_t feed) {
+    ostr_clear(out);
+    xml_reader_t r = xml_reader_init(&scratch, flags);
+    usize fed = MIN(feed.first, doc.len);
+    xml_reader_feed(&r, strv(doc.buf, fed), fed == doc.len);
+
+    while (true) {
+        switch (xml_reader_next(&r)) {
+            case XML_EVENT_NEED_INPUT:
+            {
+                usize len = MIN(feed.chunk, doc.len - fed);
+                xml_reader_feed(&r, strv(doc.buf + fed, len), fed + len == doc.len);
+                fed += len;
+                break;
+            }
+            case XML_EVENT_TAG_BEGIN:
+            {
+                ostr_print(out, "B[%v", r.name);
+                xmlattr_t attr = {0};
+                while (xml_reader_next_attribute(&r, &attr)) {
+                    ostr_print(out, " %v=%v", attr.key, attr.value);
+                }
+                ostr_putc(out, ']');
+                break;
+            }
+            case XML_EVENT_TAG_END:
+                ostr_print(out, "E[%v]", r.name);
+                break;
+            case XML_EVENT_TEXT:
+                ostr_print(out, "T[%v]", r.text);
+                break;
+            case XML_EVENT_DONE:
+                return ostr_as_view(out);
+            case XML_EVENT_ERROR:
+                ostr_puts(out, strv("ERROR"));
+                return ostr_as_view(out);
+        }
+    }
+}
+
+// every chunk size and every split in two has to give the same events
+static void check_every_feed(arena_t *arena, outstream_t *expected_out, outstream_t *out, strview_t doc, xmlflags_e flags) {
+    strview_t expected = read_events(*arena, expected_out, doc, flags, (feed_t){ doc.len, doc.len });
+    for (usize size = 1; size < doc.len; ++size) {
+        strview_t got = read_events(*arena, out, doc, flags, (feed_t){ size, size });
+        check(strv_equals(got, expected), "%v\n    with %zu byte chunks: %v\n    expected: %v", doc, size, got, expected);
+    }
+    for (usize split = 0; split < doc.len; ++split) {
+        strview_t got = read_events(*arena, out, doc, flags, (feed_t){ split, doc.len });
+        check(strv_equals(got, expected), "%v\n    split at %zu: %v\n    expected: %v", doc, split, got, expected);
+    }
+}
+
+// == TESTS ===========================================
+
+typedef struct sample_t sample_t;
+struct sample_t {
+    xmlflags_e flags;
+    const char *doc;
+    const char *events;
+};
+
+static sample_t samples[] = {
+    { XML_DEFAULT, "<a><b x=\"1\" y='2'>hi</b><c/></a>", "B[a]B[b x=1 y=2]T[hi]E[b]B[c]E[c]E[a]" },
+    { XML_DEFAULT, "<?xml version=\"1.0\"?><!DOCTYPE r><r><!-- a > b --><![CDATA[1 < 2]]></r>", "B[r]T[1 < 2]E[r]" },
+    { XML_DEFAULT, "<r a=\"x>y\" b='/>'>  text  \n</r>", "B[r a=x>y b=/>]T[text]E[r]" },
+    { XML_DEFAULT, "<r><?pi a > b ?>t</r>", "B[r]T[t]E[r]" },
+    { XML_DEFAULT, "<a><b></a>", "B[a]B[b]ERROR" },
+    { XML_DEFAULT, "<a>", "B[a]ERROR" },
+    { XML_DEFAULT, "<a>3 < 4</a>", "B[a]T[3]ERROR" },
+    { XML_HTML, "<p>3 < 4</p>", "B[p]T[3 < 4]E[p]" },
+    { XML_HTML, "<p>a<</p>", "B[p]T[a<]E[p]" },
+    { XML_HTML, "<p>1 <= 2 <3 < </p>", "B[p]T[1 <= 2 <3 <]E[p]" },
+    { XML_HTML, "<", "T[<]" },
+    { XML_HTML, "< <b>x</b>", "T[<]B[b]T[x]E[b]" },
+    { XML_HTML, "<P>one<p>two<DIV>three</div>", "B[P]T[one]E[P]B[p]T[two]E[p]B[DIV]T[three]E[DIV]" },
+    { XML_HTML, "<ul><li>a<br>b<img src=x.png alt=\"it's\"></ul>", "B[ul]B[li]T[a]B[br]E[br]T[b]B[img src=x.png alt=it's]E[img]E[li]E[ul]" },
+    { XML_HTML, "<script>if (a < b && c > d) x = '</scr' + 'ipt>';</script>", "B[script]T[if (a < b && c > d) x = '</scr' + 'ipt>';]E[script]" },
+    { XML_HTML, "<div></span>x</div>", "B[div]T[x]E[div]" },
+    { XML_HTML, "<input disabled value=a>", "B[input disabled= value=a]E[input]" },
+};
+
+static void test_samples(arena_t *arena, outstream_t *a, outstream_t *b) {
+    for (usize i = 0; i < arrlen(samples); ++i) {
+        strview_t doc = strv(samples[i].doc);
+        strview_t got = read_events(*arena, a, doc, samples[i].flags, (feed_t){ doc.len, doc.len });
+        check(strv_equals(got, strv(samples[i].events)), "%v\n    got:      %v\n    expected: %s", doc, got, samples[i].events);
+        check_every_feed(arena, a, b, doc, samples[i].flags);
+    }
+    print("%zu samples\n", arrlen(samples));
+}
+
+// == GENERATOR =======================================
+
+static const char *gen_names[] = { "a", "item", "b", "title", "p", "div", "x-y", "ns:tag" };
+
+static void gen_text(outstream_t *out, bool is_html) {
+    static const char *pieces[] = { "hello", " ", "\n", "&amp;", "&lt;", "a > b", "\"q\"", "'", "/", "=" };
+    static const char *html_pieces[] = { "3 < 4", "a<", " <= ", "< " };
+    usize count = test_rand_range(1, 5);
+    for (usize i = 0; i < count; ++i) {
+        if (is_html && test_chance(3)) {
+            ostr_puts(out, strv(html_pieces[test_rand_range(0, arrlen(html_pieces))]));
+        }
+        else {
+            ostr_puts(out, strv(pieces[test_rand_range(0, arrlen(pieces))]));
+        }
+    }
+}
+
+static void gen_element(outstream_t *out, int depth, bool is_html) {
+    const char *name = gen_names[test_rand_range(0, arrlen(gen_names))];
+    ostr_print(out, "<%s", name);
+    usize attr_count = test_rand_range(0, 3);
+    for (usize i = 0; i < attr_count; ++i) {
+        const char *quote = test_chance(2) ? "\"" : "'";
+        ostr_print(out, "%sk%zu%s=%s%s%s", test_chance(3) ? "\n  " : " ", i, test_chance(4) ? " " : "", quote, test_chance(3) ? "a > /b" : "v", quote);
+    }
+    if (test_chance(5)) {
+        ostr_puts(out, strv(test_chance(2) ? "/>" : " />"));
+        return;
+    }
+    ostr_putc(out, '>');
+
+    usize count = depth < 5 ? test_rand_range(0, 5) : 0;
+    for (usize i = 0; i < count; ++i) {
+        switch (test_rand_range(0, 6)) {
+            case 0: ostr_puts(out, strv("<!-- a - b > c -->"));       break;
+            case 1: ostr_puts(out, strv("<![CDATA[ x < y ]] > ]]>")); break;
+            case 2: ostr_puts(out, strv("<?pi a=\"?\" ?>"));          break;
+            case 3: gen_text(out, is_html);                           break;
+            default: gen_element(out, depth + 1, is_html);            break;
+        }
+    }
+    ostr_print(out, "</%s>", name);
+}
+
+// root is where the root element starts
+static strview_t gen_document(outstream_t *out, bool is_html, usize *root) {
+    ostr_clear(out);
+    if (test_chance(2)) ostr_puts(out, strv("<?xml version=\"1.0\"?>\n"));
+    if (test_chance(3)) ostr_puts(out, strv("<!DOCTYPE doc>\n"));
+    *root = ostr_tell(out);
+    gen_element(out, 0, is_html);
+    return ostr_as_view(out);
+}
+
+static void test_random_documents(arena_t *arena, outstream_t *gen, outstream_t *a, outstream_t *b) {
+    int count = test_quick() ? 200 : 2000;
+    for (int n = 0; n < count; ++n) {
+        bool is_html = n % 2;
+        xmlflags_e flags = is_html ? XML_HTML : XML_DEFAULT;
+        usize root = 0;
+        strview_t doc = gen_document(gen, is_html, &root);
+
+        strview_t events = read_events(*arena, a, doc, flags, (feed_t){ doc.len, doc.len });
+        check(!strv_ends_with_view(events, strv("ERROR")), "valid document gave an error: %v\n    %v", doc, events);
+
+        if (doc.len < 400) {
+            check_every_feed(arena, a, b, doc, flags);
+        }
+        else {
+            for (int i = 0; i < 20; ++i) {
+                feed_t feed = { test_rand_range(0, doc.len), test_rand_range(1, 64) };
+                strview_t got = read_events(*arena, b, doc, flags, feed);
+                check(strv_equals(got, events), "%v\n    first chunk %zu, then %zu: %v\n    expected: %v", doc, feed.first, feed.chunk, got, events);
+            }
+        }
+
+        if (!is_html) {
+            // the root element can't be closed yet
+            strview_t cut = strv(doc.buf, test_rand_range(root + 1, doc.len));
+            strview_t got = read_events(*arena, b, cut, flags, (feed_t){ 7, 7 });
+            check(strv_ends_with_view(got, strv("ERROR")), "truncated document was accepted: %v\n    %v", cut, got);
+        }
+    }
+    print("%d random documents\n", count);
+}
+
+// == BENCHMARK =======================================
+
+static strview_t gen_catalog(outstream_t *out, usize size) {
+    ostr_clear(out);
+    ostr_puts(out, strv("<?xml version=\"1.0\"?>\n<catalog>\n"));
+    for (u64 id = 0; ostr_tell(out) < size; ++id) {
+        ostr_print(
+            out,
+            "  <book id=\"bk%llu\" lang='en'>\n"
+            "    <author>Author %llu</author>\n"
+            "    <title>Title of book %llu &amp; more</title>\n"
+            "    <genre>Genre %llu</genre>\n"
+            "    <price>%llu.%02llu</price>\n"
+            "    <publish_date>2000-10-%02llu</publish_date>\n"
+            "    <description>A description of book %llu, with some &lt;escaped&gt; text.</description>\n"
+            "  </book>\n",
+            id, id % 1000, id, id % 20, id % 100, id % 97, id % 28 + 1, id
+        );
+    }
+    ostr_puts(out, strv("</catalog>\n"));
+    return ostr_as_view(out);
+}
+
+static double sum_prices_reader(arena_t scratch, strview_t doc, usize chunk_size, usize *memory) {
+    usize start = arena_tell(&scratch);
+    xml_path_t path = xml_path_init(&scratch, strv("catalog/book/price"));
+    xml_reader_t r = xml_reader_init(&scratch, XML_DEFAULT);
+    usize fed = MIN(chunk_size, doc.len);
+    xml_reader_feed(&r, strv(doc.buf, fed), fed == doc.len);
+
+    double sum = 0;
+    bool in_price = false;
+    while (true) {
+        xml_event_e event = in_price ? xml_reader_next(&r) : xml_reader_select(&r, &path, 1, &(int){0});
+        if (event == XML_EVENT_NEED_INPUT) {
+            usize len = MIN(chunk_size, doc.len - fed);
+            xml_reader_feed(&r, strv(doc.buf + fed, len), fed + len == doc.len);
+            fed += len;
+        }
+        else if (event == XML_EVENT_TAG_BEGIN) {
+            in_price = true;
+        }
+        else if (event == XML_EVENT_TEXT) {
+            instream_t in = istr_init(r.text);
+            double price = 0;
+            istr_get_num(&in, &price);
+            sum += price;
+            in_price = false;
+        }
+        else if (event == XML_EVENT_DONE) {
+            break;
+        }
+        else {
+            check(false, "the catalog gave an error after %zu bytes", fed);
+            break;
+        }
+    }
+
+    if (memory) {
+        *memory = arena_tell(&scratch) - start;
+    }
+    return sum;
+}
+
+static double sum_prices_tree(arena_t scratch, strview_t doc, usize *memory) {
+    usize start = arena_tell(&scratch);
+    xml_t xml = xml_parse_str(&scratch, doc);
+    double sum = 0;
+    xmltag_t *catalog = xml_get_tag(xml.root, strv("catalog"), false);
+    for (xmltag_t *book = catalog ? catalog->child : NULL; book; book = book->next) {
+        xmltag_t *price = xml_get_tag(book, strv("price"), false);
+        if (price) {
+            instream_t in = istr_init(price->content);
+            double value = 0;
+            istr_get_num(&in, &value);
+            sum += value;
+        }
+    }
+    *memory = arena_tell(&scratch) - start;
+    return sum;
+}
+
+static void bench_catalog(arena_t *arena, outstream_t *out) {
+    strview_t doc = gen_catalog(out, MB(100));
+    print("benchmark on a %_$$$dB catalog, selecting catalog/book/price\n", doc.len);
+
+    double expected = sum_prices_reader(*arena, doc, doc.len, NULL);
+    usize reader_mem = 0, reader_chunked_mem = 0, tree_mem = 0;
+
+    bench("xml_reader_t, 4KB chunks", doc.len, {
+        double sum = sum_prices_reader(*arena, doc, KB(4), &reader_chunked_mem);
+        check(sum == expected, "the prices add up to %f instead of %f", sum, expected);
+    });
+
+    bench("xml_reader_t, one chunk", doc.len, {
+        sum_prices_reader(*arena, doc, doc.len, &reader_mem);
+    });
+
+    bench("xml_parse_str and walk", doc.len, {
+        double sum = sum_prices_tree(*arena, doc, &tree_mem);
+        check(sum == expected, "the tree prices add up to %f instead of %f", sum, expected);
+    });
+
+    print("    memory: reader %_$$$dB (4KB chunks) %_$$$dB (one chunk), tree %_$$$dB\n", reader_chunked_mem, reader_mem, tree_mem);
+}
+
+int main(void) {
+    test_init();
+
+    arena_t arena = arena_make(ARENA_VIRTUAL, GB(4));
+    arena_t gen_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    arena_t a_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    arena_t b_arena = arena_make(ARENA_VIRTUAL, GB(1));
+    outstream_t gen = ostr_init(&gen_arena);
+    outstream_t a = ostr_init(&a_arena);
+    outstream_t b = ostr_init(&b_arena);
+
+    test_samples(&arena, &a, &b);
+    test_random_documents(&arena, &gen, &a, &b);
+
+    if (!test_quick()) {
+        bench_catalog(&arena, &gen);
+    }
+
+    return test_end();
+}